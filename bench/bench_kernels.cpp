@@ -0,0 +1,189 @@
+// Scalar kernels: great-circle distance, the E6B computations, E6B worksheet sessions (including a
+// long dependency chain), and the weight-and-balance batch search.
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench/harness.hpp"
+#include "core/density.hpp"
+#include "core/e6b.hpp"
+#include "core/e6b_session.hpp"
+#include "core/geo.hpp"
+#include "core/strutil.hpp"
+#include "core/weight_balance.hpp"
+
+using namespace flightsuite;
+
+// Inputs vary per call so the compiler cannot hoist the math out of the loop.
+struct Inputs {
+    std::vector<double> a, b, c, d;
+    explicit Inputs(size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            a.push_back(10.0 + static_cast<double>(i % 70));
+            b.push_back(-120.0 + static_cast<double>(i % 240));
+            c.push_back(static_cast<double>((i * 37) % 360));
+            d.push_back(5.0 + static_cast<double>(i % 40));
+        }
+    }
+};
+
+constexpr size_t kBatch = 1024;
+
+static void haversine(bench::State& state) {
+    Inputs in(kBatch);
+    state.set_items_per_iter(kBatch);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (size_t i = 0; i < kBatch; ++i) acc += haversine_nm(in.a[i], in.b[i], in.a[kBatch - 1 - i], in.b[kBatch - 1 - i]);
+        bench::do_not_optimize(acc);
+    }
+}
+FS_BENCHMARK(haversine);
+
+static void e6b_wind_triangle(bench::State& state) {
+    Inputs in(kBatch);
+    state.set_items_per_iter(kBatch);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (size_t i = 0; i < kBatch; ++i) acc += wind_triangle(in.c[i], 120.0, in.c[kBatch - 1 - i], in.d[i]).groundspeed_kt;
+        bench::do_not_optimize(acc);
+    }
+}
+FS_BENCHMARK(e6b_wind_triangle);
+
+static void e6b_components(bench::State& state) {
+    Inputs in(kBatch);
+    state.set_items_per_iter(kBatch);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (size_t i = 0; i < kBatch; ++i) {
+            acc += crosswind_component(in.c[i], in.d[i], 220.0) + headwind_component(in.c[i], in.d[i], 220.0);
+        }
+        bench::do_not_optimize(acc);
+    }
+}
+FS_BENCHMARK(e6b_components);
+
+static void e6b_density_altitude(bench::State& state) {
+    Inputs in(kBatch);
+    state.set_items_per_iter(kBatch);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (size_t i = 0; i < kBatch; ++i) {
+            acc += density_altitude_ft(pressure_altitude_ft(in.a[i] * 50.0, 29.5 + in.d[i] / 40.0), in.d[i] - 10.0);
+        }
+        bench::do_not_optimize(acc);
+    }
+}
+FS_BENCHMARK(e6b_density_altitude);
+
+// Column pass over a whole cycle's worth of stations (core/density).
+static void density_altitude_columns(bench::State& state) {
+    Inputs in(kBatch);
+    StationObsColumns obs;
+    for (size_t i = 0; i < kBatch; ++i) {
+        obs.station.emplace_back();
+        obs.elevation_ft.push_back(in.a[i] * 50.0);
+        obs.altimeter_inhg.push_back(29.5 + in.d[i] / 40.0);
+        obs.temperature_c.push_back(in.d[i] - 10.0);
+    }
+    DensityColumns out;
+    std::vector<double> factors;
+    state.set_items_per_iter(kBatch);
+    for (auto _ : state) {
+        compute_density_altitudes(obs, out);
+        takeoff_distance_factors(AirframeClass::kPistonSingle, out.density_alt_ft, factors);
+        bench::do_not_optimize(factors.data());
+    }
+}
+FS_BENCHMARK(density_altitude_columns);
+
+static void e6b_mach_tas(bench::State& state) {
+    Inputs in(kBatch);
+    state.set_items_per_iter(kBatch);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (size_t i = 0; i < kBatch; ++i) {
+            acc += tas_from_mach(mach_from_tas(300.0 + in.c[i], -in.d[i]), -in.d[i]);
+        }
+        bench::do_not_optimize(acc);
+    }
+}
+FS_BENCHMARK(e6b_mach_tas);
+
+// The sample planning worksheet, parsed and evaluated from scratch each iteration.
+static void e6b_worksheet_full(bench::State& state) {
+    auto text = read_file(std::string(FLIGHTSUITE_SOURCE_DIR) + "/e6bTool/plan.e6b").value_or("");
+    for (auto _ : state) {
+        E6bSession session;
+        std::ostringstream out;
+        session.run_script(text, out);
+        bench::do_not_optimize(out.tellp());
+    }
+}
+FS_BENCHMARK(e6b_worksheet_full);
+
+// The same worksheet kept live: one input changes, and reading the final burn recomputes only
+// the chain below it.
+static void e6b_worksheet_update(bench::State& state) {
+    auto text = read_file(std::string(FLIGHTSUITE_SOURCE_DIR) + "/e6bTool/plan.e6b").value_or("");
+    E6bSession session;
+    std::ostringstream out;
+    session.run_script(text, out);
+    double wind = 0.0;
+    for (auto _ : state) {
+        wind = wind >= 40.0 ? 0.0 : wind + 1.0;
+        session.set("wind_kt", wind);
+        bench::do_not_optimize(session.get("burn"));
+    }
+}
+FS_BENCHMARK(e6b_worksheet_update);
+
+// Arg = chain length: x1 = x0 + 1 ... xN = xN-1 + 1, then the base changes and the tail is read,
+// so every link is invalidated and recomputed. Chains this long used to overflow the stack.
+static void e6b_session_long_chain(bench::State& state) {
+    size_t n = static_cast<size_t>(state.arg());
+    E6bSession session;
+    std::string out;
+    session.run_line("x0 = 0", out, false);
+    for (size_t i = 1; i < n; ++i) {
+        session.run_line("x" + std::to_string(i) + " = x" + std::to_string(i - 1) + " + 1", out, false);
+    }
+    std::string tail = "x" + std::to_string(n - 1);
+    double base = 0.0;
+    state.set_items_per_iter(n);
+    for (auto _ : state) {
+        session.set("x0", ++base);
+        auto v = session.get(tail);
+        if (!v || *v != base + static_cast<double>(n - 1)) std::abort();
+        bench::do_not_optimize(v);
+    }
+}
+FS_BENCHMARK(e6b_session_long_chain, 100000);
+
+// Arg = candidates per station on the sample 737 (four stations), with 8 fuel uplifts and 4 trip
+// burns: 131072 loadings at 8, each checked at zero fuel, takeoff, three burn points, and landing.
+static void wb_batch_loadings(bench::State& state) {
+    WbAirframe af;
+    load_wb_airframe(std::string(FLIGHTSUITE_SOURCE_DIR) + "/weightBalance/b738.wb", af);
+    WbBatchOptions opt;
+    size_t n = static_cast<size_t>(state.arg());
+    opt.station_candidates.resize(af.stations.size());
+    for (size_t s = 0; s < af.stations.size(); ++s) {
+        for (size_t i = 0; i < n; ++i) {
+            opt.station_candidates[s].push_back(af.stations[s].max_weight * static_cast<double>(i) / static_cast<double>(n - 1));
+        }
+    }
+    for (int i = 0; i < 8; ++i) opt.fuel_candidates.push_back(6000.0 + 2000.0 * i);
+    for (int i = 0; i < 4; ++i) opt.burn_candidates.push_back(3000.0 + 2000.0 * i);
+    opt.taxi = 200.0;
+    size_t total = 32;
+    for (size_t s = 0; s < af.stations.size(); ++s) total *= n;
+    state.set_items_per_iter(total);
+    for (auto _ : state) {
+        auto result = evaluate_batch(af, opt);
+        bench::do_not_optimize(result.feasible);
+    }
+}
+FS_BENCHMARK(wb_batch_loadings, 8);
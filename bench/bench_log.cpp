@@ -0,0 +1,26 @@
+// Flight log full-text search.
+#include <string>
+#include <vector>
+
+#include "bench/fixtures.hpp"
+#include "bench/harness.hpp"
+#include "core/log_index.hpp"
+
+using namespace flightsuite;
+
+// Arg = log entries; the index is built once, untimed, and each iteration runs a mix of word,
+// phrase, and field-restricted queries against it.
+static void log_index_search(bench::State& state) {
+    std::string csv = bench::synthetic_flight_log_file(static_cast<size_t>(state.arg()));
+    LogIndex index;
+    index.open(csv, log_index_path(csv), true);
+    const std::vector<std::string> queries = {"ILS", "remarks:\"ILS 16R\"", "route:J70", "\"RNAV (GPS) Y 34L\"",
+                                              "night remarks:crosswind", "LOCAL"};
+    state.set_items_per_iter(queries.size());
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& q : queries) hits += index.search(q)->size();
+        bench::do_not_optimize(hits);
+    }
+}
+FS_BENCHMARK(log_index_search, 1000000);
@@ -0,0 +1,53 @@
+// METAR decoding throughput.
+#include <sstream>
+
+#include "bench/fixtures.hpp"
+#include "bench/harness.hpp"
+#include "core/metar.hpp"
+
+using namespace flightsuite;
+
+static void decode_metar_single(bench::State& state) {
+    const std::string raw = "KJFK 011651Z 18012G18KT 1 1/2SM -RA BR BKN025 OVC035 18/12 A2992 RMK AO2";
+    state.set_bytes_per_iter(raw.size());
+    for (auto _ : state) {
+        auto m = decode_metar(raw);
+        bench::do_not_optimize(m);
+    }
+}
+FS_BENCHMARK(decode_metar_single);
+
+// Arg = reports decoded per iteration (synthetic mix of US/ICAO groups).
+static void decode_metar_batch(bench::State& state) {
+    auto raws = bench::synthetic_metars(static_cast<size_t>(state.arg()));
+    size_t bytes = 0;
+    for (const auto& r : raws) bytes += r.size();
+    state.set_bytes_per_iter(bytes);
+    state.set_items_per_iter(raws.size());
+    for (auto _ : state) {
+        for (const auto& r : raws) {
+            auto m = decode_metar(r);
+            bench::do_not_optimize(m);
+        }
+    }
+}
+FS_BENCHMARK(decode_metar_batch, 10, 100, 1000);
+
+// Classification alone: every body token of 1000 synthetic reports, one dispatch per token.
+static void classify_metar_tokens(bench::State& state) {
+    std::vector<std::string> tokens;
+    for (const auto& raw : bench::synthetic_metars(1000)) {
+        std::istringstream in(raw);
+        std::string t;
+        for (int i = 0; in >> t; ++i) {
+            if (i >= 2) tokens.push_back(t); // skip station and time
+        }
+    }
+    state.set_items_per_iter(tokens.size());
+    for (auto _ : state) {
+        unsigned sum = 0;
+        for (const auto& t : tokens) sum += static_cast<unsigned>(classify_metar_group(t));
+        bench::do_not_optimize(sum);
+    }
+}
+FS_BENCHMARK(classify_metar_tokens);
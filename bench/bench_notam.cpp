@@ -0,0 +1,38 @@
+// NOTAM parsing and scoring.
+#include "bench/fixtures.hpp"
+#include "bench/harness.hpp"
+#include "core/notam.hpp"
+
+using namespace flightsuite;
+
+static void parse_notams_fixture(bench::State& state) {
+    const std::string text = bench::read_fixture("notamTool/sample_notams.txt");
+    state.set_bytes_per_iter(text.size());
+    for (auto _ : state) {
+        auto ns = parse_notams_text(text, "KJFK");
+        bench::do_not_optimize(ns);
+    }
+}
+FS_BENCHMARK(parse_notams_fixture);
+
+// Arg = NOTAM lines per dump.
+static void parse_notams_text_lines(bench::State& state) {
+    const std::string text = bench::synthetic_notams_text(static_cast<size_t>(state.arg()));
+    state.set_bytes_per_iter(text.size());
+    state.set_items_per_iter(static_cast<uint64_t>(state.arg()));
+    for (auto _ : state) {
+        auto ns = parse_notams_text(text, "KAAA");
+        bench::do_not_optimize(ns);
+    }
+}
+FS_BENCHMARK(parse_notams_text_lines, 10, 100, 1000);
+
+static void score_notams_lines(bench::State& state) {
+    auto ns = parse_notams_text(bench::synthetic_notams_text(static_cast<size_t>(state.arg())), "KAAA");
+    state.set_items_per_iter(ns.size());
+    for (auto _ : state) {
+        auto r = score_notams(ns, "KAAA");
+        bench::do_not_optimize(r);
+    }
+}
+FS_BENCHMARK(score_notams_lines, 100, 1000);
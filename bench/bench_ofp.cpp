@@ -0,0 +1,55 @@
+// SimBrief OFP extraction: navlog fixes and tag lookups, and Monte Carlo over a navlog.
+#include "bench/fixtures.hpp"
+#include "bench/harness.hpp"
+#include "core/montecarlo.hpp"
+#include "core/ofp.hpp"
+
+using namespace flightsuite;
+
+// Arg = navlog fixes in the OFP.
+static void parse_navlog_fixes_n(bench::State& state) {
+    const std::string xml = bench::synthetic_ofp_xml(static_cast<size_t>(state.arg()));
+    state.set_bytes_per_iter(xml.size());
+    state.set_items_per_iter(static_cast<uint64_t>(state.arg()));
+    for (auto _ : state) {
+        auto fixes = parse_navlog_fixes(xml);
+        bench::do_not_optimize(fixes);
+    }
+}
+FS_BENCHMARK(parse_navlog_fixes_n, 10, 100, 1000);
+
+// Tag near the top of the document.
+static void tag_value_early(bench::State& state) {
+    const std::string xml = bench::synthetic_ofp_xml(static_cast<size_t>(state.arg()));
+    state.set_bytes_per_iter(xml.size());
+    for (auto _ : state) {
+        auto v = tag_value(xml, {"icao_airline"});
+        bench::do_not_optimize(v);
+    }
+}
+FS_BENCHMARK(tag_value_early, 100, 1000);
+
+// Tag after the navlog, reached only after trying two absent aliases (print_summary's pattern).
+static void tag_value_late_fallback(bench::State& state) {
+    const std::string xml = bench::synthetic_ofp_xml(static_cast<size_t>(state.arg()));
+    state.set_bytes_per_iter(xml.size());
+    for (auto _ : state) {
+        auto v = tag_value(xml, {"zfw", "estimated_zfw", "plan_zfw"});
+        bench::do_not_optimize(v);
+    }
+}
+FS_BENCHMARK(tag_value_late_fallback, 100, 1000);
+
+// Arg = trials over a 60-fix navlog (59 legs), on one thread so the number is per core.
+static void trip_montecarlo(bench::State& state) {
+    auto legs = trip_legs_from_ofp(bench::synthetic_ofp_xml(60), 450.0, 5000.0);
+    MonteCarloOptions opt;
+    opt.trials = static_cast<size_t>(state.arg());
+    opt.threads = 1;
+    state.set_items_per_iter(opt.trials);
+    for (auto _ : state) {
+        auto result = run_trip_montecarlo(legs, opt);
+        bench::do_not_optimize(result.minutes.p95);
+    }
+}
+FS_BENCHMARK(trip_montecarlo, 20000);
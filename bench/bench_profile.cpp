@@ -0,0 +1,39 @@
+// Vertical profile interpolation.
+#include "bench/fixtures.hpp"
+#include "bench/harness.hpp"
+#include "core/profile.hpp"
+
+using namespace flightsuite;
+
+// Arg = samples over the bundled route_sample.csv.
+static void interpolate_profile_fixture(bench::State& state) {
+    auto route = parse_route_csv(bench::read_fixture("verticalProfile/route_sample.csv"));
+    int samples = static_cast<int>(state.arg());
+    state.set_items_per_iter(static_cast<uint64_t>(samples) + 1);
+    for (auto _ : state) {
+        auto p = interpolate_profile(route, samples);
+        bench::do_not_optimize(p);
+    }
+}
+FS_BENCHMARK(interpolate_profile_fixture, 200, 2000);
+
+// Arg = waypoints in a synthetic route, sampled 2000 times.
+static void interpolate_profile_waypoints(bench::State& state) {
+    auto route = bench::synthetic_route(static_cast<size_t>(state.arg()));
+    state.set_items_per_iter(2001);
+    for (auto _ : state) {
+        auto p = interpolate_profile(route, 2000);
+        bench::do_not_optimize(p);
+    }
+}
+FS_BENCHMARK(interpolate_profile_waypoints, 100, 1000);
+
+static void parse_route_csv_fixture(bench::State& state) {
+    const std::string text = bench::read_fixture("verticalProfile/route_sample.csv");
+    state.set_bytes_per_iter(text.size());
+    for (auto _ : state) {
+        auto r = parse_route_csv(text);
+        bench::do_not_optimize(r);
+    }
+}
+FS_BENCHMARK(parse_route_csv_fixture);
@@ -0,0 +1,209 @@
+// Route suggestion, area filters, spatial queries, grid interpolation, navdata lookups, route
+// expansion, and airway routing.
+#include <cmath>
+#include <random>
+
+#include "bench/fixtures.hpp"
+#include "bench/harness.hpp"
+#include "core/airway_router.hpp"
+#include "core/fuel_stops.hpp"
+#include "core/geo.hpp"
+#include "core/geofilter.hpp"
+#include "core/grid.hpp"
+#include "core/navdata.hpp"
+#include "core/route_string.hpp"
+#include "core/routes.hpp"
+#include "core/schedule.hpp"
+#include "core/spatial.hpp"
+
+using namespace flightsuite;
+
+static void run_suggest(bench::State& state, const std::vector<Airport>& airports) {
+    auto by_icao = index_by_icao(airports);
+    Aircraft ac;
+    ac.name = "KingAir";
+    ac.role = "Turboprop";
+    ac.range_nm = 1200;
+    ac.home = airports.front().icao;
+    std::mt19937 gen(42);
+    state.set_items_per_iter(airports.size());
+    for (auto _ : state) {
+        auto s = suggest_routes(ac, by_icao, airports, 3, GeoFilter{}, false, gen);
+        bench::do_not_optimize(s);
+    }
+}
+
+static void suggest_routes_fixture(bench::State& state) {
+    std::string path = std::string(FLIGHTSUITE_SOURCE_DIR) + "/flightIdeas/airports.csv";
+    run_suggest(state, load_airports(path));
+}
+FS_BENCHMARK(suggest_routes_fixture);
+
+// Arg = airports in a synthetic catalog.
+static void suggest_routes_catalog(bench::State& state) {
+    run_suggest(state, bench::synthetic_airports(static_cast<size_t>(state.arg())));
+}
+FS_BENCHMARK(suggest_routes_catalog, 1000, 10000, 70000);
+
+// Arg = airports in a synthetic catalog; masked by a 4000-vertex ragged ring around the middle
+// of the contiguous US (a coastline-like outline), prepared once outside the loop.
+static void geofilter_polygon_mask(bench::State& state) {
+    auto airports = bench::synthetic_airports(static_cast<size_t>(state.arg()));
+    std::vector<GeoPoint> ring;
+    for (int i = 0; i < 4000; ++i) {
+        double t = 2.0 * kPi * i / 4000.0;
+        double r = 12.0 + 3.0 * std::sin(7.0 * t) + 0.5 * std::sin(131.0 * t);
+        ring.push_back({39.0 + r * std::sin(t), -98.0 + 1.6 * r * std::cos(t)});
+    }
+    GeoFilter area;
+    area.set_polygon(PreparedPolygon({ring}));
+    state.set_items_per_iter(airports.size());
+    for (auto _ : state) {
+        auto mask = area.mask(airports);
+        bench::do_not_optimize(mask.data());
+    }
+}
+FS_BENCHMARK(geofilter_polygon_mask, 70000);
+
+// Arg = airports in a synthetic catalog; 50 King Air trips (4000 ft runways, 1080 nm legs)
+// between random airports anywhere, fewest stops, one reused planner.
+static void fuel_stop_plan(bench::State& state) {
+    auto airports = bench::synthetic_airports(static_cast<size_t>(state.arg()));
+    FuelStopPlanner planner(airports, 4000);
+    std::vector<std::pair<size_t, size_t>> trips;
+    for (size_t i = 0; i < 50; ++i) trips.emplace_back((i * 7919) % airports.size(), (i * 104729 + 13) % airports.size());
+    state.set_items_per_iter(trips.size());
+    for (auto _ : state) {
+        size_t stops = 0;
+        for (const auto& [a, b] : trips) stops += planner.plan(airports[a], airports[b], 1080.0).stops.size();
+        bench::do_not_optimize(stops);
+    }
+}
+FS_BENCHMARK(fuel_stop_plan, 70000);
+
+// Arg = aircraft; a mixed fleet based at every 17th airport of a 5000-airport catalog, four
+// restarts on one thread so the number does not depend on the core count.
+static void schedule_fleet(bench::State& state) {
+    auto airports = bench::synthetic_airports(5000);
+    static const char* const kRoles[] = {"Shorthaul Jet", "Regional Jet", "Turboprop", "GA Piston"};
+    static const double kRanges[] = {2900.0, 2000.0, 1500.0, 700.0};
+    std::vector<Aircraft> fleet(static_cast<size_t>(state.arg()));
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        fleet[i].name = "AC" + std::to_string(i);
+        fleet[i].role = kRoles[i % 4];
+        fleet[i].range_nm = kRanges[i % 4];
+        fleet[i].home = airports[(i * 17) % airports.size()].icao;
+    }
+    ScheduleOptions opt;
+    opt.threads = 1;
+    opt.restarts = 4;
+    state.set_items_per_iter(fleet.size());
+    for (auto _ : state) {
+        auto sched = build_schedule(fleet, airports, opt);
+        bench::do_not_optimize(sched.covered);
+    }
+}
+FS_BENCHMARK(schedule_fleet, 300);
+
+// Arg = stations indexed; each iteration answers one 400-fix navlog's nearest-station queries.
+static void spatial_nearest_batch(bench::State& state) {
+    auto airports = bench::synthetic_airports(static_cast<size_t>(state.arg()));
+    std::vector<GeoPoint> points;
+    for (const auto& a : airports) points.push_back({a.lat, a.lon});
+    SpatialIndex index(points);
+    std::vector<GeoPoint> queries;
+    for (size_t i = 0; i < 400; ++i) queries.push_back(points[(i * 7919) % points.size()]);
+    for (auto& q : queries) q.lat += 0.3;
+    std::vector<std::vector<SpatialHit>> hits;
+    state.set_items_per_iter(queries.size());
+    for (auto _ : state) {
+        index.nearest_batch(queries, 1, 50.0, hits);
+        bench::do_not_optimize(hits.data());
+    }
+}
+FS_BENCHMARK(spatial_nearest_batch, 1000, 20000);
+
+// Arg = stations; a 0.1 deg contiguous-US grid with k = 6, on one thread so runs are comparable.
+static void idw_grid_conus(bench::State& state) {
+    auto airports = bench::synthetic_airports(static_cast<size_t>(state.arg()));
+    std::vector<GeoPoint> points;
+    std::vector<double> values;
+    for (const auto& a : airports) {
+        points.push_back({a.lat, a.lon});
+        values.push_back(static_cast<double>((a.icao.size() * 977u + points.size() * 131u) % 12000u));
+    }
+    SpatialIndex index(points);
+    GridSpec spec;
+    IdwOptions opt;
+    opt.threads = 1;
+    state.set_items_per_iter(spec.rows() * spec.cols());
+    for (auto _ : state) {
+        GridField grid = idw_grid(index, values, spec, opt);
+        bench::do_not_optimize(grid.values.data());
+    }
+}
+FS_BENCHMARK(idw_grid_conus, 20000);
+
+// Arg = enroute fixes; each iteration maps the compiled database and resolves 1000 idents near
+// their own positions, the way a tool resolving one route's waypoints would.
+static void navdata_open_resolve(bench::State& state) {
+    std::string path = bench::synthetic_navdata_file(static_cast<size_t>(state.arg()));
+    NavDatabase probe;
+    probe.open(path);
+    std::vector<std::string> idents;
+    std::vector<GeoPoint> near;
+    for (size_t i = 0; i < 1000; ++i) {
+        NavPoint p = probe.point(static_cast<uint32_t>((i * 7919) % probe.point_count()));
+        idents.emplace_back(p.ident);
+        near.push_back({p.lat + 0.2, p.lon - 0.2});
+    }
+    state.set_items_per_iter(idents.size());
+    for (auto _ : state) {
+        NavDatabase db;
+        db.open(path);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < idents.size(); ++i) sum += db.resolve(idents[i], near[i].lat, near[i].lon).value_or(0);
+        bench::do_not_optimize(sum);
+    }
+}
+FS_BENCHMARK(navdata_open_resolve, 200000);
+
+// Arg = routes; an archive of route strings over a 200k-fix database, expanded on one thread so
+// the airway cache effect shows without scheduling noise.
+static void expand_route_archive(bench::State& state) {
+    size_t n = static_cast<size_t>(state.arg());
+    NavDatabase db;
+    db.open(bench::synthetic_navdata_file(200000));
+    std::vector<RouteRequest> requests;
+    for (auto& r : bench::synthetic_route_strings(200000, n)) requests.push_back({std::move(r), "", ""});
+    state.set_items_per_iter(n);
+    for (auto _ : state) {
+        auto expanded = expand_routes(db, requests, 1);
+        bench::do_not_optimize(expanded.data());
+    }
+}
+FS_BENCHMARK(expand_route_archive, 5000);
+
+// Arg = airport pairs; positions near points of a 200k-fix database, 300-1500 nm apart, routed
+// in still air over the full altitude band by one reused router.
+static void airway_route_astar(bench::State& state) {
+    size_t n = static_cast<size_t>(state.arg());
+    NavDatabase db;
+    db.open(bench::synthetic_navdata_file(200000));
+    std::vector<std::pair<GeoPoint, GeoPoint>> pairs;
+    for (uint32_t i = 0; pairs.size() < n; ++i) {
+        NavPoint a = db.point((i * 7919u) % db.point_count());
+        NavPoint b = db.point((i * 104729u + 13u) % db.point_count());
+        double nm = haversine_nm(a.lat, a.lon, b.lat, b.lon);
+        if (nm < 300.0 || nm > 1500.0) continue;
+        pairs.push_back({{a.lat + 0.1, a.lon + 0.1}, {b.lat - 0.1, b.lon - 0.1}});
+    }
+    AirwayRouter router(db, AirwayRouteOptions{});
+    state.set_items_per_iter(n);
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const auto& [a, b] : pairs) sum += router.find(a.lat, a.lon, b.lat, b.lon).distance_nm;
+        bench::do_not_optimize(sum);
+    }
+}
+FS_BENCHMARK(airway_route_astar, 200);
@@ -0,0 +1,136 @@
+#include "bench/fixtures.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "core/datagen.hpp"
+#include "core/navdata.hpp"
+#include "core/strutil.hpp"
+
+namespace bench {
+
+std::string read_fixture(const std::string& rel_path) {
+    std::string path = std::string(FLIGHTSUITE_SOURCE_DIR) + "/" + rel_path;
+    auto text = flightsuite::read_file(path);
+    if (!text) {
+        std::cerr << "Missing benchmark fixture: " << path << "\n";
+        std::exit(1);
+    }
+    return *text;
+}
+
+std::vector<std::string> synthetic_metars(size_t n, uint64_t seed) {
+    flightsuite::MetarCycleOptions opt;
+    opt.seed = seed;
+    opt.speci_rate = 0.0;
+    std::ostringstream cycle;
+    flightsuite::write_metar_cycle(cycle, flightsuite::generate_stations(n, seed), opt);
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (auto& line : flightsuite::split_lines(cycle.str())) {
+        if (!std::isdigit(static_cast<unsigned char>(line[0]))) out.push_back(std::move(line));
+    }
+    return out;
+}
+
+std::string synthetic_notams_text(size_t n, uint64_t seed) {
+    // A handful of stations so per-ICAO scoring filters see realistic repetition.
+    std::ostringstream out;
+    flightsuite::write_notam_dump(out, flightsuite::generate_stations(8, seed), n, flightsuite::NotamFormat::kFaa,
+                                  seed);
+    return out.str();
+}
+
+std::string synthetic_ofp_xml(size_t n_fixes, uint64_t seed) {
+    auto stations = flightsuite::generate_stations(64, seed);
+    std::ostringstream out;
+    flightsuite::write_ofp_xml(out, stations.front(), stations.back(), n_fixes, seed);
+    return out.str();
+}
+
+std::vector<flightsuite::Airport> synthetic_airports(size_t n, uint64_t seed) {
+    std::vector<flightsuite::Airport> out;
+    out.reserve(n);
+    for (const auto& s : flightsuite::generate_stations(n, seed)) out.push_back(flightsuite::to_airport(s));
+    return out;
+}
+
+std::vector<flightsuite::Waypoint> synthetic_route(size_t n_waypoints, uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<flightsuite::Waypoint> out;
+    double dist = 0.0;
+    for (size_t i = 0; i < n_waypoints; ++i) {
+        flightsuite::Waypoint w;
+        w.name = "WP" + std::to_string(i);
+        w.distance_nm = dist;
+        double frac = n_waypoints > 1 ? static_cast<double>(i) / (n_waypoints - 1) : 0.0;
+        w.altitude_ft = frac < 0.1 ? frac * 350000.0 : frac > 0.9 ? (1.0 - frac) * 350000.0 : 35000.0;
+        out.push_back(w);
+        dist += 5.0 + static_cast<double>(gen() % 400) / 10.0;
+    }
+    return out;
+}
+
+std::string synthetic_navdata_file(size_t n_fixes, uint64_t seed) {
+    auto nav = flightsuite::generate_navdata(flightsuite::generate_stations(5000, seed), n_fixes, seed);
+    std::string base = (std::filesystem::temp_directory_path() / "flightsuite_bench_nav").string();
+    flightsuite::NavSources src;
+    src.fix_path = base + "_fix.dat";
+    src.nav_path = base + "_nav.dat";
+    src.awy_path = base + "_awy.dat";
+    {
+        std::ofstream fix(src.fix_path, std::ios::binary), navaids(src.nav_path, std::ios::binary),
+            awy(src.awy_path, std::ios::binary);
+        flightsuite::write_earth_fix(fix, nav);
+        flightsuite::write_earth_nav(navaids, nav);
+        flightsuite::write_earth_awy(awy, nav);
+    }
+    std::string out = base + ".bin", error;
+    if (!flightsuite::compile_navdata(src, out, nullptr, &error)) {
+        std::cerr << "Synthetic navdata failed: " << error << "\n";
+        std::exit(1);
+    }
+    for (const auto& p : {src.fix_path, src.nav_path, src.awy_path}) std::filesystem::remove(p);
+    return out;
+}
+
+std::vector<std::string> synthetic_route_strings(size_t n_fixes, size_t n_routes, uint64_t seed) {
+    auto nav = flightsuite::generate_navdata(flightsuite::generate_stations(5000, seed), n_fixes, seed);
+    std::vector<const flightsuite::SyntheticAirway*> airways;
+    for (const auto& a : nav.airways) {
+        if (a.points.size() >= 3) airways.push_back(&a);
+    }
+    std::mt19937_64 gen(seed);
+    std::vector<std::string> out;
+    if (airways.empty()) return out;
+    for (size_t r = 0; r < n_routes; ++r) {
+        std::string route;
+        for (size_t leg = 0, legs = 2 + gen() % 4; leg < legs; ++leg) {
+            const auto& a = *airways[gen() % airways.size()];
+            size_t entry = gen() % (a.points.size() - 1);
+            size_t exit = entry + 1 + gen() % (a.points.size() - entry - 1);
+            if (!route.empty()) route += ' ';
+            route += nav.points[a.points[entry]].ident + " " + a.name + " " + nav.points[a.points[exit]].ident;
+        }
+        out.push_back(std::move(route));
+    }
+    return out;
+}
+
+std::string synthetic_flight_log_file(size_t rows, uint64_t seed) {
+    std::string path = (std::filesystem::temp_directory_path() / "flightsuite_bench_log.csv").string();
+    std::ofstream out(path, std::ios::binary);
+    flightsuite::write_flight_log_csv(out, flightsuite::generate_stations(2000, seed), rows, seed);
+    if (!out) {
+        std::cerr << "Synthetic flight log failed: " << path << "\n";
+        std::exit(1);
+    }
+    return path;
+}
+
+} // namespace bench
@@ -0,0 +1,30 @@
+// Benchmark inputs: repo fixture files plus synthetic data from core/datagen.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/profile.hpp"
+
+namespace bench {
+
+// Reads a file relative to the source tree (e.g. "notamTool/sample_notams.txt"); exits if missing.
+std::string read_fixture(const std::string& rel_path);
+
+std::vector<std::string> synthetic_metars(size_t n, uint64_t seed = 1);
+std::string synthetic_notams_text(size_t n, uint64_t seed = 1);
+std::string synthetic_ofp_xml(size_t n_fixes, uint64_t seed = 1);
+std::vector<flightsuite::Airport> synthetic_airports(size_t n, uint64_t seed = 1);
+std::vector<flightsuite::Waypoint> synthetic_route(size_t n_waypoints, uint64_t seed = 1);
+// Compiles synthetic navdata (5000 stations plus `n_fixes` fixes) into a temp file; returns its
+// path. Exits on failure.
+std::string synthetic_navdata_file(size_t n_fixes, uint64_t seed = 1);
+// Route strings over the same synthetic navdata: 2-5 airway legs ("A J12 B C V7 D"), each entering
+// and leaving its airway at random points.
+std::vector<std::string> synthetic_route_strings(size_t n_fixes, size_t n_routes, uint64_t seed = 1);
+// Writes a flightLog CSV of `rows` entries over 2000 stations into a temp file; returns its path.
+std::string synthetic_flight_log_file(size_t rows, uint64_t seed = 1);
+
+} // namespace bench
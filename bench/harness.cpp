@@ -0,0 +1,254 @@
+#include "bench/harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+
+#include "core/alloc_stats.hpp"
+#include "core/json.hpp"
+#include "core/strutil.hpp"
+
+namespace bench {
+
+void State::start() {
+    auto c = flightsuite::alloc_counters_total();
+    allocs0_ = c.allocs;
+    alloc_bytes0_ = c.bytes;
+    t0_ = std::chrono::steady_clock::now();
+}
+
+bool State::next_run(uint64_t& remaining) {
+    auto t1 = std::chrono::steady_clock::now();
+    elapsed_ns_ = std::chrono::duration<double, std::nano>(t1 - t0_).count();
+    auto c = flightsuite::alloc_counters_total();
+    allocs_ = c.allocs - allocs0_;
+    alloc_bytes_ = c.bytes - alloc_bytes0_;
+    if (elapsed_ns_ / 1e9 >= min_time_s_ || iterations_ >= (1ull << 34)) {
+        finished_ = true;
+        return false;
+    }
+    // Aim 20% past the target based on the rate so far; at least double, at most 100x.
+    double per_iter = std::max(elapsed_ns_ / iterations_, 1.0);
+    double want = min_time_s_ * 1.2e9 / per_iter;
+    iterations_ = static_cast<uint64_t>(std::clamp(want, iterations_ * 2.0, iterations_ * 100.0));
+    remaining = iterations_;
+    start();
+    return true;
+}
+
+namespace {
+
+struct Entry {
+    std::string name;
+    BenchFn fn;
+    std::vector<int64_t> args;
+};
+
+std::vector<Entry>& registry() {
+    static std::vector<Entry> r;
+    return r;
+}
+
+struct Result {
+    std::string name;
+    std::string label;
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+    double alloc_bytes_per_op = 0.0;
+    double bytes_per_second = 0.0;
+    double ns_per_item = 0.0;
+};
+
+struct Options {
+    std::string filter;
+    std::string json_path;
+    std::string baseline_path;
+    double min_time_s = 0.2;
+    bool list_only = false;
+};
+
+} // namespace
+
+Registration::Registration(const char* name, BenchFn fn, std::vector<int64_t> args) {
+    registry().push_back({name, fn, std::move(args)});
+}
+
+struct Runner {
+    // Runs the body once; its loop repeats with more iterations until one timed run lasts at
+    // least min_time.
+    static Result run(const std::string& name, BenchFn fn, int64_t arg, double min_time_s) {
+        State st(arg, min_time_s);
+        fn(st);
+        if (!st.finished_) {
+            std::cerr << name << ": benchmark body never ran its loop\n";
+            std::exit(1);
+        }
+        double secs = st.elapsed_ns_ / 1e9;
+        uint64_t iters = st.iterations_;
+        Result r;
+        r.name = name;
+        r.label = st.label_;
+        r.iterations = iters;
+        r.ns_per_op = st.elapsed_ns_ / iters;
+        r.allocs_per_op = static_cast<double>(st.allocs_) / iters;
+        r.alloc_bytes_per_op = static_cast<double>(st.alloc_bytes_) / iters;
+        if (st.bytes_per_iter_ && secs > 0) r.bytes_per_second = st.bytes_per_iter_ * iters / secs;
+        if (st.items_per_iter_) r.ns_per_item = r.ns_per_op / st.items_per_iter_;
+        return r;
+    }
+};
+
+namespace {
+
+// Reads name -> ns_per_op from a JSON file previously written by this harness.
+std::map<std::string, double> load_baseline(const std::string& path) {
+    std::map<std::string, double> out;
+    auto text = flightsuite::read_file(path);
+    if (!text) {
+        std::cerr << "Could not read baseline: " << path << "\n";
+        return out;
+    }
+    static const std::regex entry_re(R"re("name":"([^"]+)"[^}]*?"ns_per_op":([0-9.eE+-]+))re");
+    for (auto it = std::sregex_iterator(text->begin(), text->end(), entry_re); it != std::sregex_iterator(); ++it) {
+        out[(*it)[1]] = std::stod((*it)[2]);
+    }
+    return out;
+}
+
+std::string human_bytes_per_sec(double bps) {
+    const char* units[] = {"B/s", "KB/s", "MB/s", "GB/s"};
+    int u = 0;
+    while (bps >= 1024.0 && u < 3) {
+        bps /= 1024.0;
+        ++u;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f %s", bps, units[u]);
+    return buf;
+}
+
+void write_json(const std::string& path, const std::vector<Result>& results) {
+    flightsuite::JsonWriter w;
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    w.begin_object();
+    w.key("context").begin_object();
+    w.field("date", date);
+#ifdef FLIGHTSUITE_BUILD_TYPE
+    w.field("build_type", FLIGHTSUITE_BUILD_TYPE);
+#endif
+#ifdef FLIGHTSUITE_GIT_REV
+    w.field("git_rev", FLIGHTSUITE_GIT_REV);
+#endif
+    w.end_object();
+    w.key("benchmarks").begin_array();
+    for (const auto& r : results) {
+        w.begin_object();
+        w.field("name", r.name);
+        if (!r.label.empty()) w.field("label", r.label);
+        w.field("iterations", static_cast<unsigned long long>(r.iterations));
+        w.field("ns_per_op", r.ns_per_op, 1);
+        w.field("allocs_per_op", r.allocs_per_op, 2);
+        w.field("alloc_bytes_per_op", r.alloc_bytes_per_op, 1);
+        if (r.bytes_per_second > 0) w.field("bytes_per_second", r.bytes_per_second, 0);
+        if (r.ns_per_item > 0) w.field("ns_per_item", r.ns_per_item, 2);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open JSON output: " << path << "\n";
+        return;
+    }
+    out << w.str() << "\n";
+    std::cout << "Results written to " << path << "\n";
+}
+
+void usage(const char* prog) {
+    std::cerr << "Usage: " << prog
+              << " [--filter REGEX] [--min-time 0.2] [--json out.json] [--baseline old.json] [--list]\n";
+}
+
+} // namespace
+} // namespace bench
+
+int main(int argc, char** argv) {
+    flightsuite::set_alloc_tracking(true);
+    bench::Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            opt.json_path = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            opt.baseline_path = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            opt.min_time_s = std::stod(argv[++i]);
+        } else if (arg == "--list") {
+            opt.list_only = true;
+        } else if (arg == "--help" || arg == "-h") {
+            bench::usage(argv[0]);
+            return 0;
+        } else {
+            bench::usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::regex filter_re(opt.filter.empty() ? ".*" : opt.filter);
+    std::vector<std::pair<std::string, std::pair<bench::BenchFn, int64_t>>> plan;
+    for (const auto& e : bench::registry()) {
+        if (e.args.empty()) {
+            plan.push_back({e.name, {e.fn, 0}});
+        } else {
+            for (int64_t a : e.args) plan.push_back({e.name + "/" + std::to_string(a), {e.fn, a}});
+        }
+    }
+    std::sort(plan.begin(), plan.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto baseline = opt.baseline_path.empty() ? std::map<std::string, double>{}
+                                              : bench::load_baseline(opt.baseline_path);
+    std::vector<bench::Result> results;
+    std::printf("%-40s %14s %12s %14s %12s %14s\n", "benchmark", "ns/op", "allocs/op", "alloc B/op",
+                "ns/item", baseline.empty() ? "throughput" : "vs baseline");
+    for (const auto& [name, job] : plan) {
+        if (!std::regex_search(name, filter_re)) continue;
+        if (opt.list_only) {
+            std::printf("%s\n", name.c_str());
+            continue;
+        }
+        bench::Result r = bench::Runner::run(name, job.first, job.second, opt.min_time_s);
+        std::string last;
+        if (!baseline.empty()) {
+            auto it = baseline.find(name);
+            if (it != baseline.end() && it->second > 0) {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%+.1f%%", (r.ns_per_op / it->second - 1.0) * 100.0);
+                last = buf;
+            } else {
+                last = "new";
+            }
+        } else if (r.bytes_per_second > 0) {
+            last = bench::human_bytes_per_sec(r.bytes_per_second);
+        }
+        std::printf("%-40s %14.1f %12.2f %14.1f %12s %14s\n", name.c_str(), r.ns_per_op, r.allocs_per_op,
+                    r.alloc_bytes_per_op,
+                    r.ns_per_item > 0 ? flightsuite::format_double(r.ns_per_item, 1).c_str() : "-",
+                    last.c_str());
+        std::fflush(stdout);
+        results.push_back(std::move(r));
+    }
+    if (!opt.json_path.empty() && !opt.list_only) bench::write_json(opt.json_path, results);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Self-contained microbenchmark harness (Google Benchmark-style): register a function with
+// FS_BENCHMARK, loop with `for (auto _ : state)`, and the runner reports ns/op, allocated
+// bytes/op, and allocations/op, optionally as JSON. Each function runs once per argument: its
+// setup before the loop is not repeated while the loop calibrates its iteration count.
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+class State {
+public:
+    State(int64_t arg, double min_time_s) : arg_(arg), min_time_s_(min_time_s) {}
+
+    int64_t arg() const { return arg_; }
+    uint64_t iterations() const { return iterations_; } // of the current timed run
+
+    // Input bytes consumed per iteration; enables a throughput column.
+    void set_bytes_per_iter(uint64_t n) { bytes_per_iter_ = n; }
+    // Logical items per iteration (reports, fixes, lines); enables ns/item.
+    void set_items_per_iter(uint64_t n) { items_per_iter_ = n; }
+    void set_label(std::string label) { label_ = std::move(label); }
+
+    // Loop variable type; the user-provided destructor keeps -Wunused-variable quiet on `_`.
+    struct Value {
+        ~Value() {}
+    };
+
+    class Iterator {
+    public:
+        Iterator(State* st, uint64_t remaining) : st_(st), remaining_(remaining) {}
+        bool operator!=(const Iterator&) { return remaining_ != 0 || st_->next_run(remaining_); }
+        void operator++() { --remaining_; }
+        Value operator*() const { return {}; }
+
+    private:
+        State* st_;
+        uint64_t remaining_;
+    };
+
+    Iterator begin() {
+        start();
+        return Iterator(this, iterations_);
+    }
+    Iterator end() { return Iterator(this, 0); }
+
+private:
+    friend struct Runner;
+    void start();
+    // Ends a timed run; starts a longer one (setting `remaining`) until a run lasts min_time.
+    bool next_run(uint64_t& remaining);
+
+    int64_t arg_;
+    double min_time_s_;
+    uint64_t iterations_ = 1;
+    uint64_t bytes_per_iter_ = 0;
+    uint64_t items_per_iter_ = 0;
+    std::string label_;
+    std::chrono::steady_clock::time_point t0_;
+    double elapsed_ns_ = 0.0;
+    uint64_t allocs0_ = 0, alloc_bytes0_ = 0;
+    uint64_t allocs_ = 0, alloc_bytes_ = 0;
+    bool finished_ = false;
+};
+
+using BenchFn = void (*)(State&);
+
+struct Registration {
+    Registration(const char* name, BenchFn fn, std::vector<int64_t> args = {});
+};
+
+// Keeps `value` (and everything it points to) observable so the optimizer cannot drop the work.
+template <typename T>
+inline void do_not_optimize(T const& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+} // namespace bench
+
+#define FS_BENCH_CONCAT_(a, b) a##b
+#define FS_BENCH_CONCAT(a, b) FS_BENCH_CONCAT_(a, b)
+// FS_BENCHMARK(fn) or FS_BENCHMARK(fn, 10, 100, 1000) to run once per argument.
+#define FS_BENCHMARK(fn, ...) \
+    static ::bench::Registration FS_BENCH_CONCAT(fs_bench_reg_, __LINE__)(#fn, fn, {__VA_ARGS__})
@@ -0,0 +1,154 @@
+#include "core/airports.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+std::vector<Airport> load_airports(const std::string& path) {
+    TraceSpan span("load_airports", "airports", path);
+    std::vector<Airport> airports;
+    std::vector<std::string> lines;
+    if (!read_file_lines(path, lines)) {
+        std::cerr << "Failed to open airports file: " << path << "\n";
+        return airports;
+    }
+    for (const auto& line : lines) {
+        if (line.empty() || line[0] == '#') continue;
+        auto cells = split_csv_line(line);
+        if (cells.size() < 7) continue;
+        Airport a;
+        a.icao = cells[0];
+        a.name = cells[1];
+        a.country = cells[2];
+        a.region = cells[3];
+        a.lat = std::stod(cells[4]);
+        a.lon = std::stod(cells[5]);
+        a.longest_runway_ft = std::stoi(cells[6]);
+        a.kind = cells.size() > 7 ? cells[7] : "";
+        if (cells.size() > 8 && !cells[8].empty()) a.elevation_ft = std::stoi(cells[8]);
+        airports.push_back(a);
+    }
+    return airports;
+}
+
+std::vector<Aircraft> load_aircraft(const std::string& path) {
+    TraceSpan span("load_aircraft", "airports", path);
+    std::vector<Aircraft> planes;
+    std::vector<std::string> lines;
+    if (!read_file_lines(path, lines)) {
+        std::cerr << "Failed to open aircraft file: " << path << "\n";
+        return planes;
+    }
+    for (const auto& line : lines) {
+        if (line.empty() || line[0] == '#') continue;
+        auto cells = split_csv_line(line);
+        if (cells.size() < 3) continue;
+        Aircraft ac;
+        ac.name = cells[0];
+        ac.role = cells[1];
+        ac.home = cells[2];
+        if (cells.size() > 3 && !cells[3].empty()) {
+            ac.range_nm = std::stod(cells[3]);
+        }
+        if (cells.size() > 4 && !cells[4].empty()) {
+            ac.min_runway_ft = std::stoi(cells[4]);
+        }
+        if (cells.size() > 5 && !cells[5].empty()) {
+            ac.cruise_tas_kt = std::stod(cells[5]);
+        }
+        planes.push_back(ac);
+    }
+    return planes;
+}
+
+std::unordered_map<std::string, Airport> index_by_icao(const std::vector<Airport>& airports) {
+    TraceSpan span("index_by_icao", "airports");
+    std::unordered_map<std::string, Airport> by_icao;
+    for (const auto& a : airports) {
+        by_icao[a.icao] = a;
+    }
+    return by_icao;
+}
+
+namespace {
+
+enum class RoleClass { kWidebody, kJet, kRegional, kTurboprop, kPiston, kOther };
+
+RoleClass role_class(const std::string& role_raw) {
+    std::string r = role_raw;
+    std::transform(r.begin(), r.end(), r.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (r.find("wide") != std::string::npos || r.find("long") != std::string::npos) return RoleClass::kWidebody;
+    if (r.find("jet") != std::string::npos || r.find("737") != std::string::npos ||
+        r.find("320") != std::string::npos)
+        return RoleClass::kJet;
+    if (r.find("regional") != std::string::npos || r.find("crj") != std::string::npos ||
+        r.find("e175") != std::string::npos)
+        return RoleClass::kRegional;
+    if (r.find("turboprop") != std::string::npos || r.find("king") != std::string::npos ||
+        r.find("pc-12") != std::string::npos)
+        return RoleClass::kTurboprop;
+    if (r.find("ga") != std::string::npos || r.find("piston") != std::string::npos ||
+        r.find("172") != std::string::npos || r.find("pa-") != std::string::npos)
+        return RoleClass::kPiston;
+    return RoleClass::kOther;
+}
+
+} // namespace
+
+int role_min_runway(const std::string& role_raw) {
+    switch (role_class(role_raw)) {
+    case RoleClass::kWidebody:
+        return 8000;
+    case RoleClass::kJet:
+        return 6500;
+    case RoleClass::kRegional:
+        return 5500;
+    case RoleClass::kTurboprop:
+        return 4000;
+    case RoleClass::kPiston:
+        return 2500;
+    default:
+        return 3500;
+    }
+}
+
+double role_cruise_tas(const std::string& role_raw) {
+    switch (role_class(role_raw)) {
+    case RoleClass::kWidebody:
+        return 490.0;
+    case RoleClass::kJet:
+        return 450.0;
+    case RoleClass::kRegional:
+        return 420.0;
+    case RoleClass::kTurboprop:
+        return 280.0;
+    case RoleClass::kPiston:
+        return 120.0;
+    default:
+        return 200.0;
+    }
+}
+
+int role_turnaround_min(const std::string& role_raw) {
+    switch (role_class(role_raw)) {
+    case RoleClass::kWidebody:
+        return 90;
+    case RoleClass::kJet:
+        return 45;
+    case RoleClass::kRegional:
+        return 35;
+    case RoleClass::kTurboprop:
+        return 25;
+    case RoleClass::kPiston:
+        return 15;
+    default:
+        return 30;
+    }
+}
+
+} // namespace flightsuite
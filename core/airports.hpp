@@ -0,0 +1,45 @@
+// Airport and aircraft catalogs (flightIdeas CSV formats).
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flightsuite {
+
+struct Airport {
+    std::string icao;
+    std::string name;
+    std::string country;
+    std::string region;
+    double lat = 0.0;
+    double lon = 0.0;
+    int longest_runway_ft = 0;
+    std::string kind;
+    std::optional<int> elevation_ft;
+};
+
+struct Aircraft {
+    std::string name;
+    std::string role;
+    std::string home;
+    double range_nm = 500.0;
+    int min_runway_ft = 0;
+    double cruise_tas_kt = 0.0; // 0 = inferred from role
+};
+
+// airports.csv: icao,name,country,region,lat,lon,longest_runway_ft[,kind[,elevation_ft]]
+std::vector<Airport> load_airports(const std::string& path);
+// aircraft.csv: name,role,home,range_nm[,min_runway_ft[,cruise_tas_kt]]
+std::vector<Aircraft> load_aircraft(const std::string& path);
+
+std::unordered_map<std::string, Airport> index_by_icao(const std::vector<Airport>& airports);
+
+// Runway requirement inferred from the free-text role when the CSV leaves it blank.
+int role_min_runway(const std::string& role_raw);
+// Cruise true airspeed and minimum turnaround at an outstation, from the same role buckets.
+double role_cruise_tas(const std::string& role_raw);
+int role_turnaround_min(const std::string& role_raw);
+
+} // namespace flightsuite
@@ -0,0 +1,184 @@
+#include "core/airway_router.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+#include "core/e6b.hpp"
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+uint64_t segment_key(uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+
+} // namespace
+
+AirwayRouter::AirwayRouter(const NavDatabase& db, AirwayRouteOptions opt) : db_(db), opt_(std::move(opt)) {
+    for (const auto& name : opt_.avoid_airways) {
+        if (auto id = db_.find_airway(name)) blocked_airways_.insert(*id);
+    }
+    for (const auto& ident : opt_.avoid_fixes) {
+        auto [first, last] = db_.find(ident);
+        for (uint32_t id = first; id < last; ++id) blocked_points_.insert(id);
+    }
+    for (const auto& [a, b] : opt_.avoid_segments) {
+        auto ra = db_.find(a), rb = db_.find(b);
+        for (uint32_t x = ra.first; x < ra.second; ++x) {
+            for (uint32_t y = rb.first; y < rb.second; ++y) {
+                blocked_segments_.insert(segment_key(x, y));
+                blocked_segments_.insert(segment_key(y, x));
+            }
+        }
+    }
+    // Two extra slots: the departure (source) and arrival (target) airports.
+    size_t n = db_.point_count() + 2;
+    g_.assign(n, kInf);
+    parent_.assign(n, kNone);
+    parent_airway_.assign(n, kNone);
+    stamp_.assign(n, 0);
+    closed_.assign(n, 0);
+}
+
+bool AirwayRouter::usable(const NavEdge& e, uint32_t from) const {
+    if (e.top_fl < opt_.min_fl || e.base_fl > opt_.max_fl) return false;
+    if (!blocked_airways_.empty() && blocked_airways_.count(e.airway)) return false;
+    if (!blocked_points_.empty() && blocked_points_.count(e.to)) return false;
+    return blocked_segments_.empty() || !blocked_segments_.count(segment_key(from, e.to));
+}
+
+double AirwayRouter::leg_cost(double lat1, double lon1, double lat2, double lon2, double nm) const {
+    if (opt_.tas_kt <= 0.0) return nm;
+    WindSample w;
+    if (opt_.wind) {
+        // Wind at the leg midpoint; legs are short next to the scale of a wind field.
+        double mid_lon = std::fabs(lon2 - lon1) > 180.0 ? lon1 : (lon1 + lon2) / 2.0;
+        w = opt_.wind((lat1 + lat2) / 2.0, mid_lon);
+    }
+    double course = initial_course_deg(lat1, lon1, lat2, lon2);
+    double cross = crosswind_component(w.dir_deg, w.speed_kt, course);
+    if (cross >= opt_.tas_kt) return kInf;
+    double gs = std::sqrt(opt_.tas_kt * opt_.tas_kt - cross * cross) -
+                headwind_component(w.dir_deg, w.speed_kt, course);
+    return gs > 1.0 ? nm / gs * 60.0 : kInf;
+}
+
+double AirwayRouter::heuristic(double lat, double lon) const {
+    double nm = haversine_nm(lat, lon, to_lat_, to_lon_);
+    if (opt_.tas_kt <= 0.0) return nm;
+    return nm / (opt_.tas_kt + opt_.max_wind_kt) * 60.0;
+}
+
+void AirwayRouter::connectors(double lat, double lon, bool departing, double other_lat, double other_lon,
+                              double radius_nm, std::vector<Connector>& out) {
+    out.clear();
+    // Ask for extra neighbours: fixes off the airway network (and other airports) are skipped.
+    db_.spatial().nearest(lat, lon, opt_.connect_k * 4, radius_nm, hits_);
+    for (const auto& h : hits_) {
+        if (out.size() >= opt_.connect_k) break;
+        if (blocked_points_.count(h.id)) continue;
+        bool any = false;
+        for (const NavEdge* e = db_.edges_begin(h.id); e != db_.edges_end(h.id) && !any; ++e) any = usable(*e, h.id);
+        if (!any) continue;
+        NavPoint p = db_.point(h.id);
+        double cost = departing ? leg_cost(lat, lon, p.lat, p.lon, h.distance_nm)
+                                : leg_cost(p.lat, p.lon, other_lat, other_lon, h.distance_nm);
+        if (cost < kInf) out.push_back({h.id, cost, h.distance_nm});
+    }
+}
+
+AirwayRoute AirwayRouter::find(double from_lat, double from_lon, double to_lat, double to_lon) {
+    TraceSpan span("airway_route", "route");
+    AirwayRoute route;
+    route.direct_nm = haversine_nm(from_lat, from_lon, to_lat, to_lon);
+    to_lat_ = to_lat;
+    to_lon_ = to_lon;
+    if (++query_ == 0) { // stamps wrapped: start over
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        std::fill(closed_.begin(), closed_.end(), 0);
+        query_ = 1;
+    }
+    const uint32_t source = static_cast<uint32_t>(db_.point_count());
+    const uint32_t target = source + 1;
+
+    // On short trips a wide radius would let one fix midway stand in for the whole route.
+    double radius = std::min(opt_.connect_nm, std::max(30.0, route.direct_nm / 3.0));
+    std::vector<Connector> entries, exits;
+    connectors(from_lat, from_lon, true, to_lat, to_lon, radius, entries);
+    connectors(to_lat, to_lon, false, to_lat, to_lon, radius, exits);
+    if (entries.empty() || exits.empty()) return route;
+
+    using Item = std::pair<double, uint32_t>; // (g + h, node)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    auto relax = [&](uint32_t v, double g, uint32_t parent, uint32_t airway, double h) {
+        if (stamp_[v] == query_ && g >= g_[v]) return;
+        stamp_[v] = query_;
+        g_[v] = g;
+        parent_[v] = parent;
+        parent_airway_[v] = airway;
+        open.push({g + h, v});
+    };
+    for (const auto& c : entries) {
+        NavPoint p = db_.point(c.id);
+        relax(c.id, c.cost, source, kNone, heuristic(p.lat, p.lon));
+    }
+    while (!open.empty()) {
+        uint32_t u = open.top().second;
+        open.pop();
+        if (u == target) break;
+        if (closed_[u] == query_) continue;
+        closed_[u] = query_;
+        ++route.expanded;
+        // Leave the network only after flying at least one airway segment.
+        for (const auto& c : exits) {
+            if (c.id == u && parent_airway_[u] != kNone) relax(target, g_[u] + c.cost, u, kNone, 0.0);
+        }
+        NavPoint pu = db_.point(u);
+        for (const NavEdge* e = db_.edges_begin(u); e != db_.edges_end(u); ++e) {
+            if (closed_[e->to] == query_ || !usable(*e, u)) continue;
+            NavPoint pv = db_.point(e->to);
+            double cost = leg_cost(pu.lat, pu.lon, pv.lat, pv.lon, e->distance_nm);
+            if (cost == kInf) continue;
+            relax(e->to, g_[u] + cost, u, e->airway, heuristic(pv.lat, pv.lon));
+        }
+    }
+    if (stamp_[target] != query_) return route;
+
+    route.found = true;
+    if (opt_.tas_kt > 0.0) route.minutes = g_[target];
+    for (uint32_t v = parent_[target]; v != source; v = parent_[v]) {
+        route.points.push_back(v);
+        route.via.push_back(parent_airway_[v] == kNone ? "DCT" : std::string(db_.airway_name(parent_airway_[v])));
+    }
+    std::reverse(route.points.begin(), route.points.end());
+    std::reverse(route.via.begin(), route.via.end());
+    double lat = from_lat, lon = from_lon;
+    for (uint32_t id : route.points) {
+        NavPoint p = db_.point(id);
+        route.distance_nm += haversine_nm(lat, lon, p.lat, p.lon);
+        lat = p.lat;
+        lon = p.lon;
+    }
+    route.distance_nm += haversine_nm(lat, lon, to_lat, to_lon);
+    return route;
+}
+
+std::string AirwayRoute::route_string(const NavDatabase& db, const std::string& from, const std::string& to) const {
+    std::string out = from;
+    for (size_t i = 0; i < points.size(); ++i) {
+        // Name each airway once, at the point where the route leaves it.
+        if (i + 1 < points.size() && via[i + 1] == via[i] && via[i] != "DCT") continue;
+        out += " " + via[i] + " " + std::string(db.point(points[i]).ident);
+    }
+    if (found) out += " DCT " + to;
+    return out;
+}
+
+} // namespace flightsuite
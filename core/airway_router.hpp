@@ -0,0 +1,90 @@
+// Airway routing between two airports over a compiled navdata database (core/navdata): A* on the
+// database's CSR airway graph with a great-circle heuristic. Segments can be limited to an
+// altitude band, airways/fixes/segments can be avoided, and costs can be flight time in a wind
+// field instead of distance.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "core/navdata.hpp"
+
+namespace flightsuite {
+
+struct WindSample {
+    double dir_deg = 0.0; // direction the wind blows from
+    double speed_kt = 0.0;
+};
+
+struct AirwayRouteOptions {
+    // Only segments whose published band overlaps [min_fl, max_fl] are used.
+    int min_fl = 0;
+    int max_fl = 999;
+    std::vector<std::string> avoid_airways;
+    std::vector<std::string> avoid_fixes;
+    std::vector<std::pair<std::string, std::string>> avoid_segments; // either direction
+    // Joining and leaving the network: up to connect_k airway points within connect_nm of each airport
+    // (capped at a third of the trip, floor 30 nm); at least one airway segment is flown.
+    size_t connect_k = 8;
+    double connect_nm = 100.0;
+    // tas_kt > 0 switches costs to minutes at that true airspeed in `wind` (none = still air);
+    // max_wind_kt must bound every sample so the heuristic stays admissible.
+    double tas_kt = 0.0;
+    std::function<WindSample(double lat, double lon)> wind;
+    double max_wind_kt = 0.0;
+};
+
+struct AirwayRoute {
+    bool found = false;
+    std::vector<uint32_t> points;  // navdata ids between the two airports
+    std::vector<std::string> via;  // airway flown to reach points[i] ("DCT" when joining)
+    double distance_nm = 0.0;      // airport to airport, along the route
+    double direct_nm = 0.0;        // great circle between the airports
+    double minutes = 0.0;          // when costs are flight time
+    size_t expanded = 0;           // nodes settled by the search
+
+    // "KSEA DCT SEA V23 OED DCT KMFR"
+    std::string route_string(const NavDatabase& db, const std::string& from, const std::string& to) const;
+};
+
+// Reusable across queries (search arrays are stamped, not cleared); one per thread.
+class AirwayRouter {
+public:
+    AirwayRouter(const NavDatabase& db, AirwayRouteOptions opt);
+
+    AirwayRoute find(double from_lat, double from_lon, double to_lat, double to_lon);
+
+private:
+    struct Connector {
+        uint32_t id;
+        double cost;
+        double nm;
+    };
+
+    bool usable(const NavEdge& e, uint32_t from) const;
+    double leg_cost(double lat1, double lon1, double lat2, double lon2, double nm) const;
+    double heuristic(double lat, double lon) const;
+    void connectors(double lat, double lon, bool departing, double other_lat, double other_lon, double radius_nm,
+                    std::vector<Connector>& out);
+
+    const NavDatabase& db_;
+    AirwayRouteOptions opt_;
+    std::unordered_set<uint32_t> blocked_airways_;
+    std::unordered_set<uint32_t> blocked_points_;
+    std::unordered_set<uint64_t> blocked_segments_;
+    double to_lat_ = 0.0, to_lon_ = 0.0;
+
+    std::vector<double> g_;
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> parent_airway_;
+    std::vector<uint32_t> stamp_;  // g_/parent_ are valid for this query when stamp_ == query_
+    std::vector<uint32_t> closed_; // == query_ once settled
+    uint32_t query_ = 0;
+    std::vector<SpatialHit> hits_;
+};
+
+} // namespace flightsuite
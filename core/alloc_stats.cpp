@@ -0,0 +1,185 @@
+#include "core/alloc_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define FLIGHTSUITE_USABLE_SIZE(p) malloc_size(p)
+#elif defined(__GLIBC__) || defined(__linux__)
+#include <malloc.h>
+#define FLIGHTSUITE_USABLE_SIZE(p) malloc_usable_size(p)
+#else
+#define FLIGHTSUITE_USABLE_SIZE(p) 0 // live/peak bytes unavailable
+#endif
+
+namespace flightsuite {
+
+namespace {
+
+constexpr int kStages = static_cast<int>(AllocStage::kCount);
+constexpr int kMaxSlots = 256;
+
+// One slot per thread; only its owner writes it, so the atomics never contend. Threads beyond
+// kMaxSlots share the last slot.
+struct ThreadSlot {
+    std::atomic<uint64_t> allocs[kStages];
+    std::atomic<uint64_t> bytes[kStages];
+    std::atomic<uint64_t> frees[kStages];
+};
+
+ThreadSlot g_slots[kMaxSlots];
+std::atomic<int> g_slots_used{0};
+std::atomic<bool> g_enabled{false};
+std::atomic<int64_t> g_live{0};
+std::atomic<int64_t> g_peak_total{0};
+std::atomic<int64_t> g_peak[kStages];
+
+// Trivially-initialized thread_locals: no TLS init guard inside operator new.
+thread_local ThreadSlot* t_slot = nullptr;
+thread_local AllocStage t_stage = AllocStage::kOther;
+
+const char* g_report_title = "";
+
+ThreadSlot& slot() {
+    if (!t_slot) {
+        int i = g_slots_used.fetch_add(1, std::memory_order_relaxed);
+        t_slot = &g_slots[i < kMaxSlots ? i : kMaxSlots - 1];
+    }
+    return *t_slot;
+}
+
+void raise_peak(std::atomic<int64_t>& peak, int64_t live) {
+    int64_t cur = peak.load(std::memory_order_relaxed);
+    while (live > cur && !peak.compare_exchange_weak(cur, live, std::memory_order_relaxed)) {
+    }
+}
+
+void record_alloc(void* p, std::size_t n) {
+    int s = static_cast<int>(t_stage);
+    ThreadSlot& ts = slot();
+    ts.allocs[s].fetch_add(1, std::memory_order_relaxed);
+    ts.bytes[s].fetch_add(n, std::memory_order_relaxed);
+    int64_t usable = static_cast<int64_t>(FLIGHTSUITE_USABLE_SIZE(p));
+    int64_t live = g_live.fetch_add(usable, std::memory_order_relaxed) + usable;
+    raise_peak(g_peak[s], live);
+    raise_peak(g_peak_total, live);
+}
+
+void record_free(void* p) {
+    int s = static_cast<int>(t_stage);
+    slot().frees[s].fetch_add(1, std::memory_order_relaxed);
+    g_live.fetch_sub(static_cast<int64_t>(FLIGHTSUITE_USABLE_SIZE(p)), std::memory_order_relaxed);
+}
+
+void* tracked_alloc(std::size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    if (g_enabled.load(std::memory_order_relaxed)) record_alloc(p, n);
+    return p;
+}
+
+void tracked_free(void* p) noexcept {
+    if (!p) return;
+    if (g_enabled.load(std::memory_order_relaxed)) record_free(p);
+    std::free(p);
+}
+
+void report_at_exit() { print_alloc_report(stderr, g_report_title); }
+
+} // namespace
+
+const char* alloc_stage_name(AllocStage stage) {
+    switch (stage) {
+    case AllocStage::kFetch: return "fetch";
+    case AllocStage::kParse: return "parse";
+    case AllocStage::kAnalyze: return "analyze";
+    case AllocStage::kOutput: return "output";
+    default: return "other";
+    }
+}
+
+void set_alloc_tracking(bool on) { g_enabled.store(on, std::memory_order_relaxed); }
+
+bool alloc_tracking_enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+AllocCounters alloc_counters(AllocStage stage) {
+    int s = static_cast<int>(stage);
+    AllocCounters c;
+    int used = std::min(g_slots_used.load(std::memory_order_relaxed), kMaxSlots);
+    for (int i = 0; i < used; ++i) {
+        c.allocs += g_slots[i].allocs[s].load(std::memory_order_relaxed);
+        c.bytes += g_slots[i].bytes[s].load(std::memory_order_relaxed);
+        c.frees += g_slots[i].frees[s].load(std::memory_order_relaxed);
+    }
+    c.peak_live_bytes = g_peak[s].load(std::memory_order_relaxed);
+    return c;
+}
+
+AllocCounters alloc_counters_total() {
+    AllocCounters total;
+    for (int s = 0; s < kStages; ++s) {
+        AllocCounters c = alloc_counters(static_cast<AllocStage>(s));
+        total.allocs += c.allocs;
+        total.bytes += c.bytes;
+        total.frees += c.frees;
+    }
+    total.peak_live_bytes = g_peak_total.load(std::memory_order_relaxed);
+    return total;
+}
+
+void set_alloc_stage(AllocStage stage) { t_stage = stage; }
+
+AllocStageScope::AllocStageScope(AllocStage stage) : prev_(t_stage) { t_stage = stage; }
+
+AllocStageScope::~AllocStageScope() { t_stage = prev_; }
+
+void print_alloc_report(std::FILE* out, const char* title) {
+    // fprintf only: this runs from atexit and must not perturb the numbers it prints.
+    std::fprintf(out, "\n=== Allocation stats%s%s ===\n", title[0] ? ": " : "", title);
+    std::fprintf(out, "%-8s %12s %14s %12s %14s\n", "stage", "allocs", "bytes", "frees", "peak live B");
+    for (int s = 0; s < kStages; ++s) {
+        AllocCounters c = alloc_counters(static_cast<AllocStage>(s));
+        if (c.allocs == 0 && c.frees == 0) continue;
+        std::fprintf(out, "%-8s %12llu %14llu %12llu %14lld\n", alloc_stage_name(static_cast<AllocStage>(s)),
+                     static_cast<unsigned long long>(c.allocs), static_cast<unsigned long long>(c.bytes),
+                     static_cast<unsigned long long>(c.frees), static_cast<long long>(c.peak_live_bytes));
+    }
+    AllocCounters t = alloc_counters_total();
+    std::fprintf(out, "%-8s %12llu %14llu %12llu %14lld\n", "total", static_cast<unsigned long long>(t.allocs),
+                 static_cast<unsigned long long>(t.bytes), static_cast<unsigned long long>(t.frees),
+                 static_cast<long long>(t.peak_live_bytes));
+}
+
+bool init_alloc_stats(int& argc, char** argv) {
+    bool found = false;
+    int w = 1;
+    for (int r = 1; r < argc; ++r) {
+        if (std::strcmp(argv[r], "--alloc-stats") == 0) {
+            found = true;
+        } else {
+            argv[w++] = argv[r];
+        }
+    }
+    argc = w;
+    argv[argc] = nullptr;
+    if (found) {
+        const char* slash = std::strrchr(argv[0], '/');
+        g_report_title = slash ? slash + 1 : argv[0];
+        std::atexit(report_at_exit);
+        set_alloc_tracking(true);
+    }
+    return found;
+}
+
+} // namespace flightsuite
+
+void* operator new(std::size_t n) { return flightsuite::tracked_alloc(n); }
+void* operator new[](std::size_t n) { return flightsuite::tracked_alloc(n); }
+void operator delete(void* p) noexcept { flightsuite::tracked_free(p); }
+void operator delete[](void* p) noexcept { flightsuite::tracked_free(p); }
+void operator delete(void* p, std::size_t) noexcept { flightsuite::tracked_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { flightsuite::tracked_free(p); }
@@ -0,0 +1,50 @@
+// Opt-in heap instrumentation. Linking this module replaces the global operator new/delete; while
+// tracking is enabled every allocation is counted per pipeline stage in thread-local slots, and
+// live/peak bytes are tracked process-wide. Tools enable it with `--alloc-stats`.
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+namespace flightsuite {
+
+enum class AllocStage { kOther, kFetch, kParse, kAnalyze, kOutput, kCount };
+
+const char* alloc_stage_name(AllocStage stage);
+
+struct AllocCounters {
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+    uint64_t frees = 0;
+    int64_t peak_live_bytes = 0; // process-wide live bytes high-water mark seen while in this stage
+};
+
+void set_alloc_tracking(bool on);
+bool alloc_tracking_enabled();
+
+// Totals over all threads, per stage or for the whole process.
+AllocCounters alloc_counters(AllocStage stage);
+AllocCounters alloc_counters_total();
+
+// Switches this thread's current stage; for straight-line pipelines in a tool's main().
+void set_alloc_stage(AllocStage stage);
+
+// Attributes allocations on this thread to `stage` until destroyed; nests (inner stage wins).
+class AllocStageScope {
+public:
+    explicit AllocStageScope(AllocStage stage);
+    ~AllocStageScope();
+    AllocStageScope(const AllocStageScope&) = delete;
+    AllocStageScope& operator=(const AllocStageScope&) = delete;
+
+private:
+    AllocStage prev_;
+};
+
+void print_alloc_report(std::FILE* out, const char* title);
+
+// Removes `--alloc-stats` from argv; if it was present, enables tracking and prints the report to
+// stderr at exit. Returns whether tracking was enabled.
+bool init_alloc_stats(int& argc, char** argv);
+
+} // namespace flightsuite
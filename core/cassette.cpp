@@ -0,0 +1,192 @@
+#include "core/cassette.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#include "core/strutil.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+struct IndexEntry {
+    bool ok = false;
+    double elapsed_ms = 0.0;
+};
+
+CassetteMode g_mode = CassetteMode::kOff;
+std::string g_dir;
+double g_latency_ms = 0.0;
+std::time_t g_recorded_at = 0;
+std::mutex g_mu; // guards g_index and writes to index.tsv
+std::unordered_map<std::string, IndexEntry> g_index; // url -> last recorded result
+
+std::string url_hash(const std::string& url) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : url) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+std::string body_path(const std::string& url) { return g_dir + "/" + url_hash(url) + ".body"; }
+
+std::string index_path() { return g_dir + "/index.tsv"; }
+
+// Loads index.tsv; later lines override earlier ones so re-recording a URL replaces it.
+bool load_index() {
+    std::ifstream in(index_path());
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("# recorded_at ", 0) == 0) {
+            g_recorded_at = static_cast<std::time_t>(std::atoll(line.c_str() + 14));
+            continue;
+        }
+        if (line.empty() || line[0] == '#') continue;
+        // hash, ok, elapsed_ms, bytes, url (the URL may not contain tabs, so it is the 5th field)
+        size_t pos = 0;
+        std::string fields[4];
+        bool good = true;
+        for (auto& f : fields) {
+            size_t tab = line.find('\t', pos);
+            if (tab == std::string::npos) {
+                good = false;
+                break;
+            }
+            f = line.substr(pos, tab - pos);
+            pos = tab + 1;
+        }
+        if (!good) continue;
+        IndexEntry e;
+        e.ok = fields[1] == "1";
+        e.elapsed_ms = parse_double(fields[2]).value_or(0.0);
+        g_index[line.substr(pos)] = e;
+    }
+    return true;
+}
+
+} // namespace
+
+bool set_cassette(CassetteMode mode, const std::string& dir, double replay_latency_ms) {
+    std::lock_guard<std::mutex> lock(g_mu);
+    g_mode = CassetteMode::kOff;
+    g_index.clear();
+    g_recorded_at = 0;
+    g_dir = dir;
+    g_latency_ms = replay_latency_ms;
+    if (mode == CassetteMode::kRecord) {
+        if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        bool existing = load_index(); // appending to an existing cassette keeps its clock
+        std::ofstream index(index_path(), std::ios::app);
+        if (!index) return false;
+        if (!existing) index << "# recorded_at " << static_cast<long long>(std::time(nullptr)) << "\n";
+    } else if (mode == CassetteMode::kReplay) {
+        if (!load_index()) return false;
+    }
+    g_mode = mode;
+    return true;
+}
+
+CassetteMode cassette_mode() { return g_mode; }
+
+std::time_t cassette_now() {
+    if (g_mode == CassetteMode::kReplay && g_recorded_at > 0) return g_recorded_at;
+    return std::time(nullptr);
+}
+
+std::optional<CassetteEntry> cassette_replay(const std::string& url) {
+    if (g_mode != CassetteMode::kReplay) return std::nullopt;
+    IndexEntry e;
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        auto it = g_index.find(url);
+        if (it == g_index.end()) return std::nullopt;
+        e = it->second;
+    }
+    CassetteEntry out;
+    out.ok = e.ok;
+    out.elapsed_ms = e.elapsed_ms;
+    if (e.ok) {
+        auto body = read_file(body_path(url));
+        if (!body) return std::nullopt;
+        out.body = std::move(*body);
+    }
+    return out;
+}
+
+double cassette_latency_ms(const CassetteEntry& entry) { return g_latency_ms < 0 ? entry.elapsed_ms : g_latency_ms; }
+
+void cassette_record(const std::string& url, const std::optional<std::string>& body, double elapsed_ms) {
+    if (g_mode != CassetteMode::kRecord) return;
+    if (url.find_first_of("\t\n") != std::string::npos) return;
+    std::string path = body_path(url);
+    if (body) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(body->data(), static_cast<std::streamsize>(body->size()));
+        if (!out) return;
+    }
+    char line[96];
+    std::snprintf(line, sizeof(line), "%s\t%d\t%.3f\t%zu\t", url_hash(url).c_str(), body ? 1 : 0, elapsed_ms,
+                  body ? body->size() : size_t{0});
+    std::lock_guard<std::mutex> lock(g_mu);
+    std::ofstream index(index_path(), std::ios::app);
+    index << line << url << "\n";
+    g_index[url] = IndexEntry{body.has_value(), elapsed_ms};
+}
+
+bool init_cassette(int& argc, char** argv) {
+    std::string record_dir, replay_dir, latency;
+    int w = 1;
+    for (int r = 1; r < argc; ++r) {
+        if (std::strcmp(argv[r], "--record") == 0 && r + 1 < argc) {
+            record_dir = argv[++r];
+        } else if (std::strcmp(argv[r], "--replay") == 0 && r + 1 < argc) {
+            replay_dir = argv[++r];
+        } else if (std::strcmp(argv[r], "--replay-latency") == 0 && r + 1 < argc) {
+            latency = argv[++r];
+        } else {
+            argv[w++] = argv[r];
+        }
+    }
+    argc = w;
+    argv[argc] = nullptr;
+    if (!record_dir.empty() && !replay_dir.empty()) {
+        std::cerr << "--record and --replay are mutually exclusive.\n";
+        return false;
+    }
+    double latency_ms = 0.0;
+    if (latency == "recorded") {
+        latency_ms = -1.0;
+    } else if (!latency.empty()) {
+        auto v = parse_double(latency);
+        if (!v || *v < 0) {
+            std::cerr << "--replay-latency expects 'recorded' or milliseconds, got: " << latency << "\n";
+            return false;
+        }
+        latency_ms = *v;
+    }
+    if (!record_dir.empty() && !set_cassette(CassetteMode::kRecord, record_dir)) {
+        std::cerr << "Cannot record to cassette directory: " << record_dir << "\n";
+        return false;
+    }
+    if (!replay_dir.empty() && !set_cassette(CassetteMode::kReplay, replay_dir, latency_ms)) {
+        std::cerr << "Cannot read cassette index: " << replay_dir << "/index.tsv\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace flightsuite
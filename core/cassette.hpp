@@ -0,0 +1,44 @@
+// Record/replay transport for fetch_url. In record mode every fetched URL body is saved to a
+// cassette directory along with its status and wall time; in replay mode fetch_url serves those
+// bodies back without touching the network, optionally sleeping for the recorded (or an injected)
+// latency. Tools enable it with `--record DIR` / `--replay DIR [--replay-latency recorded|MS]`.
+//
+// Cassette layout: DIR/index.tsv holds one `hash<TAB>ok<TAB>elapsed_ms<TAB>bytes<TAB>url` line per
+// fetch (the last line for a URL wins), after a `# recorded_at <unix time>` header; DIR/<hash>.body
+// holds the body, hash = FNV-1a 64 of the URL.
+#pragma once
+
+#include <ctime>
+#include <optional>
+#include <string>
+
+namespace flightsuite {
+
+enum class CassetteMode { kOff, kRecord, kReplay };
+
+struct CassetteEntry {
+    bool ok = false;         // false: the live fetch failed, so replay fails too
+    double elapsed_ms = 0.0; // wall time of the recorded fetch
+    std::string body;
+};
+
+// Replay latency: < 0 sleeps for each entry's recorded time, >= 0 sleeps a fixed number of ms.
+bool set_cassette(CassetteMode mode, const std::string& dir, double replay_latency_ms = 0.0);
+CassetteMode cassette_mode();
+
+// Wall clock for building time-dependent URLs (e.g. METAR cycle files): the recording time while
+// replaying, so a cassette requests the same URLs whenever it is played back; otherwise now.
+std::time_t cassette_now();
+
+// Replay lookup; nullopt when the URL is not on the cassette.
+std::optional<CassetteEntry> cassette_replay(const std::string& url);
+// How long replaying `entry` should take under the configured --replay-latency.
+double cassette_latency_ms(const CassetteEntry& entry);
+// Saves one fetch result (no-op unless recording). Safe to call from several threads.
+void cassette_record(const std::string& url, const std::optional<std::string>& body, double elapsed_ms);
+
+// Removes `--record DIR`, `--replay DIR` and `--replay-latency recorded|MS` from argv and enables
+// the matching mode. Returns false (after printing why) if the cassette cannot be opened.
+bool init_cassette(int& argc, char** argv);
+
+} // namespace flightsuite
@@ -0,0 +1,357 @@
+#include "core/compress.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr size_t kReadBytes = 1 << 18;   // compressed (or plain) bytes per read
+constexpr size_t kOutStep = 1 << 18;     // output growth per decoder call
+constexpr unsigned kMaxThreads = 8;
+// Frames larger than this (or of unknown size) stream instead of decoding whole in a worker.
+constexpr unsigned long long kMaxParallelFrame = 256ull << 20;
+
+std::atomic<unsigned> g_threads{0}; // 0 = default
+
+unsigned decompress_threads() {
+    unsigned n = g_threads.load(std::memory_order_relaxed);
+    if (n) return n;
+    return std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreads);
+}
+
+} // namespace
+
+Compression detect_compression(std::string_view head) {
+    if (head.size() >= 2 && static_cast<unsigned char>(head[0]) == 0x1f && static_cast<unsigned char>(head[1]) == 0x8b) {
+        return Compression::kGzip;
+    }
+    if (head.size() >= 4 && head.substr(0, 4) == std::string_view("\x28\xb5\x2f\xfd", 4)) return Compression::kZstd;
+    return Compression::kNone;
+}
+
+const char* compression_name(Compression c) {
+    switch (c) {
+    case Compression::kGzip: return "gzip";
+    case Compression::kZstd: return "zstd";
+    default: return "none";
+    }
+}
+
+bool compression_supported(Compression c) {
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+    (void)c;
+    return true;
+#else
+    return c != Compression::kZstd;
+#endif
+}
+
+struct StreamDecoder::Impl {
+    Compression kind;
+    std::string error;
+    bool complete = true;
+    bool failed = false;
+    z_stream z{};
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+    ZSTD_DStream* zstd = nullptr;
+#endif
+
+    bool fail(const std::string& why) {
+        failed = true;
+        error = why;
+        return false;
+    }
+
+    bool feed_gzip(const char* data, size_t n, std::string& out) {
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        z.avail_in = static_cast<uInt>(n);
+        for (;;) {
+            size_t old = out.size();
+            out.resize(old + kOutStep);
+            z.next_out = reinterpret_cast<Bytef*>(&out[old]);
+            z.avail_out = static_cast<uInt>(kOutStep);
+            int rc = inflate(&z, Z_NO_FLUSH);
+            out.resize(old + kOutStep - z.avail_out);
+            if (rc == Z_STREAM_END) {
+                complete = true;
+                if (z.avail_in == 0) return true;
+                inflateReset(&z); // another member follows
+            } else if (rc == Z_OK) {
+                complete = false;
+                if (z.avail_in == 0 && z.avail_out != 0) return true;
+            } else if (rc == Z_BUF_ERROR && z.avail_in == 0) {
+                return true;
+            } else {
+                return fail(std::string("gzip: ") + (z.msg ? z.msg : "corrupt stream"));
+            }
+        }
+    }
+
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+    bool feed_zstd(const char* data, size_t n, std::string& out) {
+        ZSTD_inBuffer in{data, n, 0};
+        for (;;) {
+            size_t old = out.size();
+            out.resize(old + kOutStep);
+            ZSTD_outBuffer o{&out[old], kOutStep, 0};
+            size_t rc = ZSTD_decompressStream(zstd, &o, &in);
+            out.resize(old + o.pos);
+            if (ZSTD_isError(rc)) return fail(std::string("zstd: ") + ZSTD_getErrorName(rc));
+            complete = rc == 0;
+            if (in.pos == in.size && o.pos < o.size) return true;
+        }
+    }
+#endif
+};
+
+StreamDecoder::StreamDecoder(Compression c) : impl_(std::make_unique<Impl>()) {
+    impl_->kind = c;
+    if (c == Compression::kGzip) {
+        if (inflateInit2(&impl_->z, 16 + MAX_WBITS) != Z_OK) impl_->fail("gzip: inflateInit2 failed");
+    } else if (c == Compression::kZstd) {
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+        impl_->zstd = ZSTD_createDStream();
+        if (!impl_->zstd || ZSTD_isError(ZSTD_initDStream(impl_->zstd))) impl_->fail("zstd: cannot create decoder");
+#else
+        impl_->fail("zstd input, but this build has no zstd support (configure with libzstd installed)");
+#endif
+    }
+}
+
+StreamDecoder::~StreamDecoder() {
+    if (impl_->kind == Compression::kGzip) inflateEnd(&impl_->z);
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+    if (impl_->zstd) ZSTD_freeDStream(impl_->zstd);
+#endif
+}
+
+bool StreamDecoder::feed(const char* data, size_t n, std::string& out) {
+    if (impl_->failed) return false;
+    if (n == 0) return true;
+    switch (impl_->kind) {
+    case Compression::kGzip: return impl_->feed_gzip(data, n, out);
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+    case Compression::kZstd: return impl_->feed_zstd(data, n, out);
+#endif
+    default: out.append(data, n); return true;
+    }
+}
+
+bool StreamDecoder::complete() const { return !impl_->failed && impl_->complete; }
+
+const std::string& StreamDecoder::error() const { return impl_->error; }
+
+std::optional<std::string> decompress_buffer(std::string data) {
+    Compression kind = detect_compression(data);
+    if (kind == Compression::kNone) return data;
+    TraceSpan span("decompress_buffer", "compress", compression_name(kind));
+    StreamDecoder decoder(kind);
+    std::string out;
+    out.reserve(data.size() * 4);
+    if (!decoder.feed(data.data(), data.size(), out) || !decoder.complete()) return std::nullopt;
+    return out;
+}
+
+void set_decompress_threads(unsigned n) { g_threads.store(n, std::memory_order_relaxed); }
+
+struct ChunkedFileReader::Impl {
+    int fd = -1;
+    Compression kind = Compression::kNone;
+    std::unique_ptr<StreamDecoder> decoder;
+    std::vector<char> buf;
+    size_t buffered = 0; // bytes sniffed by open() and not yet consumed
+    bool eof = false;
+    bool failed = false;
+    std::string error;
+
+    // Parallel zstd: the file is mapped and whole frames decode on worker threads, in order.
+    struct Frame {
+        size_t offset;
+        size_t size;
+        size_t content;
+    };
+    const char* map = nullptr;
+    size_t map_size = 0;
+    std::vector<Frame> frames;
+    size_t next_frame = 0;
+    unsigned threads = 1;
+    std::deque<std::future<std::optional<std::string>>> inflight;
+
+    bool fail(const std::string& why) {
+        failed = true;
+        error = why;
+        return false;
+    }
+
+    bool setup_parallel();
+    bool next_parallel(std::string& chunk);
+};
+
+#ifdef FLIGHTSUITE_HAVE_ZSTD
+bool ChunkedFileReader::Impl::setup_parallel() {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) return false;
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return false;
+    const char* base = static_cast<const char*>(p);
+    std::vector<Frame> found;
+    bool ok = true;
+    for (size_t pos = 0; pos < size && ok;) {
+        size_t len = ZSTD_findFrameCompressedSize(base + pos, size - pos);
+        unsigned long long content = ZSTD_getFrameContentSize(base + pos, size - pos);
+        ok = !ZSTD_isError(len) && content != ZSTD_CONTENTSIZE_UNKNOWN && content != ZSTD_CONTENTSIZE_ERROR &&
+             content <= kMaxParallelFrame;
+        if (ok) found.push_back({pos, len, static_cast<size_t>(content)});
+        pos += ok ? len : 0;
+    }
+    if (!ok || found.size() < 2) {
+        munmap(p, size);
+        return false;
+    }
+    madvise(p, size, MADV_SEQUENTIAL);
+    map = base;
+    map_size = size;
+    frames = std::move(found);
+    return true;
+}
+
+bool ChunkedFileReader::Impl::next_parallel(std::string& chunk) {
+    while (inflight.size() < threads && next_frame < frames.size()) {
+        const Frame f = frames[next_frame++];
+        const char* src = map + f.offset;
+        inflight.push_back(std::async(std::launch::async, [src, f]() -> std::optional<std::string> {
+            TraceSpan span("zstd_frame", "compress");
+            std::string out(f.content, '\0');
+            size_t rc = ZSTD_decompress(out.data(), out.size(), src, f.size);
+            if (ZSTD_isError(rc) || rc != f.content) return std::nullopt;
+            return out;
+        }));
+    }
+    if (inflight.empty()) return false;
+    auto decoded = inflight.front().get();
+    inflight.pop_front();
+    if (!decoded) return fail("zstd: corrupt frame");
+    chunk = std::move(*decoded);
+    return true;
+}
+#else
+bool ChunkedFileReader::Impl::setup_parallel() { return false; }
+bool ChunkedFileReader::Impl::next_parallel(std::string&) { return false; }
+#endif
+
+ChunkedFileReader::ChunkedFileReader() : impl_(std::make_unique<Impl>()) {}
+
+ChunkedFileReader::~ChunkedFileReader() {
+    impl_->inflight.clear(); // waits for the workers still reading the mapping
+    if (impl_->map) munmap(const_cast<char*>(impl_->map), impl_->map_size);
+    if (impl_->fd >= 0) close(impl_->fd);
+}
+
+bool ChunkedFileReader::open(const std::string& path) {
+    Impl& s = *impl_;
+    s.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (s.fd < 0) return s.fail("cannot open " + path + ": " + std::strerror(errno));
+    s.buf.resize(kReadBytes);
+    ssize_t n;
+    while ((n = read(s.fd, s.buf.data(), s.buf.size())) < 0 && errno == EINTR) {
+    }
+    if (n < 0) return s.fail("cannot read " + path + ": " + std::strerror(errno));
+    s.buffered = static_cast<size_t>(n);
+    s.kind = detect_compression(std::string_view(s.buf.data(), s.buffered));
+    if (!compression_supported(s.kind)) {
+        return s.fail(path + " is zstd-compressed, but this build has no zstd support");
+    }
+    if (s.kind == Compression::kZstd) {
+        s.threads = decompress_threads();
+        if (s.threads > 1 && s.setup_parallel()) return true;
+    }
+    if (s.kind != Compression::kNone) s.decoder = std::make_unique<StreamDecoder>(s.kind);
+    return true;
+}
+
+bool ChunkedFileReader::next(std::string& chunk) {
+    Impl& s = *impl_;
+    chunk.clear();
+    if (s.failed || s.fd < 0) return false;
+    if (s.map) return s.next_parallel(chunk);
+    // A compressed read can decode to nothing (headers, a block split across reads), so keep going
+    // until there is output or input runs out.
+    while (chunk.empty() && !s.eof) {
+        if (s.buffered == 0) {
+            ssize_t n;
+            while ((n = read(s.fd, s.buf.data(), s.buf.size())) < 0 && errno == EINTR) {
+            }
+            if (n < 0) return s.fail(std::string("read failed: ") + std::strerror(errno));
+            s.buffered = static_cast<size_t>(n);
+            if (n == 0) {
+                s.eof = true;
+                break;
+            }
+        }
+        if (s.decoder) {
+            if (!s.decoder->feed(s.buf.data(), s.buffered, chunk)) return s.fail(s.decoder->error());
+        } else {
+            chunk.assign(s.buf.data(), s.buffered);
+        }
+        s.buffered = 0;
+    }
+    if (s.eof && s.decoder && !s.decoder->complete()) {
+        return s.fail(std::string(compression_name(s.kind)) + ": truncated input");
+    }
+    return !chunk.empty();
+}
+
+bool ChunkedFileReader::failed() const { return impl_->failed; }
+
+const std::string& ChunkedFileReader::error() const { return impl_->error; }
+
+Compression ChunkedFileReader::compression() const { return impl_->kind; }
+
+bool for_each_line(ChunkedFileReader& reader, const std::function<void(std::string_view)>& fn) {
+    auto emit = [&fn](std::string_view line) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        fn(line);
+    };
+    std::string chunk, carry; // carry: a line split across chunks
+    while (reader.next(chunk)) {
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+        while (const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)))) {
+            if (carry.empty()) {
+                emit(std::string_view(p, static_cast<size_t>(nl - p)));
+            } else {
+                carry.append(p, nl);
+                emit(carry);
+                carry.clear();
+            }
+            p = nl + 1;
+        }
+        carry.append(p, end);
+    }
+    if (reader.failed()) return false;
+    if (!carry.empty()) emit(carry);
+    return true;
+}
+
+} // namespace flightsuite
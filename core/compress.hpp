@@ -0,0 +1,75 @@
+// Transparent decompression for the suite's file and fetch readers: gzip through zlib, and zstd
+// when built with FLIGHTSUITE_ZSTD. The format is sniffed from magic bytes, so file names don't
+// matter. Files decode in fixed-size chunks that feed the line/record parsers directly, and
+// multi-frame zstd archives decode their frames in parallel.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace flightsuite {
+
+enum class Compression { kNone, kGzip, kZstd };
+
+Compression detect_compression(std::string_view head);
+const char* compression_name(Compression c);
+// False for zstd in builds without libzstd.
+bool compression_supported(Compression c);
+
+// Incremental decoder: feed compressed bytes as they arrive and decoded bytes are appended to
+// `out`. Concatenated gzip members and zstd frames decode as one stream.
+class StreamDecoder {
+public:
+    explicit StreamDecoder(Compression c);
+    ~StreamDecoder();
+    StreamDecoder(const StreamDecoder&) = delete;
+    StreamDecoder& operator=(const StreamDecoder&) = delete;
+
+    // False on corrupt input (see error()); nothing more should be fed after that.
+    bool feed(const char* data, size_t n, std::string& out);
+    // Whether the input so far ends on a member/frame boundary, i.e. nothing is truncated.
+    bool complete() const;
+    const std::string& error() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Decodes a whole in-memory buffer (e.g. a fetched .gz) if it is compressed; plain input comes
+// back unchanged. std::nullopt on corrupt, truncated, or unsupported input.
+std::optional<std::string> decompress_buffer(std::string data);
+
+// Worker threads for multi-frame zstd files (default: hardware concurrency, at most 8); 1 turns
+// parallel decoding off.
+void set_decompress_threads(unsigned n);
+
+// Reads a plain or compressed file as a sequence of decoded chunks (about 1 MiB each).
+class ChunkedFileReader {
+public:
+    ChunkedFileReader();
+    ~ChunkedFileReader();
+    ChunkedFileReader(const ChunkedFileReader&) = delete;
+    ChunkedFileReader& operator=(const ChunkedFileReader&) = delete;
+
+    bool open(const std::string& path);
+    // Replaces `chunk` with the next decoded bytes; false at the end of the file or on error.
+    bool next(std::string& chunk);
+    bool failed() const;
+    const std::string& error() const;
+    Compression compression() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Streams the remaining lines of an opened reader to `fn` (without the '\n' or a trailing '\r').
+// Returns false if the input fails to decode; see reader.error().
+bool for_each_line(ChunkedFileReader& reader, const std::function<void(std::string_view)>& fn);
+
+} // namespace flightsuite
@@ -0,0 +1,831 @@
+#include "core/datagen.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "core/geo.hpp"
+#include "core/spatial.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// Per-generator stream so e.g. the METAR file for a catalog does not shift when the catalog grows.
+uint64_t derive_seed(uint64_t seed, uint64_t stream) { return seed * 0x9E3779B97F4A7C15ULL ^ (stream + 1); }
+
+struct RegionSpec {
+    char prefix;
+    const char* country;
+    const char* region;
+    double lat_lo, lat_hi, lon_lo, lon_hi;
+    int weight;     // share of the catalog
+    int max_elev;   // rough terrain ceiling
+    bool us_style;
+};
+
+// Coarse boxes per ICAO nationality letter; weights follow the real distribution of aerodromes.
+const RegionSpec kRegions[] = {
+    {'K', "USA", "US-CONUS", 25.0, 49.0, -124.0, -67.0, 34, 7000, true},
+    {'P', "USA", "US-AK-HI", 51.0, 71.0, -168.0, -130.0, 3, 3000, true},
+    {'C', "CAN", "CA", 42.0, 68.0, -139.0, -53.0, 8, 4000, true},
+    {'M', "MEX", "CENTAM", 8.0, 32.0, -117.0, -77.0, 4, 7500, false},
+    {'T', "CUB", "CARIB", 10.0, 26.0, -85.0, -60.0, 2, 1500, false},
+    {'S', "BRA", "SAM", -54.0, 12.0, -81.0, -35.0, 9, 13000, false},
+    {'E', "DEU", "EUR-N", 47.0, 70.0, -10.0, 30.0, 6, 3000, false},
+    {'L', "FRA", "EUR-S", 35.0, 51.0, -9.0, 30.0, 6, 5000, false},
+    {'B', "ISL", "ISL-GRL", 60.0, 78.0, -60.0, -13.0, 1, 2000, false},
+    {'U', "RUS", "RU", 42.0, 72.0, 30.0, 178.0, 4, 4000, false},
+    {'G', "MAR", "AFR-NW", 5.0, 36.0, -17.0, 0.0, 2, 5000, false},
+    {'D', "NGA", "AFR-W", 4.0, 25.0, -8.0, 15.0, 2, 3000, false},
+    {'H', "KEN", "AFR-E", -12.0, 31.0, 25.0, 51.0, 2, 8000, false},
+    {'F', "ZAF", "AFR-S", -35.0, -5.0, 11.0, 41.0, 3, 6000, false},
+    {'O', "SAU", "MIDEAST", 12.0, 38.0, 34.0, 63.0, 2, 6000, false},
+    {'V', "IND", "ASIA-S", 6.0, 33.0, 68.0, 98.0, 3, 8000, false},
+    {'Z', "CHN", "ASIA-CN", 20.0, 50.0, 75.0, 132.0, 4, 12000, false},
+    {'R', "JPN", "ASIA-E", 22.0, 45.0, 120.0, 146.0, 3, 3000, false},
+    {'W', "IDN", "ASIA-SE", -10.0, 7.0, 95.0, 141.0, 2, 5000, false},
+    {'Y', "AUS", "OCEANIA", -43.0, -11.0, 113.0, 154.0, 6, 3000, false},
+    {'N', "NZL", "PAC-S", -47.0, -8.0, 160.0, 180.0, 2, 2500, false},
+    {'A', "PNG", "PAC-SW", -11.0, -2.0, 141.0, 160.0, 1, 5500, false},
+};
+constexpr size_t kSuffixSpace = 26 * 26 * 26;
+
+const char* kSyllables[] = {"Ash", "Bel", "Cor", "Dun", "El", "Fair", "Glen", "Har", "Iron", "Jas",
+                            "Kel", "Lin", "Mar", "Nor", "Oak", "Pine", "Quin", "Ros", "Sil", "Tor",
+                            "Val", "Wes", "Yar", "Zen", "ford", "ton", "field", "dale", "mont", "vik"};
+
+std::string suffix_letters(size_t idx) {
+    // Scatter consecutive indices over the suffix space (7919 is coprime with 26^3).
+    size_t v = (idx * 7919) % kSuffixSpace;
+    std::string s(3, 'A');
+    for (int k = 2; k >= 0; --k) {
+        s[k] = static_cast<char>('A' + v % 26);
+        v /= 26;
+    }
+    return s;
+}
+
+std::string station_name(DataRng& rng, const std::string& kind) {
+    std::string name = rng.pick(kSyllables);
+    const char* tail = rng.pick(kSyllables);
+    if (tail[0] >= 'a') {
+        name += tail;
+    } else {
+        name += " ";
+        name += tail;
+    }
+    if (kind == "large_airport") return name + " Intl";
+    if (kind == "medium_airport") return name + (rng.chance(0.5) ? " Regional" : " Municipal");
+    return name + (rng.chance(0.5) ? " Field" : " Airstrip");
+}
+
+template <typename... Args>
+void emit(std::ostream& out, const char* fmt, Args... args) {
+    char buf[512];
+    int n = std::snprintf(buf, sizeof(buf), fmt, args...);
+    if (n > 0) out.write(buf, std::min<int>(n, sizeof(buf) - 1));
+}
+
+// ---- METAR ----
+
+enum class FlightCat { kVfr, kMvfr, kIfr, kLifr };
+
+FlightCat pick_category(DataRng& rng) {
+    double p = rng.uniform(0.0, 1.0);
+    if (p < 0.70) return FlightCat::kVfr;
+    if (p < 0.85) return FlightCat::kMvfr;
+    if (p < 0.95) return FlightCat::kIfr;
+    return FlightCat::kLifr;
+}
+
+std::string temp_group(int t) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%s%02d", t < 0 ? "M" : "", std::abs(t));
+    return buf;
+}
+
+std::string wind_group(DataRng& rng, bool mps) {
+    if (rng.chance(0.06)) return mps ? "00000MPS" : "00000KT";
+    int spd = rng.range(2, mps ? 14 : 28);
+    char buf[32];
+    if (spd < (mps ? 3 : 6) && rng.chance(0.4)) {
+        std::snprintf(buf, sizeof(buf), "VRB%02d%s", spd, mps ? "MPS" : "KT");
+        return buf;
+    }
+    int dir = rng.range(1, 36) * 10;
+    if (spd > (mps ? 7 : 14) && rng.chance(0.5)) {
+        std::snprintf(buf, sizeof(buf), "%03d%02dG%02d%s", dir, spd, spd + rng.range(5, 15), mps ? "MPS" : "KT");
+    } else {
+        std::snprintf(buf, sizeof(buf), "%03d%02d%s", dir, spd, mps ? "MPS" : "KT");
+    }
+    std::string w = buf;
+    if (spd > 6 && rng.chance(0.08)) {
+        auto norm = [](int d) { return d % 360 == 0 ? 360 : d % 360; };
+        std::snprintf(buf, sizeof(buf), " %03dV%03d", norm(dir + 330), norm(dir + 30));
+        w += buf;
+    }
+    return w;
+}
+
+std::string sm_visibility(FlightCat cat, DataRng& rng) {
+    static const char* kVfr[] = {"10SM", "10SM", "10SM", "7SM", "6SM"};
+    static const char* kMvfr[] = {"5SM", "4SM", "3SM"};
+    static const char* kIfr[] = {"2 1/2SM", "2SM", "1 1/2SM", "1 1/4SM", "1SM"};
+    static const char* kLifr[] = {"3/4SM", "1/2SM", "1/4SM", "M1/4SM"};
+    switch (cat) {
+    case FlightCat::kVfr: return rng.pick(kVfr);
+    case FlightCat::kMvfr: return rng.pick(kMvfr);
+    case FlightCat::kIfr: return rng.pick(kIfr);
+    default: return rng.pick(kLifr);
+    }
+}
+
+int metric_visibility(FlightCat cat, DataRng& rng) {
+    switch (cat) {
+    case FlightCat::kVfr: return rng.chance(0.7) ? 9999 : rng.range(6, 9) * 1000;
+    case FlightCat::kMvfr: return rng.range(5, 8) * 500;
+    case FlightCat::kIfr: return rng.range(16, 30) * 100;
+    default: return rng.range(1, 15) * 50;
+    }
+}
+
+std::string weather_group(FlightCat cat, int temp_c, DataRng& rng) {
+    static const char* kLight[] = {"-RA", "-SHRA", "-DZ", "HZ", "-RA BR"};
+    static const char* kModerate[] = {"RA", "BR", "RA BR", "SHRA", "-TSRA", "VCSH"};
+    static const char* kHeavy[] = {"+RA", "+TSRA", "FG", "BR", "DZ BR", "TSRA BR"};
+    static const char* kWinter[] = {"-SN", "SN", "+SN", "-FZRA", "FZFG", "-SN BR", "BLSN"};
+    if (cat == FlightCat::kVfr && !rng.chance(0.12)) return "";
+    if (temp_c <= 0 && rng.chance(0.7)) return rng.pick(kWinter);
+    switch (cat) {
+    case FlightCat::kVfr: return rng.pick(kLight);
+    case FlightCat::kMvfr: return rng.pick(kModerate);
+    default: return rng.pick(kHeavy);
+    }
+}
+
+std::string sky_groups(FlightCat cat, DataRng& rng, bool us_style) {
+    static const char* kCover[] = {"FEW", "SCT", "BKN", "OVC"};
+    char buf[16];
+    int ceiling;
+    switch (cat) {
+    case FlightCat::kVfr:
+        if (rng.chance(0.35)) return us_style ? "CLR" : "NSC";
+        ceiling = rng.range(31, 250);
+        break;
+    case FlightCat::kMvfr: ceiling = rng.range(10, 30); break;
+    case FlightCat::kIfr: ceiling = rng.range(5, 9); break;
+    default:
+        if (rng.chance(0.3)) {
+            std::snprintf(buf, sizeof(buf), "VV%03d", rng.range(1, 4));
+            return buf;
+        }
+        ceiling = rng.range(1, 4);
+        break;
+    }
+    std::string sky;
+    int layers = rng.range(1, 3);
+    int base = ceiling;
+    for (int i = 0; i < layers; ++i) {
+        const char* cover = i == 0 ? (cat == FlightCat::kVfr ? kCover[rng.range(0, 3)] : kCover[rng.range(2, 3)])
+                                   : kCover[rng.range(1, 3)];
+        std::snprintf(buf, sizeof(buf), "%s%s%03d", i ? " " : "", cover, base);
+        sky += buf;
+        if (i == 0 && !us_style && base < 60 && rng.chance(0.1)) sky += "CB";
+        base += rng.range(10, 80);
+        if (std::string(cover) == "OVC" || base > 400) break;
+    }
+    return sky;
+}
+
+std::string rvr_group(bool us_style, DataRng& rng) {
+    char buf[32];
+    int rwy = rng.range(1, 36);
+    const char* side = rng.chance(0.3) ? (rng.chance(0.5) ? "L" : "R") : "";
+    if (us_style) {
+        int v = rng.range(6, 60) * 100;
+        std::snprintf(buf, sizeof(buf), "R%02d%s/%s%04dFT", rwy, side, v >= 6000 ? "P" : "", v);
+    } else {
+        static const char* kTrend[] = {"", "U", "D", "N"};
+        int v = rng.range(3, 15) * 100;
+        std::snprintf(buf, sizeof(buf), "R%02d%s/%s%04d%s", rwy, side, v >= 1500 ? "P" : "", v, rng.pick(kTrend));
+    }
+    return buf;
+}
+
+std::string metar_body(const StationSpec& s, int day, int hour, int minute, bool speci, DataRng& rng) {
+    FlightCat cat = pick_category(rng);
+    int temp = static_cast<int>(std::lround(30.0 - std::fabs(s.lat) * 0.6 - s.elevation_ft / 500.0 + rng.uniform(-8.0, 8.0)));
+    int spread = cat == FlightCat::kVfr ? rng.range(3, 18) : rng.range(0, 3);
+    int dew = temp - spread;
+
+    std::string m;
+    m.reserve(128);
+    if (speci) m += "SPECI ";
+    m += s.icao;
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), " %02d%02d%02dZ", day, hour, minute);
+    m += buf;
+    bool automated = rng.chance(s.kind == "small_airport" ? 0.6 : 0.1);
+    if (rng.chance(0.01)) m += " COR";
+    if (automated) m += " AUTO";
+    m += " " + wind_group(rng, !s.us_style && s.region == "RU" && rng.chance(0.5));
+
+    bool cavok = !s.us_style && cat == FlightCat::kVfr && rng.chance(0.45);
+    if (cavok) {
+        m += " CAVOK";
+    } else {
+        if (s.us_style) {
+            m += " " + sm_visibility(cat, rng);
+        } else {
+            std::snprintf(buf, sizeof(buf), " %04d", metric_visibility(cat, rng));
+            m += buf;
+        }
+        if (cat == FlightCat::kLifr && s.kind != "small_airport" && rng.chance(0.6)) {
+            m += " " + rvr_group(s.us_style, rng);
+        }
+        std::string wx = weather_group(cat, temp, rng);
+        if (!wx.empty()) m += " " + wx;
+        m += " " + sky_groups(cat, rng, s.us_style);
+    }
+    m += " " + temp_group(temp) + "/" + temp_group(dew);
+    if (s.us_style) {
+        std::snprintf(buf, sizeof(buf), " A%04d", rng.range(2930, 3070));
+        m += buf;
+        m += " RMK AO2";
+        std::snprintf(buf, sizeof(buf), " SLP%03d T%d%03d%d%03d", rng.range(0, 999), temp < 0 ? 1 : 0,
+                      std::abs(temp) * 10 + rng.range(0, 9), dew < 0 ? 1 : 0, std::abs(dew) * 10 + rng.range(0, 9));
+        m += buf;
+    } else {
+        std::snprintf(buf, sizeof(buf), " Q%04d", rng.range(992, 1038));
+        m += buf;
+        if (rng.chance(0.4)) m += " NOSIG";
+    }
+    m += "=";
+    return m;
+}
+
+// ---- NOTAM ----
+
+struct NotamTemplate {
+    const char* qcode;
+    const char* scope; // traffic/purpose/scope field
+    const char* text;
+};
+
+const NotamTemplate kNotamTemplates[] = {
+    {"QMRLC", "IV/NBO/A", "RWY %02d%s/%02d%s CLSD"},
+    {"QICAS", "I/NBO/A", "ILS RWY %02d%s OUT OF SERVICE"},
+    {"QGAXX", "IV/NBO/AE", "GPS UNRELIABLE WI %dNM %dFT AGL-SFC"},
+    {"QLPAS", "IV/BO/A", "RWY %02d%s PAPI U/S"},
+    {"QMXLC", "IV/M/A", "TWY %c BTN %c%d-%c%d CLSD"},
+    {"QOBCE", "IV/M/AE", "OBST CRANE %dFT AGL %dNM E OF ARP LGTD"},
+    {"QLHAS", "IV/BO/A", "RWY %02d%s HIRL UNSERVICEABLE"},
+    {"QPIAU", "I/NBO/A", "RNAV (GPS) Z RWY %02d%s NOT AVBL"},
+    {"QMNHW", "IV/M/A", "APRON %d WIP"},
+    {"QFAHX", "IV/NBO/A", "AD HR OF OPS %02d00-%02d00"},
+};
+
+std::string notam_text(const NotamTemplate& t, DataRng& rng) {
+    static const char* kSides[] = {"", "L", "R", "C"};
+    char buf[128];
+    int rwy = rng.range(1, 18);
+    const char* side = rng.pick(kSides);
+    const char* opposite = side[0] == 'L' ? "R" : side[0] == 'R' ? "L" : side;
+    char twy = static_cast<char>('A' + rng.range(0, 12));
+    switch (&t - kNotamTemplates) {
+    case 0: std::snprintf(buf, sizeof(buf), t.text, rwy, side, rwy + 18, opposite); break;
+    case 2: std::snprintf(buf, sizeof(buf), t.text, rng.range(10, 80), rng.range(1, 40) * 1000); break;
+    case 4: std::snprintf(buf, sizeof(buf), t.text, twy, twy, rng.range(1, 4), twy, rng.range(5, 9)); break;
+    case 5: std::snprintf(buf, sizeof(buf), t.text, rng.range(5, 60) * 10, rng.range(1, 5)); break;
+    case 8: std::snprintf(buf, sizeof(buf), t.text, rng.range(1, 9)); break;
+    case 9: std::snprintf(buf, sizeof(buf), t.text, rng.range(5, 8), rng.range(20, 23)); break;
+    default: std::snprintf(buf, sizeof(buf), t.text, rwy, side); break;
+    }
+    return buf;
+}
+
+std::string coord_q(double lat, double lon) {
+    char buf[24];
+    int la = static_cast<int>(std::fabs(lat) * 60.0), lo = static_cast<int>(std::fabs(lon) * 60.0);
+    std::snprintf(buf, sizeof(buf), "%02d%02d%c%03d%02d%c", la / 60, la % 60, lat < 0 ? 'S' : 'N', lo / 60, lo % 60,
+                  lon < 0 ? 'W' : 'E');
+    return buf;
+}
+
+// ---- OFP / fleet / log ----
+
+struct AirframeSpec {
+    const char* icao_type;
+    const char* role;
+    int range_nm;
+    int min_runway_ft;
+    int cruise_kt;
+    int ceiling_ft;
+};
+
+const AirframeSpec kAirframes[] = {
+    {"C172", "C172 GA", 600, 0, 115, 12000},     {"PA28", "Piston GA", 500, 0, 120, 12000},
+    {"SR22", "Piston GA", 1000, 0, 170, 17000},  {"BE58", "Piston Twin", 1200, 0, 190, 20000},
+    {"BE20", "Turboprop Shuttle", 1200, 0, 290, 31000}, {"PC12", "Turboprop Utility", 1800, 0, 270, 30000},
+    {"DH8D", "Regional Turboprop", 1100, 4500, 340, 27000}, {"AT76", "Regional Turboprop", 900, 4000, 275, 25000},
+    {"CRJ9", "Regional Jet", 1500, 6000, 450, 41000}, {"E175", "Regional Jet", 2000, 5500, 450, 41000},
+    {"B738", "Shorthaul Jet", 1800, 6500, 460, 41000}, {"A320", "Shorthaul Jet", 3100, 5000, 450, 39000},
+    {"A321", "Midhaul Jet", 3500, 7000, 450, 39000}, {"B789", "Longhaul Jet", 7500, 9000, 490, 43000},
+    {"A359", "Longhaul Jet", 8000, 9000, 490, 43000}, {"B77W", "Longhaul Jet", 7300, 10000, 490, 43000},
+};
+
+std::string fix_ident(uint64_t v) {
+    std::string s(5, 'A');
+    for (auto& c : s) {
+        c = static_cast<char>('A' + v % 26);
+        v /= 26;
+    }
+    return s;
+}
+
+struct LatLon {
+    double lat, lon;
+};
+
+// Point at fraction f along the great circle (spherical linear interpolation).
+LatLon great_circle_point(double lat1, double lon1, double lat2, double lon2, double f) {
+    double p1 = deg2rad(lat1), l1 = deg2rad(lon1), p2 = deg2rad(lat2), l2 = deg2rad(lon2);
+    double d = haversine_nm(lat1, lon1, lat2, lon2) / kEarthRadiusNm;
+    if (d < 1e-9) return {lat1, lon1};
+    double a = std::sin((1.0 - f) * d) / std::sin(d), b = std::sin(f * d) / std::sin(d);
+    double x = a * std::cos(p1) * std::cos(l1) + b * std::cos(p2) * std::cos(l2);
+    double y = a * std::cos(p1) * std::sin(l1) + b * std::cos(p2) * std::sin(l2);
+    double z = a * std::sin(p1) + b * std::sin(p2);
+    return {rad2deg(std::atan2(z, std::sqrt(x * x + y * y))), rad2deg(std::atan2(y, x))};
+}
+
+// Point `nm` from (lat, lon) along initial course `course_deg`.
+LatLon destination_point(double lat, double lon, double course_deg, double nm) {
+    double p1 = deg2rad(lat), l1 = deg2rad(lon), c = deg2rad(course_deg), d = nm / kEarthRadiusNm;
+    double p2 = std::asin(std::sin(p1) * std::cos(d) + std::cos(p1) * std::sin(d) * std::cos(c));
+    double l2 = l1 + std::atan2(std::sin(c) * std::sin(d) * std::cos(p1), std::cos(d) - std::sin(p1) * std::sin(p2));
+    double lon2 = std::fmod(rad2deg(l2) + 540.0, 360.0) - 180.0;
+    return {rad2deg(p2), lon2};
+}
+
+std::string upper_words(const std::string& s) {
+    std::string out = s;
+    for (auto& c : out) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return out;
+}
+
+const char* kRemarks[] = {
+    "ILS 16R to mins",       "VOR-A circling",          "RNAV (GPS) Y 34L",     "crosswind 15G25",
+    "practice holds at fix", "ATC reroute via airway",  "light rime in climb",  "night currency",
+    "pattern work",          "IPC with CFII",           "checkride",            "diverted for weather",
+    "smooth ride",           "moderate chop FL240",     "visual approach",      "LOC BC approach",
+    "go-around windshear",   "short field practice",    "single pilot IFR",     "mountain wave",
+};
+
+} // namespace
+
+DataRng::DataRng(uint64_t seed) {
+    for (auto& s : s_) s = splitmix64(seed);
+}
+
+uint64_t DataRng::next() {
+    uint64_t result = rotl(s_[1] * 5, 7) * 9;
+    uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+}
+
+double DataRng::uniform(double lo, double hi) {
+    return lo + (hi - lo) * (static_cast<double>(next() >> 11) * 0x1.0p-53);
+}
+
+int DataRng::range(int lo, int hi) {
+    uint64_t span = static_cast<uint64_t>(hi - lo) + 1;
+    return lo + static_cast<int>(next() % span);
+}
+
+bool DataRng::chance(double p) { return uniform(0.0, 1.0) < p; }
+
+std::vector<StationSpec> generate_stations(size_t count, uint64_t seed) {
+    DataRng rng(derive_seed(seed, 0));
+    constexpr size_t kRegionCount = sizeof(kRegions) / sizeof(kRegions[0]);
+    int total_weight = 0;
+    for (const auto& r : kRegions) total_weight += r.weight;
+    std::vector<size_t> used(kRegionCount, 0);
+
+    std::vector<StationSpec> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        int w = rng.range(0, total_weight - 1);
+        size_t ri = 0;
+        while (w >= kRegions[ri].weight) w -= kRegions[ri++].weight;
+        // Spill into the next prefix once a region's 26^3 idents are exhausted.
+        size_t tries = 0;
+        while (used[ri] >= kSuffixSpace && tries++ < kRegionCount) ri = (ri + 1) % kRegionCount;
+        if (used[ri] >= kSuffixSpace) break;
+        const RegionSpec& r = kRegions[ri];
+
+        StationSpec s;
+        s.icao = std::string(1, r.prefix) + suffix_letters(used[ri]++);
+        double k = rng.uniform(0.0, 1.0);
+        s.kind = k < 0.02 ? "large_airport" : k < 0.15 ? "medium_airport" : "small_airport";
+        s.name = station_name(rng, s.kind);
+        s.country = r.country;
+        s.region = r.region;
+        s.lat = std::round(rng.uniform(r.lat_lo, r.lat_hi) * 1e4) / 1e4;
+        s.lon = std::round(rng.uniform(r.lon_lo, r.lon_hi) * 1e4) / 1e4;
+        // Skewed toward sea level with a long tail into high terrain.
+        double e = rng.uniform(0.0, 1.0);
+        s.elevation_ft = static_cast<int>(e * e * e * r.max_elev);
+        if (s.kind == "large_airport") {
+            s.longest_runway_ft = rng.range(90, 160) * 100;
+        } else if (s.kind == "medium_airport") {
+            s.longest_runway_ft = rng.range(50, 100) * 100;
+        } else {
+            s.longest_runway_ft = rng.range(15, 55) * 100;
+        }
+        s.us_style = r.us_style;
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+Airport to_airport(const StationSpec& s) {
+    Airport a;
+    a.icao = s.icao;
+    a.name = s.name;
+    a.country = s.country;
+    a.region = s.region;
+    a.lat = s.lat;
+    a.lon = s.lon;
+    a.longest_runway_ft = s.longest_runway_ft;
+    a.kind = s.kind;
+    a.elevation_ft = s.elevation_ft;
+    return a;
+}
+
+void write_airports_csv(std::ostream& out, const std::vector<StationSpec>& stations) {
+    out << "# icao,name,country,region,lat,lon,longest_runway_ft,kind,elevation_ft\n";
+    for (const auto& s : stations) {
+        emit(out, "%s,%s,%s,%s,%.4f,%.4f,%d,%s,%d\n", s.icao.c_str(), s.name.c_str(), s.country.c_str(),
+             s.region.c_str(), s.lat, s.lon, s.longest_runway_ft, s.kind.c_str(), s.elevation_ft);
+    }
+}
+
+void write_metar_cycle(std::ostream& out, const std::vector<StationSpec>& stations, const MetarCycleOptions& opt) {
+    DataRng rng(derive_seed(opt.seed, 1));
+    for (const auto& s : stations) {
+        // US stations report just before the hour; elsewhere on the hour or half hour.
+        int hour = opt.hour;
+        int minute = s.us_style ? rng.range(51, 56) : (rng.chance(0.3) ? 30 : 0);
+        int obs_hour = s.us_style ? (hour + 23) % 24 : hour;
+        int obs_day = s.us_style && hour == 0 ? std::max(1, opt.day - 1) : opt.day;
+        emit(out, "%04d/%02d/%02d %02d:%02d\n", opt.year, opt.month, obs_day, obs_hour, minute);
+        out << metar_body(s, obs_day, obs_hour, minute, false, rng) << "\n\n";
+        if (rng.chance(opt.speci_rate)) {
+            int speci_minute = rng.range(1, 50);
+            emit(out, "%04d/%02d/%02d %02d:%02d\n", opt.year, opt.month, opt.day, hour, speci_minute);
+            out << metar_body(s, opt.day, hour, speci_minute, true, rng) << "\n\n";
+        }
+    }
+}
+
+void write_notam_dump(std::ostream& out, const std::vector<StationSpec>& stations, size_t count,
+                      NotamFormat format, uint64_t seed) {
+    if (stations.empty()) return;
+    DataRng rng(derive_seed(seed, 2));
+    constexpr int kTemplates = sizeof(kNotamTemplates) / sizeof(kNotamTemplates[0]);
+    std::unordered_map<std::string, int> serial;
+    for (size_t i = 0; i < count; ++i) {
+        // Skew toward busier fields: most NOTAMs land on the first part of the catalog.
+        double u = rng.uniform(0.0, 1.0);
+        const StationSpec& s = stations[static_cast<size_t>(u * u * stations.size())];
+        const NotamTemplate& t = kNotamTemplates[rng.range(0, kTemplates - 1)];
+        std::string text = notam_text(t, rng);
+        int month = rng.range(1, 12), day = rng.range(1, 28), start_h = rng.range(0, 20);
+        int number = ++serial[s.icao];
+        if (format == NotamFormat::kFaa) {
+            emit(out, "!%s %02d/%03d %s %s %02d%02d-%02d%02d\n", s.icao.c_str(), month, number, s.icao.c_str() + 1,
+                 text.c_str(), start_h, 0, start_h + rng.range(1, 3), 0);
+            continue;
+        }
+        static const char kSeries[] = "ABCM";
+        bool replace = rng.chance(0.1), cancel = !replace && rng.chance(0.05);
+        emit(out, "%c%04d/24 NOTAM%c\n", kSeries[rng.range(0, 3)], static_cast<int>(i % 10000),
+             replace ? 'R' : cancel ? 'C' : 'N');
+        emit(out, "Q) %c%cZZ/%s/%s/000/999/%s005\n", s.icao[0], s.icao[1], t.qcode, t.scope,
+             coord_q(s.lat, s.lon).c_str());
+        emit(out, "A) %s B) 24%02d%02d%02d00 C) ", s.icao.c_str(), month, day, start_h);
+        if (rng.chance(0.1)) {
+            out << "PERM\n";
+        } else {
+            emit(out, "24%02d%02d%02d00%s\n", month, std::min(28, day + rng.range(0, 14)), rng.range(0, 23),
+                 rng.chance(0.2) ? " EST" : "");
+        }
+        out << "E) " << text << "\n\n";
+    }
+}
+
+void write_ofp_xml(std::ostream& out, const StationSpec& from, const StationSpec& to, size_t n_fixes,
+                   uint64_t seed) {
+    DataRng rng(derive_seed(seed, 3));
+    const AirframeSpec& af = kAirframes[rng.range(10, 15)];
+    double total_nm = haversine_nm(from.lat, from.lon, to.lat, to.lon);
+    int cruise_ft = std::min(af.ceiling_ft - 2000, total_nm < 300 ? 24000 : rng.range(33, 39) * 1000);
+    double climb_nm = std::min(total_nm * 0.3, cruise_ft / 1000.0 * 3.5);
+    double descent_nm = std::min(total_nm * 0.3, cruise_ft / 1000.0 * 3.0);
+    double hours = total_nm / af.cruise_kt + 0.3;
+    int burn_per_hr = af.range_nm > 5000 ? 6500 : 2600;
+    int trip = static_cast<int>(hours * burn_per_hr);
+    int reserve = burn_per_hr * 3 / 4, taxi = 250, extra = rng.range(0, 20) * 100;
+    int zfw = af.range_nm > 5000 ? rng.range(170, 200) * 1000 : rng.range(52, 62) * 1000;
+
+    std::vector<std::string> idents;
+    idents.reserve(n_fixes);
+    for (size_t i = 0; i < n_fixes; ++i) {
+        idents.push_back(i == 0 ? from.icao : i + 1 == n_fixes ? to.icao : fix_ident(rng.next()));
+    }
+
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<OFP>\n";
+    emit(out, "<params><request_id>%llu</request_id><units>lbs</units></params>\n",
+         static_cast<unsigned long long>(seed));
+    out << "<general><icao_airline>FSX</icao_airline>";
+    emit(out, "<flight_number>%d</flight_number><initial_altitude>%d</initial_altitude>", rng.range(1, 9999), cruise_ft);
+    emit(out, "<route_distance>%d</route_distance><gc_distance>%d</gc_distance>", static_cast<int>(total_nm * 1.03),
+         static_cast<int>(total_nm));
+    out << "<route>";
+    // Airway-style string: every few fixes joined by a synthetic airway, DCT elsewhere.
+    size_t stride = std::max<size_t>(4, n_fixes / 40);
+    for (size_t i = 1; i + 1 < n_fixes; i += stride) {
+        if (i > 1) emit(out, " %c%d ", "JQUL"[rng.range(0, 3)], rng.range(1, 999));
+        out << idents[i];
+    }
+    out << "</route></general>\n";
+    emit(out, "<origin><icao_code>%s</icao_code><name>%s</name><plan_rwy>%02d</plan_rwy><elevation>%d</elevation></origin>\n",
+         from.icao.c_str(), from.name.c_str(), rng.range(1, 36), from.elevation_ft);
+    emit(out, "<destination><icao_code>%s</icao_code><name>%s</name><plan_rwy>%02d</plan_rwy><elevation>%d</elevation></destination>\n",
+         to.icao.c_str(), to.name.c_str(), rng.range(1, 36), to.elevation_ft);
+    emit(out, "<alternate><icao_code>%s</icao_code></alternate>\n", to.icao.c_str());
+    emit(out, "<aircraft><icaocode>%s</icaocode><name>%s</name><reg>N%dFS</reg><engines>%s</engines></aircraft>\n",
+         af.icao_type, af.icao_type, rng.range(100, 999), af.range_nm > 5000 ? "GE90" : "CFM56");
+    emit(out, "<fuel><taxi>%d</taxi><enroute_burn>%d</enroute_burn><reserve>%d</reserve><extra>%d</extra>"
+              "<plan_trip>%d</plan_trip><plan_ramp>%d</plan_ramp></fuel>\n",
+         taxi, trip, reserve, extra, trip, trip + reserve + taxi + extra);
+    emit(out, "<times><est_time_enroute>%d</est_time_enroute></times>\n", static_cast<int>(hours * 3600));
+
+    out << "<navlog>\n";
+    double prev_lat = from.lat, prev_lon = from.lon, flown = 0.0;
+    for (size_t i = 0; i < n_fixes; ++i) {
+        double f = n_fixes > 1 ? static_cast<double>(i) / (n_fixes - 1) : 0.0;
+        LatLon p = great_circle_point(from.lat, from.lon, to.lat, to.lon, f);
+        double leg = haversine_nm(prev_lat, prev_lon, p.lat, p.lon);
+        flown += leg;
+        int alt;
+        if (i == 0) {
+            alt = from.elevation_ft;
+        } else if (i + 1 == n_fixes) {
+            alt = to.elevation_ft;
+        } else if (flown < climb_nm) {
+            alt = static_cast<int>(cruise_ft * flown / climb_nm) / 100 * 100;
+        } else if (total_nm - flown < descent_nm) {
+            alt = static_cast<int>(cruise_ft * (total_nm - flown) / descent_nm) / 100 * 100;
+        } else {
+            alt = cruise_ft;
+        }
+        const char* type = i == 0 || i + 1 == n_fixes ? "apt" : rng.chance(0.15) ? "vor" : "wpt";
+        int track = static_cast<int>(std::lround(initial_course_deg(p.lat, p.lon, to.lat, to.lon))) % 360;
+        emit(out, "<fix><ident>%s</ident><name>%s</name><type>%s</type><pos_lat>%.6f</pos_lat><pos_long>%.6f</pos_long>"
+                  "<altitude_feet>%d</altitude_feet><distance>%d</distance><track_true>%03d</track_true>",
+             idents[i].c_str(), idents[i].c_str(), type, p.lat, p.lon, alt, static_cast<int>(std::lround(leg)), track);
+        emit(out, "<wind_dir>%03d</wind_dir><wind_spd>%d</wind_spd><oat>%d</oat><mora>%d</mora></fix>\n",
+             rng.range(20, 32) * 10, alt > 20000 ? rng.range(30, 140) : rng.range(5, 40), 15 - alt * 2 / 1000,
+             std::max(from.elevation_ft, to.elevation_ft) / 100 + rng.range(20, 80));
+        prev_lat = p.lat;
+        prev_lon = p.lon;
+    }
+    out << "</navlog>\n";
+    emit(out, "<weights><est_zfw>%d</est_zfw><plan_zfw>%d</plan_zfw><plan_takeoff>%d</plan_takeoff>"
+              "<plan_landing>%d</plan_landing><pax_count>%d</pax_count></weights>\n",
+         zfw, zfw, zfw + trip + reserve + extra, zfw + reserve + extra, rng.range(20, 300));
+    out << "</OFP>\n";
+}
+
+void write_fleet_csv(std::ostream& out, const std::vector<StationSpec>& stations, size_t count, uint64_t seed) {
+    DataRng rng(derive_seed(seed, 4));
+    std::vector<const StationSpec*> bases;
+    for (const auto& s : stations) {
+        if (s.kind != "small_airport") bases.push_back(&s);
+    }
+    out << "# name,role,home(optional),range_nm,min_runway_ft\n";
+    constexpr int kTypes = sizeof(kAirframes) / sizeof(kAirframes[0]);
+    for (size_t i = 0; i < count; ++i) {
+        const AirframeSpec& af = kAirframes[rng.range(0, kTypes - 1)];
+        const char* home = !bases.empty() && rng.chance(0.8) ? bases[rng.next() % bases.size()]->icao.c_str() : "";
+        int range = af.range_nm * rng.range(90, 105) / 100;
+        emit(out, "%s-%zu,%s,%s,%d,%d\n", af.icao_type, i + 1, af.role, home, range, af.min_runway_ft);
+    }
+}
+
+void write_flight_log_csv(std::ostream& out, const std::vector<StationSpec>& stations, size_t rows,
+                          uint64_t seed) {
+    DataRng rng(derive_seed(seed, 5));
+    out << "date,tail,from,to,route,pic_hours,sic_hours,night_hours,ifr_hours,landings_day,landings_night,remarks\n";
+    if (stations.empty()) return;
+
+    struct Tail {
+        std::string reg;
+        const AirframeSpec* af;
+        size_t at; // current station
+    };
+    constexpr int kTypes = sizeof(kAirframes) / sizeof(kAirframes[0]);
+    size_t n_tails = std::max<size_t>(1, std::min<size_t>(rows / 400 + 1, 5000));
+    std::vector<Tail> tails;
+    tails.reserve(n_tails);
+    for (size_t i = 0; i < n_tails; ++i) {
+        char reg[32];
+        std::snprintf(reg, sizeof(reg), "N%zu%c%c", 100 + i, 'A' + static_cast<int>(i % 26),
+                      'A' + static_cast<int>((i / 26) % 26));
+        tails.push_back({reg, &kAirframes[rng.range(0, kTypes - 1)], rng.next() % stations.size()});
+    }
+
+    // Civil date walk starting 2015-01-01, spread so the log covers roughly ten years.
+    int year = 2015, month = 1, day = 1;
+    double next_day_p = std::min(1.0, 3650.0 / static_cast<double>(rows));
+    static const int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    for (size_t row = 0; row < rows; ++row) {
+        if (row > 0 && rng.chance(next_day_p)) {
+            int dim = kDays[month - 1] + (month == 2 && year % 4 == 0 ? 1 : 0);
+            if (++day > dim) {
+                day = 1;
+                if (++month > 12) {
+                    month = 1;
+                    ++year;
+                }
+            }
+        }
+        Tail& t = tails[rng.next() % tails.size()];
+        const StationSpec& from = stations[t.at];
+        // Pick a destination within range by probing a few random candidates.
+        size_t to_idx = t.at;
+        double dist = 0.0;
+        for (int probe = 0; probe < 8; ++probe) {
+            size_t cand = rng.next() % stations.size();
+            if (cand == t.at) continue;
+            double d = haversine_nm(from.lat, from.lon, stations[cand].lat, stations[cand].lon);
+            if (d <= t.af->range_nm * 0.8) {
+                to_idx = cand;
+                dist = d;
+                break;
+            }
+        }
+        const StationSpec& to = stations[to_idx];
+        double hours = std::max(0.3, dist / t.af->cruise_kt + 0.2);
+        bool crewed = t.af->min_runway_ft > 0;
+        double pic = crewed && rng.chance(0.5) ? 0.0 : hours;
+        double sic = pic > 0.0 ? 0.0 : hours;
+        double night = rng.chance(0.25) ? hours * rng.uniform(0.1, 1.0) : 0.0;
+        double ifr = rng.chance(0.4) ? hours * rng.uniform(0.1, 0.9) : 0.0;
+        int ldg_night = night > 0.0 && rng.chance(0.6) ? 1 : 0;
+        int ldg_day = to_idx == t.at ? rng.range(1, 6) : 1 - ldg_night;
+
+        std::string route;
+        if (to_idx == t.at) {
+            route = "LOCAL";
+        } else if (rng.chance(0.4)) {
+            route = "DCT";
+        } else {
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), "%s %c%d %s", fix_ident(rng.next()).c_str(), "JVQT"[rng.range(0, 3)],
+                          rng.range(1, 600), fix_ident(rng.next()).c_str());
+            route = buf;
+        }
+        emit(out, "%04d-%02d-%02d,%s,%s,%s,%s,%.1f,%.1f,%.1f,%.1f,%d,%d,%s\n", year, month, day, t.reg.c_str(),
+             from.icao.c_str(), to.icao.c_str(), route.c_str(), pic, sic, night, ifr, ldg_day, ldg_night,
+             rng.chance(0.6) ? rng.pick(kRemarks) : "");
+        t.at = to_idx;
+    }
+}
+
+// ---- Navdata ----
+
+SyntheticNavdata generate_navdata(const std::vector<StationSpec>& stations, size_t n_fixes, uint64_t seed) {
+    DataRng rng(derive_seed(seed, 6));
+    SyntheticNavdata nav;
+    if (stations.empty()) return nav;
+    for (const auto& s : stations) {
+        std::string region = s.icao.substr(0, 2);
+        if (s.kind == "large_airport" || s.kind == "medium_airport") {
+            LatLon p = destination_point(s.lat, s.lon, rng.uniform(0.0, 360.0), rng.uniform(1.0, 8.0));
+            nav.points.push_back({s.icao.substr(s.icao.size() - 3), region, upper_words(s.name) + " VOR/DME", 3, p.lat,
+                                  p.lon, 10800 + rng.range(0, 199) * 5});
+        } else if (rng.chance(0.3)) {
+            LatLon p = destination_point(s.lat, s.lon, rng.uniform(0.0, 360.0), rng.uniform(2.0, 12.0));
+            nav.points.push_back({s.icao.substr(s.icao.size() - 2), region, upper_words(s.name) + " NDB", 2, p.lat, p.lon,
+                                  rng.range(190, 535)});
+        }
+    }
+    for (size_t i = 0; i < n_fixes; ++i) {
+        const StationSpec& s = stations[rng.next() % stations.size()];
+        LatLon p = destination_point(s.lat, s.lon, rng.uniform(0.0, 360.0), rng.uniform(10.0, 150.0));
+        // A small ident space makes some names repeat, far apart, like real fixes do.
+        nav.points.push_back({fix_ident(rng.next() % 4000000), s.icao.substr(0, 2), "", 11, p.lat, p.lon, 0});
+    }
+
+    // Airways: from a random point, repeatedly step to a nearby point roughly ahead on the heading.
+    std::vector<GeoPoint> geo;
+    geo.reserve(nav.points.size());
+    for (const auto& p : nav.points) geo.push_back({p.lat, p.lon});
+    SpatialIndex index(geo);
+    std::vector<SpatialHit> hits;
+    size_t n_airways = std::max<size_t>(1, nav.points.size() / 12);
+    int high_no = 0, low_no = 0;
+    for (size_t a = 0; a < n_airways; ++a) {
+        SyntheticAirway awy;
+        awy.high = rng.chance(0.5);
+        size_t at = rng.next() % nav.points.size();
+        double heading = rng.uniform(0.0, 360.0);
+        int length = rng.range(4, 24);
+        awy.points.push_back(at);
+        for (int step = 0; step < length; ++step) {
+            const auto& here = nav.points[at];
+            index.nearest(here.lat, here.lon, 16, awy.high ? 200.0 : 90.0, hits);
+            double best_score = 0.0;
+            size_t best = at;
+            double best_course = heading;
+            for (const auto& h : hits) {
+                if (h.distance_nm < (awy.high ? 25.0 : 8.0)) continue;
+                if (std::find(awy.points.begin(), awy.points.end(), h.id) != awy.points.end()) continue;
+                double course = initial_course_deg(here.lat, here.lon, nav.points[h.id].lat, nav.points[h.id].lon);
+                double off = std::fabs(std::fmod(course - heading + 540.0, 360.0) - 180.0);
+                if (off > 40.0) continue;
+                double score = h.distance_nm * (1.0 + off / 40.0);
+                if (best == at || score < best_score) {
+                    best = h.id;
+                    best_score = score;
+                    best_course = course;
+                }
+            }
+            if (best == at) break;
+            awy.points.push_back(best);
+            at = best;
+            heading = best_course;
+        }
+        if (awy.points.size() < 2) continue;
+        awy.name = awy.high ? "J" + std::to_string(++high_no) : "V" + std::to_string(++low_no);
+        nav.airways.push_back(std::move(awy));
+    }
+    return nav;
+}
+
+void write_earth_fix(std::ostream& out, const SyntheticNavdata& nav) {
+    out << "I\n1100 Version - synthetic flightsuite navdata, not for navigation.\n\n";
+    for (const auto& p : nav.points) {
+        if (p.type != 11) continue;
+        emit(out, "%12.8f %13.8f %s ENRT %s 2\n", p.lat, p.lon, p.ident.c_str(), p.region.c_str());
+    }
+    out << "99\n";
+}
+
+void write_earth_nav(std::ostream& out, const SyntheticNavdata& nav) {
+    out << "I\n1100 Version - synthetic flightsuite navdata, not for navigation.\n\n";
+    for (const auto& p : nav.points) {
+        if (p.type == 11) continue;
+        emit(out, "%d %12.8f %13.8f %6d %5d %3d %6.1f %s ENRT %s %s\n", p.type, p.lat, p.lon, 0, p.freq,
+             p.type == 3 ? 130 : 50, 0.0, p.ident.c_str(), p.region.c_str(), p.name.c_str());
+    }
+    out << "99\n";
+}
+
+void write_earth_awy(std::ostream& out, const SyntheticNavdata& nav) {
+    out << "I\n1100 Version - synthetic flightsuite navdata, not for navigation.\n\n";
+    for (const auto& awy : nav.airways) {
+        for (size_t i = 0; i + 1 < awy.points.size(); ++i) {
+            const auto& a = nav.points[awy.points[i]];
+            const auto& b = nav.points[awy.points[i + 1]];
+            emit(out, "%s %s %d %s %s %d N %d %d %d %s\n", a.ident.c_str(), a.region.c_str(), a.type, b.ident.c_str(),
+                 b.region.c_str(), b.type, awy.high ? 2 : 1, awy.high ? 180 : 18, awy.high ? 450 : 180,
+                 awy.name.c_str());
+        }
+    }
+    out << "99\n";
+}
+
+} // namespace flightsuite
@@ -0,0 +1,111 @@
+// Deterministic synthetic inputs for load tests and benchmarks: station catalogs, METAR cycle
+// files, NOTAM dumps, SimBrief OFPs, aircraft fleets, and flight logs. Everything streams to an
+// std::ostream and depends only on the seed (own RNG, no std distributions), so the same seed
+// produces byte-identical files on every platform.
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "core/airports.hpp"
+
+namespace flightsuite {
+
+// xoshiro256** seeded through splitmix64.
+class DataRng {
+public:
+    explicit DataRng(uint64_t seed);
+    uint64_t next();
+    double uniform(double lo, double hi);
+    int range(int lo, int hi); // inclusive
+    bool chance(double p);
+    template <typename T, size_t N>
+    const T& pick(const T (&items)[N]) { return items[next() % N]; }
+
+private:
+    uint64_t s_[4];
+};
+
+struct StationSpec {
+    std::string icao;
+    std::string name;
+    std::string country;
+    std::string region;
+    std::string kind; // large_airport, medium_airport, small_airport
+    double lat = 0.0;
+    double lon = 0.0;
+    int elevation_ft = 0;
+    int longest_runway_ft = 0;
+    bool us_style = false; // reports in SM / inHg rather than metres / hPa
+};
+
+// Worldwide catalog with unique ICAO idents drawn from realistic regional prefixes. The same
+// (count, seed) always yields the same stations, so files generated separately line up.
+std::vector<StationSpec> generate_stations(size_t count, uint64_t seed);
+Airport to_airport(const StationSpec& s);
+
+// airports.csv: icao,name,country,region,lat,lon,longest_runway_ft,kind,elevation_ft
+void write_airports_csv(std::ostream& out, const std::vector<StationSpec>& stations);
+
+struct MetarCycleOptions {
+    int year = 2024;
+    int month = 1;
+    int day = 15;
+    int hour = 12;          // cycle hour (UTC)
+    double speci_rate = 0.05; // extra SPECI reports per station
+    uint64_t seed = 1;
+};
+
+// NOAA cycle-file layout: "YYYY/MM/DD HH:MM" line, report line, blank line.
+void write_metar_cycle(std::ostream& out, const std::vector<StationSpec>& stations, const MetarCycleOptions& opt);
+
+enum class NotamFormat { kIcao, kFaa };
+
+// kIcao: multi-line "A1234/24 NOTAMN / Q) / A) B) C) / E)" records; kFaa: one "!KJFK 01/123 ..." per line.
+void write_notam_dump(std::ostream& out, const std::vector<StationSpec>& stations, size_t count,
+                      NotamFormat format, uint64_t seed);
+
+// OFP with `n_fixes` navlog fixes along the great circle from `from` to `to`.
+void write_ofp_xml(std::ostream& out, const StationSpec& from, const StationSpec& to, size_t n_fixes,
+                   uint64_t seed);
+
+// aircraft.csv: name,role,home,range_nm,min_runway_ft
+void write_fleet_csv(std::ostream& out, const std::vector<StationSpec>& stations, size_t count, uint64_t seed);
+
+// flightLog CSV (with header); legs chain per tail so each arrival is the next departure.
+void write_flight_log_csv(std::ostream& out, const std::vector<StationSpec>& stations, size_t rows,
+                          uint64_t seed);
+
+struct SyntheticNavPoint {
+    std::string ident;
+    std::string region; // first two letters of the nearby station's ICAO code
+    std::string name;   // navaids only
+    int type = 11;      // earth_awy.dat type: 11 fix, 2 NDB, 3 VOR
+    double lat = 0.0;
+    double lon = 0.0;
+    int freq = 0; // 10 kHz units for VORs, kHz for NDBs
+};
+
+struct SyntheticAirway {
+    std::string name; // J### (high) or V### (low)
+    bool high = false;
+    std::vector<size_t> points; // indices into SyntheticNavdata::points, in order
+};
+
+struct SyntheticNavdata {
+    std::vector<SyntheticNavPoint> points;
+    std::vector<SyntheticAirway> airways;
+};
+
+// VORs beside large/medium stations, NDBs beside some small ones, `n_fixes` enroute fixes
+// scattered around stations, and airways chained through neighbouring points along a heading.
+// Fix idents repeat across regions now and then, as they do in real data.
+SyntheticNavdata generate_navdata(const std::vector<StationSpec>& stations, size_t n_fixes, uint64_t seed);
+// X-Plane 1100-format earth_fix.dat / earth_nav.dat / earth_awy.dat for the same navdata.
+void write_earth_fix(std::ostream& out, const SyntheticNavdata& nav);
+void write_earth_nav(std::ostream& out, const SyntheticNavdata& nav);
+void write_earth_awy(std::ostream& out, const SyntheticNavdata& nav);
+
+} // namespace flightsuite
@@ -0,0 +1,98 @@
+#include "core/density.hpp"
+
+#include <algorithm>
+
+#include "core/e6b.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+struct AirframeRule {
+    const char* name;
+    double per_1000ft;
+};
+
+// Normally aspirated pistons lose the most; turbines less so (flat-rated engines, more excess thrust).
+constexpr AirframeRule kAirframeRules[] = {
+    {"piston-single", 0.12},
+    {"piston-twin", 0.10},
+    {"turboprop", 0.08},
+    {"jet", 0.06},
+};
+
+} // namespace
+
+StationObsColumns join_station_obs(const std::vector<MetarDecoded>& reports,
+                                   const std::unordered_map<std::string, Airport>& by_icao, ObsJoinStats* stats) {
+    TraceSpan span("join_station_obs", "density");
+    ObsJoinStats st;
+    st.reports = reports.size();
+    StationObsColumns cols;
+    std::unordered_map<std::string, size_t> row_of;
+    row_of.reserve(reports.size());
+    std::vector<int64_t> row_time; // resolved obs_time per row, 0 if the reports carry none
+    for (const auto& m : reports) {
+        if (!m.temperature_c || !m.altimeter_inhg) {
+            ++st.missing_obs;
+            continue;
+        }
+        auto ap = by_icao.find(m.station);
+        if (ap == by_icao.end() || !ap->second.elevation_ft) {
+            ++st.missing_elevation;
+            continue;
+        }
+        auto [it, inserted] = row_of.emplace(m.station, cols.size());
+        size_t row = it->second;
+        if (inserted) {
+            cols.station.push_back(m.station);
+            cols.time_z.push_back(m.timestamp_z);
+            cols.elevation_ft.push_back(*ap->second.elevation_ft);
+            cols.altimeter_inhg.push_back(*m.altimeter_inhg);
+            cols.temperature_c.push_back(*m.temperature_c);
+            row_time.push_back(m.obs_time.value_or(0));
+        } else if (m.obs_time ? *m.obs_time > row_time[row] : m.timestamp_z > cols.time_z[row]) {
+            // Cycle files can hold a METAR and later SPECIs for one station: keep the newest. The
+            // resolved time orders reports across a month rollover; DDHHMMZ alone only within one.
+            cols.time_z[row] = m.timestamp_z;
+            row_time[row] = m.obs_time.value_or(0);
+            cols.altimeter_inhg[row] = *m.altimeter_inhg;
+            cols.temperature_c[row] = *m.temperature_c;
+        }
+    }
+    st.stations = cols.size();
+    if (stats) *stats = st;
+    return cols;
+}
+
+void compute_density_altitudes(const StationObsColumns& obs, DensityColumns& out) {
+    TraceSpan span("compute_density_altitudes", "density");
+    size_t n = obs.size();
+    out.pressure_alt_ft.resize(n);
+    out.density_alt_ft.resize(n);
+    const double* elev = obs.elevation_ft.data();
+    const double* alt = obs.altimeter_inhg.data();
+    const double* oat = obs.temperature_c.data();
+    double* pa = out.pressure_alt_ft.data();
+    double* da = out.density_alt_ft.data();
+    for (size_t i = 0; i < n; ++i) {
+        pa[i] = pressure_altitude_ft(elev[i], alt[i]);
+        da[i] = density_altitude_ft(pa[i], oat[i]);
+    }
+}
+
+const char* airframe_class_name(AirframeClass c) { return kAirframeRules[static_cast<int>(c)].name; }
+
+double takeoff_increase_per_1000ft(AirframeClass c) { return kAirframeRules[static_cast<int>(c)].per_1000ft; }
+
+void takeoff_distance_factors(AirframeClass c, const std::vector<double>& density_alt_ft, std::vector<double>& out) {
+    double k = takeoff_increase_per_1000ft(c) / 1000.0;
+    size_t n = density_alt_ft.size();
+    out.resize(n);
+    const double* da = density_alt_ft.data();
+    double* f = out.data();
+    for (size_t i = 0; i < n; ++i) f[i] = 1.0 + k * std::max(da[i], 0.0);
+}
+
+} // namespace flightsuite
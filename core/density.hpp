@@ -0,0 +1,55 @@
+// Network-wide density altitude: joins decoded METARs with catalog elevations into column arrays
+// and computes pressure/density altitude and takeoff distance factors in tight loops over them.
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/metar.hpp"
+
+namespace flightsuite {
+
+// One row per station (its latest report), stored column-wise so the batch kernels vectorize.
+struct StationObsColumns {
+    std::vector<std::string> station;
+    std::vector<std::string> time_z;
+    std::vector<double> elevation_ft;
+    std::vector<double> altimeter_inhg;
+    std::vector<double> temperature_c;
+
+    size_t size() const { return station.size(); }
+};
+
+struct DensityColumns {
+    std::vector<double> pressure_alt_ft;
+    std::vector<double> density_alt_ft;
+};
+
+struct ObsJoinStats {
+    size_t reports = 0;
+    size_t stations = 0;
+    size_t missing_elevation = 0; // station not in the catalog, or catalog row has no elevation
+    size_t missing_obs = 0;       // no temperature or altimeter group
+};
+
+// Keeps the latest report per station (by obs_time when decoded with a reference time) that has
+// temperature and altimeter, and a known elevation.
+StationObsColumns join_station_obs(const std::vector<MetarDecoded>& reports,
+                                   const std::unordered_map<std::string, Airport>& by_icao,
+                                   ObsJoinStats* stats = nullptr);
+
+void compute_density_altitudes(const StationObsColumns& obs, DensityColumns& out);
+
+// Rule-of-thumb takeoff distance growth with density altitude, per airframe class.
+enum class AirframeClass { kPistonSingle, kPistonTwin, kTurboprop, kJet, kCount };
+
+const char* airframe_class_name(AirframeClass c);
+// Fraction of sea-level takeoff distance added per 1000 ft of density altitude.
+double takeoff_increase_per_1000ft(AirframeClass c);
+
+// factor[i] = 1 + k * max(DA[i], 0) / 1000: the multiplier on the book sea-level ISA distance.
+void takeoff_distance_factors(AirframeClass c, const std::vector<double>& density_alt_ft, std::vector<double>& out);
+
+} // namespace flightsuite
@@ -0,0 +1,62 @@
+#include "core/e6b.hpp"
+
+#include <cmath>
+
+#include "core/geo.hpp"
+
+namespace flightsuite {
+
+WindTriangle wind_triangle(double hdg_deg, double tas_kt, double wind_dir_deg, double wind_spd_kt) {
+    WindTriangle out;
+    double hdg = deg2rad(hdg_deg);
+    double wind_dir = deg2rad(wind_dir_deg);
+    double wx = wind_spd_kt * std::sin(wind_dir);
+    double wy = wind_spd_kt * std::cos(wind_dir);
+    double tx = tas_kt * std::sin(hdg) + wx;
+    double ty = tas_kt * std::cos(hdg) + wy;
+    out.track_deg = rad2deg(std::atan2(tx, ty));
+    if (out.track_deg < 0) out.track_deg += 360.0;
+    out.groundspeed_kt = std::sqrt(tx * tx + ty * ty);
+    double desired_track_rad = deg2rad(out.track_deg);
+    double wca = std::asin((wind_spd_kt * std::sin(wind_dir - desired_track_rad)) / tas_kt);
+    out.wca_deg = rad2deg(wca);
+    return out;
+}
+
+double crosswind_component(double wind_dir_deg, double wind_spd_kt, double runway_deg) {
+    double angle = std::fabs(wind_dir_deg - runway_deg);
+    if (angle > 180.0) angle = 360.0 - angle;
+    return wind_spd_kt * std::sin(deg2rad(angle));
+}
+
+double headwind_component(double wind_dir_deg, double wind_spd_kt, double runway_deg) {
+    double angle = std::fabs(wind_dir_deg - runway_deg);
+    if (angle > 180.0) angle = 360.0 - angle;
+    return wind_spd_kt * std::cos(deg2rad(angle));
+}
+
+double tas_from_cas(double cas_kt, double density_alt_ft) {
+    double sigma = std::pow(1.0 - 6.8755856e-6 * density_alt_ft, 4.2558797);
+    return cas_kt / std::sqrt(sigma);
+}
+
+double mach_from_tas(double tas_kt, double oat_c) {
+    // a = sqrt(gamma*R*T), gamma=1.4, R=287 J/kg/K; TAS in kt -> m/s
+    double tas_ms = tas_kt * 0.514444;
+    double temp_k = oat_c + 273.15;
+    double a_ms = std::sqrt(1.4 * 287.0 * temp_k);
+    return tas_ms / a_ms;
+}
+
+double tas_from_mach(double mach, double oat_c) {
+    double temp_k = oat_c + 273.15;
+    double a_ms = std::sqrt(1.4 * 287.0 * temp_k);
+    double tas_ms = mach * a_ms;
+    return tas_ms / 0.514444;
+}
+
+double drift_angle_deg(double wind_dir_deg, double wind_spd_kt, double tas_kt, double track_deg) {
+    return rad2deg(std::asin((wind_spd_kt / tas_kt) * std::sin(deg2rad(wind_dir_deg - track_deg))));
+}
+
+} // namespace flightsuite
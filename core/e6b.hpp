@@ -0,0 +1,35 @@
+// E6B flight computer kernels (wind triangle, components, altitudes, Mach/TAS).
+#pragma once
+
+namespace flightsuite {
+
+struct WindTriangle {
+    double groundspeed_kt = 0.0;
+    double track_deg = 0.0;
+    double wca_deg = 0.0;
+};
+
+// Basic wind triangle: ground speed and track from heading, true airspeed, wind direction/speed.
+WindTriangle wind_triangle(double hdg_deg, double tas_kt, double wind_dir_deg, double wind_spd_kt);
+
+double crosswind_component(double wind_dir_deg, double wind_spd_kt, double runway_deg);
+double headwind_component(double wind_dir_deg, double wind_spd_kt, double runway_deg);
+
+// Inline so batch loops over observation columns (core/density) vectorize.
+inline double pressure_altitude_ft(double field_elev_ft, double altimeter_inhg) {
+    return field_elev_ft + (29.92 - altimeter_inhg) * 1000.0;
+}
+// Simple approximation: DA = PA + 120 * (OAT - ISA)
+inline double density_altitude_ft(double pressure_alt_ft, double oat_c) {
+    double isa_temp_c = 15.0 - (pressure_alt_ft / 1000.0) * 2.0;
+    return pressure_alt_ft + 120.0 * (oat_c - isa_temp_c);
+}
+
+// TAS from calibrated airspeed at a density altitude (ISA troposphere density ratio).
+double tas_from_cas(double cas_kt, double density_alt_ft);
+double mach_from_tas(double tas_kt, double oat_c);
+double tas_from_mach(double mach, double oat_c);
+
+double drift_angle_deg(double wind_dir_deg, double wind_spd_kt, double tas_kt, double track_deg);
+
+} // namespace flightsuite
@@ -0,0 +1,453 @@
+#include "core/e6b_session.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "core/e6b.hpp"
+#include "core/geo.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr size_t kMaxStack = 64;
+constexpr int kMaxNesting = 64; // parentheses, unary minus, and ^ chains; bounds the parser's recursion
+
+struct Function {
+    const char* name;
+    size_t argc;
+    double (*fn)(const double*);
+    const char* args;
+};
+
+// Signed crosswind, positive from the right of `course_deg`.
+double cross_from_right(double course_deg, double wind_dir_deg, double wind_kt) {
+    return wind_kt * std::sin(deg2rad(wind_dir_deg - course_deg));
+}
+
+const Function kFunctions[] = {
+    {"pa", 2, [](const double* a) { return pressure_altitude_ft(a[0], a[1]); }, "field_elev_ft, altimeter_inhg"},
+    {"da", 2, [](const double* a) { return density_altitude_ft(a[0], a[1]); }, "pressure_alt_ft, oat_c"},
+    {"isa", 1, [](const double* a) { return 15.0 - a[0] / 1000.0 * 2.0; }, "pressure_alt_ft"},
+    {"tas", 2, [](const double* a) { return tas_from_cas(a[0], a[1]); }, "cas_kt, density_alt_ft"},
+    {"mach", 2, [](const double* a) { return mach_from_tas(a[0], a[1]); }, "tas_kt, oat_c"},
+    {"tas_mach", 2, [](const double* a) { return tas_from_mach(a[0], a[1]); }, "mach, oat_c"},
+    {"gs", 4,
+     [](const double* a) {
+         double cross = crosswind_component(a[2], a[3], a[1]);
+         if (cross >= a[0]) return std::nan("");
+         return std::sqrt(a[0] * a[0] - cross * cross) - headwind_component(a[2], a[3], a[1]);
+     },
+     "tas_kt, course_deg, wind_dir_deg, wind_kt"},
+    {"hdg", 4,
+     [](const double* a) {
+         double wca = rad2deg(std::asin(cross_from_right(a[1], a[2], a[3]) / a[0]));
+         return std::fmod(a[1] + wca + 360.0, 360.0);
+     },
+     "tas_kt, course_deg, wind_dir_deg, wind_kt"},
+    {"xwind", 3, [](const double* a) { return crosswind_component(a[0], a[1], a[2]); }, "wind_dir_deg, wind_kt, runway_deg"},
+    {"headwind", 3, [](const double* a) { return headwind_component(a[0], a[1], a[2]); }, "wind_dir_deg, wind_kt, runway_deg"},
+    {"drift", 4, [](const double* a) { return drift_angle_deg(a[0], a[1], a[2], a[3]); }, "wind_dir_deg, wind_kt, tas_kt, track_deg"},
+    {"time", 2, [](const double* a) { return a[0] / a[1] * 60.0; }, "distance_nm, groundspeed_kt (minutes)"},
+    {"fuel", 2, [](const double* a) { return a[0] * a[1]; }, "flow_per_hr, time_hr"},
+    {"sqrt", 1, [](const double* a) { return std::sqrt(a[0]); }, "x"},
+    {"abs", 1, [](const double* a) { return std::fabs(a[0]); }, "x"},
+    {"round", 1, [](const double* a) { return std::round(a[0]); }, "x"},
+    {"min", 2, [](const double* a) { return std::min(a[0], a[1]); }, "a, b"},
+    {"max", 2, [](const double* a) { return std::max(a[0], a[1]); }, "a, b"},
+};
+
+const Function* find_function(const std::string& name) {
+    for (const auto& f : kFunctions) {
+        if (name == f.name) return &f;
+    }
+    return nullptr;
+}
+
+bool ident_start(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+bool ident_char(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+} // namespace
+
+// Recursive descent straight to postfix: + - * / ^ (right-assoc), unary minus, parentheses,
+// numbers, variables, and calls into kFunctions.
+class E6bSession::Parser {
+public:
+    Parser(E6bSession& session, const std::string& text) : session_(session), s_(text) {}
+
+    bool parse(std::vector<Instr>& code, std::string* error) {
+        code_ = &code;
+        bool ok = expr();
+        skip_ws();
+        if (ok && pos_ < s_.size()) ok = fail("unexpected '" + std::string(1, s_[pos_]) + "'");
+        if (!ok && error) *error = error_;
+        return ok;
+    }
+
+private:
+    void skip_ws() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+    }
+    bool fail(const std::string& message) {
+        if (error_.empty()) error_ = message;
+        return false;
+    }
+    bool emit(Instr in, int stack_delta) {
+        code_->push_back(in);
+        depth_ += stack_delta;
+        if (depth_ > static_cast<int>(kMaxStack)) return fail("expression too deep");
+        return true;
+    }
+    bool binary(bool (Parser::*operand)(), const char* ops, const Op* codes) {
+        if (!(this->*operand)()) return false;
+        for (;;) {
+            skip_ws();
+            if (pos_ >= s_.size()) return true;
+            const char* hit = std::char_traits<char>::find(ops, std::char_traits<char>::length(ops), s_[pos_]);
+            if (!hit) return true;
+            ++pos_;
+            if (!(this->*operand)() || !emit({codes[hit - ops]}, -1)) return false;
+        }
+    }
+    bool expr() {
+        static const Op codes[] = {Op::kAdd, Op::kSub};
+        return binary(&Parser::term, "+-", codes);
+    }
+    bool term() {
+        static const Op codes[] = {Op::kMul, Op::kDiv};
+        return binary(&Parser::unary, "*/", codes);
+    }
+    bool unary() {
+        if (++nesting_ > kMaxNesting) return fail("expression nested too deeply");
+        bool ok = unary_operand();
+        --nesting_;
+        return ok;
+    }
+    bool unary_operand() {
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == '-') {
+            ++pos_;
+            return unary() && emit({Op::kNeg}, 0);
+        }
+        if (!primary()) return false;
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == '^') {
+            ++pos_;
+            return unary() && emit({Op::kPow}, -1);
+        }
+        return true;
+    }
+    bool primary() {
+        skip_ws();
+        if (pos_ >= s_.size()) return fail("expression ends early");
+        char c = s_[pos_];
+        if (c == '(') {
+            ++pos_;
+            if (!expr()) return false;
+            skip_ws();
+            if (pos_ >= s_.size() || s_[pos_] != ')') return fail("missing ')'");
+            ++pos_;
+            return true;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            char* end = nullptr;
+            double v = std::strtod(s_.c_str() + pos_, &end);
+            if (end == s_.c_str() + pos_) return fail("bad number");
+            pos_ = static_cast<size_t>(end - s_.c_str());
+            return emit({Op::kConst, 0, v}, 1);
+        }
+        if (!ident_start(c)) return fail("unexpected '" + std::string(1, c) + "'");
+        size_t start = pos_;
+        while (pos_ < s_.size() && ident_char(s_[pos_])) ++pos_;
+        std::string name = s_.substr(start, pos_ - start);
+        skip_ws();
+        if (pos_ >= s_.size() || s_[pos_] != '(') return emit({Op::kVar, session_.intern(name)}, 1);
+
+        const Function* fn = find_function(name);
+        if (!fn) return fail("unknown function " + name + "()");
+        ++pos_;
+        size_t argc = 0;
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == ')') {
+            ++pos_;
+        } else {
+            for (;;) {
+                if (!expr()) return false;
+                ++argc;
+                skip_ws();
+                if (pos_ < s_.size() && s_[pos_] == ',') {
+                    ++pos_;
+                    continue;
+                }
+                if (pos_ < s_.size() && s_[pos_] == ')') {
+                    ++pos_;
+                    break;
+                }
+                return fail("missing ')' after arguments to " + name + "()");
+            }
+        }
+        if (argc != fn->argc) {
+            return fail(name + "() takes " + std::to_string(fn->argc) + " arguments (" + fn->args + ")");
+        }
+        return emit({Op::kCall, static_cast<uint32_t>(fn - kFunctions)}, 1 - static_cast<int>(argc));
+    }
+
+    E6bSession& session_;
+    const std::string& s_;
+    size_t pos_ = 0;
+    std::vector<Instr>* code_ = nullptr;
+    int depth_ = 0;
+    int nesting_ = 0;
+    std::string error_;
+};
+
+const char* E6bSession::help() {
+    static const std::string text = [] {
+        std::string t = "name = expr binds a formula (rebinding recomputes only what depends on it); a bare\n"
+                        "expression prints its value. Operators + - * / ^ and parentheses. Commands: vars, stats,\n"
+                        "clear, help. Functions:\n";
+        for (const auto& f : kFunctions) t += std::string("  ") + f.name + "(" + f.args + ")\n";
+        return t;
+    }();
+    return text.c_str();
+}
+
+uint32_t E6bSession::intern(const std::string& name) {
+    auto [it, added] = by_name_.emplace(name, static_cast<uint32_t>(vars_.size()));
+    if (added) {
+        vars_.emplace_back();
+        vars_.back().name = name;
+    }
+    return it->second;
+}
+
+// Depth-first over deps from an explicit stack. Each walk stamps the variables it visits, so shared
+// sub-chains are walked once and nothing is allocated or cleared per call.
+bool E6bSession::reaches(uint32_t from, uint32_t target) {
+    ++walk_;
+    work_.assign(1, from);
+    vars_[from].seen = walk_;
+    while (!work_.empty()) {
+        uint32_t v = work_.back();
+        work_.pop_back();
+        if (v == target) return true;
+        for (uint32_t d : vars_[v].deps) {
+            if (vars_[d].seen != walk_) {
+                vars_[d].seen = walk_;
+                work_.push_back(d);
+            }
+        }
+    }
+    return false;
+}
+
+void E6bSession::invalidate(uint32_t v) {
+    vars_[v].valid = false;
+    work_.assign(1, v);
+    while (!work_.empty()) {
+        uint32_t u = work_.back();
+        work_.pop_back();
+        for (uint32_t d : vars_[u].dependents) {
+            if (vars_[d].valid) {
+                vars_[d].valid = false;
+                work_.push_back(d);
+            }
+        }
+    }
+}
+
+bool E6bSession::define(uint32_t v, std::vector<Instr> code, std::string source, std::string* error) {
+    Var& var = vars_[v];
+    if (code == var.code) return true; // same formula: every cached value downstream still holds
+    std::vector<uint32_t> deps;
+    for (const auto& in : code) {
+        if (in.op == Op::kVar && std::find(deps.begin(), deps.end(), in.index) == deps.end()) deps.push_back(in.index);
+    }
+    for (uint32_t d : deps) {
+        // Only a variable something already depends on can close a cycle.
+        if (d == v || (!var.dependents.empty() && reaches(d, v))) {
+            if (error) *error = var.name + " would depend on itself through " + vars_[d].name;
+            return false;
+        }
+    }
+    for (uint32_t d : var.deps) {
+        auto& list = vars_[d].dependents;
+        list.erase(std::remove(list.begin(), list.end(), v), list.end());
+    }
+    for (uint32_t d : deps) vars_[d].dependents.push_back(v);
+    var.deps = std::move(deps);
+    var.code = std::move(code);
+    var.source = std::move(source);
+    invalidate(v);
+    return true;
+}
+
+bool E6bSession::run(const std::vector<Instr>& code, double& out, std::string* error) {
+    double stack[kMaxStack];
+    size_t sp = 0;
+    for (const auto& in : code) {
+        switch (in.op) {
+        case Op::kConst: stack[sp++] = in.value; break;
+        case Op::kVar:
+            if (!eval_var(in.index, stack[sp], error)) return false;
+            ++sp;
+            break;
+        case Op::kNeg: stack[sp - 1] = -stack[sp - 1]; break;
+        case Op::kAdd: --sp, stack[sp - 1] += stack[sp]; break;
+        case Op::kSub: --sp, stack[sp - 1] -= stack[sp]; break;
+        case Op::kMul: --sp, stack[sp - 1] *= stack[sp]; break;
+        case Op::kDiv: --sp, stack[sp - 1] /= stack[sp]; break;
+        case Op::kPow: --sp, stack[sp - 1] = std::pow(stack[sp - 1], stack[sp]); break;
+        case Op::kCall: {
+            const Function& fn = kFunctions[in.index];
+            sp -= fn.argc;
+            stack[sp] = fn.fn(stack + sp);
+            ++sp;
+            break;
+        }
+        }
+    }
+    out = stack[0];
+    return true;
+}
+
+// A dirty variable is computed bottom-up from an explicit stack: it stays on the stack until every
+// dep is valid, so chains of any length evaluate without recursing. Reads of variables computed in
+// this pass are not counted as cache hits.
+bool E6bSession::eval_var(uint32_t v, double& out, std::string* error) {
+    Var& var = vars_[v];
+    if (var.valid) {
+        if (var.pass != pass_) ++cache_hits_;
+        out = var.value;
+        return true;
+    }
+    ++pass_;
+    work_.assign(1, v);
+    while (!work_.empty()) {
+        uint32_t u = work_.back();
+        if (vars_[u].valid) {
+            work_.pop_back();
+            continue;
+        }
+        if (vars_[u].code.empty()) {
+            if (error) *error = vars_[u].name + " is not defined";
+            return false;
+        }
+        size_t pending = work_.size();
+        for (uint32_t d : vars_[u].deps) {
+            if (!vars_[d].valid) work_.push_back(d);
+        }
+        if (work_.size() != pending) continue;
+        work_.pop_back();
+        ++evaluations_;
+        double value = 0.0;
+        if (!run(vars_[u].code, value, error)) return false; // deps are valid: no recursion
+        vars_[u].value = value;
+        vars_[u].valid = true;
+        vars_[u].pass = pass_;
+    }
+    out = vars_[v].value;
+    return true;
+}
+
+void E6bSession::set(const std::string& name, double value) {
+    uint32_t v = intern(name);
+    define(v, {{Op::kConst, 0, value}}, std::string(), nullptr); // `vars` shows constants by value
+}
+
+std::optional<double> E6bSession::get(const std::string& name, std::string* error) {
+    auto it = by_name_.find(name);
+    if (it == by_name_.end()) {
+        if (error) *error = name + " is not defined";
+        return std::nullopt;
+    }
+    double out = 0.0;
+    ++pass_; // a fresh read: values computed earlier count as cache hits
+    if (!eval_var(it->second, out, error)) return std::nullopt;
+    return out;
+}
+
+bool E6bSession::run_line(const std::string& raw, std::string& out, bool echo, std::string* error) {
+    out.clear();
+    std::string line = trim(raw.substr(0, raw.find('#')));
+    if (line.empty()) return true;
+    if (line == "help") {
+        out = help();
+        return true;
+    }
+    if (line == "stats") {
+        size_t defined = std::count_if(vars_.begin(), vars_.end(), [](const Var& v) { return !v.code.empty(); });
+        out = std::to_string(defined) + " variables, " + std::to_string(evaluations_) + " formulas evaluated, " +
+              std::to_string(cache_hits_) + " cached reads\n";
+        return true;
+    }
+    if (line == "clear") {
+        vars_.clear();
+        by_name_.clear();
+        return true;
+    }
+    if (line == "vars") {
+        for (uint32_t v = 0; v < vars_.size(); ++v) {
+            if (vars_[v].code.empty()) continue;
+            std::string err;
+            auto value = get(vars_[v].name, &err);
+            out += vars_[v].name + " = " + (value ? format_double(*value, 2) : "error: " + err);
+            if (vars_[v].code.size() > 1) out += "   (" + vars_[v].source + ")";
+            out += "\n";
+        }
+        return true;
+    }
+
+    // "name = expr" (but not "name == ...", which is no statement at all)
+    size_t pos = 0;
+    while (pos < line.size() && ident_char(line[pos])) ++pos;
+    size_t eq = line.find_first_not_of(" \t", pos);
+    if (pos > 0 && ident_start(line[0]) && eq != std::string::npos && line[eq] == '=' &&
+        (eq + 1 >= line.size() || line[eq + 1] != '=')) {
+        std::string name = line.substr(0, pos);
+        std::string source = trim(line.substr(eq + 1));
+        std::vector<Instr> code;
+        if (!Parser(*this, source).parse(code, error)) return false;
+        if (!define(intern(name), std::move(code), source, error)) return false;
+        if (echo) {
+            auto value = get(name, error);
+            if (!value) return false;
+            out = name + " = " + format_double(*value, 2) + "\n";
+        }
+        return true;
+    }
+
+    TraceSpan span("e6b_expression", "e6b");
+    std::vector<Instr> code;
+    double value = 0.0;
+    ++pass_;
+    if (!Parser(*this, line).parse(code, error) || !run(code, value, error)) return false;
+    out = line + " = " + format_double(value, 2) + "\n";
+    return true;
+}
+
+bool E6bSession::run_script(const std::string& text, std::ostream& out, std::string* error) {
+    TraceSpan span("e6b_script", "e6b");
+    size_t start = 0, number = 0;
+    std::string printed;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        ++number;
+        std::string err;
+        if (!run_line(text.substr(start, end - start), printed, false, &err)) {
+            if (error) *error = "line " + std::to_string(number) + ": " + err;
+            return false;
+        }
+        out << printed;
+        start = end + 1;
+    }
+    return true;
+}
+
+} // namespace flightsuite
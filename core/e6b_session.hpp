@@ -0,0 +1,73 @@
+// E6B worksheet session: named variables bound to expressions over the E6B kernels, evaluated
+// lazily and cached. Redefining a variable invalidates only what depends on it, so a planning
+// worksheet (density altitude -> TAS -> groundspeed -> time -> fuel) recomputes the changed chain
+// and reuses everything else. Shared by `e6b session` and the launcher's E6B menu.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flightsuite {
+
+class E6bSession {
+public:
+    // One statement: "name = expr" binds (or rebinds) a formula, a bare expression is evaluated, and
+    // "vars", "stats", "help", and "clear" are commands; '#' starts a comment. Anything to print
+    // goes to `out` (assignments only when `echo` is set). Returns false with *error set.
+    bool run_line(const std::string& line, std::string& out, bool echo, std::string* error = nullptr);
+    // Every line of a worksheet, printing bare expressions; stops at the first error, which names
+    // its line.
+    bool run_script(const std::string& text, std::ostream& out, std::string* error = nullptr);
+
+    // Binds `name` to a constant; a no-op (dependents keep their cached values) if it already is one.
+    void set(const std::string& name, double value);
+    std::optional<double> get(const std::string& name, std::string* error = nullptr);
+
+    size_t evaluations() const { return evaluations_; } // formulas run
+    size_t cache_hits() const { return cache_hits_; }   // variable reads served from cache
+
+    static const char* help();
+
+private:
+    enum class Op : uint8_t { kConst, kVar, kNeg, kAdd, kSub, kMul, kDiv, kPow, kCall };
+    struct Instr {
+        Op op = Op::kConst;
+        uint32_t index = 0; // variable or function
+        double value = 0.0;
+        bool operator==(const Instr& o) const { return op == o.op && index == o.index && value == o.value; }
+    };
+    struct Var {
+        std::string name;
+        std::string source;       // formula text as written
+        std::vector<Instr> code;  // postfix; empty = undefined
+        std::vector<uint32_t> deps;
+        std::vector<uint32_t> dependents;
+        double value = 0.0;
+        bool valid = false;
+        uint64_t seen = 0; // reaches() walk that last visited this variable
+        uint64_t pass = 0; // eval_var() pass that last computed it
+    };
+    class Parser;
+
+    uint32_t intern(const std::string& name);
+    bool define(uint32_t v, std::vector<Instr> code, std::string source, std::string* error);
+    void invalidate(uint32_t v);
+    bool reaches(uint32_t from, uint32_t target);
+    bool eval_var(uint32_t v, double& out, std::string* error);
+    bool run(const std::vector<Instr>& code, double& out, std::string* error);
+
+    std::vector<Var> vars_;
+    std::unordered_map<std::string, uint32_t> by_name_;
+    size_t evaluations_ = 0;
+    size_t cache_hits_ = 0;
+    uint64_t walk_ = 0;
+    uint64_t pass_ = 0;
+    std::vector<uint32_t> work_; // explicit stack for reaches(), invalidate(), and eval_var()
+};
+
+} // namespace flightsuite
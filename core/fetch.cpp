@@ -0,0 +1,362 @@
+#include "core/fetch.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "core/alloc_stats.hpp"
+#include "core/cassette.hpp"
+#include "core/compress.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kLatencySamples = 32; // per host, most recent successes
+constexpr size_t kMinSamplesForP95 = 8;
+
+struct HostLatency {
+    double ms[kLatencySamples] = {};
+    size_t count = 0;
+};
+
+std::mutex g_mu; // guards everything below
+FetchPolicy g_policy;
+bool g_has_deadline = false;
+Clock::time_point g_deadline;
+std::unordered_map<std::string, std::vector<std::string>> g_mirrors;
+std::unordered_map<std::string, HostLatency> g_latency;
+
+double ms_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// "https://host:port/path" -> "https://host:port"; latencies are tracked per origin.
+std::string origin_of(const std::string& url) {
+    size_t scheme = url.find("://");
+    size_t slash = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+    return url.substr(0, slash);
+}
+
+void record_latency(const std::string& url, double ms) {
+    std::lock_guard<std::mutex> lock(g_mu);
+    HostLatency& h = g_latency[origin_of(url)];
+    h.ms[h.count++ % kLatencySamples] = ms;
+}
+
+double hedge_delay_ms(const std::string& url, const FetchPolicy& policy, double timeout_ms) {
+    double delay = policy.hedge_initial_ms;
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        auto it = g_latency.find(origin_of(url));
+        if (it != g_latency.end() && it->second.count >= kMinSamplesForP95) {
+            size_t n = std::min(it->second.count, kLatencySamples);
+            std::vector<double> v(it->second.ms, it->second.ms + n);
+            size_t k = (n * 95 + 99) / 100 - 1;
+            std::nth_element(v.begin(), v.begin() + k, v.end());
+            delay = v[k];
+        }
+    }
+    return std::min(std::max(delay, static_cast<double>(policy.hedge_min_ms)), timeout_ms);
+}
+
+// Milliseconds left before the briefing deadline (infinity when there is none).
+double remaining_budget_ms(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(g_mu);
+    if (!g_has_deadline) return std::numeric_limits<double>::infinity();
+    return std::max(0.0, ms_between(now, g_deadline));
+}
+
+// One curl child writing the body into a non-blocking pipe.
+struct Attempt {
+    std::string url;
+    pid_t pid = -1;
+    int fd = -1;
+    Clock::time_point start;
+    std::string body;
+    std::unique_ptr<TraceSpan> span;
+};
+
+bool spawn(Attempt& a, double timeout_ms) {
+    char max_time[32];
+    std::snprintf(max_time, sizeof(max_time), "%.3f", timeout_ms / 1000.0);
+    // argv is built before fork: the child only calls async-signal-safe functions.
+    const char* args[] = {"curl", "-s", "-f", "--compressed", "--max-time", max_time, a.url.c_str(), nullptr};
+    // Close-on-exec from the start, so no other child (a hedged sibling, or one forked on another
+    // thread between pipe and fork) inherits the pipe; an inherited write end would hold it open
+    // past our curl's exit.
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return false;
+    a.span = std::make_unique<TraceSpan>("fetch_attempt", "fetch", a.url);
+    a.start = Clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // The copy dup2 makes is inheritable; if the write end already is stdout there is no copy,
+        // so clear its flag instead. Both pipe fds close on exec.
+        if (fds[1] == STDOUT_FILENO) {
+            fcntl(fds[1], F_SETFD, 0);
+        } else {
+            dup2(fds[1], STDOUT_FILENO);
+        }
+        execvp("curl", const_cast<char* const*>(args));
+        _exit(127);
+    }
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    a.pid = pid;
+    a.fd = fds[0];
+    return true;
+}
+
+// Closes the pipe and reaps the child (killing it first if asked); true if curl exited 0.
+bool finish(Attempt& a, bool kill_it) {
+    if (a.pid < 0) return false;
+    if (kill_it) kill(a.pid, SIGKILL);
+    close(a.fd);
+    int status = 0;
+    while (waitpid(a.pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    a.pid = -1;
+    a.fd = -1;
+    a.span.reset();
+    return !kill_it && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+std::optional<std::string> fetch_live(const std::vector<std::string>& urls, const FetchPolicy& policy,
+                                      double timeout_ms) {
+    Clock::time_point begin = Clock::now();
+    double budget_ms = remaining_budget_ms(begin);
+    if (budget_ms <= 0) return std::nullopt;
+    Clock::time_point deadline = begin + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double, std::milli>(
+                                                 std::min(budget_ms, 1e9)));
+    double hedge_ms = hedge_delay_ms(urls.front(), policy, timeout_ms);
+
+    std::vector<Attempt> attempts(urls.size());
+    size_t launched = 0;
+    Clock::time_point next_launch = begin;
+    std::optional<std::string> winner;
+    char buf[16384];
+
+    auto launch_next = [&](Clock::time_point now) {
+        while (launched < urls.size()) {
+            Attempt& a = attempts[launched++];
+            a.url = urls[launched - 1];
+            if (spawn(a, timeout_ms)) break;
+            cassette_record(a.url, std::nullopt, 0.0);
+        }
+        next_launch = policy.hedge ? now + std::chrono::duration_cast<Clock::duration>(
+                                               std::chrono::duration<double, std::milli>(hedge_ms))
+                                   : Clock::time_point::max();
+    };
+    launch_next(begin);
+
+    while (!winner) {
+        Clock::time_point now = Clock::now();
+        std::vector<pollfd> pfds;
+        std::vector<Attempt*> live;
+        Clock::time_point wake = std::min(deadline, launched < urls.size() ? next_launch : deadline);
+        for (auto& a : attempts) {
+            if (a.pid < 0) continue;
+            Clock::time_point source_deadline =
+                a.start + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double, std::milli>(timeout_ms));
+            if (now >= source_deadline) {
+                finish(a, true);
+                cassette_record(a.url, std::nullopt, timeout_ms);
+                next_launch = now; // fail over to the next mirror right away
+                continue;
+            }
+            wake = std::min(wake, source_deadline);
+            pfds.push_back({a.fd, POLLIN, 0});
+            live.push_back(&a);
+        }
+        if (now >= deadline) break;
+        if (launched < urls.size() && (now >= next_launch || live.empty())) {
+            launch_next(now);
+            continue;
+        }
+        if (live.empty()) break;
+
+        int wait_ms = static_cast<int>(std::ceil(std::max(0.0, ms_between(now, wake))));
+        int rc = poll(pfds.data(), pfds.size(), wait_ms);
+        if (rc < 0 && errno != EINTR) break;
+        for (size_t i = 0; i < pfds.size() && !winner; ++i) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Attempt& a = *live[i];
+            ssize_t n;
+            while ((n = read(a.fd, buf, sizeof(buf))) > 0) a.body.append(buf, static_cast<size_t>(n));
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            // EOF: curl is done with this source.
+            double elapsed = ms_between(a.start, Clock::now());
+            bool ok = finish(a, false) && !a.body.empty();
+            if (ok) {
+                record_latency(a.url, elapsed);
+                cassette_record(a.url, a.body, elapsed);
+                winner = std::move(a.body);
+            } else {
+                cassette_record(a.url, std::nullopt, elapsed);
+                next_launch = Clock::now(); // fail over to the next mirror right away
+            }
+        }
+    }
+    for (auto& a : attempts) {
+        if (a.pid >= 0) finish(a, true); // cancel the losers
+    }
+    return winner;
+}
+
+// Replays the same race against the cassette: each URL answers after its replay latency (or never,
+// if it is missing or failed), mirrors start at the hedge delay, and the call sleeps until the
+// winner would have answered.
+std::optional<std::string> fetch_replay(const std::vector<std::string>& urls, const FetchPolicy& policy,
+                                        double timeout_ms) {
+    constexpr double kNever = std::numeric_limits<double>::infinity();
+    double budget_ms = remaining_budget_ms(Clock::now());
+    double hedge_ms = hedge_delay_ms(urls.front(), policy, timeout_ms);
+    double launch = 0.0, best = kNever;
+    std::optional<CassetteEntry> best_entry;
+    size_t best_idx = 0;
+    for (size_t i = 0; i < urls.size() && launch < best && launch < budget_ms; ++i) {
+        auto entry = cassette_replay(urls[i]);
+        double latency = entry ? cassette_latency_ms(*entry) : kNever;
+        bool ok = entry && entry->ok && !entry->body.empty() && latency <= timeout_ms;
+        double done = launch + std::min(latency, timeout_ms);
+        if (ok && done < best) {
+            best = done;
+            best_entry = std::move(entry);
+            best_idx = i;
+        }
+        double next = policy.hedge ? launch + hedge_ms : kNever;
+        if (!ok) next = std::min(next, done);
+        launch = next;
+    }
+    double wait = std::min(best, std::min(budget_ms, timeout_ms * static_cast<double>(urls.size())));
+    if (wait > 0 && wait < kNever) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(wait));
+    if (!best_entry || best > budget_ms) return std::nullopt;
+    record_latency(urls[best_idx], cassette_latency_ms(*best_entry));
+    return std::move(best_entry->body);
+}
+
+} // namespace
+
+void set_fetch_policy(const FetchPolicy& policy) {
+    std::lock_guard<std::mutex> lock(g_mu);
+    g_policy = policy;
+}
+
+FetchPolicy fetch_policy() {
+    std::lock_guard<std::mutex> lock(g_mu);
+    return g_policy;
+}
+
+void start_fetch_deadline() {
+    std::lock_guard<std::mutex> lock(g_mu);
+    g_has_deadline = g_policy.overall_deadline_ms > 0;
+    g_deadline = Clock::now() + std::chrono::milliseconds(g_policy.overall_deadline_ms);
+}
+
+std::optional<std::string> fetch_url(const std::string& url, int max_time_s) {
+    return fetch_first({url}, max_time_s);
+}
+
+std::optional<std::string> fetch_first(const std::vector<std::string>& urls, int max_time_s) {
+    if (urls.empty()) return std::nullopt;
+    AllocStageScope stage(AllocStage::kFetch);
+    TraceSpan span("fetch_url", "fetch", urls.front());
+    FetchPolicy policy = fetch_policy();
+    double timeout_ms = policy.source_timeout_ms > 0 ? policy.source_timeout_ms : max_time_s * 1000.0;
+    auto body = cassette_mode() == CassetteMode::kReplay ? fetch_replay(urls, policy, timeout_ms)
+                                                         : fetch_live(urls, policy, timeout_ms);
+    // curl undoes HTTP content encodings; archives served as .gz/.zst files still arrive compressed.
+    if (body) body = decompress_buffer(std::move(*body));
+    return body;
+}
+
+void add_fetch_mirror(const std::string& source, const std::string& url_template) {
+    std::lock_guard<std::mutex> lock(g_mu);
+    g_mirrors[source].push_back(url_template);
+}
+
+std::vector<std::string> fetch_source_urls(const std::string& source, const std::string& primary_template,
+                                           const std::string& icao) {
+    std::vector<std::string> templates{primary_template};
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        auto it = g_mirrors.find(source);
+        if (it != g_mirrors.end()) templates.insert(templates.end(), it->second.begin(), it->second.end());
+    }
+    std::vector<std::string> urls;
+    for (auto& t : templates) {
+        size_t pos;
+        while ((pos = t.find("{ICAO}")) != std::string::npos) t.replace(pos, 6, icao);
+        urls.push_back(std::move(t));
+    }
+    return urls;
+}
+
+bool init_fetch_policy(int& argc, char** argv) {
+    FetchPolicy policy = fetch_policy();
+    bool ok = true;
+    auto parse_ms = [&](const char* flag, const char* value, int& out) {
+        auto v = parse_double(value);
+        if (!v || *v < 0) {
+            std::cerr << flag << " expects milliseconds, got: " << value << "\n";
+            ok = false;
+            return;
+        }
+        out = static_cast<int>(*v);
+    };
+    int w = 1;
+    for (int r = 1; r < argc; ++r) {
+        if (std::strcmp(argv[r], "--deadline") == 0 && r + 1 < argc) {
+            parse_ms("--deadline", argv[++r], policy.overall_deadline_ms);
+        } else if (std::strcmp(argv[r], "--source-timeout") == 0 && r + 1 < argc) {
+            parse_ms("--source-timeout", argv[++r], policy.source_timeout_ms);
+        } else if (std::strcmp(argv[r], "--no-hedge") == 0) {
+            policy.hedge = false;
+        } else if (std::strcmp(argv[r], "--mirror") == 0 && r + 1 < argc) {
+            std::string spec = argv[++r];
+            size_t eq = spec.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "--mirror expects SOURCE=URL_TEMPLATE, got: " << spec << "\n";
+                ok = false;
+            } else {
+                add_fetch_mirror(spec.substr(0, eq), spec.substr(eq + 1));
+            }
+        } else {
+            argv[w++] = argv[r];
+        }
+    }
+    argc = w;
+    argv[argc] = nullptr;
+    set_fetch_policy(policy);
+    start_fetch_deadline();
+    return ok;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,46 @@
+// HTTP(S) fetch through the system `curl` binary, or from a record/replay cassette (core/cassette).
+//
+// Every fetch runs under a FetchPolicy: a per-source timeout, an optional overall deadline shared
+// by all fetches of one briefing, and hedging across mirrors. fetch_first() starts the first source
+// and, if it has not answered after the hedge delay (the p95 of that host's recent latencies),
+// starts the next one; the first good response wins and the other requests are killed.
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flightsuite {
+
+struct FetchPolicy {
+    int source_timeout_ms = 0;     // per request; 0 = the caller's max_time_s
+    int overall_deadline_ms = 0;   // for every fetch after start_fetch_deadline(); 0 = none
+    bool hedge = true;             // false: try mirrors only after the previous source fails
+    int hedge_initial_ms = 1000;   // hedge delay until a host has enough latency samples
+    int hedge_min_ms = 50;
+};
+
+void set_fetch_policy(const FetchPolicy& policy);
+FetchPolicy fetch_policy();
+
+// Starts the overall deadline clock (the briefing's budget) now.
+void start_fetch_deadline();
+
+// Returns the response body, or nullopt on failure/empty body. Compressed bodies (gzip, zstd) are
+// decoded.
+std::optional<std::string> fetch_url(const std::string& url, int max_time_s = 5);
+
+// Races `urls` (primary first) under the current policy; `max_time_s` caps the per-source timeout.
+std::optional<std::string> fetch_first(const std::vector<std::string>& urls, int max_time_s = 5);
+
+// Mirrors for a named source ("metar", "notam"): URL templates in which `{ICAO}` is replaced.
+void add_fetch_mirror(const std::string& source, const std::string& url_template);
+// The primary template followed by the source's mirrors, expanded for `icao`.
+std::vector<std::string> fetch_source_urls(const std::string& source, const std::string& primary_template,
+                                           const std::string& icao);
+
+// Removes `--deadline MS`, `--source-timeout MS`, `--no-hedge` and `--mirror SOURCE=TEMPLATE` from
+// argv and applies them (starting the deadline clock). Returns false after printing a bad value.
+bool init_fetch_policy(int& argc, char** argv);
+
+} // namespace flightsuite
@@ -0,0 +1,228 @@
+#include "core/fuel_stops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+// Airports a flood from either end may settle before the search proper takes over.
+constexpr size_t kFloodBudget = 64;
+
+} // namespace
+
+FuelStopPlanner::FuelStopPlanner(const std::vector<Airport>& airports, int min_runway_ft) {
+    std::vector<GeoPoint> points;
+    for (const auto& a : airports) {
+        if (a.longest_runway_ft < min_runway_ft) continue;
+        stops_.push_back(&a);
+        points.push_back({a.lat, a.lon});
+    }
+    index_ = SpatialIndex(points, true);
+    settled_ = SpatialMask(index_);
+    // Two extra slots: the departure (source) and destination (target).
+    size_t n = stops_.size() + 2;
+    g_.resize(n);
+    nm_.resize(n);
+    parent_.assign(n, kNone);
+    stamp_.assign(n, 0);
+    closed_.assign(n, 0);
+    remaining_nm_.resize(n);
+    remaining_stamp_.assign(n, 0);
+    band_.resize(n);
+    key_.resize(n);
+    slot_.assign(n, kNone);
+}
+
+uint32_t FuelStopPlanner::next_query() {
+    if (++query_ == 0) { // stamps wrapped: start over
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        std::fill(closed_.begin(), closed_.end(), 0);
+        std::fill(remaining_stamp_.begin(), remaining_stamp_.end(), 0);
+        query_ = 1;
+    }
+    return query_;
+}
+
+void FuelStopPlanner::open_push(uint32_t v, Cost key) {
+    key_[v] = key;
+    size_t i = slot_[v];
+    if (i == kNone) {
+        i = open_.size();
+        open_.push_back(v);
+    }
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!(key < key_[open_[parent]])) break;
+        open_[i] = open_[parent];
+        slot_[open_[i]] = static_cast<uint32_t>(i);
+        i = parent;
+    }
+    open_[i] = v;
+    slot_[v] = static_cast<uint32_t>(i);
+}
+
+uint32_t FuelStopPlanner::open_pop() {
+    uint32_t top = open_.front();
+    slot_[top] = kNone;
+    uint32_t last = open_.back();
+    open_.pop_back();
+    if (open_.empty()) return top;
+    const Cost key = key_[last];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= open_.size()) break;
+        if (child + 1 < open_.size() && key_[open_[child + 1]] < key_[open_[child]]) ++child;
+        if (!(key_[open_[child]] < key)) break;
+        open_[i] = open_[child];
+        slot_[open_[i]] = static_cast<uint32_t>(i);
+        i = child;
+    }
+    open_[i] = last;
+    slot_[last] = static_cast<uint32_t>(i);
+    return top;
+}
+
+bool FuelStopPlanner::cut_off(const Airport& at, const Airport& other, double max_leg_nm) {
+    uint32_t q = next_query();
+    std::vector<GeoPoint> frontier{{at.lat, at.lon}};
+    size_t settled = 0;
+    while (!frontier.empty()) {
+        GeoPoint p = frontier.back();
+        frontier.pop_back();
+        if (haversine_nm(p.lat, p.lon, other.lat, other.lon) <= max_leg_nm) return false;
+        ++settled;
+        index_.within_unordered(p.lat, p.lon, max_leg_nm, hits_);
+        for (const auto& h : hits_) {
+            if (closed_[h.id] == q) continue;
+            closed_[h.id] = q;
+            frontier.push_back({stops_[h.id]->lat, stops_[h.id]->lon});
+        }
+        // Everything found must be settled before the flood can run out, so stop as soon as that
+        // would take more than the budget.
+        if (settled + frontier.size() > kFloodBudget) return false;
+    }
+    return true;
+}
+
+FuelStopPlan FuelStopPlanner::plan(const Airport& from, const Airport& to, double max_leg_nm, FuelStopGoal goal) {
+    TraceSpan span("fuel_stop_plan", "routes", [&] { return from.icao + "-" + to.icao; });
+    FuelStopPlan out;
+    if (max_leg_nm <= 0.0) return out;
+    // An island (or a continent the legs cannot leave) would otherwise be proven unreachable by
+    // exhausting everything reachable from the other end.
+    if (cut_off(to, from, max_leg_nm) || cut_off(from, to, max_leg_nm)) return out;
+    next_query();
+    settled_.reset();
+    const uint32_t source = static_cast<uint32_t>(stops_.size());
+    const uint32_t target = source + 1;
+    const bool fewest = goal == FuelStopGoal::kFewestStops;
+
+    auto point = [&](uint32_t v) {
+        return v == source ? GeoPoint{from.lat, from.lon} : GeoPoint{stops_[v]->lat, stops_[v]->lon};
+    };
+    // Great-circle distance left to the destination, computed once per airport per query.
+    auto remaining = [&](uint32_t v) {
+        if (remaining_stamp_[v] != query_) {
+            GeoPoint p = point(v);
+            remaining_stamp_[v] = query_;
+            remaining_nm_[v] = haversine_nm(p.lat, p.lon, to.lat, to.lon);
+        }
+        return remaining_nm_[v];
+    };
+    // Consistent for both goals: a leg shortens the remaining distance by at most its own length,
+    // and the remaining legs by at most one.
+    auto heuristic = [&](uint32_t v) {
+        double nm = remaining(v);
+        double legs = std::ceil(nm / max_leg_nm);
+        return fewest ? Cost{legs, nm} : Cost{nm, legs};
+    };
+    auto cost = [&](const Cost& g, double leg_nm) {
+        return fewest ? Cost{g.first + 1.0, g.second + leg_nm} : Cost{g.first + leg_nm, g.second + 1.0};
+    };
+
+    auto relax = [&](uint32_t v, Cost g, double nm, uint32_t parent, Cost h) {
+        stamp_[v] = query_;
+        g_[v] = g;
+        nm_[v] = nm;
+        parent_[v] = parent;
+        open_push(v, {g.first + h.first, g.second + h.second});
+    };
+
+    // For fewest stops a successor of u costs one of three leg counts, by how many legs its own
+    // remaining distance rounds up to: one fewer than u's, the same, or one more. u's successors are
+    // generated a band at a time (partial expansion), each band once the search reaches its leg
+    // count, so an expansion usually reads only the thin lens of u's reach that lies a leg closer
+    // to the destination. The shortest-distance goal reads every successor at once.
+    const uint8_t bands = fewest ? 3 : 1;
+    auto band_legs = [&](uint32_t u, uint8_t band) {
+        return g_[u].first + std::ceil(remaining(u) / max_leg_nm) + band;
+    };
+    auto expand = [&](uint32_t u, uint8_t band) {
+        GeoPoint p = point(u);
+        double direct = remaining(u);
+        if (band == 0 && direct <= max_leg_nm) {
+            Cost g = cost(g_[u], direct);
+            if (stamp_[target] != query_ || g < g_[target]) relax(target, g, nm_[u] + direct, u, Cost{});
+        }
+        // Successors whose remaining distance rounds up to the band's leg count, plus slack for
+        // rounding between the two distance formulas; re-reading earlier bands is harmless. The last
+        // band is the whole globe. Settled airports are masked out of the walk.
+        double radius = kPi * kEarthRadiusNm;
+        if (fewest && band < bands - 1) radius = max_leg_nm * (std::ceil(direct / max_leg_nm) - 1.0 + band) + 1e-6;
+        if (radius < 0.0) return;
+        index_.within_both_unordered(p.lat, p.lon, max_leg_nm, to.lat, to.lon, radius, hits_, &settled_);
+        for (const auto& h : hits_) {
+            // Most hits are already reached at least as cheaply; check before any trigonometry.
+            Cost g = cost(g_[u], h.distance_nm);
+            if (stamp_[h.id] == query_ && !(g < g_[h.id])) continue;
+            const Airport* a = stops_[h.id];
+            if (a->icao == from.icao || a->icao == to.icao) continue;
+            relax(h.id, g, nm_[u] + h.distance_nm, u, heuristic(h.id));
+        }
+    };
+
+    relax(source, Cost{}, 0.0, kNone, heuristic(source));
+    while (!open_.empty()) {
+        uint32_t u = open_pop();
+        if (u == target) break;
+        if (closed_[u] != query_) {
+            closed_[u] = query_;
+            band_[u] = 0;
+            if (u != source) {
+                settled_.remove(u);
+                ++out.expanded;
+            }
+        }
+        // Settled airports come back only for their next band, keyed by its leg count and a lower
+        // bound on the distance of anything in it.
+        expand(u, band_[u]++);
+        if (band_[u] < bands) open_push(u, {band_legs(u, band_[u]), g_[u].second + remaining(u)});
+    }
+    for (uint32_t v : open_) slot_[v] = kNone;
+    open_.clear();
+    if (stamp_[target] != query_) return out;
+
+    out.found = true;
+    out.distance_nm = nm_[target];
+    out.stops.push_back(&to);
+    for (uint32_t v = parent_[target]; v != source; v = parent_[v]) out.stops.push_back(stops_[v]);
+    out.stops.push_back(&from);
+    std::reverse(out.stops.begin(), out.stops.end());
+    for (size_t i = 1; i < out.stops.size(); ++i) {
+        const Airport* a = out.stops[i - 1];
+        const Airport* b = out.stops[i];
+        out.longest_leg_nm = std::max(out.longest_leg_nm, haversine_nm(a->lat, a->lon, b->lat, b->lon));
+    }
+    return out;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,76 @@
+// Fuel-stop planning for trips beyond an aircraft's range: a best-first search over the implicit
+// graph of runway-qualified airports no more than one leg apart, with neighbours read from a
+// spatial index instead of a stored edge list. Plans either the fewest stops (ties broken by
+// distance) or the shortest total distance; both use a great-circle heuristic, and fewest-stops
+// searches read each airport's neighbours a band at a time, only as far as the search needs.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/spatial.hpp"
+
+namespace flightsuite {
+
+enum class FuelStopGoal { kFewestStops, kShortestDistance };
+
+struct FuelStopPlan {
+    bool found = false;
+    std::vector<const Airport*> stops; // departure, fuel stops, destination
+    double distance_nm = 0.0;
+    double longest_leg_nm = 0.0;
+    size_t expanded = 0; // airports settled by the search
+};
+
+// Reusable across queries (search arrays are stamped, not cleared); one per thread. Keeps
+// pointers into `airports`, which must outlive the planner.
+class FuelStopPlanner {
+public:
+    // Only airports with a runway of at least `min_runway_ft` can be fuel stops.
+    FuelStopPlanner(const std::vector<Airport>& airports, int min_runway_ft);
+
+    size_t qualified() const { return stops_.size(); }
+
+    // Departure and destination need not be runway-qualified themselves. A direct leg of up to
+    // `max_leg_nm` is a plan with no stops.
+    FuelStopPlan plan(const Airport& from, const Airport& to, double max_leg_nm,
+                      FuelStopGoal goal = FuelStopGoal::kFewestStops);
+
+private:
+    // Search cost, compared lexicographically: (legs, nm) for fewest stops, (nm, legs) otherwise.
+    struct Cost {
+        double first = 0.0;
+        double second = 0.0;
+        bool operator<(const Cost& o) const { return first < o.first || (first == o.first && second < o.second); }
+    };
+
+    uint32_t next_query();
+    // The open set: a binary heap of airports keyed by g + h. Pushing an airport already in it
+    // lowers its key in place.
+    void open_push(uint32_t v, Cost key);
+    uint32_t open_pop();
+    // True when a small flood from `at` runs out of airports without coming within a leg of `other`.
+    bool cut_off(const Airport& at, const Airport& other, double max_leg_nm);
+
+    std::vector<const Airport*> stops_;
+    SpatialIndex index_;
+    SpatialMask settled_;
+
+    std::vector<Cost> g_;
+    std::vector<double> nm_;       // distance flown to reach each airport
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> stamp_;  // g_/nm_/parent_ are valid for this query when stamp_ == query_
+    std::vector<uint32_t> closed_; // == query_ once settled
+    std::vector<double> remaining_nm_; // great-circle distance to the destination
+    std::vector<uint32_t> remaining_stamp_;
+    std::vector<uint8_t> band_;    // successor bands generated, once settled
+    std::vector<uint32_t> open_;
+    std::vector<Cost> key_;        // open_ key of each airport in it
+    std::vector<uint32_t> slot_;   // position in open_, or none
+    uint32_t query_ = 0;
+    std::vector<SpatialHit> hits_;
+};
+
+} // namespace flightsuite
@@ -0,0 +1,24 @@
+#include "core/geo.hpp"
+
+#include <cmath>
+
+namespace flightsuite {
+
+double haversine_nm(double lat1, double lon1, double lat2, double lon2) {
+    double dlat = deg2rad(lat2 - lat1);
+    double dlon = deg2rad(lon2 - lon1);
+    double a = std::sin(dlat / 2) * std::sin(dlat / 2) +
+               std::cos(deg2rad(lat1)) * std::cos(deg2rad(lat2)) * std::sin(dlon / 2) *
+                   std::sin(dlon / 2);
+    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+    return kEarthRadiusNm * c;
+}
+
+double initial_course_deg(double lat1, double lon1, double lat2, double lon2) {
+    double p1 = deg2rad(lat1), p2 = deg2rad(lat2), dl = deg2rad(lon2 - lon1);
+    double y = std::sin(dl) * std::cos(p2);
+    double x = std::cos(p1) * std::sin(p2) - std::sin(p1) * std::cos(p2) * std::cos(dl);
+    return std::fmod(rad2deg(std::atan2(y, x)) + 360.0, 360.0);
+}
+
+} // namespace flightsuite
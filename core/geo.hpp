@@ -0,0 +1,16 @@
+// Angle conversions, great-circle distance and course.
+#pragma once
+
+namespace flightsuite {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kEarthRadiusNm = 3440.065;
+
+inline double deg2rad(double d) { return d * kPi / 180.0; }
+inline double rad2deg(double r) { return r * 180.0 / kPi; }
+
+double haversine_nm(double lat1, double lon1, double lat2, double lon2);
+// True course (0-360) at the start of the great circle from point 1 to point 2.
+double initial_course_deg(double lat1, double lon1, double lat2, double lon2);
+
+} // namespace flightsuite
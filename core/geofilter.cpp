@@ -0,0 +1,404 @@
+#include "core/geofilter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+
+#include "core/geo.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+bool parse_numbers(const std::string& spec, size_t n, double* out) {
+    const char* p = spec.c_str();
+    for (size_t i = 0; i < n; ++i) {
+        char* end = nullptr;
+        out[i] = std::strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        if (i + 1 < n) {
+            if (*p != ',') return false;
+            ++p;
+        }
+    }
+    return *p == '\0';
+}
+
+// Just enough JSON for GeoJSON: a plain value tree. \u escapes decode to '?' since only the
+// ASCII "type" names matter here.
+struct JsonValue {
+    enum class Kind { kNull, kBool, kNumber, kString, kArray, kObject };
+    Kind kind = Kind::kNull;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> fields;
+
+    const JsonValue* get(const std::string& key) const {
+        for (const auto& [k, v] : fields) {
+            if (k == key) return &v;
+        }
+        return nullptr;
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& s) : s_(s) {}
+
+    bool parse(JsonValue& out) {
+        if (!value(out, 0)) return false;
+        skip_ws();
+        return pos_ == s_.size();
+    }
+    size_t pos() const { return pos_; }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skip_ws() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+    }
+    bool literal(const char* word) {
+        size_t n = std::char_traits<char>::length(word);
+        if (s_.compare(pos_, n, word) != 0) return false;
+        pos_ += n;
+        return true;
+    }
+    bool string(std::string& out) {
+        if (s_[pos_] != '"') return false;
+        for (++pos_; pos_ < s_.size(); ++pos_) {
+            char c = s_[pos_];
+            if (c == '"') {
+                ++pos_;
+                return true;
+            }
+            if (c == '\\') {
+                if (++pos_ >= s_.size()) return false;
+                if (s_[pos_] == 'u') {
+                    pos_ += 4;
+                    c = '?';
+                } else {
+                    c = s_[pos_] == 'n' ? '\n' : s_[pos_] == 't' ? '\t' : s_[pos_];
+                }
+            }
+            out += c;
+        }
+        return false;
+    }
+    bool value(JsonValue& out, int depth) {
+        skip_ws();
+        if (pos_ >= s_.size() || depth > kMaxDepth) return false;
+        char c = s_[pos_];
+        if (c == '{') {
+            out.kind = JsonValue::Kind::kObject;
+            ++pos_;
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == '}') return ++pos_, true;
+            for (;;) {
+                skip_ws();
+                std::string key;
+                if (pos_ >= s_.size() || !string(key)) return false;
+                skip_ws();
+                if (pos_ >= s_.size() || s_[pos_++] != ':') return false;
+                out.fields.emplace_back(std::move(key), JsonValue{});
+                if (!value(out.fields.back().second, depth + 1)) return false;
+                skip_ws();
+                if (pos_ >= s_.size()) return false;
+                if (s_[pos_] == '}') return ++pos_, true;
+                if (s_[pos_++] != ',') return false;
+            }
+        }
+        if (c == '[') {
+            out.kind = JsonValue::Kind::kArray;
+            ++pos_;
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == ']') return ++pos_, true;
+            for (;;) {
+                out.items.emplace_back();
+                if (!value(out.items.back(), depth + 1)) return false;
+                skip_ws();
+                if (pos_ >= s_.size()) return false;
+                if (s_[pos_] == ']') return ++pos_, true;
+                if (s_[pos_++] != ',') return false;
+            }
+        }
+        if (c == '"') {
+            out.kind = JsonValue::Kind::kString;
+            return string(out.text);
+        }
+        if (literal("true") || literal("false")) {
+            out.kind = JsonValue::Kind::kBool;
+            return true;
+        }
+        if (literal("null")) return true;
+        char* end = nullptr;
+        out.number = std::strtod(s_.c_str() + pos_, &end);
+        if (end == s_.c_str() + pos_) return false;
+        out.kind = JsonValue::Kind::kNumber;
+        pos_ = static_cast<size_t>(end - s_.c_str());
+        return true;
+    }
+
+    const std::string& s_;
+    size_t pos_ = 0;
+};
+
+bool ring_from(const JsonValue& coords, std::vector<GeoPoint>& ring) {
+    if (coords.kind != JsonValue::Kind::kArray) return false;
+    for (const auto& pos : coords.items) {
+        if (pos.kind != JsonValue::Kind::kArray || pos.items.size() < 2) return false;
+        ring.push_back({pos.items[1].number, pos.items[0].number}); // GeoJSON is [lon, lat]
+    }
+    return true;
+}
+
+bool polygon_from(const JsonValue& coords, std::vector<std::vector<GeoPoint>>& rings) {
+    if (coords.kind != JsonValue::Kind::kArray) return false;
+    for (const auto& r : coords.items) {
+        rings.emplace_back();
+        if (!ring_from(r, rings.back())) return false;
+    }
+    return true;
+}
+
+bool collect_rings(const JsonValue& v, std::vector<std::vector<GeoPoint>>& rings) {
+    if (v.kind != JsonValue::Kind::kObject) return false;
+    const JsonValue* type = v.get("type");
+    if (!type || type->kind != JsonValue::Kind::kString) return false;
+    const std::string& t = type->text;
+    if (t == "Polygon" || t == "MultiPolygon") {
+        const JsonValue* coords = v.get("coordinates");
+        if (!coords || coords->kind != JsonValue::Kind::kArray) return false;
+        if (t == "Polygon") return polygon_from(*coords, rings);
+        for (const auto& poly : coords->items) {
+            if (!polygon_from(poly, rings)) return false;
+        }
+        return true;
+    }
+    const char* list = t == "FeatureCollection" ? "features" : t == "GeometryCollection" ? "geometries" : nullptr;
+    if (list) {
+        const JsonValue* items = v.get(list);
+        if (!items || items->kind != JsonValue::Kind::kArray) return false;
+        for (const auto& item : items->items) {
+            if (!collect_rings(item, rings)) return false;
+        }
+        return true;
+    }
+    if (t == "Feature") {
+        const JsonValue* geometry = v.get("geometry");
+        return !geometry || geometry->kind == JsonValue::Kind::kNull || collect_rings(*geometry, rings);
+    }
+    return true; // points and lines carry no area
+}
+
+// Sign of the turn a -> b -> c.
+double orient(double ax, double ay, double bx, double by, double cx, double cy) {
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+} // namespace
+
+bool parse_bbox(const std::string& spec, BoundingBox& out) {
+    double v[4];
+    if (!parse_numbers(spec, 4, v)) return false;
+    if (std::fabs(v[0]) > 90.0 || std::fabs(v[2]) > 90.0 || std::fabs(v[1]) > 180.0 || std::fabs(v[3]) > 180.0) {
+        return false;
+    }
+    out.lat_min = std::min(v[0], v[2]);
+    out.lat_max = std::max(v[0], v[2]);
+    out.lon_min = v[1];
+    out.lon_max = v[3];
+    return true;
+}
+
+bool parse_radius(const std::string& spec, GeoPoint& center, double& radius_nm) {
+    double v[3];
+    if (!parse_numbers(spec, 3, v) || std::fabs(v[0]) > 90.0 || std::fabs(v[1]) > 180.0 || v[2] <= 0.0) return false;
+    center = {v[0], v[1]};
+    radius_nm = v[2];
+    return true;
+}
+
+PreparedPolygon::PreparedPolygon(const std::vector<std::vector<GeoPoint>>& rings) {
+    TraceSpan span("prepare_polygon", "geofilter");
+    bounds_ = {90.0, 180.0, -90.0, -180.0};
+    for (const auto& ring : rings) {
+        if (ring.size() < 3) continue;
+        for (size_t i = 0; i < ring.size(); ++i) {
+            const GeoPoint& a = ring[i];
+            const GeoPoint& b = ring[(i + 1) % ring.size()];
+            if (a.lat == b.lat && a.lon == b.lon) continue; // includes the closing repeat
+            edges_.push_back({a.lon, a.lat, b.lon, b.lat});
+            bounds_.lat_min = std::min(bounds_.lat_min, a.lat);
+            bounds_.lat_max = std::max(bounds_.lat_max, a.lat);
+            bounds_.lon_min = std::min(bounds_.lon_min, a.lon);
+            bounds_.lon_max = std::max(bounds_.lon_max, a.lon);
+        }
+    }
+    if (edges_.empty()) return;
+
+    // About one cell per edge, shaped like the bounding box, so a cell holds O(1) edges on average.
+    double w = std::max(bounds_.lon_max - bounds_.lon_min, 1e-9);
+    double h = std::max(bounds_.lat_max - bounds_.lat_min, 1e-9);
+    double e = static_cast<double>(edges_.size());
+    nx_ = static_cast<size_t>(std::clamp(std::round(std::sqrt(e * w / h)), 1.0, 2048.0));
+    ny_ = static_cast<size_t>(std::clamp(std::ceil(e / static_cast<double>(nx_)), 1.0, 2048.0));
+    cell_w_ = w / static_cast<double>(nx_);
+    cell_h_ = h / static_cast<double>(ny_);
+
+    // Cells each edge passes through: per column strip, the rows its clipped piece spans.
+    std::vector<std::pair<uint32_t, uint32_t>> hits; // (cell, edge)
+    for (uint32_t i = 0; i < edges_.size(); ++i) {
+        const Edge& ed = edges_[i];
+        size_t c0 = cell_x(std::min(ed.x1, ed.x2)), c1 = cell_x(std::max(ed.x1, ed.x2));
+        for (size_t c = c0; c <= c1; ++c) {
+            double y_lo = std::min(ed.y1, ed.y2), y_hi = std::max(ed.y1, ed.y2);
+            if (ed.x1 != ed.x2) {
+                double left = std::max(std::min(ed.x1, ed.x2), bounds_.lon_min + static_cast<double>(c) * cell_w_);
+                double right = std::min(std::max(ed.x1, ed.x2), bounds_.lon_min + static_cast<double>(c + 1) * cell_w_);
+                double ya = ed.y1 + (left - ed.x1) * (ed.y2 - ed.y1) / (ed.x2 - ed.x1);
+                double yb = ed.y1 + (right - ed.x1) * (ed.y2 - ed.y1) / (ed.x2 - ed.x1);
+                y_lo = std::max(y_lo, std::min(ya, yb));
+                y_hi = std::min(y_hi, std::max(ya, yb));
+            }
+            for (size_t r = cell_y(y_lo), r1 = cell_y(y_hi); r <= r1; ++r) {
+                hits.emplace_back(static_cast<uint32_t>(r * nx_ + c), i);
+            }
+        }
+    }
+    cell_start_.assign(nx_ * ny_ + 1, 0);
+    for (const auto& [cell, edge] : hits) ++cell_start_[cell + 1];
+    for (size_t c = 0; c < nx_ * ny_; ++c) cell_start_[c + 1] += cell_start_[c];
+    cell_edges_.resize(hits.size());
+    std::vector<uint32_t> fill(cell_start_.begin(), cell_start_.end() - 1);
+    for (const auto& [cell, edge] : hits) cell_edges_[fill[cell]++] = edge;
+
+    // Cell centres, one horizontal scanline per row: crossings to the left of a centre decide it.
+    centre_inside_.assign(nx_ * ny_, 0);
+    std::vector<double> xs;
+    for (size_t r = 0; r < ny_; ++r) {
+        double y = bounds_.lat_min + (static_cast<double>(r) + 0.5) * cell_h_;
+        xs.clear();
+        for (const Edge& ed : edges_) {
+            if ((ed.y1 > y) != (ed.y2 > y)) xs.push_back(ed.x1 + (y - ed.y1) * (ed.x2 - ed.x1) / (ed.y2 - ed.y1));
+        }
+        std::sort(xs.begin(), xs.end());
+        size_t left = 0;
+        for (size_t c = 0; c < nx_; ++c) {
+            double x = bounds_.lon_min + (static_cast<double>(c) + 0.5) * cell_w_;
+            while (left < xs.size() && xs[left] < x) ++left;
+            centre_inside_[r * nx_ + c] = left & 1;
+        }
+    }
+}
+
+size_t PreparedPolygon::cell_x(double lon) const {
+    double c = std::floor((lon - bounds_.lon_min) / cell_w_);
+    return static_cast<size_t>(std::clamp(c, 0.0, static_cast<double>(nx_ - 1)));
+}
+
+size_t PreparedPolygon::cell_y(double lat) const {
+    double r = std::floor((lat - bounds_.lat_min) / cell_h_);
+    return static_cast<size_t>(std::clamp(r, 0.0, static_cast<double>(ny_ - 1)));
+}
+
+bool PreparedPolygon::contains(double lat, double lon) const {
+    if (edges_.empty() || lat < bounds_.lat_min || lat > bounds_.lat_max || lon < bounds_.lon_min ||
+        lon > bounds_.lon_max) {
+        return false;
+    }
+    size_t cx = cell_x(lon), cy = cell_y(lat), cell = cy * nx_ + cx;
+    bool inside = centre_inside_[cell];
+    // Walk from the centre to the point; each edge of this cell it crosses flips the answer.
+    double ox = bounds_.lon_min + (static_cast<double>(cx) + 0.5) * cell_w_;
+    double oy = bounds_.lat_min + (static_cast<double>(cy) + 0.5) * cell_h_;
+    for (uint32_t k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+        const Edge& e = edges_[cell_edges_[k]];
+        bool a = orient(e.x1, e.y1, e.x2, e.y2, ox, oy) > 0.0;
+        bool b = orient(e.x1, e.y1, e.x2, e.y2, lon, lat) > 0.0;
+        if (a == b) continue;
+        bool c = orient(ox, oy, lon, lat, e.x1, e.y1) > 0.0;
+        bool d = orient(ox, oy, lon, lat, e.x2, e.y2) > 0.0;
+        if (c != d) inside = !inside;
+    }
+    return inside;
+}
+
+bool load_geojson_polygon(const std::string& path, PreparedPolygon& out, std::string* error) {
+    TraceSpan span("load_geojson", "geofilter", path);
+    auto text = read_file(path);
+    if (!text) {
+        if (error) *error = "cannot read " + path;
+        return false;
+    }
+    JsonValue root;
+    JsonReader reader(*text);
+    if (!reader.parse(root)) {
+        if (error) *error = "malformed JSON near byte " + std::to_string(reader.pos());
+        return false;
+    }
+    std::vector<std::vector<GeoPoint>> rings;
+    if (!collect_rings(root, rings)) {
+        if (error) *error = "not a GeoJSON geometry, feature, or collection";
+        return false;
+    }
+    PreparedPolygon polygon(rings);
+    if (polygon.empty()) {
+        if (error) *error = "no polygon rings in " + path;
+        return false;
+    }
+    out = std::move(polygon);
+    return true;
+}
+
+void GeoFilter::set_radius(GeoPoint center, double radius_nm) {
+    radius_ = Radius{center, radius_nm, radius_nm / 60.0};
+}
+
+bool GeoFilter::contains(const Airport& a) const {
+    if (!region_.empty() && a.country != region_ && a.region != region_) return false;
+    if (bbox_ && !bbox_->contains(a.lat, a.lon)) return false;
+    if (radius_) {
+        if (std::fabs(a.lat - radius_->center.lat) > radius_->lat_margin) return false;
+        if (haversine_nm(radius_->center.lat, radius_->center.lon, a.lat, a.lon) > radius_->nm) return false;
+    }
+    return polygon_.empty() || polygon_.contains(a.lat, a.lon);
+}
+
+std::vector<uint8_t> GeoFilter::mask(const std::vector<Airport>& airports) const {
+    TraceSpan span("geofilter_mask", "geofilter", [&] { return std::to_string(airports.size()) + " airports"; });
+    std::vector<uint8_t> out(airports.size(), 1);
+    if (empty()) return out;
+    for (size_t i = 0; i < airports.size(); ++i) out[i] = contains(airports[i]);
+    return out;
+}
+
+std::string GeoFilter::describe() const {
+    std::ostringstream out;
+    const char* sep = "";
+    if (!region_.empty()) {
+        out << region_;
+        sep = ", ";
+    }
+    if (bbox_) {
+        out << sep << "in " << format_double(bbox_->lat_min, 2) << "," << format_double(bbox_->lon_min, 2) << " to "
+            << format_double(bbox_->lat_max, 2) << "," << format_double(bbox_->lon_max, 2);
+        sep = ", ";
+    }
+    if (radius_) {
+        out << sep << "within " << format_double(radius_->nm, 0) << " nm of " << format_double(radius_->center.lat, 2)
+            << "," << format_double(radius_->center.lon, 2);
+        sep = ", ";
+    }
+    if (!polygon_.empty()) out << sep << "in polygon (" << polygon_.edge_count() << " edges)";
+    return out.str();
+}
+
+} // namespace flightsuite
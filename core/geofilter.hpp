@@ -0,0 +1,101 @@
+// Geographic filters for airport catalogs: a country/region code (the CSV columns), a bounding
+// box, a radius around a point, and GeoJSON polygons. Polygons are prepared once: their edges
+// are bucketed on a grid whose cells also record whether their centre is inside, so a test only
+// looks at the few edges in the point's own cell.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/spatial.hpp"
+
+namespace flightsuite {
+
+struct BoundingBox {
+    double lat_min = -90.0;
+    double lon_min = -180.0;
+    double lat_max = 90.0;
+    double lon_max = 180.0; // lon_max < lon_min spans the antimeridian
+
+    bool contains(double lat, double lon) const {
+        if (lat < lat_min || lat > lat_max) return false;
+        return lon_min <= lon_max ? lon >= lon_min && lon <= lon_max : lon >= lon_min || lon <= lon_max;
+    }
+};
+
+// "LAT1,LON1,LAT2,LON2": latitudes in either order, LON1 is the west edge (LON1 > LON2 spans the
+// antimeridian).
+bool parse_bbox(const std::string& spec, BoundingBox& out);
+// "LAT,LON,NM".
+bool parse_radius(const std::string& spec, GeoPoint& center, double& radius_nm);
+
+class PreparedPolygon {
+public:
+    PreparedPolygon() = default;
+    // Rings as lat/lon points, closed or not. Inside means inside an odd number of rings, so
+    // holes and multipolygon parts need no tagging. Edges are straight in lat/lon, and rings
+    // must not cross the antimeridian.
+    explicit PreparedPolygon(const std::vector<std::vector<GeoPoint>>& rings);
+
+    bool empty() const { return edges_.empty(); }
+    size_t edge_count() const { return edges_.size(); }
+    size_t cell_count() const { return nx_ * ny_; }
+    const BoundingBox& bounds() const { return bounds_; }
+
+    bool contains(double lat, double lon) const;
+
+private:
+    struct Edge {
+        double x1, y1, x2, y2; // lon, lat
+    };
+
+    size_t cell_x(double lon) const;
+    size_t cell_y(double lat) const;
+
+    std::vector<Edge> edges_;
+    BoundingBox bounds_;
+    size_t nx_ = 0, ny_ = 0;
+    double cell_w_ = 0.0, cell_h_ = 0.0;
+    std::vector<uint32_t> cell_start_; // CSR: edges of cell c are cell_edges_[cell_start_[c], cell_start_[c+1])
+    std::vector<uint32_t> cell_edges_;
+    std::vector<uint8_t> centre_inside_;
+};
+
+// Polygon, MultiPolygon, Feature, FeatureCollection, or GeometryCollection; every polygon ring
+// found is used. Reads gzip/zstd transparently.
+bool load_geojson_polygon(const std::string& path, PreparedPolygon& out, std::string* error = nullptr);
+
+// All criteria that are set must hold.
+class GeoFilter {
+public:
+    void set_region(const std::string& code) { region_ = code; }
+    void set_bbox(const BoundingBox& box) { bbox_ = box; }
+    void set_radius(GeoPoint center, double radius_nm);
+    void set_polygon(PreparedPolygon polygon) { polygon_ = std::move(polygon); }
+
+    bool empty() const { return region_.empty() && !bbox_ && !radius_ && polygon_.empty(); }
+    bool contains(const Airport& a) const;
+    // One byte per airport, for filtering the same catalog many times.
+    std::vector<uint8_t> mask(const std::vector<Airport>& airports) const;
+    // "US-WA, within 200 nm of 47.45,-122.31", for headers.
+    std::string describe() const;
+
+private:
+    struct Radius {
+        GeoPoint center;
+        double nm = 0.0;
+        double lat_margin = 0.0; // degrees; cheap reject before the great circle
+    };
+
+    std::string region_;
+    std::optional<BoundingBox> bbox_;
+    std::optional<Radius> radius_;
+    PreparedPolygon polygon_;
+};
+
+} // namespace flightsuite
@@ -0,0 +1,144 @@
+#include "core/grid.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#include "core/alloc_stats.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+size_t GridSpec::rows() const {
+    if (step_deg <= 0 || lat_max < lat_min) return 0;
+    return static_cast<size_t>(std::floor((lat_max - lat_min) / step_deg + 1e-9)) + 1;
+}
+
+size_t GridSpec::cols() const {
+    if (step_deg <= 0 || lon_max < lon_min) return 0;
+    return static_cast<size_t>(std::floor((lon_max - lon_min) / step_deg + 1e-9)) + 1;
+}
+
+GridField idw_grid(const SpatialIndex& index, const std::vector<double>& values, const GridSpec& spec,
+                   const IdwOptions& opt) {
+    TraceSpan span("idw_grid", "grid");
+    GridField grid;
+    grid.spec = spec;
+    const size_t rows = spec.rows(), cols = spec.cols();
+    grid.values.assign(rows * cols, std::numeric_limits<float>::quiet_NaN());
+    if (rows == 0 || cols == 0 || index.size() == 0) return grid;
+
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, rows));
+    std::atomic<size_t> next_row{0};
+    auto worker = [&](unsigned n) {
+        AllocStageScope stage(AllocStage::kAnalyze);
+        if (threads > 1) trace_set_thread_name("grid worker " + std::to_string(n));
+        std::vector<GeoPoint> queries(cols);
+        std::vector<std::vector<SpatialHit>> hits;
+        // Rows are handed out one at a time so uneven station density still balances.
+        for (size_t r; (r = next_row.fetch_add(1, std::memory_order_relaxed)) < rows;) {
+            double lat = spec.lat_of(r);
+            for (size_t c = 0; c < cols; ++c) queries[c] = {lat, spec.lon_of(c)};
+            index.nearest_batch(queries, opt.k, opt.max_nm, hits);
+            float* row = grid.values.data() + r * cols;
+            for (size_t c = 0; c < cols; ++c) {
+                const auto& h = hits[c];
+                if (h.empty()) continue;
+                if (h[0].distance_nm < 0.5) { // on top of a station: take its value
+                    row[c] = static_cast<float>(values[h[0].id]);
+                    continue;
+                }
+                double wsum = 0.0, vsum = 0.0;
+                for (const auto& hit : h) {
+                    double w = 1.0 / std::pow(hit.distance_nm, opt.power);
+                    wsum += w;
+                    vsum += w * values[hit.id];
+                }
+                row[c] = static_cast<float>(vsum / wsum);
+            }
+        }
+    };
+    if (threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+        for (auto& t : pool) t.join();
+    }
+    return grid;
+}
+
+void render_grid_map(std::ostream& out, const GridField& grid, double low, double high, size_t max_width,
+                     bool unicode) {
+    static const char* const kUnicode[] = {"█", "▓", "▒", "░", " "};
+    static const char* const kAscii[] = {"@", "#", "+", ".", " "};
+    const char* const* shades = unicode ? kUnicode : kAscii;
+    constexpr int kLevels = 5;
+    const size_t rows = grid.spec.rows(), cols = grid.spec.cols();
+    if (rows == 0 || cols == 0) return;
+    // Terminal cells are about twice as tall as wide, so each cell spans two grid rows per column.
+    size_t bw = std::max<size_t>(1, (cols + std::max<size_t>(max_width, 1) - 1) / std::max<size_t>(max_width, 1));
+    size_t bh = bw * 2;
+    for (size_t r0 = 0; r0 < rows; r0 += bh) {
+        for (size_t c0 = 0; c0 < cols; c0 += bw) {
+            double sum = 0.0;
+            size_t n = 0;
+            for (size_t r = r0; r < std::min(rows, r0 + bh); ++r) {
+                for (size_t c = c0; c < std::min(cols, c0 + bw); ++c) {
+                    float v = grid.values[r * cols + c];
+                    if (std::isnan(v)) continue;
+                    sum += v;
+                    ++n;
+                }
+            }
+            if (n == 0) {
+                out << '?';
+                continue;
+            }
+            double t = (sum / static_cast<double>(n) - low) / (high - low);
+            int level = static_cast<int>(std::clamp(t, 0.0, 1.0) * (kLevels - 1) + 0.5);
+            out << shades[level];
+        }
+        out << '\n';
+    }
+}
+
+bool write_grid_binary(const std::string& path, const GridField& grid) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    auto put = [&out](const void* p, size_t n) { out.write(static_cast<const char*>(p), static_cast<std::streamsize>(n)); };
+    // Fixed little-endian layout; the byte swaps compile away on the platforms we build for.
+    auto put_u32 = [&put](uint32_t v) {
+        unsigned char b[4] = {static_cast<unsigned char>(v), static_cast<unsigned char>(v >> 8),
+                              static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 24)};
+        put(b, 4);
+    };
+    auto put_u64 = [&put_u32](uint64_t v) {
+        put_u32(static_cast<uint32_t>(v));
+        put_u32(static_cast<uint32_t>(v >> 32));
+    };
+    auto put_f64 = [&put_u64](double d) {
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        put_u64(bits);
+    };
+    put("FSGRID1\0", 8);
+    put_u32(static_cast<uint32_t>(grid.spec.rows()));
+    put_u32(static_cast<uint32_t>(grid.spec.cols()));
+    put_f64(grid.spec.lat_max);
+    put_f64(grid.spec.lon_min);
+    put_f64(grid.spec.step_deg);
+    for (float f : grid.values) {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        put_u32(bits);
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace flightsuite
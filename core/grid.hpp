@@ -0,0 +1,55 @@
+// Gridded analysis of station observations: inverse-distance weighting over the k nearest stations
+// (via core/spatial) onto a regular lat/lon grid, computed in parallel across rows, with a text
+// heat-map renderer and a compact binary export.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "core/spatial.hpp"
+
+namespace flightsuite {
+
+struct GridSpec {
+    double lat_min = 24.0;
+    double lat_max = 50.0;
+    double lon_min = -125.0;
+    double lon_max = -66.0;
+    double step_deg = 0.1;
+
+    size_t rows() const;
+    size_t cols() const;
+    // Row 0 is the northern edge, column 0 the western edge.
+    double lat_of(size_t row) const { return lat_max - static_cast<double>(row) * step_deg; }
+    double lon_of(size_t col) const { return lon_min + static_cast<double>(col) * step_deg; }
+};
+
+struct GridField {
+    GridSpec spec;
+    std::vector<float> values; // row-major; NaN where no station lies within reach
+};
+
+struct IdwOptions {
+    size_t k = 6;            // stations blended per grid point
+    double power = 2.0;      // weight = 1 / distance^power
+    double max_nm = 150.0;   // stations farther than this are ignored
+    unsigned threads = 0;    // 0 = hardware concurrency
+};
+
+// `values[id]` is the observation at the point the index was built with under that id.
+GridField idw_grid(const SpatialIndex& index, const std::vector<double>& values, const GridSpec& spec,
+                   const IdwOptions& opt);
+
+// Text heat map, downsampled to at most `max_width` columns by averaging each block of cells.
+// Shading runs from `low` (densest) to `high` (blank); blocks with no data print as '?'.
+void render_grid_map(std::ostream& out, const GridField& grid, double low, double high, size_t max_width,
+                     bool unicode);
+
+// "FSGRID1\0", u32 rows, u32 cols, f64 lat_max, lon_min, step_deg, then rows*cols little-endian
+// float32 values (row 0 north). Returns false if the file cannot be written.
+bool write_grid_binary(const std::string& path, const GridField& grid);
+
+} // namespace flightsuite
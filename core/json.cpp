@@ -0,0 +1,121 @@
+#include "core/json.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace flightsuite {
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+void JsonWriter::sep() {
+    if (!first_) out_ += ',';
+    first_ = false;
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    sep();
+    out_ += '{';
+    first_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    out_ += '}';
+    first_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    sep();
+    out_ += '[';
+    first_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    out_ += ']';
+    first_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& k) {
+    sep();
+    out_ += '"';
+    out_ += json_escape(k);
+    out_ += "\":";
+    first_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& v) {
+    sep();
+    out_ += '"';
+    out_ += json_escape(v);
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    sep();
+    out_ += v ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int v) {
+    sep();
+    out_ += std::to_string(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long v) {
+    sep();
+    out_ += std::to_string(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long v) {
+    sep();
+    out_ += std::to_string(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double v, int precision) {
+    sep();
+    if (!std::isfinite(v)) {
+        out_ += "null";
+        return *this;
+    }
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.*f", precision, v);
+    out_ += buf;
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    sep();
+    out_ += "null";
+    return *this;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,45 @@
+// Minimal streaming JSON writer used for machine-readable output.
+#pragma once
+
+#include <optional>
+#include <string>
+
+namespace flightsuite {
+
+std::string json_escape(const std::string& s);
+
+// Callers are responsible for well-formed nesting; commas are inserted automatically.
+class JsonWriter {
+public:
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+    JsonWriter& key(const std::string& k);
+    JsonWriter& value(const std::string& v);
+    JsonWriter& value(const char* v) { return value(std::string(v)); }
+    JsonWriter& value(bool v);
+    JsonWriter& value(int v);
+    JsonWriter& value(long long v);
+    JsonWriter& value(unsigned long long v);
+    JsonWriter& value(double v, int precision = 2); // non-finite values become null
+    JsonWriter& null();
+
+    template <typename T>
+    JsonWriter& field(const std::string& k, const T& v) { key(k); return value(v); }
+    template <typename T>
+    JsonWriter& field(const std::string& k, const std::optional<T>& v) {
+        key(k);
+        return v ? value(*v) : null();
+    }
+    JsonWriter& field(const std::string& k, double v, int precision) { key(k); return value(v, precision); }
+
+    const std::string& str() const { return out_; }
+
+private:
+    void sep();
+    std::string out_;
+    bool first_ = true;
+};
+
+} // namespace flightsuite
@@ -0,0 +1,968 @@
+#include "core/log_index.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+// On-disk layout: a FileHeader, then segments back to back in entry order. Each segment and each
+// section in it starts 8-byte aligned; fixed-size records are in host byte order, and open()
+// rebuilds an index written on a machine with the other endianness. The file header stamps the log
+// as last seen (size, times, inode); when the stamp no longer matches, each segment's content hash
+// is checked against the log before the segment is trusted.
+struct LogIndex::SegmentHeader {
+    char magic[8];
+    uint64_t size;      // the whole segment, header included
+    uint64_t csv_begin; // CSV bytes [csv_begin, csv_end) are indexed here
+    uint64_t csv_end;
+    uint64_t content_hash; // hash_bytes over CSV bytes [csv_begin, csv_end)
+    uint32_t first_entry;
+    uint32_t entry_count;
+    uint32_t term_count;
+    uint32_t block_count;
+    uint64_t off_marks; // RowMark for every kRowMarkEvery-th entry
+    uint64_t off_rows;  // varint gaps between the other entries' line offsets
+    uint64_t rows_size;
+    uint64_t off_blocks; // TermBlock for every kTermsPerBlock-th term
+    uint64_t off_dict;   // per term: varint shared prefix, suffix length, suffix, entries, postings bytes
+    uint64_t dict_size;
+    uint64_t off_postings; // per term: varint first entry (segment-relative), then gaps
+    uint64_t postings_size;
+};
+
+namespace {
+
+// The log as the index last saw it; any append or edit changes at least one field.
+struct CsvStamp {
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+    int64_t ctime_ns = 0;
+
+    bool operator==(const CsvStamp& o) const {
+        return dev == o.dev && ino == o.ino && size == o.size && mtime_ns == o.mtime_ns && ctime_ns == o.ctime_ns;
+    }
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t endian;
+    uint32_t version;
+    CsvStamp csv;
+};
+
+struct RowMark {
+    uint64_t offset;
+    uint64_t pos; // into the row gaps
+};
+
+struct TermBlock {
+    uint64_t dict_pos;
+    uint64_t postings_pos;
+};
+
+using SegmentHeader = LogIndex::SegmentHeader;
+
+constexpr char kFileMagic[8] = {'F', 'S', 'L', 'O', 'G', 'I', 'D', 'X'};
+constexpr char kSegmentMagic[8] = {'F', 'S', 'L', 'O', 'G', 'S', 'E', 'G'};
+constexpr uint32_t kEndianTag = 0x01020304;
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kRowMarkEvery = 64;
+constexpr uint32_t kTermsPerBlock = 16;
+constexpr size_t kMaxToken = 48;
+constexpr size_t kReadChunk = 1 << 20;
+constexpr size_t kRouteColumn = 4;
+constexpr size_t kRemarksColumn = 11;
+constexpr char kRoutePrefix = 'r'; // terms are a field byte plus upper-case tokens
+constexpr char kRemarksPrefix = 'm';
+constexpr uint8_t kRouteField = 1;
+constexpr uint8_t kRemarksField = 2;
+
+void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+template <typename T>
+void put_pod(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+uint64_t align8(uint64_t n) { return (n + 7) & ~uint64_t{7}; }
+
+// Word-at-a-time multiply-xor hash: the log is re-hashed whenever it changes, so this has to keep
+// up with reading it. Streaming: feed() takes chunks whose sizes are multiples of 8 except the last.
+class ContentHash {
+public:
+    void feed(const char* p, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            mix(w);
+        }
+        if (i < n) {
+            uint64_t w = 0;
+            std::memcpy(&w, p + i, n - i);
+            mix(w ^ (uint64_t{n - i} << 56));
+        }
+        bytes_ += n;
+    }
+    uint64_t value() const {
+        uint64_t h = h_ ^ bytes_;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        return h ^ (h >> 33);
+    }
+
+private:
+    void mix(uint64_t w) {
+        h_ = (h_ ^ w) * 0x9E3779B97F4A7C15ull;
+        h_ ^= h_ >> 29;
+    }
+    uint64_t h_ = 0x243F6A8885A308D3ull;
+    uint64_t bytes_ = 0;
+};
+
+bool hash_csv_range(const std::string& path, uint64_t begin, uint64_t end, uint64_t& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in || !in.seekg(static_cast<std::streamoff>(begin))) return false;
+    ContentHash hash;
+    std::vector<char> chunk(kReadChunk);
+    for (uint64_t pos = begin; pos < end;) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(kReadChunk, end - pos));
+        if (!in.read(chunk.data(), static_cast<std::streamsize>(want))) return false;
+        hash.feed(chunk.data(), want);
+        pos += want;
+    }
+    out = hash.value();
+    return true;
+}
+
+CsvStamp csv_stamp(const struct stat& st) {
+    CsvStamp s;
+    s.dev = static_cast<uint64_t>(st.st_dev);
+    s.ino = static_cast<uint64_t>(st.st_ino);
+    s.size = static_cast<uint64_t>(st.st_size);
+    s.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    s.ctime_ns = static_cast<int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+    return s;
+}
+
+template <typename T>
+const T* section(const SegmentHeader* h, uint64_t off) {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(h) + off);
+}
+
+// Serializes one segment from rows in entry order and terms in byte order.
+class SegmentWriter {
+public:
+    SegmentWriter(uint32_t first_entry, uint64_t csv_begin) : first_entry_(first_entry), csv_begin_(csv_begin) {}
+
+    void add_row(uint64_t offset) {
+        if (entries_ % kRowMarkEvery == 0) {
+            put_pod(marks_, RowMark{offset, rows_.size()});
+        } else {
+            put_varint(rows_, offset - last_offset_);
+        }
+        last_offset_ = offset;
+        ++entries_;
+    }
+
+    // `ids` are segment-relative and ascending.
+    void add_term(std::string_view term, const uint32_t* ids, size_t count) {
+        size_t shared = 0;
+        if (terms_ % kTermsPerBlock == 0) {
+            put_pod(blocks_, TermBlock{dict_.size(), postings_.size()});
+        } else {
+            size_t limit = std::min(prev_.size(), term.size());
+            while (shared < limit && prev_[shared] == term[shared]) ++shared;
+        }
+        size_t start = postings_.size();
+        uint32_t prev = 0;
+        for (size_t i = 0; i < count; ++i) {
+            put_varint(postings_, ids[i] - prev);
+            prev = ids[i];
+        }
+        put_varint(dict_, shared);
+        put_varint(dict_, term.size() - shared);
+        dict_.append(term.substr(shared));
+        put_varint(dict_, count);
+        put_varint(dict_, postings_.size() - start);
+        prev_.assign(term);
+        ++terms_;
+    }
+
+    std::string finish(uint64_t csv_end, uint64_t content_hash) const {
+        SegmentHeader h{};
+        std::memcpy(h.magic, kSegmentMagic, sizeof(kSegmentMagic));
+        h.csv_begin = csv_begin_;
+        h.csv_end = csv_end;
+        h.content_hash = content_hash;
+        h.first_entry = first_entry_;
+        h.entry_count = entries_;
+        h.term_count = terms_;
+        h.block_count = static_cast<uint32_t>(blocks_.size() / sizeof(TermBlock));
+        uint64_t pos = align8(sizeof(SegmentHeader));
+        auto place = [&pos](const std::string& s) {
+            uint64_t off = pos;
+            pos = align8(pos + s.size());
+            return off;
+        };
+        h.off_marks = place(marks_);
+        h.off_rows = place(rows_);
+        h.rows_size = rows_.size();
+        h.off_blocks = place(blocks_);
+        h.off_dict = place(dict_);
+        h.dict_size = dict_.size();
+        h.off_postings = place(postings_);
+        h.postings_size = postings_.size();
+        h.size = pos;
+
+        std::string out;
+        out.reserve(pos);
+        put_pod(out, h);
+        for (const std::string* s : {&marks_, &rows_, &blocks_, &dict_, &postings_}) {
+            out.resize(align8(out.size()), '\0');
+            out += *s;
+        }
+        out.resize(pos, '\0');
+        return out;
+    }
+
+    uint32_t entries() const { return entries_; }
+
+private:
+    uint32_t first_entry_;
+    uint64_t csv_begin_;
+    uint32_t entries_ = 0;
+    uint32_t terms_ = 0;
+    uint64_t last_offset_ = 0;
+    std::string prev_;
+    std::string marks_, rows_, blocks_, dict_, postings_;
+};
+
+// The distinct terms of a segment being built, numbered in order of first use. Term bytes live
+// back to back in one buffer and the table holds ids, so interning a term never allocates.
+class TermTable {
+public:
+    uint32_t intern(std::string_view term) {
+        if ((count() + 1) * 2 > slots_.size()) grow();
+        uint32_t hash = static_cast<uint32_t>(std::hash<std::string_view>{}(term));
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots_[i];
+            if (slot.id == kEmpty) {
+                slot = {hash, static_cast<uint32_t>(count())};
+                bytes_.append(term);
+                ends_.push_back(bytes_.size());
+                return slot.id;
+            }
+            if (slot.hash == hash && term_of(slot.id) == term) return slot.id;
+        }
+    }
+
+    size_t count() const { return ends_.size(); }
+    std::string_view term_of(uint32_t id) const {
+        size_t begin = id == 0 ? 0 : ends_[id - 1];
+        return std::string_view(bytes_.data() + begin, ends_[id] - begin);
+    }
+
+private:
+    static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+    struct Slot {
+        uint32_t hash = 0; // compared before the term bytes are
+        uint32_t id = kEmpty;
+    };
+
+    void grow() {
+        std::vector<Slot> old(std::max<size_t>(slots_.size() * 2, 1024));
+        old.swap(slots_);
+        size_t mask = slots_.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.id == kEmpty) continue;
+            size_t i = slot.hash & mask;
+            while (slots_[i].id != kEmpty) i = (i + 1) & mask;
+            slots_[i] = slot;
+        }
+    }
+
+    std::string bytes_;
+    std::vector<size_t> ends_; // end of each term in bytes_
+    std::vector<Slot> slots_;
+};
+
+// Walks a segment's dictionary in term order, from the start of a block.
+class DictCursor {
+public:
+    DictCursor(const SegmentHeader* h, uint32_t block) : h_(h), index_(block * kTermsPerBlock) {}
+
+    bool next() {
+        if (index_ >= h_->term_count) return false;
+        const uint8_t* dict = section<uint8_t>(h_, h_->off_dict);
+        const uint8_t* end = dict + h_->dict_size;
+        if (index_ % kTermsPerBlock == 0) {
+            const TermBlock& b = section<TermBlock>(h_, h_->off_blocks)[index_ / kTermsPerBlock];
+            if (b.dict_pos > h_->dict_size) return false;
+            p_ = dict + b.dict_pos;
+            postings_pos_ = b.postings_pos;
+            term_.clear();
+        }
+        uint64_t shared, suffix, len;
+        if (!get_varint(p_, end, shared) || !get_varint(p_, end, suffix) || shared > term_.size() ||
+            suffix > static_cast<uint64_t>(end - p_)) {
+            return false;
+        }
+        term_.resize(shared);
+        term_.append(reinterpret_cast<const char*>(p_), suffix);
+        p_ += suffix;
+        if (!get_varint(p_, end, count_) || !get_varint(p_, end, len) || postings_pos_ > h_->postings_size ||
+            len > h_->postings_size - postings_pos_) {
+            return false;
+        }
+        postings_ = section<uint8_t>(h_, h_->off_postings) + postings_pos_;
+        postings_len_ = len;
+        postings_pos_ += len;
+        ++index_;
+        return true;
+    }
+
+    const std::string& term() const { return term_; }
+    uint64_t count() const { return count_; }
+
+    // Appends this term's entries plus `base`.
+    void decode(uint32_t base, std::vector<uint32_t>& out) const {
+        const uint8_t* p = postings_;
+        const uint8_t* end = postings_ + postings_len_;
+        uint64_t id = 0, gap;
+        for (uint64_t i = 0; i < count_ && get_varint(p, end, gap); ++i) {
+            id += gap;
+            out.push_back(base + static_cast<uint32_t>(id));
+        }
+    }
+
+private:
+    const SegmentHeader* h_;
+    uint32_t index_;
+    const uint8_t* p_ = nullptr;
+    uint64_t postings_pos_ = 0;
+    std::string term_;
+    uint64_t count_ = 0;
+    const uint8_t* postings_ = nullptr;
+    uint64_t postings_len_ = 0;
+};
+
+// First term of a block: stored whole, so it is a view into the mapping.
+std::string_view block_first_term(const SegmentHeader* h, uint32_t block) {
+    const uint8_t* dict = section<uint8_t>(h, h->off_dict);
+    const uint8_t* end = dict + h->dict_size;
+    uint64_t pos = section<TermBlock>(h, h->off_blocks)[block].dict_pos;
+    if (pos > h->dict_size) return {};
+    const uint8_t* p = dict + pos;
+    uint64_t shared, suffix;
+    if (!get_varint(p, end, shared) || !get_varint(p, end, suffix) || suffix > static_cast<uint64_t>(end - p)) return {};
+    return std::string_view(reinterpret_cast<const char*>(p), suffix);
+}
+
+// Positions a cursor on `term`; false if the segment does not have it.
+bool find_term(const SegmentHeader* h, std::string_view term, DictCursor& cursor) {
+    uint32_t lo = 0, hi = h->block_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (block_first_term(h, mid) <= term) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return false;
+    cursor = DictCursor(h, lo - 1);
+    for (uint32_t k = 0; k < kTermsPerBlock && cursor.next(); ++k) {
+        int cmp = cursor.term().compare(term);
+        if (cmp == 0) return true;
+        if (cmp > 0) break;
+    }
+    return false;
+}
+
+void decode_rows(const SegmentHeader* h, std::vector<uint64_t>& out) {
+    const RowMark* marks = section<RowMark>(h, h->off_marks);
+    const uint8_t* rows = section<uint8_t>(h, h->off_rows);
+    const uint8_t* end = rows + h->rows_size;
+    const uint8_t* p = rows;
+    uint64_t offset = 0, gap = 0;
+    for (uint32_t i = 0; i < h->entry_count; ++i) {
+        if (i % kRowMarkEvery == 0) {
+            offset = marks[i / kRowMarkEvery].offset;
+        } else if (get_varint(p, end, gap)) {
+            offset += gap;
+        }
+        out.push_back(offset);
+    }
+}
+
+bool segment_ok(const SegmentHeader* h, uint64_t available) {
+    if (available < sizeof(SegmentHeader) || std::memcmp(h->magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0) {
+        return false;
+    }
+    uint64_t size = h->size;
+    auto section_ok = [size](uint64_t off, uint64_t bytes) { return off % 8 == 0 && off <= size && bytes <= size - off; };
+    uint64_t marks = (uint64_t{h->entry_count} + kRowMarkEvery - 1) / kRowMarkEvery;
+    uint64_t blocks = (uint64_t{h->term_count} + kTermsPerBlock - 1) / kTermsPerBlock;
+    return size % 8 == 0 && size >= sizeof(SegmentHeader) && size <= available && h->block_count == blocks &&
+           h->csv_begin <= h->csv_end &&
+           section_ok(h->off_marks, marks * sizeof(RowMark)) && section_ok(h->off_rows, h->rows_size) &&
+           section_ok(h->off_blocks, blocks * sizeof(TermBlock)) && section_ok(h->off_dict, h->dict_size) &&
+           section_ok(h->off_postings, h->postings_size);
+}
+
+bool append_file(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+std::string file_header(const CsvStamp& csv) {
+    FileHeader fh{};
+    std::memcpy(fh.magic, kFileMagic, sizeof(kFileMagic));
+    fh.endian = kEndianTag;
+    fh.version = kVersion;
+    fh.csv = csv;
+    std::string out;
+    put_pod(out, fh);
+    out.resize(align8(out.size()), '\0');
+    return out;
+}
+
+// Rewrites the header in place once the segments match the log `csv` describes.
+bool write_stamp(const std::string& path, const CsvStamp& csv) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    std::string header = file_header(csv);
+    bool ok = ::pwrite(fd, header.data(), sizeof(FileHeader), 0) == static_cast<ssize_t>(sizeof(FileHeader));
+    ::close(fd);
+    return ok;
+}
+
+void intersect_into(std::vector<uint32_t>& acc, const std::vector<uint32_t>& ids) {
+    auto out = std::set_intersection(acc.begin(), acc.end(), ids.begin(), ids.end(), acc.begin());
+    acc.erase(out, acc.end());
+}
+
+struct Clause {
+    uint8_t fields = kRouteField | kRemarksField;
+    std::vector<std::string> words;
+};
+
+bool parse_query(const std::string& query, std::vector<Clause>& clauses, std::string* error) {
+    size_t i = 0;
+    while (i < query.size()) {
+        if (std::isspace(static_cast<unsigned char>(query[i]))) {
+            ++i;
+            continue;
+        }
+        Clause clause;
+        size_t colon = i;
+        while (colon < query.size() && std::isalpha(static_cast<unsigned char>(query[colon]))) ++colon;
+        if (colon < query.size() && query[colon] == ':' && colon > i) {
+            std::string field = to_upper(query.substr(i, colon - i));
+            if (field == "ROUTE") {
+                clause.fields = kRouteField;
+            } else if (field == "REMARKS") {
+                clause.fields = kRemarksField;
+            } else {
+                if (error) *error = "unknown field '" + query.substr(i, colon - i) + "' (use route: or remarks:)";
+                return false;
+            }
+            i = colon + 1;
+        }
+        size_t end;
+        if (i < query.size() && query[i] == '"') {
+            end = query.find('"', i + 1);
+            if (end == std::string::npos) end = query.size();
+            tokenize_log_text(std::string_view(query).substr(i + 1, end - i - 1), clause.words);
+            i = end + 1;
+        } else {
+            end = i;
+            while (end < query.size() && !std::isspace(static_cast<unsigned char>(query[end]))) ++end;
+            tokenize_log_text(std::string_view(query).substr(i, end - i), clause.words);
+            i = end;
+        }
+        if (!clause.words.empty()) clauses.push_back(std::move(clause));
+    }
+    if (clauses.empty()) {
+        if (error) *error = "nothing to search for";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void tokenize_log_text(std::string_view text, std::vector<std::string>& out) {
+    out.clear();
+    std::string cur;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (std::isalnum(c)) {
+            if (cur.size() < kMaxToken) cur.push_back(static_cast<char>(std::toupper(c)));
+        } else if (!cur.empty()) {
+            out.push_back(std::move(cur));
+            cur.clear();
+        }
+    }
+}
+
+std::string log_index_path(const std::string& csv_path) { return csv_path + ".idx"; }
+
+LogIndex::~LogIndex() { close(); }
+
+LogIndex::LogIndex(LogIndex&& other) noexcept { *this = std::move(other); }
+
+LogIndex& LogIndex::operator=(LogIndex&& other) noexcept {
+    if (this != &other) {
+        close();
+        map_ = std::exchange(other.map_, nullptr);
+        map_size_ = std::exchange(other.map_size_, 0);
+        segments_ = std::move(other.segments_);
+        other.segments_.clear();
+        added_ = other.added_;
+        rebuilt_ = other.rebuilt_;
+    }
+    return *this;
+}
+
+void LogIndex::close() {
+    if (map_) munmap(const_cast<char*>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    segments_.clear();
+}
+
+bool LogIndex::map(const std::string& path, std::string* error) {
+    close();
+    auto fail = [&](const std::string& why) {
+        if (error) *error = path + ": " + why;
+        close();
+        return false;
+    };
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return fail(std::strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        return fail("not a flight log index");
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return fail(std::strerror(errno));
+    map_ = static_cast<const char*>(p);
+    map_size_ = size;
+
+    const auto* fh = reinterpret_cast<const FileHeader*>(map_);
+    if (std::memcmp(fh->magic, kFileMagic, sizeof(kFileMagic)) != 0) return fail("not a flight log index");
+    if (fh->endian != kEndianTag || fh->version != kVersion) return fail("written by another version or machine");
+    uint64_t pos = align8(sizeof(FileHeader));
+    uint32_t next_entry = 0;
+    uint64_t csv_pos = 0;
+    while (pos < size) {
+        const auto* h = reinterpret_cast<const SegmentHeader*>(map_ + pos);
+        if (!segment_ok(h, size - pos) || h->first_entry != next_entry || h->csv_begin != csv_pos) {
+            return fail("damaged segment at byte " + std::to_string(pos));
+        }
+        segments_.push_back({h, pos});
+        next_entry += h->entry_count;
+        csv_pos = h->csv_end;
+        pos += h->size;
+    }
+    return true;
+}
+
+// Indexes the complete lines of CSV bytes [begin, csv_size) into one segment (empty when there
+// are none). At the start of the file the header row is skipped.
+bool LogIndex::index_rows(const std::string& csv_path, uint64_t begin, uint64_t csv_size, std::string& segment,
+                          std::string* error) {
+    TraceSpan span("index_log_rows", "log_index");
+    segment.clear();
+    std::ifstream in(csv_path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "cannot read " + csv_path;
+        return false;
+    }
+    in.seekg(static_cast<std::streamoff>(begin));
+
+    // Each row appends the ids of its distinct terms to row_terms; postings are laid out once all
+    // rows are in, from per-term counts.
+    const uint32_t first_entry = static_cast<uint32_t>(entry_count());
+    TermTable table;
+    std::vector<uint32_t> last_row; // per term: the latest row it was seen in
+    std::vector<uint32_t> row_terms;
+    std::vector<size_t> row_ends;
+    std::vector<uint64_t> offsets;
+    std::string words, term;
+    std::vector<size_t> word_ends;
+    auto add_term = [&](uint32_t local) {
+        uint32_t id = table.intern(term);
+        if (id == last_row.size()) last_row.push_back(std::numeric_limits<uint32_t>::max());
+        if (last_row[id] == local) return;
+        last_row[id] = local;
+        row_terms.push_back(id);
+    };
+    // Same words as tokenize_log_text(), without a string per word.
+    auto add_field = [&](char prefix, std::string_view text, uint32_t local) {
+        words.clear();
+        word_ends.clear();
+        size_t start = 0;
+        for (size_t i = 0; i <= text.size(); ++i) {
+            unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+            if (std::isalnum(c)) {
+                if (words.size() - start < kMaxToken) words.push_back(static_cast<char>(std::toupper(c)));
+            } else if (words.size() > start) {
+                word_ends.push_back(words.size());
+                start = words.size();
+            }
+        }
+        for (size_t w = 0; w < word_ends.size(); ++w) {
+            size_t begin = w == 0 ? 0 : word_ends[w - 1];
+            term.assign(1, prefix);
+            term.append(words, begin, word_ends[w] - begin);
+            add_term(local);
+            if (w + 1 < word_ends.size()) {
+                term += ' ';
+                term.append(words, word_ends[w], word_ends[w + 1] - word_ends[w]);
+                add_term(local);
+            }
+        }
+    };
+    auto is_blank = [](std::string_view line) {
+        return std::all_of(line.begin(), line.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); });
+    };
+
+    std::string buf, carry;
+    std::vector<char> chunk(kReadChunk);
+    uint64_t pos = begin; // file offset of carry's first byte
+    uint64_t end = begin; // just past the last complete line
+    while (pos + carry.size() < csv_size && in) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(kReadChunk, csv_size - pos - carry.size()));
+        in.read(chunk.data(), static_cast<std::streamsize>(want));
+        size_t got = static_cast<size_t>(in.gcount());
+        if (got == 0) break;
+        buf.swap(carry);
+        buf.append(chunk.data(), got);
+        carry.clear();
+        size_t line_start = 0;
+        for (size_t nl = buf.find('\n'); nl != std::string::npos; nl = buf.find('\n', line_start)) {
+            std::string_view line(buf.data() + line_start, nl - line_start);
+            uint64_t offset = pos + line_start;
+            line_start = nl + 1;
+            end = pos + line_start;
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (is_blank(line)) continue;
+            if (offset == 0 && line.rfind("date,", 0) == 0) continue;
+            // The route cell, and the remarks with any commas in them: cells are only trimmed, and
+            // whitespace and commas both separate words, so the raw text yields the same words.
+            std::string_view route, remarks;
+            size_t column = 0, cell = 0;
+            for (size_t c = 0; c <= line.size() && column < kRemarksColumn; ++c) {
+                if (c < line.size() && line[c] != ',') continue;
+                if (column == kRouteColumn) route = line.substr(cell, c - cell);
+                ++column;
+                cell = c + 1;
+            }
+            if (column == kRemarksColumn && cell <= line.size()) remarks = line.substr(cell);
+            uint32_t local = static_cast<uint32_t>(offsets.size());
+            add_field(kRoutePrefix, route, local);
+            add_field(kRemarksPrefix, remarks, local);
+            row_ends.push_back(row_terms.size());
+            offsets.push_back(offset);
+        }
+        carry.assign(buf, line_start, std::string::npos);
+        pos += line_start;
+    }
+    if (offsets.empty()) return true;
+
+    // Counting sort of (term, row) by term: rows go in ascending, so each term's postings come out
+    // ascending too.
+    std::vector<size_t> starts(table.count() + 1, 0);
+    for (uint32_t id : row_terms) ++starts[id + 1];
+    for (size_t id = 0; id < table.count(); ++id) starts[id + 1] += starts[id];
+    std::vector<uint32_t> postings(row_terms.size());
+    std::vector<size_t> fill(starts.begin(), starts.end() - 1);
+    for (uint32_t row = 0, i = 0; row < row_ends.size(); ++row) {
+        for (; i < row_ends[row]; ++i) postings[fill[row_terms[i]]++] = row;
+    }
+
+    SegmentWriter writer(first_entry, begin);
+    for (uint64_t off : offsets) writer.add_row(off);
+    // Sorted on their first eight bytes, big-endian, falling back to the whole term on ties, so
+    // most comparisons stay within the array.
+    std::vector<std::pair<uint64_t, uint32_t>> sorted(table.count());
+    for (uint32_t id = 0; id < sorted.size(); ++id) {
+        std::string_view t = table.term_of(id);
+        uint64_t key = 0;
+        for (size_t i = 0; i < 8; ++i) key = key << 8 | (i < t.size() ? static_cast<unsigned char>(t[i]) : 0);
+        sorted[id] = {key, id};
+    }
+    std::sort(sorted.begin(), sorted.end(), [&](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : table.term_of(a.second) < table.term_of(b.second);
+    });
+    for (const auto& [key, id] : sorted) {
+        writer.add_term(table.term_of(id), postings.data() + starts[id], starts[id + 1] - starts[id]);
+    }
+    uint64_t hash = 0;
+    if (!hash_csv_range(csv_path, begin, end, hash)) {
+        if (error) *error = "cannot read " + csv_path;
+        return false;
+    }
+    segment = writer.finish(end, hash);
+    added_ += offsets.size();
+    return true;
+}
+
+// Merges the trailing segments whose combined size has grown past half of the segment before
+// them, so segment sizes fall off geometrically and each entry is rewritten O(log n) times.
+bool LogIndex::compact(const std::string& csv_path, const std::string& index_path, std::string* error) {
+    size_t n = segments_.size();
+    if (n < 2) return true;
+    size_t j = n - 1;
+    uint64_t merged_entries = segments_[j].header->entry_count;
+    while (j > 0 && merged_entries * 2 > segments_[j - 1].header->entry_count) {
+        merged_entries += segments_[--j].header->entry_count;
+    }
+    if (j == n - 1) return true;
+    TraceSpan span("compact_log_index", "log_index", [&] { return std::to_string(n - j) + " segments"; });
+
+    const SegmentHeader* first = segments_[j].header;
+    const SegmentHeader* last = segments_[n - 1].header;
+    SegmentWriter writer(first->first_entry, first->csv_begin);
+    std::vector<uint64_t> rows;
+    std::vector<DictCursor> cursors;
+    std::vector<bool> live;
+    for (size_t s = j; s < n; ++s) {
+        rows.clear();
+        decode_rows(segments_[s].header, rows);
+        for (uint64_t off : rows) writer.add_row(off);
+        cursors.emplace_back(segments_[s].header, 0);
+        live.push_back(cursors.back().next());
+    }
+    std::vector<uint32_t> ids;
+    std::string term;
+    while (true) {
+        const std::string* least = nullptr;
+        for (size_t c = 0; c < cursors.size(); ++c) {
+            if (live[c] && (!least || cursors[c].term() < *least)) least = &cursors[c].term();
+        }
+        if (!least) break;
+        term = *least;
+        ids.clear();
+        for (size_t c = 0; c < cursors.size(); ++c) {
+            if (!live[c] || cursors[c].term() != term) continue;
+            cursors[c].decode(segments_[j + c].header->first_entry - first->first_entry, ids);
+            live[c] = cursors[c].next();
+        }
+        writer.add_term(term, ids.data(), ids.size());
+    }
+    uint64_t hash = 0;
+    if (!hash_csv_range(csv_path, first->csv_begin, last->csv_end, hash)) {
+        if (error) *error = "cannot read " + csv_path;
+        return false;
+    }
+    std::string merged = writer.finish(last->csv_end, hash);
+    uint64_t cut = segments_[j].file_offset;
+    close();
+    if (::truncate(index_path.c_str(), static_cast<off_t>(cut)) != 0 || !append_file(index_path, merged)) {
+        if (error) *error = "cannot rewrite " + index_path;
+        return false;
+    }
+    return map(index_path, error);
+}
+
+bool LogIndex::open(const std::string& csv_path, const std::string& index_path, bool rebuild, std::string* error) {
+    TraceSpan span("open_log_index", "log_index", csv_path);
+    close();
+    added_ = 0;
+    rebuilt_ = false;
+    struct stat st;
+    if (::stat(csv_path.c_str(), &st) != 0) {
+        if (error) *error = "cannot read " + csv_path;
+        return false;
+    }
+    const CsvStamp stamp = csv_stamp(st);
+    const uint64_t csv_size = stamp.size;
+    auto write_failed = [&]() {
+        if (error) *error = "cannot write " + index_path;
+        return false;
+    };
+
+    // An unchanged stamp means the log is as indexed. Otherwise keep the segments whose bytes still
+    // hash the same; from the first changed one on, everything is indexed again. When the same file
+    // has only grown, that was an append, which leaves every byte up to the old size as it was, so
+    // the segments (which all end there or before) are trusted without reading the log.
+    bool usable = !rebuild && map(index_path, nullptr);
+    if (usable && !(reinterpret_cast<const FileHeader*>(map_)->csv == stamp)) {
+        TraceSpan verify("verify_log_index", "log_index");
+        const CsvStamp seen = reinterpret_cast<const FileHeader*>(map_)->csv;
+        const bool appended = seen.dev == stamp.dev && seen.ino == stamp.ino && seen.size < stamp.size;
+        size_t keep = 0;
+        for (; keep < segments_.size(); ++keep) {
+            const SegmentHeader* h = segments_[keep].header;
+            if (appended && h->csv_end <= seen.size) continue;
+            uint64_t hash = 0;
+            if (h->csv_end > csv_size || !hash_csv_range(csv_path, h->csv_begin, h->csv_end, hash) ||
+                hash != h->content_hash) {
+                break;
+            }
+        }
+        if (keep == 0 && !segments_.empty()) {
+            usable = false;
+        } else if (keep < segments_.size()) {
+            uint64_t cut = segments_[keep].file_offset;
+            close();
+            if (::truncate(index_path.c_str(), static_cast<off_t>(cut)) != 0) return write_failed();
+            if (!map(index_path, error)) return false;
+            rebuilt_ = true;
+        }
+    }
+    std::string segment;
+    if (!usable) {
+        close();
+        if (!index_rows(csv_path, 0, csv_size, segment, error)) return false;
+        std::string tmp = index_path + ".tmp";
+        std::remove(tmp.c_str());
+        if (!append_file(tmp, file_header(stamp) + segment) || std::rename(tmp.c_str(), index_path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return write_failed();
+        }
+        rebuilt_ = true;
+        return map(index_path, error);
+    }
+    uint64_t covered = segments_.empty() ? 0 : segments_.back().header->csv_end;
+    if (covered < csv_size) {
+        if (!index_rows(csv_path, covered, csv_size, segment, error)) return false;
+        if (!segment.empty()) {
+            close();
+            if (!append_file(index_path, segment)) return write_failed();
+            if (!map(index_path, error) || !compact(csv_path, index_path, error)) return false;
+        }
+    }
+    if (!(reinterpret_cast<const FileHeader*>(map_)->csv == stamp) && !write_stamp(index_path, stamp)) {
+        return write_failed();
+    }
+    return true;
+}
+
+std::optional<std::vector<uint32_t>> LogIndex::search(const std::string& query, std::string* error) const {
+    TraceSpan span("search_log_index", "log_index", query);
+    std::vector<Clause> clauses;
+    if (!parse_query(query, clauses, error)) return std::nullopt;
+
+    std::vector<uint32_t> result, seg_ids, clause_ids, field_ids, term_ids, merged;
+    std::vector<std::pair<uint64_t, DictCursor>> found;
+    for (const Segment& seg : segments_) {
+        const SegmentHeader* h = seg.header;
+        bool first_clause = true;
+        for (const Clause& clause : clauses) {
+            clause_ids.clear();
+            for (uint8_t field : {kRouteField, kRemarksField}) {
+                if (!(clause.fields & field)) continue;
+                char prefix = field == kRouteField ? kRoutePrefix : kRemarksPrefix;
+                // One word is looked up as itself, a phrase as each adjacent pair.
+                found.clear();
+                bool missing = false;
+                size_t n_terms = clause.words.size() == 1 ? 1 : clause.words.size() - 1;
+                for (size_t w = 0; w < n_terms && !missing; ++w) {
+                    std::string term = prefix + clause.words[w];
+                    if (clause.words.size() > 1) term += ' ' + clause.words[w + 1];
+                    DictCursor cursor(h, 0);
+                    if (find_term(h, term, cursor)) {
+                        found.emplace_back(cursor.count(), cursor);
+                    } else {
+                        missing = true;
+                    }
+                }
+                if (missing) continue;
+                // Rarest term first, so the running intersection only shrinks.
+                std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+                field_ids.clear();
+                found[0].second.decode(0, field_ids);
+                for (size_t t = 1; t < found.size() && !field_ids.empty(); ++t) {
+                    term_ids.clear();
+                    found[t].second.decode(0, term_ids);
+                    intersect_into(field_ids, term_ids);
+                }
+                merged.clear();
+                std::set_union(clause_ids.begin(), clause_ids.end(), field_ids.begin(), field_ids.end(),
+                               std::back_inserter(merged));
+                clause_ids.swap(merged);
+            }
+            if (first_clause) {
+                seg_ids.swap(clause_ids);
+                first_clause = false;
+            } else {
+                intersect_into(seg_ids, clause_ids);
+            }
+            if (seg_ids.empty()) break;
+        }
+        for (uint32_t id : seg_ids) result.push_back(h->first_entry + id);
+    }
+    return result;
+}
+
+uint64_t LogIndex::entry_offset(uint32_t entry) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), entry,
+                               [](uint32_t e, const Segment& s) { return e < s.header->first_entry; });
+    if (it == segments_.begin()) return 0;
+    const SegmentHeader* h = std::prev(it)->header;
+    uint32_t local = entry - h->first_entry;
+    if (local >= h->entry_count) return 0;
+    const RowMark& mark = section<RowMark>(h, h->off_marks)[local / kRowMarkEvery];
+    const uint8_t* rows = section<uint8_t>(h, h->off_rows);
+    const uint8_t* p = rows + std::min(mark.pos, h->rows_size);
+    uint64_t offset = mark.offset, gap;
+    for (uint32_t i = 0; i < local % kRowMarkEvery && get_varint(p, rows + h->rows_size, gap); ++i) offset += gap;
+    return offset;
+}
+
+size_t LogIndex::entry_count() const {
+    if (segments_.empty()) return 0;
+    const SegmentHeader* h = segments_.back().header;
+    return size_t{h->first_entry} + h->entry_count;
+}
+
+size_t LogIndex::term_count() const {
+    size_t n = 0;
+    for (const auto& s : segments_) n += s.header->term_count;
+    return n;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,79 @@
+// Full-text index over a flight log's route and remarks columns. Terms are upper-cased runs of
+// letters and digits, plus each pair of adjacent words so quoted phrases resolve from the index
+// alone; each term's postings are varint gaps between entry numbers. The index file is a series
+// of immutable segments, each covering a byte range of the CSV: rows appended to the log go into
+// a new segment, and trailing segments are merged as they grow, binary-counter style, so a log of
+// n entries has at most about log2(n) of them. Searching maps the file and decodes only the
+// postings of the query's terms.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flightsuite {
+
+// Upper-cased runs of letters and digits: "RNAV (GPS) Y 34L" -> RNAV, GPS, Y, 34L.
+void tokenize_log_text(std::string_view text, std::vector<std::string>& out);
+
+// Where the index for a log lives by default: next to it, with ".idx" appended.
+std::string log_index_path(const std::string& csv_path);
+
+class LogIndex {
+public:
+    LogIndex() = default;
+    ~LogIndex();
+    LogIndex(LogIndex&& other) noexcept;
+    LogIndex& operator=(LogIndex&& other) noexcept;
+    LogIndex(const LogIndex&) = delete;
+    LogIndex& operator=(const LogIndex&) = delete;
+
+    // Opens the index of `csv_path`, first indexing any rows appended to the log since the last
+    // update. When the log's times or inode differ from the last update and it has not simply grown,
+    // every segment's bytes are re-hashed, and segments from the first edited one on are indexed
+    // again. The index is rebuilt from scratch when `rebuild` is set or the file is missing or
+    // damaged.
+    bool open(const std::string& csv_path, const std::string& index_path, bool rebuild = false,
+              std::string* error = nullptr);
+    bool is_open() const { return map_ != nullptr; }
+
+    // Entries matching every clause of `query`, ascending. A clause is a word or a "quoted
+    // phrase", optionally prefixed with route: or remarks:; unprefixed clauses match either
+    // field. Phrases of three or more words match each adjacent pair.
+    std::optional<std::vector<uint32_t>> search(const std::string& query, std::string* error = nullptr) const;
+
+    // Byte offset of entry `entry`'s line in the CSV.
+    uint64_t entry_offset(uint32_t entry) const;
+
+    size_t entry_count() const;
+    size_t segment_count() const { return segments_.size(); }
+    size_t term_count() const;
+    size_t file_size() const { return map_size_; }
+    size_t added() const { return added_; } // entries indexed by the last open()
+    bool rebuilt() const { return rebuilt_; } // all or part of the index was rebuilt
+
+    struct SegmentHeader;
+
+private:
+    struct Segment {
+        const SegmentHeader* header;
+        uint64_t file_offset;
+    };
+
+    void close();
+    bool map(const std::string& path, std::string* error);
+    bool index_rows(const std::string& csv_path, uint64_t begin, uint64_t csv_size, std::string& segment,
+                    std::string* error);
+    bool compact(const std::string& csv_path, const std::string& index_path, std::string* error);
+
+    const char* map_ = nullptr;
+    size_t map_size_ = 0;
+    std::vector<Segment> segments_;
+    size_t added_ = 0;
+    bool rebuilt_ = false;
+};
+
+} // namespace flightsuite
@@ -0,0 +1,763 @@
+#include "core/metar.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <queue>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+
+#include "core/cassette.hpp"
+#include "core/compress.hpp"
+#include "core/fetch.hpp"
+#include "core/geo.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+using Token = std::string_view;
+
+constexpr double kHpaPerInHg = 33.8639;
+constexpr double kMetresPerSm = 1609.344;
+constexpr double kFeetPerMetre = 3.28084;
+
+// Character classes, built at compile time; the classifier and the small field parsers share them.
+enum CharClass : uint8_t { kOtherChar, kDigitChar, kAlphaChar, kSlashChar, kSignChar };
+
+constexpr std::array<uint8_t, 256> make_char_classes() {
+    std::array<uint8_t, 256> t{};
+    for (int c = '0'; c <= '9'; ++c) t[c] = kDigitChar;
+    for (int c = 'A'; c <= 'Z'; ++c) t[c] = kAlphaChar;
+    t['/'] = kSlashChar;
+    t['+'] = kSignChar;
+    t['-'] = kSignChar;
+    return t;
+}
+constexpr std::array<uint8_t, 256> kCharClass = make_char_classes();
+
+constexpr uint8_t char_class(char c) { return kCharClass[static_cast<unsigned char>(c)]; }
+
+bool is_digit(char c) { return char_class(c) == kDigitChar; }
+
+bool all_digits(Token t, size_t pos, size_t n) {
+    if (pos + n > t.size()) return false;
+    for (size_t i = pos; i < pos + n; ++i) {
+        if (!is_digit(t[i])) return false;
+    }
+    return true;
+}
+
+int to_int(Token t, size_t pos, size_t n) {
+    int v = 0;
+    for (size_t i = pos; i < pos + n; ++i) v = v * 10 + (t[i] - '0');
+    return v;
+}
+
+bool ends_with(Token t, Token suffix) {
+    return t.size() >= suffix.size() && t.substr(t.size() - suffix.size()) == suffix;
+}
+
+// Number of digits starting at `pos`.
+size_t digit_run(Token t, size_t pos) {
+    size_t n = 0;
+    while (pos + n < t.size() && is_digit(t[pos + n])) ++n;
+    return n;
+}
+
+using Group = MetarGroup;
+
+bool match_wind(Token t) {
+    size_t pos;
+    if (t.substr(0, 3) == "VRB") {
+        pos = 3;
+    } else if (all_digits(t, 0, 3)) {
+        pos = 3;
+    } else {
+        return false;
+    }
+    size_t n = digit_run(t, pos);
+    if (n < 2 || n > 3) return false;
+    pos += n;
+    if (pos < t.size() && t[pos] == 'G') {
+        n = digit_run(t, pos + 1);
+        if (n < 2 || n > 3) return false;
+        pos += 1 + n;
+    }
+    Token unit = t.substr(pos);
+    return unit == "KT" || unit == "MPS" || unit == "KMH";
+}
+
+bool match_wind_var(Token t) { return t.size() == 7 && all_digits(t, 0, 3) && t[3] == 'V' && all_digits(t, 4, 3); }
+
+bool match_vis_sm(Token t) {
+    if (!ends_with(t, "SM") || t.size() < 3) return false;
+    Token v = t.substr(0, t.size() - 2);
+    if (v[0] == 'M' || v[0] == 'P') v.remove_prefix(1);
+    size_t n = digit_run(v, 0);
+    if (n == 0) return false;
+    if (n == v.size()) return true;
+    return v[n] == '/' && n + 1 < v.size() && digit_run(v, n + 1) == v.size() - n - 1;
+}
+
+bool match_vis_metres(Token t) {
+    if (!all_digits(t, 0, 4)) return false;
+    Token rest = t.substr(4);
+    if (rest.empty() || rest == "NDV") return true;
+    if (rest.size() > 2) return false;
+    for (char c : rest) {
+        if (c != 'N' && c != 'S' && c != 'E' && c != 'W') return false;
+    }
+    return true;
+}
+
+bool match_rvr(Token t) {
+    if (t.size() < 8 || t[0] != 'R' || !all_digits(t, 1, 2)) return false;
+    size_t slash = t.find('/');
+    return (slash == 3 || (slash == 4 && (t[3] == 'L' || t[3] == 'R' || t[3] == 'C'))) && slash + 1 < t.size() &&
+           (is_digit(t[slash + 1]) || t[slash + 1] == 'P' || t[slash + 1] == 'M');
+}
+
+// Two-letter descriptor/phenomenon codes and their plain-English names.
+struct WxCode {
+    char code[3];
+    const char* desc;
+};
+constexpr WxCode kWxCodes[] = {
+    {"MI", "shallow"},       {"PR", "partial"},     {"BC", "patches"},        {"DR", "drifting"},
+    {"BL", "blowing"},       {"SH", "showers"},     {"TS", "thunderstorm"},   {"FZ", "freezing"},
+    {"DZ", "drizzle"},       {"RA", "rain"},        {"SN", "snow"},           {"SG", "snow grains"},
+    {"IC", "ice crystals"},  {"PL", "ice pellets"}, {"GR", "hail"},           {"GS", "small hail"},
+    {"UP", "unknown precipitation"}, {"BR", "mist"}, {"FG", "fog"},           {"FU", "smoke"},
+    {"VA", "volcanic ash"},  {"DU", "dust"},        {"SA", "sand"},           {"HZ", "haze"},
+    {"PY", "spray"},         {"PO", "dust whirls"}, {"SQ", "squalls"},        {"FC", "funnel cloud"},
+    {"SS", "sandstorm"},     {"DS", "duststorm"},
+};
+
+const WxCode* find_wx(Token t, size_t pos) {
+    for (const auto& c : kWxCodes) {
+        if (t[pos] == c.code[0] && t[pos + 1] == c.code[1]) return &c;
+    }
+    return nullptr;
+}
+
+Token strip_wx_prefix(Token t) {
+    if (!t.empty() && (t[0] == '-' || t[0] == '+')) return t.substr(1);
+    if (t.substr(0, 2) == "VC") return t.substr(2);
+    return t;
+}
+
+bool match_weather(Token t) {
+    Token w = strip_wx_prefix(t);
+    if (w.empty() || w.size() % 2 != 0 || w.size() > 8) return false;
+    for (size_t i = 0; i < w.size(); i += 2) {
+        if (!find_wx(w, i)) return false;
+    }
+    return true;
+}
+
+bool match_cloud(Token t) {
+    Token cover = t.substr(0, 3);
+    if (cover != "FEW" && cover != "SCT" && cover != "BKN" && cover != "OVC") return false;
+    return t.size() >= 6 && (all_digits(t, 3, 3) || t.substr(3, 3) == "///");
+}
+
+bool match_vert_vis(Token t) { return t.size() == 5 && t[0] == 'V' && t[1] == 'V' && (all_digits(t, 2, 3) || t.substr(2) == "///"); }
+
+bool match_no_cloud(Token t) { return t == "NSC" || t == "NCD" || t == "SKC" || t == "CLR"; }
+
+// "M05/M10", "18/12", "05/", "M01/////".
+bool match_temp_dew(Token t) {
+    size_t slash = t.find('/');
+    if (slash == std::string_view::npos) return false;
+    auto temp_ok = [](Token v) {
+        if (!v.empty() && v[0] == 'M') v.remove_prefix(1);
+        return v.size() == 2 && all_digits(v, 0, 2);
+    };
+    Token dew = t.substr(slash + 1);
+    return temp_ok(t.substr(0, slash)) && (dew.empty() || dew.find_first_not_of('/') == std::string_view::npos || temp_ok(dew));
+}
+
+bool match_alt_inhg(Token t) { return t.size() == 5 && t[0] == 'A' && all_digits(t, 1, 4); }
+
+bool match_alt_hpa(Token t) { return t.size() == 5 && t[0] == 'Q' && all_digits(t, 1, 4); }
+
+bool match_end(Token t) { return t == "RMK" || t == "TEMPO" || t == "BECMG" || t == "NOSIG"; }
+
+bool match_cavok(Token t) { return t == "CAVOK"; }
+
+// Dispatch: a token's first two characters (digits folded to '0', anything after a '+'/'-' sign to
+// '*') select the groups that can start that way from a perfect-hash table built at compile time,
+// its last character rules out the digit-led shapes that cannot end that way, and only the
+// survivors' matchers run; for nearly every token that is exactly one.
+constexpr uint16_t group_bit(Group g) { return static_cast<uint16_t>(1u << static_cast<unsigned>(g)); }
+
+constexpr uint16_t kDigitLed = group_bit(Group::kWind) | group_bit(Group::kWindVar) | group_bit(Group::kVisSm) |
+                               group_bit(Group::kVisMetres) | group_bit(Group::kTempDew);
+
+struct PrefixRule {
+    char key[3];
+    uint16_t groups;
+};
+
+constexpr PrefixRule kPrefixRules[] = {
+    {"00", kDigitLed},
+    {"0/", group_bit(Group::kVisSm)}, // 1/2SM
+    {"0S", group_bit(Group::kVisSm)}, // 6SM
+    {"M0", group_bit(Group::kVisSm) | group_bit(Group::kTempDew)},
+    {"P0", group_bit(Group::kVisSm)},
+    {"VR", group_bit(Group::kWind)},
+    {"R0", group_bit(Group::kRvr)},
+    {"CA", group_bit(Group::kCavok)},
+    {"FE", group_bit(Group::kCloud)},
+    {"SC", group_bit(Group::kCloud)},
+    {"BK", group_bit(Group::kCloud)},
+    {"OV", group_bit(Group::kCloud)},
+    {"VV", group_bit(Group::kVertVis)},
+    {"NS", group_bit(Group::kNoCloud)},
+    {"NC", group_bit(Group::kNoCloud)},
+    {"SK", group_bit(Group::kNoCloud)},
+    {"CL", group_bit(Group::kNoCloud)},
+    {"A0", group_bit(Group::kAltInHg)},
+    {"Q0", group_bit(Group::kAltHpa)},
+    {"RM", group_bit(Group::kEnd)},
+    {"TE", group_bit(Group::kEnd)},
+    {"BE", group_bit(Group::kEnd)},
+    {"NO", group_bit(Group::kEnd)},
+    {"-*", group_bit(Group::kWeather)},
+    {"+*", group_bit(Group::kWeather)},
+    {"VC", group_bit(Group::kWeather)},
+    // ...and every two-letter code in kWxCodes, for unqualified weather ("RA", "TSRA", "FZFG").
+};
+
+constexpr char fold_char(char c) { return char_class(c) == kDigitChar ? '0' : c; }
+
+constexpr uint16_t prefix_key(char a, char b) {
+    return static_cast<uint16_t>(static_cast<unsigned char>(a) | static_cast<unsigned char>(b) << 8);
+}
+
+// Callers guarantee t.size() >= 2.
+constexpr uint16_t token_key(Token t) {
+    return char_class(t[0]) == kSignChar ? prefix_key(t[0], '*') : prefix_key(fold_char(t[0]), fold_char(t[1]));
+}
+
+constexpr size_t kPrefixSlots = 256;
+constexpr size_t kPrefixKeys = std::size(kPrefixRules) + std::size(kWxCodes);
+
+constexpr size_t prefix_slot(uint16_t key, uint32_t seed) { return (static_cast<uint32_t>(key) * seed) >> 24; }
+
+struct PrefixTable {
+    uint32_t seed = 0; // 0 if no collision-free multiplier was found
+    std::array<uint16_t, kPrefixSlots> keys{};
+    std::array<uint16_t, kPrefixSlots> groups{};
+};
+
+constexpr PrefixTable make_prefix_table() {
+    std::array<uint16_t, kPrefixKeys> keys{};
+    std::array<uint16_t, kPrefixKeys> groups{};
+    size_t n = 0;
+    for (const auto& r : kPrefixRules) {
+        keys[n] = prefix_key(r.key[0], r.key[1]);
+        groups[n++] = r.groups;
+    }
+    for (const auto& c : kWxCodes) {
+        keys[n] = prefix_key(c.code[0], c.code[1]);
+        groups[n++] = group_bit(Group::kWeather);
+    }
+    PrefixTable table;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            if (keys[i] == keys[j]) return table; // ambiguous prefix: no seed can fix that
+        }
+    }
+    // Odd multipliers from an LCG walk until every key lands in its own slot (a few hundred tries).
+    for (uint32_t seed = 0x9E3779B1u, tries = 0; tries < 4096; seed = (seed * 1664525u + 1013904223u) | 1u, ++tries) {
+        std::array<bool, kPrefixSlots> used{};
+        bool ok = true;
+        for (size_t i = 0; i < n && ok; ++i) {
+            size_t slot = prefix_slot(keys[i], seed);
+            ok = !used[slot];
+            used[slot] = true;
+        }
+        if (!ok) continue;
+        table.seed = seed;
+        for (size_t i = 0; i < n; ++i) {
+            table.keys[prefix_slot(keys[i], seed)] = keys[i];
+            table.groups[prefix_slot(keys[i], seed)] = groups[i];
+        }
+        return table;
+    }
+    return table;
+}
+
+constexpr PrefixTable kPrefixTable = make_prefix_table();
+static_assert(kPrefixTable.seed != 0, "METAR group prefixes must be distinct and hash without collisions");
+
+// Digit-led groups that may end in each character; other groups pass through untouched.
+constexpr std::array<uint16_t, 256> make_tail_groups() {
+    std::array<uint16_t, 256> t{};
+    for (auto& v : t) v = static_cast<uint16_t>(~kDigitLed);
+    for (int c = '0'; c <= '9'; ++c) {
+        t[c] |= group_bit(Group::kWindVar) | group_bit(Group::kVisMetres) | group_bit(Group::kTempDew);
+    }
+    t['/'] |= group_bit(Group::kTempDew);                    // 05/, M01/////
+    for (char c : {'T', 'S', 'H'}) t[c] |= group_bit(Group::kWind); // KT, MPS, KMH
+    t['M'] |= group_bit(Group::kVisSm);
+    for (char c : {'N', 'E', 'S', 'W', 'V'}) t[c] |= group_bit(Group::kVisMetres); // 4000NE, 1500NDV
+    return t;
+}
+constexpr std::array<uint16_t, 256> kTailGroups = make_tail_groups();
+
+using GroupMatcher = bool (*)(Token);
+
+// Indexed by Group; where shapes could overlap the lower group wins.
+constexpr GroupMatcher kGroupMatchers[] = {
+    nullptr,          match_end,      match_wind,       match_wind_var,  match_vis_sm,
+    match_vis_metres, match_cavok,    match_rvr,        match_cloud,     match_vert_vis,
+    match_no_cloud,   match_temp_dew, match_alt_inhg,   match_alt_hpa,   match_weather,
+};
+static_assert(std::size(kGroupMatchers) == static_cast<size_t>(Group::kCount), "one matcher per group");
+
+void decode_wind(Token t, WindInfo& w) {
+    if (t[0] != 'V') w.direction_deg = to_int(t, 0, 3);
+    size_t n = digit_run(t, 3);
+    double speed = to_int(t, 3, n);
+    std::optional<double> gust;
+    size_t pos = 3 + n;
+    if (t[pos] == 'G') {
+        size_t g = digit_run(t, pos + 1);
+        gust = to_int(t, pos + 1, g);
+        pos += 1 + g;
+    }
+    double to_kt = t.substr(pos) == "MPS" ? 1.94384 : t.substr(pos) == "KMH" ? 0.539957 : 1.0;
+    w.speed_kt = static_cast<int>(std::lround(speed * to_kt));
+    if (gust) w.gust_kt = static_cast<int>(std::lround(*gust * to_kt));
+}
+
+// `prev` is the token before, for "1 1/2SM".
+double decode_vis_sm(Token t, Token prev) {
+    Token v = t.substr(0, t.size() - 2);
+    if (v[0] == 'M' || v[0] == 'P') v.remove_prefix(1);
+    size_t n = digit_run(v, 0);
+    double total;
+    if (n == v.size()) {
+        total = to_int(v, 0, n);
+    } else {
+        int den = to_int(v, n + 1, v.size() - n - 1);
+        total = den ? static_cast<double>(to_int(v, 0, n)) / den : 0.0;
+        if (!prev.empty() && prev.size() <= 2 && digit_run(prev, 0) == prev.size()) total += to_int(prev, 0, prev.size());
+    }
+    return total;
+}
+
+void set_visibility_metres(MetarDecoded& m, int metres) {
+    m.visibility_m = metres;
+    if (!m.visibility_sm) m.visibility_sm = (metres >= 9999 ? 10000 : metres) / kMetresPerSm;
+}
+
+RunwayVisualRange decode_rvr(Token t) {
+    RunwayVisualRange r;
+    size_t slash = t.find('/');
+    r.runway = std::string(t.substr(1, slash - 1));
+    Token v = t.substr(slash + 1);
+    bool feet = ends_with(v, "FT") || (!v.empty() && (v.back() == 'U' || v.back() == 'D' || v.back() == 'N') &&
+                                       ends_with(v.substr(0, v.size() - 1), "FT"));
+    if (!v.empty() && (v.back() == 'U' || v.back() == 'D' || v.back() == 'N')) {
+        r.trend = v.back();
+        v.remove_suffix(1);
+    }
+    if (ends_with(v, "FT")) v.remove_suffix(2);
+    if (!v.empty() && v.back() == '/') v.remove_suffix(1); // "R24/1200/U" style trend separator
+    auto to_ft = [feet](int value) { return feet ? value : static_cast<int>(std::lround(value * kFeetPerMetre)); };
+    if (!v.empty() && (v[0] == 'P' || v[0] == 'M')) {
+        r.qualifier = v[0];
+        v.remove_prefix(1);
+    }
+    size_t n = digit_run(v, 0);
+    r.range_ft = to_ft(to_int(v, 0, n));
+    if (n < v.size() && v[n] == 'V') {
+        Token hi = v.substr(n + 1);
+        if (!hi.empty() && (hi[0] == 'P' || hi[0] == 'M')) hi.remove_prefix(1);
+        size_t hn = digit_run(hi, 0);
+        if (hn) r.max_range_ft = to_ft(to_int(hi, 0, hn));
+    }
+    return r;
+}
+
+void decode_ceiling(Token t, MetarDecoded& m) {
+    bool vv = t[0] == 'V';
+    size_t pos = vv ? 2 : 3;
+    if (!vv && t.substr(0, 3) != "BKN" && t.substr(0, 3) != "OVC") return;
+    if (!all_digits(t, pos, 3)) return;
+    int height = to_int(t, pos, 3) * 100;
+    if (!m.ceiling_ft || height < *m.ceiling_ft) {
+        m.ceiling_ft = height;
+        m.ceiling_layer = std::string(t.substr(0, pos));
+    }
+}
+
+void decode_weather(Token t, std::vector<std::string>& found) {
+    Token w = strip_wx_prefix(t);
+    for (size_t i = 0; i < w.size(); i += 2) {
+        const char* desc = find_wx(w, i)->desc;
+        if (std::find(found.begin(), found.end(), desc) == found.end()) found.emplace_back(desc);
+    }
+}
+
+int decode_temp(Token v) { return v[0] == 'M' ? -to_int(v, 1, 2) : to_int(v, 0, 2); }
+
+void decode_temp_dew(Token t, MetarDecoded& m) {
+    size_t slash = t.find('/');
+    m.temperature_c = decode_temp(t.substr(0, slash));
+    Token dew = t.substr(slash + 1);
+    if (!dew.empty() && dew[0] != '/') m.dewpoint_c = decode_temp(dew);
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's days_from_civil).
+int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = static_cast<int>(y - era * 400);
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+int days_in_month(int y, int m) {
+    static const int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return m == 2 && leap ? 29 : kDays[m - 1];
+}
+
+uint64_t fnv1a(uint64_t h, Token t) {
+    for (unsigned char c : t) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Observation time and identity hash of one raw report, without a full decode.
+struct ReportKey {
+    int64_t obs_time = 0;
+    uint64_t hash = 0;
+};
+
+std::optional<ReportKey> report_key(const std::string& raw, std::time_t reference) {
+    std::string upper = to_upper(raw);
+    uint64_t h = 1469598103934665603ULL;
+    int index = 0; // position among tokens after an optional METAR/SPECI prefix
+    std::optional<int64_t> time;
+    for (size_t pos = 0; pos < upper.size();) {
+        while (pos < upper.size() && std::isspace(static_cast<unsigned char>(upper[pos]))) ++pos;
+        size_t end = pos;
+        while (end < upper.size() && !std::isspace(static_cast<unsigned char>(upper[end]))) ++end;
+        size_t len = end - pos;
+        while (len > 0 && upper[pos + len - 1] == '=') --len;
+        if (len > 0) {
+            Token t(upper.data() + pos, len);
+            // Station, time, and body all feed the hash; one separator keeps spacing out of it.
+            h = fnv1a(h, t);
+            h = fnv1a(h, " ");
+            bool type_word = index == 0 && (t == "METAR" || t == "SPECI");
+            if (!type_word) {
+                if (index == 1) time = resolve_obs_time(std::string(t), reference);
+                ++index;
+            }
+        }
+        pos = end;
+    }
+    if (!time) return std::nullopt;
+    return ReportKey{*time, h};
+}
+
+// Date lines look like "2024/01/01 12:00"; reports start with a station ident.
+bool is_cycle_date_line(std::string_view line) {
+    return line.size() >= 10 && line[4] == '/' && line[7] == '/' && is_digit(line[0]);
+}
+
+} // namespace
+
+MetarDecoded decode_metar(const std::string& raw, std::time_t reference) {
+    MetarDecoded m;
+    std::string upper = to_upper(raw);
+    std::vector<Token> tokens;
+    tokens.reserve(24);
+    for (size_t pos = 0; pos < upper.size();) {
+        while (pos < upper.size() && std::isspace(static_cast<unsigned char>(upper[pos]))) ++pos;
+        size_t end = pos;
+        while (end < upper.size() && !std::isspace(static_cast<unsigned char>(upper[end]))) ++end;
+        // ICAO reports end with '=' ("Q1013="); it terminates the report, not the group.
+        size_t len = end - pos;
+        while (len > 0 && upper[pos + len - 1] == '=') --len;
+        if (len > 0) tokens.emplace_back(upper.data() + pos, len);
+        pos = end;
+    }
+    size_t i = 0;
+    if (i < tokens.size() && (tokens[i] == "METAR" || tokens[i] == "SPECI")) ++i;
+    if (i < tokens.size()) m.station = std::string(tokens[i++]);
+    if (i < tokens.size() && tokens[i].size() >= 5 && tokens[i].back() == 'Z') m.timestamp_z = std::string(tokens[i++]);
+    if (reference != 0 && !m.timestamp_z.empty()) m.obs_time = resolve_obs_time(m.timestamp_z, reference);
+
+    bool have_wind = false, done = false;
+    for (; i < tokens.size() && !done; ++i) {
+        Token t = tokens[i];
+        switch (classify_metar_group(t)) {
+        case Group::kUnknown:
+        case Group::kCount:
+            break;
+        case Group::kEnd:
+            done = true;
+            break;
+        case Group::kWind:
+            if (!have_wind) decode_wind(t, m.wind);
+            have_wind = true;
+            break;
+        case Group::kWindVar:
+            break;
+        case Group::kVisSm:
+            if (!m.visibility_sm) m.visibility_sm = decode_vis_sm(t, i > 0 ? tokens[i - 1] : Token());
+            break;
+        case Group::kVisMetres:
+            if (!m.visibility_m) set_visibility_metres(m, to_int(t, 0, 4));
+            break;
+        case Group::kCavok:
+            m.cavok = true;
+            m.no_significant_cloud = true;
+            set_visibility_metres(m, 9999);
+            break;
+        case Group::kRvr:
+            m.rvr.push_back(decode_rvr(t));
+            break;
+        case Group::kCloud:
+        case Group::kVertVis:
+            decode_ceiling(t, m);
+            break;
+        case Group::kNoCloud:
+            m.no_significant_cloud = true;
+            break;
+        case Group::kTempDew:
+            if (!m.temperature_c) decode_temp_dew(t, m);
+            break;
+        case Group::kAltInHg:
+            m.altimeter_inhg = to_int(t, 1, 4) / 100.0;
+            m.altimeter_hpa = *m.altimeter_inhg * kHpaPerInHg;
+            break;
+        case Group::kAltHpa:
+            m.altimeter_hpa = to_int(t, 1, 4);
+            m.altimeter_inhg = *m.altimeter_hpa / kHpaPerInHg;
+            break;
+        case Group::kWeather:
+            decode_weather(t, m.weather);
+            break;
+        }
+    }
+    return m;
+}
+
+MetarGroup classify_metar_group(std::string_view t) {
+    if (t.size() < 2) return Group::kUnknown;
+    uint16_t key = token_key(t);
+    size_t slot = prefix_slot(key, kPrefixTable.seed);
+    if (kPrefixTable.keys[slot] != key) return Group::kUnknown;
+    unsigned groups = kPrefixTable.groups[slot] & kTailGroups[static_cast<unsigned char>(t.back())];
+    for (unsigned g = 0; groups; ++g, groups >>= 1) {
+        if ((groups & 1) && kGroupMatchers[g](t)) return static_cast<Group>(g);
+    }
+    return Group::kUnknown;
+}
+
+std::optional<int64_t> resolve_obs_time(const std::string& ddhhmmz, std::time_t reference) {
+    Token t(ddhhmmz);
+    if (t.size() != 7 || t[6] != 'Z' || !all_digits(t, 0, 6)) return std::nullopt;
+    int day = to_int(t, 0, 2), hour = to_int(t, 2, 2), minute = to_int(t, 4, 2);
+    if (day < 1 || day > 31 || hour > 23 || minute > 59) return std::nullopt;
+    std::tm ref{};
+    if (!gmtime_r(&reference, &ref)) return std::nullopt;
+    // Reports are never more than a clock skew ahead of the reference, so a candidate over a day in
+    // the future only wins if nothing else fits (e.g. "31" read just after February).
+    auto distance = [reference](int64_t t) {
+        int64_t d = std::llabs(t - reference);
+        return t > reference + 86400 ? d + (int64_t{1} << 40) : d;
+    };
+    std::optional<int64_t> best;
+    for (int delta = -2; delta <= 1; ++delta) {
+        int y = ref.tm_year + 1900;
+        int m = ref.tm_mon + 1 + delta;
+        if (m < 1) {
+            m += 12;
+            --y;
+        } else if (m > 12) {
+            m -= 12;
+            ++y;
+        }
+        if (day > days_in_month(y, m)) continue;
+        int64_t candidate = days_from_civil(y, m, day) * 86400 + hour * 3600 + minute * 60;
+        if (!best || distance(candidate) < distance(*best)) best = candidate;
+    }
+    return best;
+}
+
+std::vector<TimedReport> merge_metar_sources(const std::vector<std::vector<std::string>>& sources,
+                                             std::time_t reference) {
+    TraceSpan span("merge_metar_sources", "metar");
+    struct Entry {
+        int64_t obs_time;
+        uint64_t hash;
+        const std::string* raw;
+    };
+    // Each source sorted by time (cycle files are nearly sorted already; stable keeps file order on ties).
+    std::vector<std::vector<Entry>> runs(sources.size());
+    size_t total = 0;
+    for (size_t s = 0; s < sources.size(); ++s) {
+        for (const auto& raw : sources[s]) {
+            if (auto key = report_key(raw, reference)) runs[s].push_back({key->obs_time, key->hash, &raw});
+        }
+        std::stable_sort(runs[s].begin(), runs[s].end(),
+                         [](const Entry& a, const Entry& b) { return a.obs_time < b.obs_time; });
+        total += runs[s].size();
+    }
+    // Heap of (time, source, position); ties break by source order so the merge is deterministic.
+    using Cursor = std::tuple<int64_t, size_t, size_t>;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+    for (size_t s = 0; s < runs.size(); ++s) {
+        if (!runs[s].empty()) heap.emplace(runs[s][0].obs_time, s, 0);
+    }
+    std::vector<TimedReport> merged;
+    merged.reserve(total);
+    std::unordered_set<uint64_t> seen;
+    seen.reserve(total);
+    while (!heap.empty()) {
+        auto [time, s, pos] = heap.top();
+        heap.pop();
+        const Entry& e = runs[s][pos];
+        if (seen.insert(e.hash).second) merged.push_back({time, *e.raw});
+        if (pos + 1 < runs[s].size()) heap.emplace(runs[s][pos + 1].obs_time, s, pos + 1);
+    }
+    return merged;
+}
+
+std::optional<WindComponents> compute_wind_components(const WindInfo& wind, int runway_heading_deg) {
+    if (!wind.direction_deg || runway_heading_deg == 0) return std::nullopt;
+    double angle_diff_rad = std::fabs(*wind.direction_deg - runway_heading_deg) * kPi / 180.0;
+    if (angle_diff_rad > kPi) angle_diff_rad = 2 * kPi - angle_diff_rad;
+    double headwind = std::cos(angle_diff_rad) * wind.speed_kt;
+    double crosswind = std::sin(angle_diff_rad) * wind.speed_kt;
+    return WindComponents{headwind, crosswind};
+}
+
+std::optional<std::string> fetch_metar_by_icao(const std::string& icao_raw) {
+    TraceSpan span("fetch_metar_by_icao", "metar", icao_raw);
+    if (icao_raw.size() < 3) return std::nullopt;
+    std::string icao = to_upper(icao_raw);
+    auto output = fetch_first(fetch_source_urls(
+        "metar", "https://tgftp.nws.noaa.gov/data/observations/metar/stations/{ICAO}.TXT", icao));
+    if (!output) return std::nullopt;
+
+    std::istringstream iss(*output);
+    std::string line;
+    std::string last_non_empty;
+    while (std::getline(iss, line)) {
+        line = trim(line);
+        if (!line.empty()) last_non_empty = line;
+    }
+    if (!last_non_empty.empty()) {
+        return last_non_empty;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> fetch_cycle_file(int hour_utc) {
+    char hour_buf[8];
+    std::snprintf(hour_buf, sizeof(hour_buf), "%02d", hour_utc);
+    return fetch_url("https://tgftp.nws.noaa.gov/data/observations/metar/cycles/" + std::string(hour_buf) +
+                     "Z.TXT");
+}
+
+std::vector<std::string> cycle_file_reports(const std::string& text) {
+    TraceSpan span("cycle_file_reports", "metar");
+    std::vector<std::string> reports;
+    for (auto& line : split_lines(text)) {
+        if (!is_cycle_date_line(line)) reports.push_back(std::move(line));
+    }
+    return reports;
+}
+
+bool for_each_cycle_report(const std::string& path, const std::function<void(std::string_view)>& fn) {
+    TraceSpan span("for_each_cycle_report", "metar", path);
+    ChunkedFileReader reader;
+    if (!reader.open(path)) {
+        if (reader.compression() != Compression::kNone) std::cerr << reader.error() << "\n";
+        return false;
+    }
+    bool ok = for_each_line(reader, [&fn](std::string_view line) {
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) line.remove_prefix(1);
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) line.remove_suffix(1);
+        if (!line.empty() && !is_cycle_date_line(line)) fn(line);
+    });
+    if (!ok) {
+        std::cerr << "Failed to decode " << path << ": " << reader.error() << "\n";
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> fetch_cycle_metars_for_hour(const std::string& icao, int hour_utc) {
+    TraceSpan span("fetch_cycle_metars_for_hour", "metar", icao);
+    std::vector<std::string> results;
+    auto content = fetch_cycle_file(hour_utc);
+    if (!content) return results;
+    std::istringstream iss(*content);
+    std::string line;
+    std::string target = to_upper(icao) + " ";
+    while (std::getline(iss, line)) {
+        line = trim(line);
+        // SPECIs (and some METARs) carry their type word before the station.
+        size_t start = line.rfind("SPECI ", 0) == 0 || line.rfind("METAR ", 0) == 0 ? 6 : 0;
+        if (line.compare(start, target.size(), target) == 0) {
+            results.push_back(line);
+        }
+    }
+    return results;
+}
+
+std::vector<std::string> fetch_metars_history(const std::string& icao, int desired_count) {
+    TraceSpan span("fetch_metars_history", "metar", icao);
+    std::vector<std::string> result;
+    if (desired_count <= 0) return result;
+    std::time_t now = cassette_now();
+    // Cycle files are overwritten daily, so hour N and N-24 name the same file.
+    const int max_hours = 24;
+    std::vector<std::vector<std::string>> sources;
+    std::vector<TimedReport> merged;
+    size_t fetched = 0;
+    for (int back = 0; back < max_hours; ++back) {
+        std::time_t t = now - back * 3600;
+        std::tm* gmt = std::gmtime(&t);
+        if (!gmt) break;
+        sources.push_back(fetch_cycle_metars_for_hour(icao, gmt->tm_hour));
+        fetched += sources.back().size();
+        // Only re-merge once the raw count could suffice; duplicates across files may still fall short.
+        if (fetched >= static_cast<size_t>(desired_count)) {
+            merged = merge_metar_sources(sources, now);
+            if (merged.size() >= static_cast<size_t>(desired_count)) break;
+        }
+    }
+    if (fetched < static_cast<size_t>(desired_count)) merged = merge_metar_sources(sources, now);
+    size_t first = merged.size() > static_cast<size_t>(desired_count) ? merged.size() - desired_count : 0;
+    for (size_t i = first; i < merged.size(); ++i) result.push_back(std::move(merged[i].raw));
+    return result;
+}
+
+} // namespace flightsuite
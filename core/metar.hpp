@@ -0,0 +1,114 @@
+// METAR decoding and retrieval (NOAA tgftp station and cycle files).
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flightsuite {
+
+struct WindInfo {
+    std::optional<int> direction_deg; // std::nullopt for VRB
+    int speed_kt = 0;
+    std::optional<int> gust_kt;
+};
+
+struct RunwayVisualRange {
+    std::string runway;             // "04R"
+    int range_ft = 0;               // metric reports are converted
+    std::optional<int> max_range_ft; // "V" variable upper bound
+    char qualifier = 0;             // 'P' above / 'M' below the reportable range, else 0
+    char trend = 0;                 // 'U', 'D', 'N', or 0
+};
+
+struct MetarDecoded {
+    std::string station;
+    std::string timestamp_z;
+    std::optional<int64_t> obs_time; // epoch seconds; set when decoded against a reference time
+    WindInfo wind;
+    std::optional<double> visibility_sm; // from "10SM", or derived from metres / CAVOK
+    std::optional<int> visibility_m;     // metric group as reported ("9999", "0800")
+    std::optional<int> ceiling_ft;
+    std::string ceiling_layer;
+    bool cavok = false;
+    bool no_significant_cloud = false; // NSC, NCD, SKC, CLR (or CAVOK)
+    std::optional<int> temperature_c;
+    std::optional<int> dewpoint_c;
+    std::optional<double> altimeter_inhg; // A2992, or converted from Q1013
+    std::optional<double> altimeter_hpa;  // Q1013, or converted from A2992
+    std::vector<RunwayVisualRange> rvr;
+    std::vector<std::string> weather;
+};
+
+struct WindComponents {
+    double headwind = 0.0;
+    double crosswind = 0.0;
+};
+
+// Decodes the body of a METAR/SPECI (ICAO or FAA format) up to RMK or a trend group (TEMPO, BECMG,
+// NOSIG): each token is classified once against a table of group shapes. With a non-zero
+// `reference` time, `obs_time` is resolved from the DDHHMMZ group (see resolve_obs_time).
+MetarDecoded decode_metar(const std::string& raw, std::time_t reference = 0);
+
+// What a single (upper-case, '='-stripped) body token is; decode_metar dispatches on this.
+enum class MetarGroup : uint8_t {
+    kUnknown,
+    kEnd,        // RMK, TEMPO, BECMG, NOSIG: the observed body stops here
+    kWind,       // 18012G18KT, VRB03KT, 24005MPS
+    kWindVar,    // 180V240
+    kVisSm,      // 10SM, 1/2SM, M1/4SM, P6SM
+    kVisMetres,  // 9999, 0800, 4000NE, 1500NDV
+    kCavok,
+    kRvr,        // R04R/2200FT, R24/P1500U, R06/0600V1000FT
+    kCloud,      // FEW020, BKN025CB, OVC///
+    kVertVis,    // VV002
+    kNoCloud,    // NSC, NCD, SKC, CLR
+    kTempDew,    // 18/12, M05/M10, 05/
+    kAltInHg,    // A2992
+    kAltHpa,     // Q1013
+    kWeather,    // -RA, +TSRA, VCSH, FZFG
+    kCount,
+};
+
+MetarGroup classify_metar_group(std::string_view token);
+
+// "DDHHMMZ" as epoch seconds. The report carries no month or year, so of the months around the
+// reference's, the candidate closest to `reference` (and not more than a day after it) wins; a
+// 312355Z report read at 0005Z on the 1st lands on the 31st of the previous month.
+std::optional<int64_t> resolve_obs_time(const std::string& ddhhmmz, std::time_t reference);
+
+struct TimedReport {
+    int64_t obs_time = 0;
+    std::string raw;
+};
+
+// Merges per-source report lists (e.g. one per cycle file) into one list ordered by observation
+// time with a k-way heap merge. Reports with the same station, time, and body (ignoring spacing
+// and the '=' terminator) are kept once; reports without a resolvable time are dropped.
+std::vector<TimedReport> merge_metar_sources(const std::vector<std::vector<std::string>>& sources,
+                                             std::time_t reference);
+
+// Headwind/crosswind vs a runway heading; nullopt for variable wind or no runway (0).
+std::optional<WindComponents> compute_wind_components(const WindInfo& wind, int runway_heading_deg);
+
+// Latest report for one station, or nullopt if the fetch failed.
+std::optional<std::string> fetch_metar_by_icao(const std::string& icao_raw);
+// The whole NOAA cycle file for `hour_utc` (every station reporting that hour).
+std::optional<std::string> fetch_cycle_file(int hour_utc);
+// The report lines of a cycle file, skipping its "YYYY/MM/DD HH:MM" date lines.
+std::vector<std::string> cycle_file_reports(const std::string& text);
+// The same for a cycle file or archive on disk (plain, gzip, or zstd): each report line goes to
+// `fn` as its chunk decodes, and nothing else of the file is held. False if it cannot be opened or
+// decoded (reports before the failure have been delivered).
+bool for_each_cycle_report(const std::string& path, const std::function<void(std::string_view)>& fn);
+// All reports for `icao` in the hourly cycle file for `hour_utc`.
+std::vector<std::string> fetch_cycle_metars_for_hour(const std::string& icao, int hour_utc);
+// Up to `desired_count` most recent reports in observation-time order (oldest first), walking back
+// through the cycle files and merging them.
+std::vector<std::string> fetch_metars_history(const std::string& icao, int desired_count);
+
+} // namespace flightsuite
@@ -0,0 +1,272 @@
+#include "core/montecarlo.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include "core/alloc_stats.hpp"
+#include "core/geo.hpp"
+#include "core/ofp.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr double kMinGroundspeedKt = 10.0;
+constexpr size_t kChunkTrials = 4096;
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"): a keyed bijection
+// on 128-bit counters, so draw `n` of trial `t` is a pure function of (seed, t, n).
+std::array<uint32_t, 4> philox(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> key) {
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+        ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(p1),
+               static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(p0)};
+    }
+    return ctr;
+}
+
+// Four standard normals (two Box-Muller pairs) from one counter. Single precision is ample: the
+// 24-bit uniforms reach 5.9 sigma, far past the 99th percentile, at two thirds of the cost.
+std::array<double, 4> normals(uint64_t seed, uint64_t trial, uint32_t draw) {
+    auto r = philox({static_cast<uint32_t>(trial), static_cast<uint32_t>(trial >> 32), draw, 0},
+                    {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)});
+    auto uniform = [](uint32_t x) { return (static_cast<float>(x >> 8) + 0.5f) * (1.0f / 16777216.0f); };
+    std::array<double, 4> out;
+    for (int i = 0; i < 4; i += 2) {
+        float radius = std::sqrt(-2.0f * std::log(uniform(r[i])));
+        float angle = 2.0f * static_cast<float>(kPi) * uniform(r[i + 1]);
+        out[i] = radius * std::cos(angle);
+        out[i + 1] = radius * std::sin(angle);
+    }
+    return out;
+}
+
+// A leg reduced to what a trial needs: the wind as an east/north vector it blows toward.
+struct PreparedLeg {
+    double distance_nm, sin_course, cos_course;
+    double wind_u, wind_v;
+    double tas_kt, temp_k, fuel_flow;
+};
+
+PreparedLeg prepare(const TripLeg& leg) {
+    double crs = deg2rad(leg.course_deg), wdir = deg2rad(leg.wind_dir_deg);
+    return {leg.distance_nm,
+            std::sin(crs),
+            std::cos(crs),
+            -leg.wind_kt * std::sin(wdir),
+            -leg.wind_kt * std::cos(wdir),
+            leg.tas_kt,
+            leg.oat_c + 273.15,
+            leg.fuel_flow};
+}
+
+// Adds the leg's minutes and fuel; false when it is not flyable as perturbed (the time then uses
+// the ground-speed floor so the trial still has a value).
+bool fly(const PreparedLeg& leg, double du, double dv, double dt, double dflow, double& minutes, double& fuel) {
+    double u = leg.wind_u + du, v = leg.wind_v + dv;
+    double tas = leg.tas_kt * std::sqrt(std::max(leg.temp_k + dt, 1.0) / leg.temp_k);
+    double along = u * leg.sin_course + v * leg.cos_course; // tailwind positive
+    double cross = u * leg.cos_course - v * leg.sin_course;
+    double lateral = tas * tas - cross * cross;
+    double gs = along + std::sqrt(std::max(lateral, 0.0));
+    bool ok = lateral > 0.0 && gs >= kMinGroundspeedKt;
+    double m = leg.distance_nm / std::max(gs, kMinGroundspeedKt) * 60.0;
+    minutes += m;
+    fuel += leg.fuel_flow * std::max(0.0, 1.0 + dflow) * m / 60.0;
+    return ok;
+}
+
+Spread spread_of(std::vector<double>& values, double planned) {
+    Spread s;
+    s.planned = planned;
+    if (values.empty()) return s;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    s.mean = sum / static_cast<double>(values.size());
+    double sq = 0.0;
+    for (double v : values) sq += (v - s.mean) * (v - s.mean);
+    s.stddev = std::sqrt(sq / static_cast<double>(values.size()));
+    std::sort(values.begin(), values.end());
+    auto pct = [&](double p) {
+        double pos = p / 100.0 * static_cast<double>(values.size() - 1);
+        size_t lo = static_cast<size_t>(pos);
+        size_t hi = std::min(lo + 1, values.size() - 1);
+        return values[lo] + (values[hi] - values[lo]) * (pos - static_cast<double>(lo));
+    };
+    s.p05 = pct(5.0);
+    s.p50 = pct(50.0);
+    s.p90 = pct(90.0);
+    s.p95 = pct(95.0);
+    s.p99 = pct(99.0);
+    s.max = values.back();
+    return s;
+}
+
+} // namespace
+
+double planned_trip_minutes(const std::vector<TripLeg>& legs) {
+    double minutes = 0.0, fuel = 0.0;
+    for (const auto& leg : legs) fly(prepare(leg), 0.0, 0.0, 0.0, 0.0, minutes, fuel);
+    return minutes;
+}
+
+double planned_trip_fuel(const std::vector<TripLeg>& legs) {
+    double minutes = 0.0, fuel = 0.0;
+    for (const auto& leg : legs) fly(prepare(leg), 0.0, 0.0, 0.0, 0.0, minutes, fuel);
+    return fuel;
+}
+
+MonteCarloResult run_trip_montecarlo(const std::vector<TripLeg>& legs, const MonteCarloOptions& opt) {
+    TraceSpan span("trip_montecarlo", "montecarlo", [&] { return std::to_string(opt.trials) + " trials"; });
+    MonteCarloResult out;
+    out.trials = opt.trials;
+    std::vector<PreparedLeg> prepared;
+    prepared.reserve(legs.size());
+    for (const auto& leg : legs) prepared.push_back(prepare(leg));
+
+    // Per-trial results land in trial order, so neither the threads nor the chunking show in them.
+    std::vector<double> minutes(opt.trials), fuel(opt.trials);
+    const TripUncertainty& sd = opt.sd;
+    const double shared = std::sqrt(std::clamp(sd.correlation, 0.0, 1.0));
+    const double own = std::sqrt(1.0 - shared * shared);
+    const size_t chunks = (opt.trials + kChunkTrials - 1) / kChunkTrials;
+
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(chunks, 1)));
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<size_t> unflyable{0};
+    auto worker = [&](unsigned n) {
+        AllocStageScope stage(AllocStage::kAnalyze);
+        if (threads > 1) trace_set_thread_name("montecarlo worker " + std::to_string(n));
+        size_t bad = 0;
+        for (size_t c; (c = next_chunk.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+            size_t end = std::min(opt.trials, (c + 1) * kChunkTrials);
+            for (size_t t = c * kChunkTrials; t < end; ++t) {
+                auto common = normals(opt.seed, t, 0);
+                double m = 0.0, f = 0.0;
+                bool ok = true;
+                for (size_t i = 0; i < prepared.size(); ++i) {
+                    auto z = normals(opt.seed, t, static_cast<uint32_t>(i + 1));
+                    ok &= fly(prepared[i], sd.wind_sd_kt * (shared * common[0] + own * z[0]),
+                              sd.wind_sd_kt * (shared * common[1] + own * z[1]),
+                              sd.oat_sd_c * (shared * common[2] + own * z[2]),
+                              sd.fuel_flow_sd * (shared * common[3] + own * z[3]), m, f);
+                }
+                minutes[t] = m;
+                fuel[t] = f;
+                bad += !ok;
+            }
+        }
+        unflyable.fetch_add(bad, std::memory_order_relaxed);
+    };
+    if (threads <= 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+        for (auto& t : pool) t.join();
+    }
+
+    out.unflyable = unflyable.load();
+    out.minutes = spread_of(minutes, planned_trip_minutes(legs));
+    out.fuel = spread_of(fuel, planned_trip_fuel(legs));
+    return out;
+}
+
+std::vector<TripLeg> trip_legs_from_ofp(const std::string& content, double tas_kt, double fuel_flow) {
+    TraceSpan span("trip_legs_from_ofp", "montecarlo");
+    struct Point {
+        double lat, lon, wind_u, wind_v, oat_c;
+    };
+    std::vector<Point> points;
+    size_t pos = content.find("<navlog>");
+    while (pos != std::string::npos) {
+        size_t start = content.find("<fix>", pos);
+        if (start == std::string::npos) break;
+        size_t end = content.find("</fix>", start);
+        if (end == std::string::npos) break;
+        std::string block = content.substr(start, end - start);
+        pos = end;
+        auto lat = tag_in_block(block, "pos_lat"), lon = tag_in_block(block, "pos_long");
+        if (!lat || !lon) continue;
+        double dir = parse_double(tag_in_block(block, "wind_dir").value_or("")).value_or(0.0);
+        double spd = parse_double(tag_in_block(block, "wind_spd").value_or("")).value_or(0.0);
+        double oat = parse_double(tag_in_block(block, "oat").value_or("")).value_or(15.0);
+        points.push_back({parse_latlon(*lat), parse_latlon(*lon), -spd * std::sin(deg2rad(dir)),
+                          -spd * std::cos(deg2rad(dir)), oat});
+    }
+    std::vector<TripLeg> legs;
+    for (size_t i = 1; i < points.size(); ++i) {
+        const Point &a = points[i - 1], &b = points[i];
+        TripLeg leg;
+        leg.distance_nm = haversine_nm(a.lat, a.lon, b.lat, b.lon);
+        if (leg.distance_nm < 0.01) continue;
+        leg.course_deg = initial_course_deg(a.lat, a.lon, b.lat, b.lon);
+        double u = (a.wind_u + b.wind_u) / 2.0, v = (a.wind_v + b.wind_v) / 2.0;
+        leg.wind_kt = std::hypot(u, v);
+        leg.wind_dir_deg = leg.wind_kt > 0.0 ? std::fmod(rad2deg(std::atan2(-u, -v)) + 360.0, 360.0) : 0.0;
+        leg.oat_c = (a.oat_c + b.oat_c) / 2.0;
+        leg.tas_kt = tas_kt;
+        leg.fuel_flow = fuel_flow;
+        legs.push_back(leg);
+    }
+    return legs;
+}
+
+bool calibrate_trip_tas(std::vector<TripLeg>& legs, double target_minutes) {
+    auto minutes_at = [&](double tas) {
+        for (auto& leg : legs) leg.tas_kt = tas;
+        return planned_trip_minutes(legs);
+    };
+    double lo = 40.0, hi = 700.0;
+    if (legs.empty() || minutes_at(lo) < target_minutes || minutes_at(hi) > target_minutes) return false;
+    for (int i = 0; i < 60; ++i) {
+        double mid = (lo + hi) / 2.0;
+        (minutes_at(mid) > target_minutes ? lo : hi) = mid;
+    }
+    minutes_at((lo + hi) / 2.0);
+    return true;
+}
+
+std::vector<TripLeg> load_trip_legs(const std::string& path) {
+    TraceSpan span("load_trip_legs", "montecarlo", path);
+    std::vector<TripLeg> legs;
+    std::vector<std::string> lines;
+    if (!read_file_lines(path, lines)) {
+        std::cerr << "Failed to open legs file: " << path << "\n";
+        return legs;
+    }
+    for (const auto& line : lines) {
+        if (line.empty() || line[0] == '#') continue;
+        auto cells = split_csv_line(line);
+        if (cells.size() < 3) continue;
+        TripLeg leg;
+        double* fields[] = {&leg.distance_nm, &leg.course_deg, &leg.tas_kt, &leg.wind_dir_deg,
+                            &leg.wind_kt,     &leg.oat_c,      &leg.fuel_flow};
+        bool ok = true;
+        for (size_t i = 0; i < cells.size() && i < 7; ++i) {
+            if (cells[i].empty()) continue;
+            auto v = parse_double(cells[i]);
+            if (!v) {
+                ok = false;
+                break;
+            }
+            *fields[i] = *v;
+        }
+        if (ok && leg.distance_nm > 0.0 && leg.tas_kt > 0.0) legs.push_back(leg);
+    }
+    return legs;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,71 @@
+// Monte Carlo trip-time and fuel uncertainty for a planned sequence of legs (an OFP navlog or a
+// leg list). Each trial perturbs the forecast wind vector, temperature, and fuel flow on every leg,
+// partly shared across the trial and partly per leg, and flies the legs through the wind triangle.
+// Random numbers come from a counter-based generator keyed by (seed, trial, draw), so any thread
+// can run any trial and the result depends only on the seed and trial count.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flightsuite {
+
+struct TripLeg {
+    double distance_nm = 0.0;
+    double course_deg = 0.0;   // true
+    double tas_kt = 0.0;       // at the forecast temperature
+    double wind_dir_deg = 0.0; // forecast, from
+    double wind_kt = 0.0;
+    double oat_c = 15.0;
+    double fuel_flow = 0.0; // per hour, in whatever unit the report should carry
+};
+
+struct TripUncertainty {
+    double wind_sd_kt = 10.0;   // per vector component
+    double oat_sd_c = 2.0;      // TAS follows the speed of sound (Mach-hold cruise)
+    double fuel_flow_sd = 0.03; // fraction of planned flow
+    double correlation = 0.5;   // share of each variance common to every leg of a trial
+};
+
+struct MonteCarloOptions {
+    size_t trials = 200000;
+    unsigned threads = 0; // 0 = hardware concurrency
+    uint64_t seed = 1;
+    TripUncertainty sd;
+};
+
+struct Spread {
+    double planned = 0.0; // the deterministic forecast
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p05 = 0.0, p50 = 0.0, p90 = 0.0, p95 = 0.0, p99 = 0.0;
+    double max = 0.0;
+};
+
+struct MonteCarloResult {
+    size_t trials = 0;
+    Spread minutes;
+    Spread fuel;
+    size_t unflyable = 0; // trials with a leg where the crosswind beat TAS or ground speed fell under 10 kt
+};
+
+// Airborne minutes and fuel along the legs with no perturbation.
+double planned_trip_minutes(const std::vector<TripLeg>& legs);
+double planned_trip_fuel(const std::vector<TripLeg>& legs);
+
+MonteCarloResult run_trip_montecarlo(const std::vector<TripLeg>& legs, const MonteCarloOptions& opt);
+
+// One leg per pair of consecutive `<fix>` entries in an OFP navlog, with the wind and OAT averaged
+// between the two fixes. `tas_kt` and `fuel_flow` apply to every leg.
+std::vector<TripLeg> trip_legs_from_ofp(const std::string& content, double tas_kt, double fuel_flow);
+
+// The uniform TAS that makes the planned time `target_minutes`; sets it on every leg. Returns
+// false when no TAS between 40 and 700 kt does.
+bool calibrate_trip_tas(std::vector<TripLeg>& legs, double target_minutes);
+
+// CSV columns: distance_nm,course_deg,tas_kt,wind_dir_deg,wind_kt,oat_c,fuel_flow ('#' comments).
+std::vector<TripLeg> load_trip_legs(const std::string& path);
+
+} // namespace flightsuite
@@ -0,0 +1,774 @@
+#include "core/navdata.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/airports.hpp"
+#include "core/compress.hpp"
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+// On-disk layout. Every section starts 8-byte aligned; records are stored in host byte order and
+// open() rejects files written on a machine with the other endianness.
+struct NavDatabase::Header {
+    char magic[8];
+    uint32_t endian;
+    uint32_t version;
+    uint32_t point_count;
+    uint32_t edge_count;
+    uint32_t airway_count;
+    uint32_t ident_slot_count;   // power of two
+    uint32_t airway_slot_count;  // power of two
+    uint32_t airway_point_count;
+    uint64_t strings_size;
+    uint64_t file_size;
+    uint64_t off_points;
+    uint64_t off_ident_slots;
+    uint64_t off_spatial;
+    uint64_t off_edge_offsets; // point_count + 1 entries
+    uint64_t off_edges;
+    uint64_t off_airways;
+    uint64_t off_airway_slots;
+    uint64_t off_airway_point_offsets; // airway_count + 1 entries
+    uint64_t off_airway_points;
+    uint64_t off_strings;
+};
+
+struct NavDatabase::PointRecord {
+    double lat;
+    double lon;
+    float freq;
+    uint32_t ident_off;
+    uint32_t region_off;
+    uint32_t name_off;
+    uint16_t name_len;
+    uint8_t ident_len;
+    uint8_t region_len;
+    uint8_t kind;
+    uint8_t reserved[7];
+};
+
+struct NavDatabase::AirwayRecord {
+    uint32_t name_off;
+    uint32_t name_len;
+};
+
+namespace {
+
+using Header = NavDatabase::Header;
+using PointRecord = NavDatabase::PointRecord;
+using AirwayRecord = NavDatabase::AirwayRecord;
+
+constexpr char kMagic[8] = {'F', 'S', 'N', 'A', 'V', '0', '0', '1'};
+constexpr uint32_t kEndianTag = 0x01020304;
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+
+static_assert(sizeof(PointRecord) == 48, "PointRecord layout is part of the file format");
+static_assert(sizeof(NavEdge) == 20, "NavEdge layout is part of the file format");
+static_assert(sizeof(SpatialNode) == 32, "SpatialNode layout is part of the file format");
+
+uint32_t fnv1a(std::string_view s) {
+    uint32_t h = 2166136261u;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t slot_count_for(size_t keys) {
+    uint32_t n = 16;
+    while (n < keys * 2) n <<= 1;
+    return n;
+}
+
+uint64_t align8(uint64_t v) { return (v + 7) & ~uint64_t{7}; }
+
+std::vector<std::string_view> fields(std::string_view line) {
+    std::vector<std::string_view> out;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+        size_t start = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t') ++i;
+        if (i > start) out.push_back(line.substr(start, i - start));
+    }
+    return out;
+}
+
+bool parse_double(std::string_view s, double& out) {
+    std::string tmp(s);
+    char* end = nullptr;
+    out = std::strtod(tmp.c_str(), &end);
+    return end && *end == '\0' && !tmp.empty();
+}
+
+bool parse_int(std::string_view s, int& out) {
+    double d;
+    if (!parse_double(s, d) || d != std::floor(d)) return false;
+    out = static_cast<int>(d);
+    return true;
+}
+
+// Header ("I"/"A", the version line), blank, and end ("99") lines carry no records.
+bool is_preamble(std::string_view line, size_t line_no) {
+    if (line_no < 2) return true;
+    auto f = fields(line);
+    return f.empty() || (f.size() == 1 && f[0] == "99");
+}
+
+struct RawPoint {
+    std::string ident;
+    std::string region;
+    std::string name;
+    NavKind kind;
+    double lat;
+    double lon;
+    double freq;
+};
+
+struct RawSegment {
+    uint32_t from;
+    uint32_t to;
+    std::string airway;
+    uint16_t base_fl;
+    uint16_t top_fl;
+    AirwayLevel level;
+};
+
+// earth_fix.dat rows: lat lon ident [terminal-area region type]. Terminal-area fixes only serve
+// procedures, which the database does not carry.
+bool read_fixes(const std::string& path, std::vector<RawPoint>& out, NavCompileStats& stats, std::string* error) {
+    ChunkedFileReader reader;
+    if (!reader.open(path)) {
+        *error = "cannot read " + path + (reader.error().empty() ? "" : ": " + reader.error());
+        return false;
+    }
+    size_t line_no = 0;
+    bool ok = for_each_line(reader, [&](std::string_view line) {
+        if (is_preamble(line, line_no++)) return;
+        auto f = fields(line);
+        double lat, lon;
+        if (f.size() < 3 || !parse_double(f[0], lat) || !parse_double(f[1], lon)) {
+            ++stats.skipped_lines;
+            return;
+        }
+        if (f.size() >= 5 && f[3] != "ENRT") return;
+        out.push_back({std::string(f[2]), f.size() >= 5 ? std::string(f[4]) : "", "", NavKind::kFix, lat, lon, 0.0});
+        ++stats.fixes;
+    });
+    if (!ok) *error = path + ": " + reader.error();
+    return ok;
+}
+
+// earth_nav.dat rows: code lat lon elev freq range var ident terminal-area region name...
+// Codes 2 (NDB), 3 (VOR) and 13 (standalone DME) are en-route navaids; ILS components and the
+// DME half of a VOR/DME (12) are left out.
+bool read_navaids(const std::string& path, std::vector<RawPoint>& out, NavCompileStats& stats, std::string* error) {
+    ChunkedFileReader reader;
+    if (!reader.open(path)) {
+        *error = "cannot read " + path + (reader.error().empty() ? "" : ": " + reader.error());
+        return false;
+    }
+    size_t line_no = 0;
+    bool ok = for_each_line(reader, [&](std::string_view line) {
+        if (is_preamble(line, line_no++)) return;
+        auto f = fields(line);
+        int code;
+        if (f.empty() || !parse_int(f[0], code)) {
+            ++stats.skipped_lines;
+            return;
+        }
+        NavKind kind;
+        if (code == 2) {
+            kind = NavKind::kNdb;
+        } else if (code == 3) {
+            kind = NavKind::kVor;
+        } else if (code == 13) {
+            kind = NavKind::kDme;
+        } else {
+            return;
+        }
+        double lat, lon, freq;
+        if (f.size() < 11 || !parse_double(f[1], lat) || !parse_double(f[2], lon) || !parse_double(f[4], freq)) {
+            ++stats.skipped_lines;
+            return;
+        }
+        std::string name;
+        for (size_t i = 10; i < f.size(); ++i) {
+            if (!name.empty()) name += ' ';
+            name += f[i];
+        }
+        // VOR and DME frequencies are listed in units of 10 kHz.
+        if (kind != NavKind::kNdb) freq /= 100.0;
+        out.push_back({std::string(f[7]), std::string(f[9]), name, kind, lat, lon, freq});
+        ++stats.navaids;
+    });
+    if (!ok) *error = path + ": " + reader.error();
+    return ok;
+}
+
+std::string point_key(std::string_view ident, std::string_view region, NavKind kind) {
+    std::string key(ident);
+    key += '|';
+    key += region;
+    key += '|';
+    key += static_cast<char>('0' + static_cast<int>(kind));
+    return key;
+}
+
+// earth_awy.dat rows: ident region type ident region type direction level base top NAME[-NAME...]
+// where type is 11 (fix), 2 (NDB) or 3 (VOR), direction is N (both ways), F (forward only) or
+// B (backward only), and level is 1 (low) or 2 (high). A segment shared by several airways
+// names them all, joined with '-'.
+bool read_airways(const std::string& path, const std::unordered_map<std::string, uint32_t>& by_key,
+                  std::vector<RawSegment>& out, NavCompileStats& stats, std::string* error) {
+    ChunkedFileReader reader;
+    if (!reader.open(path)) {
+        *error = "cannot read " + path + (reader.error().empty() ? "" : ": " + reader.error());
+        return false;
+    }
+    auto lookup = [&by_key](std::string_view ident, std::string_view region, int type) -> std::optional<uint32_t> {
+        NavKind kinds[2] = {NavKind::kFix, NavKind::kFix};
+        size_t n = 1;
+        if (type == 2) {
+            kinds[0] = NavKind::kNdb;
+        } else if (type == 3) {
+            kinds[0] = NavKind::kVor;
+            kinds[1] = NavKind::kDme;
+            n = 2;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            auto it = by_key.find(point_key(ident, region, kinds[i]));
+            if (it != by_key.end()) return it->second;
+        }
+        return std::nullopt;
+    };
+    size_t line_no = 0;
+    bool ok = for_each_line(reader, [&](std::string_view line) {
+        if (is_preamble(line, line_no++)) return;
+        auto f = fields(line);
+        int type1, type2, level, base, top;
+        if (f.size() < 11 || !parse_int(f[2], type1) || !parse_int(f[5], type2) || f[6].size() != 1 ||
+            !parse_int(f[7], level) || !parse_int(f[8], base) || !parse_int(f[9], top)) {
+            ++stats.skipped_lines;
+            return;
+        }
+        auto a = lookup(f[0], f[1], type1);
+        auto b = lookup(f[3], f[4], type2);
+        if (!a || !b || *a == *b) {
+            ++stats.unresolved_segments;
+            return;
+        }
+        char dir = f[6][0];
+        AirwayLevel lvl = level == 2 ? AirwayLevel::kHigh : AirwayLevel::kLow;
+        std::string_view names = f[10];
+        size_t pos = 0;
+        while (pos <= names.size()) {
+            size_t dash = names.find('-', pos);
+            if (dash == std::string_view::npos) dash = names.size();
+            std::string name(names.substr(pos, dash - pos));
+            pos = dash + 1;
+            if (name.empty()) continue;
+            auto fl = [](int v) { return static_cast<uint16_t>(std::clamp(v, 0, 999)); };
+            if (dir != 'B') out.push_back({*a, *b, name, fl(base), fl(top), lvl});
+            if (dir != 'F') out.push_back({*b, *a, name, fl(base), fl(top), lvl});
+        }
+    });
+    if (!ok) *error = path + ": " + reader.error();
+    return ok;
+}
+
+// Orders one airway's points along it: each connected piece is walked depth-first from one of its
+// ends, so a simple chain comes out end to end.
+void order_airway(std::vector<std::pair<uint32_t, uint32_t>>& undirected, std::vector<uint32_t>& out) {
+    std::map<uint32_t, std::vector<uint32_t>> adj;
+    for (auto [a, b] : undirected) {
+        adj[a].push_back(b);
+        adj[b].push_back(a);
+    }
+    for (auto& [id, next] : adj) {
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+    }
+    std::map<uint32_t, bool> seen;
+    auto walk = [&](uint32_t start) {
+        std::vector<uint32_t> stack{start};
+        while (!stack.empty()) {
+            uint32_t id = stack.back();
+            stack.pop_back();
+            if (seen[id]) continue;
+            seen[id] = true;
+            out.push_back(id);
+            const auto& next = adj[id];
+            for (auto it = next.rbegin(); it != next.rend(); ++it) {
+                if (!seen[*it]) stack.push_back(*it);
+            }
+        }
+    };
+    for (auto& [id, next] : adj) {
+        if (next.size() == 1 && !seen[id]) walk(id);
+    }
+    for (auto& [id, next] : adj) {
+        if (!seen[id]) walk(id);
+    }
+}
+
+class StringTable {
+public:
+    uint32_t add(const std::string& s) {
+        auto it = offsets_.find(s);
+        if (it != offsets_.end()) return it->second;
+        uint32_t off = static_cast<uint32_t>(data_.size());
+        data_ += s;
+        offsets_.emplace(s, off);
+        return off;
+    }
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+    std::unordered_map<std::string, uint32_t> offsets_;
+};
+
+} // namespace
+
+const char* nav_kind_name(NavKind kind) {
+    switch (kind) {
+    case NavKind::kFix: return "fix";
+    case NavKind::kVor: return "vor";
+    case NavKind::kNdb: return "ndb";
+    case NavKind::kDme: return "dme";
+    case NavKind::kAirport: return "airport";
+    }
+    return "?";
+}
+
+bool compile_navdata(const NavSources& sources, const std::string& out_path, NavCompileStats* stats_out,
+                     std::string* error) {
+    TraceSpan span("compile_navdata", "navdata", out_path);
+    std::string local_error;
+    if (!error) error = &local_error;
+    NavCompileStats stats;
+
+    std::vector<RawPoint> raw;
+    if (!sources.fix_path.empty() && !read_fixes(sources.fix_path, raw, stats, error)) return false;
+    if (!sources.nav_path.empty() && !read_navaids(sources.nav_path, raw, stats, error)) return false;
+    if (!sources.airports_path.empty()) {
+        auto airports = load_airports(sources.airports_path);
+        if (airports.empty()) {
+            *error = "no airports in " + sources.airports_path;
+            return false;
+        }
+        for (const auto& a : airports) raw.push_back({a.icao, "", a.name, NavKind::kAirport, a.lat, a.lon, 0.0});
+        stats.airports = airports.size();
+    }
+    if (raw.empty()) {
+        *error = "no fixes, navaids, or airports in the sources";
+        return false;
+    }
+    // Same-named points end up adjacent, so one hash slot per ident covers them all.
+    std::sort(raw.begin(), raw.end(), [](const RawPoint& a, const RawPoint& b) {
+        if (a.ident != b.ident) return a.ident < b.ident;
+        if (a.kind != b.kind) return a.kind < b.kind;
+        if (a.region != b.region) return a.region < b.region;
+        if (a.lat != b.lat) return a.lat < b.lat;
+        return a.lon < b.lon;
+    });
+    if (raw.size() >= kEmptySlot) {
+        *error = "too many points";
+        return false;
+    }
+    const uint32_t n_points = static_cast<uint32_t>(raw.size());
+
+    std::vector<RawSegment> segments;
+    if (!sources.awy_path.empty()) {
+        std::unordered_map<std::string, uint32_t> by_key;
+        by_key.reserve(raw.size());
+        for (uint32_t i = 0; i < n_points; ++i) by_key.emplace(point_key(raw[i].ident, raw[i].region, raw[i].kind), i);
+        if (!read_airways(sources.awy_path, by_key, segments, stats, error)) return false;
+    }
+
+    // Airways get ids in name order; directed edges are grouped by source point (CSR).
+    std::map<std::string, uint32_t> airway_ids;
+    for (const auto& s : segments) airway_ids.emplace(s.airway, 0);
+    uint32_t next_airway = 0;
+    for (auto& [name, id] : airway_ids) id = next_airway++;
+    std::vector<std::pair<uint32_t, NavEdge>> directed;
+    directed.reserve(segments.size());
+    for (const auto& s : segments) {
+        NavEdge e{};
+        e.to = s.to;
+        e.airway = airway_ids[s.airway];
+        e.distance_nm = static_cast<float>(haversine_nm(raw[s.from].lat, raw[s.from].lon, raw[s.to].lat, raw[s.to].lon));
+        e.base_fl = s.base_fl;
+        e.top_fl = s.top_fl;
+        e.level = s.level;
+        directed.emplace_back(s.from, e);
+    }
+    std::sort(directed.begin(), directed.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) return a.first < b.first;
+        if (a.second.airway != b.second.airway) return a.second.airway < b.second.airway;
+        return a.second.to < b.second.to;
+    });
+    directed.erase(std::unique(directed.begin(), directed.end(),
+                               [](const auto& a, const auto& b) {
+                                   return a.first == b.first && a.second.airway == b.second.airway &&
+                                          a.second.to == b.second.to;
+                               }),
+                   directed.end());
+    std::vector<uint32_t> edge_offsets(n_points + 1, 0);
+    std::vector<NavEdge> edges;
+    edges.reserve(directed.size());
+    for (const auto& [from, e] : directed) {
+        ++edge_offsets[from + 1];
+        edges.push_back(e);
+    }
+    for (uint32_t i = 0; i < n_points; ++i) edge_offsets[i + 1] += edge_offsets[i];
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> airway_segments(airway_ids.size());
+    for (const auto& [from, e] : directed) airway_segments[e.airway].emplace_back(std::min(from, e.to), std::max(from, e.to));
+    std::vector<uint32_t> airway_point_offsets{0};
+    std::vector<uint32_t> airway_points;
+    for (auto& segs : airway_segments) {
+        order_airway(segs, airway_points);
+        airway_point_offsets.push_back(static_cast<uint32_t>(airway_points.size()));
+    }
+
+    StringTable strings;
+    std::vector<PointRecord> points(n_points);
+    std::vector<GeoPoint> geo(n_points);
+    std::memset(points.data(), 0, points.size() * sizeof(PointRecord));
+    for (uint32_t i = 0; i < n_points; ++i) {
+        const RawPoint& r = raw[i];
+        PointRecord& p = points[i];
+        p.lat = r.lat;
+        p.lon = r.lon;
+        p.freq = static_cast<float>(r.freq);
+        p.ident_off = strings.add(r.ident);
+        p.ident_len = static_cast<uint8_t>(std::min<size_t>(r.ident.size(), 255));
+        p.region_off = strings.add(r.region);
+        p.region_len = static_cast<uint8_t>(std::min<size_t>(r.region.size(), 255));
+        p.name_off = strings.add(r.name);
+        p.name_len = static_cast<uint16_t>(std::min<size_t>(r.name.size(), 65535));
+        p.kind = static_cast<uint8_t>(r.kind);
+        geo[i] = {r.lat, r.lon};
+    }
+    std::vector<AirwayRecord> airways;
+    for (const auto& [name, id] : airway_ids) airways.push_back({strings.add(name), static_cast<uint32_t>(name.size())});
+
+    // Open-addressed hashes with linear probing; a slot holds the first id of its ident's run.
+    size_t distinct = 0;
+    for (uint32_t i = 0; i < n_points; ++i) distinct += i == 0 || raw[i].ident != raw[i - 1].ident;
+    std::vector<uint32_t> ident_slots(slot_count_for(distinct), kEmptySlot);
+    for (uint32_t i = 0; i < n_points; ++i) {
+        if (i > 0 && raw[i].ident == raw[i - 1].ident) continue;
+        uint32_t mask = static_cast<uint32_t>(ident_slots.size()) - 1;
+        uint32_t s = fnv1a(raw[i].ident) & mask;
+        while (ident_slots[s] != kEmptySlot) s = (s + 1) & mask;
+        ident_slots[s] = i;
+    }
+    std::vector<uint32_t> airway_slots(slot_count_for(airways.size()), kEmptySlot);
+    for (const auto& [name, id] : airway_ids) {
+        uint32_t mask = static_cast<uint32_t>(airway_slots.size()) - 1;
+        uint32_t s = fnv1a(name) & mask;
+        while (airway_slots[s] != kEmptySlot) s = (s + 1) & mask;
+        airway_slots[s] = id;
+    }
+
+    // Copy the tree field by field into zeroed records so padding bytes are deterministic.
+    SpatialIndex tree(geo);
+    std::vector<SpatialNode> nodes(tree.size());
+    std::memset(nodes.data(), 0, nodes.size() * sizeof(SpatialNode));
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const SpatialNode& src = tree.nodes()[i];
+        std::copy(src.xyz, src.xyz + 3, nodes[i].xyz);
+        nodes[i].id = src.id;
+        nodes[i].axis = src.axis;
+    }
+
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.endian = kEndianTag;
+    h.version = kVersion;
+    h.point_count = n_points;
+    h.edge_count = static_cast<uint32_t>(edges.size());
+    h.airway_count = static_cast<uint32_t>(airways.size());
+    h.ident_slot_count = static_cast<uint32_t>(ident_slots.size());
+    h.airway_slot_count = static_cast<uint32_t>(airway_slots.size());
+    h.airway_point_count = static_cast<uint32_t>(airway_points.size());
+    h.strings_size = strings.data().size();
+    uint64_t off = align8(sizeof(Header));
+    auto place = [&off](uint64_t& field, uint64_t bytes) {
+        field = off;
+        off = align8(off + bytes);
+    };
+    place(h.off_points, points.size() * sizeof(PointRecord));
+    place(h.off_ident_slots, ident_slots.size() * sizeof(uint32_t));
+    place(h.off_spatial, nodes.size() * sizeof(SpatialNode));
+    place(h.off_edge_offsets, edge_offsets.size() * sizeof(uint32_t));
+    place(h.off_edges, edges.size() * sizeof(NavEdge));
+    place(h.off_airways, airways.size() * sizeof(AirwayRecord));
+    place(h.off_airway_slots, airway_slots.size() * sizeof(uint32_t));
+    place(h.off_airway_point_offsets, airway_point_offsets.size() * sizeof(uint32_t));
+    place(h.off_airway_points, airway_points.size() * sizeof(uint32_t));
+    place(h.off_strings, strings.data().size());
+    h.file_size = off;
+
+    // Written beside the target and renamed over it, so tools mapping the old file keep a
+    // consistent view.
+    std::string tmp_path = out_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            *error = "cannot write " + tmp_path;
+            return false;
+        }
+        uint64_t pos = 0;
+        auto put = [&](uint64_t at, const void* data, uint64_t bytes) {
+            static const char kZeros[8] = {};
+            while (pos < at) {
+                uint64_t pad = std::min<uint64_t>(at - pos, sizeof(kZeros));
+                out.write(kZeros, static_cast<std::streamsize>(pad));
+                pos += pad;
+            }
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            pos += bytes;
+        };
+        put(0, &h, sizeof(h));
+        put(h.off_points, points.data(), points.size() * sizeof(PointRecord));
+        put(h.off_ident_slots, ident_slots.data(), ident_slots.size() * sizeof(uint32_t));
+        put(h.off_spatial, nodes.data(), nodes.size() * sizeof(SpatialNode));
+        put(h.off_edge_offsets, edge_offsets.data(), edge_offsets.size() * sizeof(uint32_t));
+        put(h.off_edges, edges.data(), edges.size() * sizeof(NavEdge));
+        put(h.off_airways, airways.data(), airways.size() * sizeof(AirwayRecord));
+        put(h.off_airway_slots, airway_slots.data(), airway_slots.size() * sizeof(uint32_t));
+        put(h.off_airway_point_offsets, airway_point_offsets.data(), airway_point_offsets.size() * sizeof(uint32_t));
+        put(h.off_airway_points, airway_points.data(), airway_points.size() * sizeof(uint32_t));
+        put(h.off_strings, strings.data().data(), strings.data().size());
+        put(h.file_size, nullptr, 0);
+        if (!out) {
+            *error = "write failed: " + tmp_path;
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), out_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        *error = "cannot replace " + out_path;
+        return false;
+    }
+    stats.airways = airways.size();
+    stats.edges = edges.size();
+    if (stats_out) *stats_out = stats;
+    return true;
+}
+
+NavDatabase::~NavDatabase() { close(); }
+
+NavDatabase::NavDatabase(NavDatabase&& other) noexcept { *this = std::move(other); }
+
+NavDatabase& NavDatabase::operator=(NavDatabase&& other) noexcept {
+    if (this != &other) {
+        close();
+        map_ = std::exchange(other.map_, nullptr);
+        map_size_ = std::exchange(other.map_size_, 0);
+        header_ = std::exchange(other.header_, nullptr);
+        points_ = std::exchange(other.points_, nullptr);
+        ident_slots_ = std::exchange(other.ident_slots_, nullptr);
+        edge_offsets_ = std::exchange(other.edge_offsets_, nullptr);
+        edges_ = std::exchange(other.edges_, nullptr);
+        airways_ = std::exchange(other.airways_, nullptr);
+        airway_slots_ = std::exchange(other.airway_slots_, nullptr);
+        airway_point_offsets_ = std::exchange(other.airway_point_offsets_, nullptr);
+        airway_points_ = std::exchange(other.airway_points_, nullptr);
+        strings_ = std::exchange(other.strings_, nullptr);
+        spatial_ = std::exchange(other.spatial_, SpatialIndex());
+    }
+    return *this;
+}
+
+void NavDatabase::close() {
+    if (map_) munmap(const_cast<char*>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    header_ = nullptr;
+    spatial_ = SpatialIndex();
+}
+
+bool NavDatabase::open(const std::string& path, std::string* error) {
+    TraceSpan span("open_navdata", "navdata", path);
+    close();
+    auto fail = [&](const std::string& why) {
+        if (error) *error = path + ": " + why;
+        close();
+        return false;
+    };
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return fail(std::strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return fail("not a navdata file");
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return fail(std::strerror(errno));
+    map_ = static_cast<const char*>(p);
+    map_size_ = size;
+
+    const auto* h = reinterpret_cast<const Header*>(map_);
+    if (std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0) return fail("not a navdata file");
+    if (h->endian != kEndianTag) return fail("written on a machine with different byte order; recompile it");
+    if (h->version != kVersion) return fail("unsupported navdata version " + std::to_string(h->version));
+    if (h->file_size != size) return fail("truncated");
+    auto section_ok = [size](uint64_t off, uint64_t count, uint64_t elem) {
+        return off % 8 == 0 && off <= size && count <= (size - off) / elem;
+    };
+    bool ok = section_ok(h->off_points, h->point_count, sizeof(PointRecord)) &&
+              section_ok(h->off_ident_slots, h->ident_slot_count, sizeof(uint32_t)) &&
+              section_ok(h->off_spatial, h->point_count, sizeof(SpatialNode)) &&
+              section_ok(h->off_edge_offsets, uint64_t{h->point_count} + 1, sizeof(uint32_t)) &&
+              section_ok(h->off_edges, h->edge_count, sizeof(NavEdge)) &&
+              section_ok(h->off_airways, h->airway_count, sizeof(AirwayRecord)) &&
+              section_ok(h->off_airway_slots, h->airway_slot_count, sizeof(uint32_t)) &&
+              section_ok(h->off_airway_point_offsets, uint64_t{h->airway_count} + 1, sizeof(uint32_t)) &&
+              section_ok(h->off_airway_points, h->airway_point_count, sizeof(uint32_t)) &&
+              section_ok(h->off_strings, h->strings_size, 1) && h->ident_slot_count > 0 &&
+              (h->ident_slot_count & (h->ident_slot_count - 1)) == 0 && h->airway_slot_count > 0 &&
+              (h->airway_slot_count & (h->airway_slot_count - 1)) == 0;
+    if (!ok) return fail("corrupt section table");
+
+    header_ = h;
+    points_ = reinterpret_cast<const PointRecord*>(map_ + h->off_points);
+    ident_slots_ = reinterpret_cast<const uint32_t*>(map_ + h->off_ident_slots);
+    edge_offsets_ = reinterpret_cast<const uint32_t*>(map_ + h->off_edge_offsets);
+    edges_ = reinterpret_cast<const NavEdge*>(map_ + h->off_edges);
+    airways_ = reinterpret_cast<const AirwayRecord*>(map_ + h->off_airways);
+    airway_slots_ = reinterpret_cast<const uint32_t*>(map_ + h->off_airway_slots);
+    airway_point_offsets_ = reinterpret_cast<const uint32_t*>(map_ + h->off_airway_point_offsets);
+    airway_points_ = reinterpret_cast<const uint32_t*>(map_ + h->off_airway_points);
+    strings_ = map_ + h->off_strings;
+    spatial_ = SpatialIndex::view(reinterpret_cast<const SpatialNode*>(map_ + h->off_spatial), h->point_count);
+    // Lookups and searches index through these without bounds checks, so a damaged file has to be
+    // caught here: offsets must run in order up to exactly the record count, and every id a record
+    // holds must exist.
+    auto offsets_ok = [](const uint32_t* offsets, uint32_t n, uint64_t total) {
+        for (uint32_t i = 0; i < n; ++i) {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        return offsets[n] == total;
+    };
+    if (!offsets_ok(edge_offsets_, h->point_count, h->edge_count) ||
+        !offsets_ok(airway_point_offsets_, h->airway_count, h->airway_point_count)) {
+        return fail("corrupt adjacency offsets");
+    }
+    for (uint32_t i = 0; i < h->edge_count; ++i) {
+        if (edges_[i].to >= h->point_count || edges_[i].airway >= h->airway_count) {
+            return fail("corrupt edge " + std::to_string(i));
+        }
+    }
+    for (uint32_t i = 0; i < h->airway_point_count; ++i) {
+        if (airway_points_[i] >= h->point_count) return fail("corrupt airway point " + std::to_string(i));
+    }
+    return true;
+}
+
+size_t NavDatabase::point_count() const { return header_ ? header_->point_count : 0; }
+
+size_t NavDatabase::airway_count() const { return header_ ? header_->airway_count : 0; }
+
+size_t NavDatabase::edge_count() const { return header_ ? header_->edge_count : 0; }
+
+std::string_view NavDatabase::str(uint32_t offset, uint32_t length) const {
+    if (offset > header_->strings_size || length > header_->strings_size - offset) return {};
+    return std::string_view(strings_ + offset, length);
+}
+
+NavPoint NavDatabase::point(uint32_t id) const {
+    const PointRecord& r = points_[id];
+    NavPoint p;
+    p.id = id;
+    p.kind = static_cast<NavKind>(r.kind);
+    p.ident = str(r.ident_off, r.ident_len);
+    p.region = str(r.region_off, r.region_len);
+    p.name = str(r.name_off, r.name_len);
+    p.lat = r.lat;
+    p.lon = r.lon;
+    p.freq = r.freq;
+    return p;
+}
+
+std::pair<uint32_t, uint32_t> NavDatabase::find(std::string_view ident) const {
+    if (!header_) return {0, 0};
+    uint32_t mask = header_->ident_slot_count - 1;
+    for (uint32_t s = fnv1a(ident) & mask;; s = (s + 1) & mask) {
+        uint32_t first = ident_slots_[s];
+        if (first == kEmptySlot || first >= header_->point_count) return {0, 0};
+        const PointRecord& r = points_[first];
+        if (str(r.ident_off, r.ident_len) != ident) continue;
+        uint32_t last = first + 1;
+        while (last < header_->point_count && str(points_[last].ident_off, points_[last].ident_len) == ident) ++last;
+        return {first, last};
+    }
+}
+
+std::optional<uint32_t> NavDatabase::resolve(std::string_view ident, double near_lat, double near_lon) const {
+    auto [first, last] = find(ident);
+    std::optional<uint32_t> best;
+    double best_nm = 0.0;
+    for (uint32_t id = first; id < last; ++id) {
+        double d = haversine_nm(near_lat, near_lon, points_[id].lat, points_[id].lon);
+        if (!best || d < best_nm) {
+            best = id;
+            best_nm = d;
+        }
+    }
+    return best;
+}
+
+const NavEdge* NavDatabase::edges_begin(uint32_t id) const { return edges_ + edge_offsets_[id]; }
+
+const NavEdge* NavDatabase::edges_end(uint32_t id) const { return edges_ + edge_offsets_[id + 1]; }
+
+std::optional<uint32_t> NavDatabase::find_airway(std::string_view name) const {
+    if (!header_) return std::nullopt;
+    uint32_t mask = header_->airway_slot_count - 1;
+    for (uint32_t s = fnv1a(name) & mask;; s = (s + 1) & mask) {
+        uint32_t id = airway_slots_[s];
+        if (id == kEmptySlot || id >= header_->airway_count) return std::nullopt;
+        if (airway_name(id) == name) return id;
+    }
+}
+
+std::string_view NavDatabase::airway_name(uint32_t airway) const {
+    return str(airways_[airway].name_off, airways_[airway].name_len);
+}
+
+const uint32_t* NavDatabase::airway_points_begin(uint32_t airway) const {
+    return airway_points_ + airway_point_offsets_[airway];
+}
+
+const uint32_t* NavDatabase::airway_points_end(uint32_t airway) const {
+    return airway_points_ + airway_point_offsets_[airway + 1];
+}
+
+} // namespace flightsuite
@@ -0,0 +1,125 @@
+// Navigation database: fixes, navaids, airports, and airways compiled from X-Plane style text
+// sources (earth_fix.dat, earth_nav.dat, earth_awy.dat; plain or compressed) into one binary file.
+// The file holds an ident hash index, a k-d tree (core/spatial), and the airway graph in CSR form,
+// laid out so that opening it is an mmap plus a header check.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "core/spatial.hpp"
+
+namespace flightsuite {
+
+enum class NavKind : uint8_t { kFix, kVor, kNdb, kDme, kAirport };
+
+const char* nav_kind_name(NavKind kind);
+
+struct NavPoint {
+    uint32_t id = 0;
+    NavKind kind = NavKind::kFix;
+    std::string_view ident;
+    std::string_view region; // ICAO region code ("K1", "ED"); empty for airports
+    std::string_view name;   // navaid/airport name; empty for fixes
+    double lat = 0.0;
+    double lon = 0.0;
+    double freq = 0.0; // MHz for VOR/DME, kHz for NDB
+};
+
+enum class AirwayLevel : uint8_t { kLow = 1, kHigh = 2 };
+
+// One directed airway segment; two-way segments are stored once in each direction.
+struct NavEdge {
+    uint32_t to;
+    uint32_t airway;
+    float distance_nm;
+    uint16_t base_fl; // lowest usable flight level (hundreds of feet)
+    uint16_t top_fl;
+    AirwayLevel level;
+    uint8_t reserved[3];
+};
+
+struct NavSources {
+    std::string fix_path;      // earth_fix.dat
+    std::string nav_path;      // earth_nav.dat
+    std::string awy_path;      // earth_awy.dat
+    std::string airports_path; // optional airports.csv, so routes can start and end at airports
+};
+
+struct NavCompileStats {
+    size_t fixes = 0;
+    size_t navaids = 0;
+    size_t airports = 0;
+    size_t airways = 0;
+    size_t edges = 0;             // directed
+    size_t skipped_lines = 0;     // unparseable source lines
+    size_t unresolved_segments = 0; // airway segments naming a fix/navaid not in the sources
+};
+
+// Parses the sources and writes the binary database to `out_path`. On failure returns false with
+// the reason in `*error`.
+bool compile_navdata(const NavSources& sources, const std::string& out_path, NavCompileStats* stats,
+                     std::string* error);
+
+// Read-only view of a compiled database. Everything points into the mapping; move-only.
+class NavDatabase {
+public:
+    NavDatabase() = default;
+    ~NavDatabase();
+    NavDatabase(NavDatabase&& other) noexcept;
+    NavDatabase& operator=(NavDatabase&& other) noexcept;
+    NavDatabase(const NavDatabase&) = delete;
+    NavDatabase& operator=(const NavDatabase&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    bool is_open() const { return map_ != nullptr; }
+
+    size_t point_count() const;
+    size_t airway_count() const;
+    size_t edge_count() const;
+
+    NavPoint point(uint32_t id) const;
+    // Ids [first, last) of every point named `ident`; fixes reuse names across regions.
+    std::pair<uint32_t, uint32_t> find(std::string_view ident) const;
+    // The point named `ident` closest to (near_lat, near_lon).
+    std::optional<uint32_t> resolve(std::string_view ident, double near_lat, double near_lon) const;
+    const SpatialIndex& spatial() const { return spatial_; }
+
+    // Outgoing airway segments of point `id`.
+    const NavEdge* edges_begin(uint32_t id) const;
+    const NavEdge* edges_end(uint32_t id) const;
+    std::optional<uint32_t> find_airway(std::string_view name) const;
+    std::string_view airway_name(uint32_t airway) const;
+    // Ids of the points on an airway in order along it; a branching airway lists each branch after
+    // the trunk it leaves.
+    const uint32_t* airway_points_begin(uint32_t airway) const;
+    const uint32_t* airway_points_end(uint32_t airway) const;
+
+    struct Header;
+    struct PointRecord;
+    struct AirwayRecord;
+
+private:
+    void close();
+    std::string_view str(uint32_t offset, uint32_t length) const;
+
+    const char* map_ = nullptr;
+    size_t map_size_ = 0;
+    const Header* header_ = nullptr;
+    const PointRecord* points_ = nullptr;
+    const uint32_t* ident_slots_ = nullptr;
+    const uint32_t* edge_offsets_ = nullptr;
+    const NavEdge* edges_ = nullptr;
+    const AirwayRecord* airways_ = nullptr;
+    const uint32_t* airway_slots_ = nullptr;
+    const uint32_t* airway_point_offsets_ = nullptr;
+    const uint32_t* airway_points_ = nullptr;
+    const char* strings_ = nullptr;
+    SpatialIndex spatial_;
+};
+
+} // namespace flightsuite
@@ -0,0 +1,167 @@
+#include "core/notam.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <iostream>
+#include <regex>
+
+#include "core/compress.hpp"
+#include "core/fetch.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+std::optional<std::string> fetch_notams_http(const std::string& icao) {
+    // Source: FAA/D-NOTAM (example static feed). For offline use, prefer --file.
+    // Mirrors registered under "notam" (--mirror notam=URL) are raced against it.
+    return fetch_first(fetch_source_urls("notam",
+                                         "https://www.notams.faa.gov/dinsQueryWeb/queryRetrievalMapAction.do"
+                                         "?retrieveLocId={ICAO}&actionType=notamRetrievalByICAOs",
+                                         icao),
+                       6);
+}
+
+namespace {
+
+// "A1234/24 NOTAMN" (also NOTAMR/NOTAMC) opens a multi-line ICAO-format record.
+bool is_icao_notam_header(const std::string& line) {
+    if (line.size() < 15 || !std::isupper(static_cast<unsigned char>(line[0]))) return false;
+    for (int i = 1; i <= 4; ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(line[i]))) return false;
+    }
+    return line[5] == '/' && std::isdigit(static_cast<unsigned char>(line[6])) &&
+           std::isdigit(static_cast<unsigned char>(line[7])) && line.compare(8, 6, " NOTAM") == 0;
+}
+
+// Joins each ICAO record ("A1234/24 NOTAMN", "Q) ...", "A) ... B) ... C) ...", "E) ...") into one
+// entry; every other line stays a NOTAM of its own. Lines arrive trimmed and non-empty. A record
+// goes to `emit` once the next one starts, so only the record being folded is held.
+class NotamRecordBuilder {
+public:
+    explicit NotamRecordBuilder(std::function<void(const std::string&)> emit) : emit_(std::move(emit)) {}
+
+    void add_line(std::string line) {
+        if (in_icao_ && line.size() > 1 && line[1] == ')') {
+            pending_ += " " + line;
+            return;
+        }
+        finish();
+        pending_ = std::move(line);
+        in_icao_ = is_icao_notam_header(pending_);
+    }
+
+    void finish() {
+        if (!pending_.empty()) emit_(pending_);
+        pending_.clear();
+        in_icao_ = false;
+    }
+
+private:
+    std::function<void(const std::string&)> emit_;
+    std::string pending_;
+    bool in_icao_ = false;
+};
+
+Notam parse_notam_record(const std::string& line, const std::string& icao_hint) {
+    static const std::regex icao_re(R"(([A-Z]{4}))");
+    Notam n;
+    n.raw = line;
+    n.icao = icao_hint;
+    std::smatch m;
+    size_t a_field = is_icao_notam_header(line) ? line.find(" A) ") : std::string::npos;
+    if (a_field != std::string::npos && a_field + 8 <= line.size()) {
+        n.icao = line.substr(a_field + 4, 4);
+    } else if (std::regex_search(line, m, icao_re)) {
+        n.icao = m[1];
+    }
+    std::string up = line;
+    std::transform(up.begin(), up.end(), up.begin(), ::toupper);
+    if (up.find("RWY") != std::string::npos && (up.find("CLSD") != std::string::npos || up.find("CLOSED") != std::string::npos)) {
+        n.runway_closure = true;
+    }
+    if (up.find("ILS") != std::string::npos || up.find("RNAV") != std::string::npos ||
+        up.find("APCH") != std::string::npos || up.find("APPROACH") != std::string::npos) {
+        if (up.find("U/S") != std::string::npos || up.find("UNUSABLE") != std::string::npos ||
+            up.find("OUT OF SERVICE") != std::string::npos || up.find("NOT AVBL") != std::string::npos) {
+            n.approach_change = true;
+        }
+    }
+    if (up.find("GPS") != std::string::npos && (up.find("UNREL") != std::string::npos || up.find("OUTAGE") != std::string::npos || up.find("JAMMING") != std::string::npos)) {
+        n.gps_outage = true;
+    }
+    if (up.find("RCLL") != std::string::npos || up.find("RWY LGTS") != std::string::npos ||
+        up.find("PAPI") != std::string::npos || up.find("VASI") != std::string::npos ||
+        up.find("MALSR") != std::string::npos || up.find("MIRL") != std::string::npos ||
+        up.find("HIRL") != std::string::npos) {
+        if (up.find("U/S") != std::string::npos || up.find("UNSERVICEABLE") != std::string::npos ||
+            up.find("OUT OF SERVICE") != std::string::npos || up.find("OUTAGE") != std::string::npos ||
+            up.find("NOT AVBL") != std::string::npos) {
+            n.lighting_issue = true;
+        }
+    }
+    return n;
+}
+
+} // namespace
+
+std::vector<Notam> parse_notams_text(const std::string& text, const std::string& icao_hint) {
+    TraceSpan span("parse_notams_text", "notam");
+    std::vector<Notam> out;
+    NotamRecordBuilder builder(
+        [&out, &icao_hint](const std::string& record) { out.push_back(parse_notam_record(record, icao_hint)); });
+    for (auto& line : split_lines(text)) builder.add_line(std::move(line));
+    builder.finish();
+    return out;
+}
+
+bool for_each_notam_in_file(const std::string& path, const std::string& icao_hint,
+                            const std::function<void(Notam&&)>& fn) {
+    TraceSpan span("for_each_notam_in_file", "notam", path);
+    ChunkedFileReader reader;
+    if (!reader.open(path)) {
+        if (reader.compression() != Compression::kNone) std::cerr << reader.error() << "\n";
+        return false;
+    }
+    NotamRecordBuilder builder([&fn, &icao_hint](const std::string& record) { fn(parse_notam_record(record, icao_hint)); });
+    bool ok = for_each_line(reader, [&builder](std::string_view line) {
+        std::string trimmed = trim(std::string(line));
+        if (!trimmed.empty()) builder.add_line(std::move(trimmed));
+    });
+    if (!ok) {
+        std::cerr << "Failed to decode " << path << ": " << reader.error() << "\n";
+        return false;
+    }
+    builder.finish();
+    return true;
+}
+
+std::optional<std::vector<Notam>> parse_notams_file(const std::string& path, const std::string& icao_hint) {
+    std::vector<Notam> out;
+    if (!for_each_notam_in_file(path, icao_hint, [&out](Notam&& n) { out.push_back(std::move(n)); })) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+void add_notam_risk(const Notam& n, const std::string& icao, RiskScore& r) {
+    if (!icao.empty() && !n.icao.empty() && n.icao != icao) return;
+    auto add = [&r](int pts, const char* why) {
+        r.score += pts;
+        r.reasons.emplace_back(why);
+    };
+    if (n.runway_closure) add(4, "Runway closure");
+    if (n.approach_change) add(3, "Approach/NAVAID out");
+    if (n.gps_outage) add(2, "GPS unreliability");
+    if (n.lighting_issue) add(1, "Runway/approach lighting issue");
+}
+
+RiskScore score_notams(const std::vector<Notam>& ns, const std::string& icao) {
+    TraceSpan span("score_notams", "notam");
+    RiskScore r;
+    for (const auto& n : ns) add_notam_risk(n, icao, r);
+    return r;
+}
+
+} // namespace flightsuite
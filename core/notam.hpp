@@ -0,0 +1,42 @@
+// NOTAM parsing, hazard flagging, and risk scoring.
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flightsuite {
+
+struct Notam {
+    std::string raw;
+    std::string icao;
+    bool runway_closure = false;
+    bool approach_change = false;
+    bool gps_outage = false;
+    bool lighting_issue = false;
+};
+
+struct RiskScore {
+    int score = 0;
+    std::vector<std::string> reasons;
+};
+
+// One NOTAM per non-empty line, except ICAO-format records ("A1234/24 NOTAMN" followed by
+// "Q)"/"A)"/"E)" lines), which are folded into one entry located by their A) field. `icao_hint`
+// is used when an entry carries no location.
+std::vector<Notam> parse_notams_text(const std::string& text, const std::string& icao_hint);
+// The same for a dump on disk (plain, gzip, or zstd): lines are folded into records and parsed as
+// they decode, and each entry goes to `fn`, so only the record being folded is held. False if the
+// file cannot be opened or decoded (entries before the failure have been delivered).
+bool for_each_notam_in_file(const std::string& path, const std::string& icao_hint,
+                            const std::function<void(Notam&&)>& fn);
+// Every entry of a dump on disk; nullopt if the file cannot be opened or decoded.
+std::optional<std::vector<Notam>> parse_notams_file(const std::string& path, const std::string& icao_hint);
+RiskScore score_notams(const std::vector<Notam>& ns, const std::string& icao);
+// Adds one entry's points to `r` (entries located at another airport count for nothing).
+void add_notam_risk(const Notam& n, const std::string& icao, RiskScore& r);
+
+std::optional<std::string> fetch_notams_http(const std::string& icao);
+
+} // namespace flightsuite
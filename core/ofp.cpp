@@ -0,0 +1,174 @@
+#include "core/ofp.hpp"
+
+#include <cctype>
+#include <regex>
+#include <unordered_map>
+
+#include "core/geo.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+// Tag patterns repeat across calls (and OFPs); compile each once per thread.
+const std::regex& tag_regex(const std::string& tag) {
+    thread_local std::unordered_map<std::string, std::regex> cache;
+    auto it = cache.find(tag);
+    if (it == cache.end()) {
+        it = cache.emplace(tag, std::regex("<" + tag + R"(>([^<]+)</)" + tag + ">")).first;
+    }
+    return it->second;
+}
+
+} // namespace
+
+double parse_latlon(const std::string& s) {
+    if (s.empty()) return 0.0;
+    char hemi = 0;
+    std::string num = s;
+    if (std::isalpha(static_cast<unsigned char>(s.front()))) {
+        hemi = s.front();
+        num = s.substr(1);
+    } else if (std::isalpha(static_cast<unsigned char>(s.back()))) {
+        hemi = s.back();
+        num = s.substr(0, s.size() - 1);
+    }
+    double v = std::stod(num);
+    if (hemi == 'S' || hemi == 'W' || hemi == 's' || hemi == 'w') v = -v;
+    return v;
+}
+
+std::optional<std::string> tag_in_block(const std::string& block, const std::string& tag) {
+    std::smatch m;
+    if (std::regex_search(block, m, tag_regex(tag))) return trim(m[1]);
+    return std::nullopt;
+}
+
+std::optional<std::string> tag_in_section(const std::string& content, const std::string& section_tag,
+                                          const std::string& tag) {
+    size_t start = content.find("<" + section_tag + ">");
+    size_t end = content.find("</" + section_tag + ">", start);
+    if (start == std::string::npos || end == std::string::npos || end <= start) {
+        return std::nullopt;
+    }
+    std::string block = content.substr(start, end - start);
+    return tag_in_block(block, tag);
+}
+
+std::optional<std::string> tag_value(const std::string& content, const std::vector<std::string>& tags) {
+    static const std::string kNoTag;
+    TraceSpan span("tag_value", "ofp", tags.empty() ? kNoTag : tags.front());
+    for (const auto& t : tags) {
+        std::smatch m;
+        if (std::regex_search(content, m, tag_regex(t))) {
+            return trim(m[1]);
+        }
+    }
+    return std::nullopt;
+}
+
+AircraftInfo parse_aircraft(const std::string& content) {
+    TraceSpan span("parse_aircraft", "ofp");
+    AircraftInfo info;
+    size_t start = content.find("<aircraft>");
+    size_t end = content.find("</aircraft>", start);
+    if (start != std::string::npos && end != std::string::npos && end > start) {
+        std::string block = content.substr(start, end - start);
+        if (auto v = tag_in_block(block, "name")) info.name = *v;
+        if (auto v = tag_in_block(block, "engines")) info.engines = *v;
+        if (auto v = tag_in_block(block, "reg")) info.reg = *v;
+    }
+    return info;
+}
+
+FuelInfo parse_fuel(const std::string& content) {
+    TraceSpan span("parse_fuel", "ofp");
+    FuelInfo f;
+    size_t start = content.find("<fuel>");
+    size_t end = content.find("</fuel>", start);
+    if (start != std::string::npos && end != std::string::npos && end > start) {
+        std::string block = content.substr(start, end - start);
+        if (auto v = tag_in_block(block, "plan_ramp")) f.ramp = v;
+        if (auto v = tag_in_block(block, "plan_trip")) f.trip = v;
+        if (auto v = tag_in_block(block, "enroute_burn")) f.trip = v;
+        if (auto v = tag_in_block(block, "reserve")) f.reserve = v;
+        if (auto v = tag_in_block(block, "taxi")) f.taxi = v;
+        if (auto v = tag_in_block(block, "extra")) f.extra = v;
+    }
+    return f;
+}
+
+std::vector<Fix> parse_navlog_fixes(const std::string& content) {
+    TraceSpan span("parse_navlog_fixes", "ofp");
+    static const std::regex block_re("<fix>([\\s\\S]*?)</fix>");
+    static const std::regex ident_re("<ident>([^<]+)</ident>");
+    static const std::regex lat_re("<pos_lat>([^<]+)</pos_lat>");
+    static const std::regex lon_re("<pos_long>([^<]+)</pos_long>");
+    static const std::regex alt_re("<altitude_feet>([^<]+)</altitude_feet>");
+    static const std::regex targ_re("<target_altitude>([^<]+)</target_altitude>");
+    static const std::regex fix_re(
+        R"(<navlog_fix[^>]*fix=\"([^\"]+)\"[^>]*lat=\"([^\"]+)\"[^>]*lon=\"([^\"]+)\"[^>]*alt=\"([^\"]+)\")");
+
+    std::vector<Fix> fixes;
+    // Extract a <navlog> ... </navlog> block that contains <fix> entries.
+    std::string navlog_block;
+    size_t search_pos = 0;
+    while (true) {
+        size_t start = content.find("<navlog>", search_pos);
+        if (start == std::string::npos) break;
+        size_t end_tag = content.find("</navlog>", start);
+        if (end_tag == std::string::npos) break;
+        std::string candidate = content.substr(start, end_tag - start);
+        if (candidate.find("<fix>") != std::string::npos) {
+            navlog_block = candidate;
+            break;
+        }
+        search_pos = end_tag + 9;
+    }
+    if (navlog_block.empty()) navlog_block = content;
+
+    auto begin = std::sregex_iterator(navlog_block.begin(), navlog_block.end(), block_re);
+    auto end = std::sregex_iterator();
+    for (auto it = begin; it != end; ++it) {
+        std::string block = (*it)[1];
+        std::smatch m;
+        Fix f;
+        if (std::regex_search(block, m, ident_re)) f.name = m[1];
+        if (std::regex_search(block, m, lat_re)) f.lat = parse_latlon(m[1]);
+        if (std::regex_search(block, m, lon_re)) f.lon = parse_latlon(m[1]);
+        if (std::regex_search(block, m, alt_re)) {
+            if (auto v = parse_double(m[1])) f.altitude_ft = *v;
+        } else if (std::regex_search(block, m, targ_re)) {
+            if (auto v = parse_double(m[1])) f.altitude_ft = *v;
+        }
+        if (!f.name.empty()) fixes.push_back(f);
+    }
+    // Fallback: older navlog_fix attributes.
+    if (fixes.empty()) {
+        auto b2 = std::sregex_iterator(content.begin(), content.end(), fix_re);
+        for (auto it2 = b2; it2 != end; ++it2) {
+            std::smatch m2 = *it2;
+            Fix f2;
+            f2.name = m2[1];
+            f2.lat = parse_latlon(m2[2]);
+            f2.lon = parse_latlon(m2[3]);
+            f2.altitude_ft = std::stod(m2[4]);
+            if (f2.altitude_ft > 0.0 && f2.altitude_ft <= 200.0) f2.altitude_ft *= 100.0;
+            fixes.push_back(f2);
+        }
+    }
+    return fixes;
+}
+
+double cumulative_distance(const std::vector<Fix>& fixes) {
+    if (fixes.size() < 2) return 0.0;
+    double total = 0.0;
+    for (size_t i = 1; i < fixes.size(); ++i) {
+        total += haversine_nm(fixes[i - 1].lat, fixes[i - 1].lon, fixes[i].lat, fixes[i].lon);
+    }
+    return total;
+}
+
+} // namespace flightsuite
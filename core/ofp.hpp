@@ -0,0 +1,48 @@
+// SimBrief OFP XML extraction: tag lookups, navlog fixes, fuel and airframe blocks.
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flightsuite {
+
+struct Fix {
+    std::string name;
+    double lat = 0.0;
+    double lon = 0.0;
+    double altitude_ft = 0.0;
+};
+
+struct AircraftInfo {
+    std::string name;
+    std::string engines;
+    std::string reg;
+};
+
+struct FuelInfo {
+    std::optional<std::string> ramp;
+    std::optional<std::string> trip;
+    std::optional<std::string> reserve;
+    std::optional<std::string> taxi;
+    std::optional<std::string> extra;
+};
+
+// "N47.4", "47.4S", or plain signed degrees.
+double parse_latlon(const std::string& s);
+
+// First `<tag>value</tag>` found, trying each tag in order.
+std::optional<std::string> tag_value(const std::string& content, const std::vector<std::string>& tags);
+std::optional<std::string> tag_in_block(const std::string& block, const std::string& tag);
+std::optional<std::string> tag_in_section(const std::string& content, const std::string& section_tag,
+                                          const std::string& tag);
+
+AircraftInfo parse_aircraft(const std::string& content);
+FuelInfo parse_fuel(const std::string& content);
+
+// `<navlog><fix>...</fix></navlog>` entries, falling back to older `<navlog_fix .../>` attributes.
+std::vector<Fix> parse_navlog_fixes(const std::string& content);
+
+double cumulative_distance(const std::vector<Fix>& fixes);
+
+} // namespace flightsuite
@@ -0,0 +1,65 @@
+#include "core/profile.hpp"
+
+#include <iostream>
+
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+std::vector<Waypoint> parse_route_csv(const std::string& text) {
+    TraceSpan span("parse_route_csv", "profile");
+    std::vector<Waypoint> wpts;
+    for (const auto& line : split_lines(text)) {
+        if (line[0] == '#') continue;
+        auto cells = split_csv_line(line);
+        if (cells.size() < 3) continue;
+        Waypoint w;
+        w.name = cells[0];
+        w.distance_nm = std::stod(cells[1]);
+        w.altitude_ft = std::stod(cells[2]);
+        wpts.push_back(w);
+    }
+    return wpts;
+}
+
+std::vector<Waypoint> load_route(const std::string& path) {
+    auto text = read_file(path);
+    if (!text) {
+        std::cerr << "Failed to open route file: " << path << "\n";
+        return {};
+    }
+    return parse_route_csv(*text);
+}
+
+ProfilePoints interpolate_profile(const std::vector<Waypoint>& wpts, int samples) {
+    TraceSpan span("interpolate_profile", "profile");
+    ProfilePoints p;
+    if (wpts.size() < 2) return p;
+    double total_dist = wpts.back().distance_nm;
+    for (int i = 0; i <= samples; ++i) {
+        double d = total_dist * i / samples;
+        p.distances_nm.push_back(d);
+        // find segment
+        size_t seg = 1;
+        while (seg < wpts.size() && wpts[seg].distance_nm < d) ++seg;
+        if (seg >= wpts.size()) {
+            p.altitudes_ft.push_back(wpts.back().altitude_ft);
+        } else {
+            const auto& a = wpts[seg - 1];
+            const auto& b = wpts[seg];
+            double t = (d - a.distance_nm) / (b.distance_nm - a.distance_nm);
+            double alt = a.altitude_ft + t * (b.altitude_ft - a.altitude_ft);
+            p.altitudes_ft.push_back(alt);
+        }
+    }
+    return p;
+}
+
+double find_distance_to_alt(double start_alt, double target_alt, double gradient_ft_per_nm) {
+    if (gradient_ft_per_nm <= 0) return 0.0;
+    double delta_ft = target_alt - start_alt;
+    return delta_ft / gradient_ft_per_nm;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,28 @@
+// Vertical profile: route CSV loading, TOC/TOD distances, and altitude interpolation.
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace flightsuite {
+
+struct Waypoint {
+    std::string name;
+    double distance_nm = 0.0; // cumulative distance from origin
+    double altitude_ft = 0.0;
+};
+
+struct ProfilePoints {
+    std::vector<double> distances_nm;
+    std::vector<double> altitudes_ft;
+};
+
+// Route CSV rows: name,distance_nm,altitude_ft ('#' lines are comments).
+std::vector<Waypoint> parse_route_csv(const std::string& text);
+std::vector<Waypoint> load_route(const std::string& path);
+
+ProfilePoints interpolate_profile(const std::vector<Waypoint>& wpts, int samples = 200);
+
+double find_distance_to_alt(double start_alt, double target_alt, double gradient_ft_per_nm);
+
+} // namespace flightsuite
@@ -0,0 +1,272 @@
+#include "core/route_string.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <functional>
+#include <optional>
+#include <thread>
+
+#include "core/alloc_stats.hpp"
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+std::vector<std::string> route_tokens(const std::string& route) {
+    std::vector<std::string> out;
+    std::string tok;
+    auto flush = [&]() {
+        // "KSEA/16L", "LKV/N0450F350": the part after the slash is a runway or speed/level change.
+        size_t slash = tok.find('/');
+        if (slash != std::string::npos) tok.resize(slash);
+        if (!tok.empty()) out.push_back(tok);
+        tok.clear();
+    };
+    for (char c : route) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            flush();
+        } else {
+            tok += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    flush();
+    return out;
+}
+
+bool all_digits(const std::string& s, size_t pos, size_t len) {
+    if (pos + len > s.size()) return false;
+    for (size_t i = pos; i < pos + len; ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(s[i]))) return false;
+    }
+    return true;
+}
+
+// N0450F350, M082F390, K0830S1130.
+bool is_speed_level(const std::string& t) {
+    if (t.empty() || (t[0] != 'N' && t[0] != 'K' && t[0] != 'M')) return false;
+    size_t speed = t[0] == 'M' ? 3 : 4;
+    if (!all_digits(t, 1, speed) || t.size() <= 1 + speed) return false;
+    char unit = t[1 + speed];
+    if (unit != 'F' && unit != 'A' && unit != 'S' && unit != 'M') return false;
+    size_t level = t.size() - 2 - speed;
+    return (level == 3 || level == 4) && all_digits(t, 2 + speed, level);
+}
+
+// 47N122W, 4730N12230W, 473015N1223045W.
+bool parse_coordinate(const std::string& t, double& lat, double& lon) {
+    size_t ns = t.find_first_of("NS");
+    if (ns == std::string::npos || t.size() < ns + 2) return false;
+    char ew = t.back();
+    if (ew != 'E' && ew != 'W') return false;
+    size_t lat_len = ns, lon_len = t.size() - ns - 2;
+    if ((lat_len != 2 && lat_len != 4 && lat_len != 6) || lon_len != lat_len + 1) return false;
+    if (!all_digits(t, 0, lat_len) || !all_digits(t, ns + 1, lon_len)) return false;
+    auto dms = [&t](size_t pos, size_t deg_digits, size_t len) {
+        double v = std::stoi(t.substr(pos, deg_digits));
+        if (len >= deg_digits + 2) v += std::stoi(t.substr(pos + deg_digits, 2)) / 60.0;
+        if (len >= deg_digits + 4) v += std::stoi(t.substr(pos + deg_digits + 2, 2)) / 3600.0;
+        return v;
+    };
+    lat = dms(0, 2, lat_len);
+    lon = dms(ns + 1, 3, lon_len);
+    if (t[ns] == 'S') lat = -lat;
+    if (ew == 'W') lon = -lon;
+    return lat <= 90.0 && lon <= 180.0;
+}
+
+// SUMMA1, HAWKZ7, GLASR3A: letters, one digit, optional transition letter.
+bool looks_like_procedure(const std::string& t) {
+    size_t letters = 0;
+    while (letters < t.size() && std::isalpha(static_cast<unsigned char>(t[letters]))) ++letters;
+    if (letters < 2 || letters + 1 > t.size() || !std::isdigit(static_cast<unsigned char>(t[letters]))) return false;
+    size_t rest = t.size() - letters - 1;
+    return rest == 0 || (rest == 1 && std::isalpha(static_cast<unsigned char>(t.back())));
+}
+
+bool on_airway(const NavDatabase& db, uint32_t id, uint32_t airway) {
+    for (const NavEdge* e = db.edges_begin(id); e != db.edges_end(id); ++e) {
+        if (e->airway == airway) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+size_t RouteExpander::SegmentKeyHash::operator()(const SegmentKey& k) const {
+    size_t h = std::hash<std::string>()(k.exit);
+    h ^= (static_cast<size_t>(k.from) * 0x9E3779B97F4A7C15ULL) + (h << 6) + (h >> 2);
+    h ^= (static_cast<size_t>(k.airway) * 0xC2B2AE3D27D4EB4FULL) + (h << 6) + (h >> 2);
+    return h;
+}
+
+const std::vector<uint32_t>& RouteExpander::airway_path(uint32_t from, uint32_t airway, const std::string& exit) {
+    SegmentKey key{from, airway, exit};
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        ++hits_;
+        return it->second;
+    }
+    ++misses_;
+    // Breadth-first along the airway's own segments, so a one-way airway is only flown forward
+    // and the nearest point named `exit` (by hops) wins.
+    std::vector<uint32_t> path;
+    std::vector<std::pair<uint32_t, uint32_t>> visited{{from, from}}; // (point, parent); airways are short
+    for (size_t head = 0; head < visited.size() && path.empty(); ++head) {
+        uint32_t at = visited[head].first;
+        for (const NavEdge* e = db_.edges_begin(at); e != db_.edges_end(at); ++e) {
+            if (e->airway != airway) continue;
+            bool seen = std::any_of(visited.begin(), visited.end(), [e](const auto& v) { return v.first == e->to; });
+            if (seen) continue;
+            visited.emplace_back(e->to, at);
+            if (db_.point(e->to).ident != exit) continue;
+            for (uint32_t p = e->to; p != from;) {
+                path.push_back(p);
+                p = std::find_if(visited.begin(), visited.end(), [p](const auto& v) { return v.first == p; })->second;
+            }
+            std::reverse(path.begin(), path.end());
+            break;
+        }
+    }
+    return cache_.emplace(std::move(key), std::move(path)).first->second;
+}
+
+ExpandedRoute RouteExpander::expand(const RouteRequest& request) {
+    ExpandedRoute out;
+    auto tokens = route_tokens(request.route);
+    auto plain = [](const std::string& s) {
+        auto t = route_tokens(s);
+        return t.empty() ? std::string() : t.front();
+    };
+    std::string origin = plain(request.origin), destination = plain(request.destination);
+    if (!origin.empty() && (tokens.empty() || tokens.front() != origin)) tokens.insert(tokens.begin(), origin);
+    if (!destination.empty() && (tokens.empty() || tokens.back() != destination)) tokens.push_back(destination);
+
+    auto push = [&out](const std::string& name, double lat, double lon, uint32_t id, const std::string& via) {
+        if (id != kNoNavId && !out.ids.empty() && out.ids.back() == id) return;
+        Fix f;
+        f.name = name;
+        f.lat = lat;
+        f.lon = lon;
+        out.fixes.push_back(std::move(f));
+        out.ids.push_back(id);
+        out.via.push_back(out.fixes.size() == 1 ? "" : via);
+    };
+    auto push_id = [&](uint32_t id, const std::string& via) {
+        NavPoint p = db_.point(id);
+        push(std::string(p.ident), p.lat, p.lon, id, via);
+    };
+    // Before anything is placed, the first ident with a single candidate stands in for "nearby".
+    auto anchor = [&](size_t from, double& lat, double& lon) {
+        for (size_t j = from; j < tokens.size(); ++j) {
+            auto [first, last] = db_.find(tokens[j]);
+            if (last - first == 1) {
+                NavPoint p = db_.point(first);
+                lat = p.lat;
+                lon = p.lon;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string& tok = tokens[i];
+        if (tok == "DCT" || tok == "SID" || tok == "STAR") continue;
+        if (is_speed_level(tok)) {
+            out.skipped.push_back(tok);
+            continue;
+        }
+        double lat, lon;
+        if (parse_coordinate(tok, lat, lon)) {
+            push(tok, lat, lon, kNoNavId, "DCT");
+            continue;
+        }
+        uint32_t prev = out.ids.empty() ? kNoNavId : out.ids.back();
+        auto airway = db_.find_airway(tok);
+        if (airway && prev != kNoNavId && i + 1 < tokens.size() && on_airway(db_, prev, *airway)) {
+            const auto& path = airway_path(prev, *airway, tokens[i + 1]);
+            if (path.empty()) {
+                out.unresolved.push_back(tok + " to " + tokens[i + 1]);
+                continue; // the exit fix is then flown direct
+            }
+            for (uint32_t id : path) push_id(id, tok);
+            ++i;
+            continue;
+        }
+        auto [first, last] = db_.find(tok);
+        if (first == last) {
+            if (airway) {
+                out.unresolved.push_back(tok + (out.fixes.empty() ? "" : " at " + out.fixes.back().name));
+            } else if (looks_like_procedure(tok)) {
+                out.skipped.push_back(tok);
+            } else {
+                out.unresolved.push_back(tok);
+            }
+            continue;
+        }
+        uint32_t id = first;
+        if (last - first > 1) {
+            double ref_lat, ref_lon;
+            bool have_ref = !out.fixes.empty();
+            if (have_ref) {
+                ref_lat = out.fixes.back().lat;
+                ref_lon = out.fixes.back().lon;
+            } else {
+                have_ref = anchor(i + 1, ref_lat, ref_lon);
+            }
+            // An airway joined here narrows the candidates to the ones on it; proximity decides the rest.
+            std::optional<uint32_t> next_airway = i + 1 < tokens.size() ? db_.find_airway(tokens[i + 1]) : std::nullopt;
+            bool any_on_airway = false;
+            if (next_airway) {
+                for (uint32_t c = first; c < last && !any_on_airway; ++c) any_on_airway = on_airway(db_, c, *next_airway);
+            }
+            double best = -1.0;
+            for (uint32_t c = first; c < last; ++c) {
+                if (any_on_airway && !on_airway(db_, c, *next_airway)) continue;
+                NavPoint p = db_.point(c);
+                double d = have_ref ? haversine_nm(ref_lat, ref_lon, p.lat, p.lon) : 0.0;
+                if (best < 0.0 || d < best) {
+                    best = d;
+                    id = c;
+                }
+            }
+        }
+        push_id(id, "DCT");
+    }
+    return out;
+}
+
+std::vector<ExpandedRoute> expand_routes(const NavDatabase& db, const std::vector<RouteRequest>& requests,
+                                         unsigned threads) {
+    TraceSpan span("expand_routes", "route", [&] { return std::to_string(requests.size()) + " routes"; });
+    std::vector<ExpandedRoute> out(requests.size());
+    if (requests.empty()) return out;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    constexpr size_t kBatch = 64;
+    threads = static_cast<unsigned>(std::min<size_t>(threads, (requests.size() + kBatch - 1) / kBatch));
+    std::atomic<size_t> next{0};
+    auto worker = [&](unsigned n) {
+        AllocStageScope stage(AllocStage::kAnalyze);
+        if (threads > 1) trace_set_thread_name("route worker " + std::to_string(n));
+        // One cache per worker: routes in an archive share most of their airway segments, so it
+        // warms up within the first batches and needs no locking.
+        RouteExpander expander(db);
+        for (size_t b; (b = next.fetch_add(kBatch, std::memory_order_relaxed)) < requests.size();) {
+            size_t end = std::min(b + kBatch, requests.size());
+            for (size_t i = b; i < end; ++i) out[i] = expander.expand(requests[i]);
+        }
+    };
+    if (threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+        for (auto& t : pool) t.join();
+    }
+    return out;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,71 @@
+// ATC/SimBrief route strings ("KSEA SUMMA1 SUMMA J70 LKV ...") expanded into the full fix
+// sequence by walking airways in a compiled navdata database (core/navdata). Same-named fixes
+// resolve to the candidate nearest the previous point, and airway walks are memoized per
+// (entry point, airway, exit ident) so an archive of similar routes expands quickly.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/navdata.hpp"
+#include "core/ofp.hpp"
+
+namespace flightsuite {
+
+constexpr uint32_t kNoNavId = std::numeric_limits<uint32_t>::max();
+
+struct ExpandedRoute {
+    std::vector<Fix> fixes;       // altitude_ft is left at 0; the caller knows the profile
+    std::vector<uint32_t> ids;    // navdata id per fix; kNoNavId for lat/lon waypoints
+    std::vector<std::string> via; // airway flown to reach each fix, "DCT" for direct, "" for the first
+    std::vector<std::string> skipped;    // procedures and speed/level groups, which are not expanded
+    std::vector<std::string> unresolved; // idents not in the database, airways without the exit fix
+};
+
+struct RouteRequest {
+    std::string route;
+    std::string origin;      // optional; prepended unless the route already starts there
+    std::string destination; // optional; appended unless the route already ends there
+};
+
+// Expands one route at a time; keep one per thread, since the airway cache is not shared.
+class RouteExpander {
+public:
+    explicit RouteExpander(const NavDatabase& db) : db_(db) {}
+
+    ExpandedRoute expand(const RouteRequest& request);
+
+    size_t cache_hits() const { return hits_; }
+    size_t cache_misses() const { return misses_; }
+
+private:
+    struct SegmentKey {
+        uint32_t from;
+        uint32_t airway;
+        std::string exit;
+        bool operator==(const SegmentKey& o) const { return from == o.from && airway == o.airway && exit == o.exit; }
+    };
+    struct SegmentKeyHash {
+        size_t operator()(const SegmentKey& k) const;
+    };
+
+    // Points after `from` along `airway` up to and including the nearest point named `exit`;
+    // empty when the airway does not lead there.
+    const std::vector<uint32_t>& airway_path(uint32_t from, uint32_t airway, const std::string& exit);
+
+    const NavDatabase& db_;
+    std::unordered_map<SegmentKey, std::vector<uint32_t>, SegmentKeyHash> cache_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+// Expands every request, spreading them over `threads` workers (0 = hardware concurrency), each
+// with its own expander. out[i] answers requests[i].
+std::vector<ExpandedRoute> expand_routes(const NavDatabase& db, const std::vector<RouteRequest>& requests,
+                                         unsigned threads = 0);
+
+} // namespace flightsuite
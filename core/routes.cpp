@@ -0,0 +1,78 @@
+#include "core/routes.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+const Airport* pick_random_airport(const std::vector<Airport>& airports, int min_rwy,
+                                   const GeoFilter& area, std::mt19937& gen) {
+    std::vector<const Airport*> candidates;
+    for (const auto& a : airports) {
+        if (a.longest_runway_ft < min_rwy) continue;
+        if (!area.contains(a)) continue;
+        candidates.push_back(&a);
+    }
+    if (candidates.empty()) return nullptr;
+    std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+    return candidates[dist(gen)];
+}
+
+std::vector<Suggestion> suggest_routes(const Aircraft& ac,
+                                       const std::unordered_map<std::string, Airport>& by_icao,
+                                       const std::vector<Airport>& airports, int count,
+                                       const GeoFilter& area, bool random_start,
+                                       std::mt19937& gen) {
+    TraceSpan span("suggest_routes", "routes", ac.name);
+    std::vector<Suggestion> out;
+    int min_rwy = ac.min_runway_ft > 0 ? ac.min_runway_ft : role_min_runway(ac.role);
+    double min_leg = ac.range_nm * 0.3;
+    double max_leg = ac.range_nm * 0.9;
+
+    auto home_it = by_icao.find(ac.home);
+    const Airport* home = (random_start || home_it == by_icao.end()) ? nullptr : &home_it->second;
+    if (!home) {
+        home = pick_random_airport(airports, min_rwy, area, gen);
+    }
+
+    std::vector<std::pair<const Airport*, double>> candidates;
+    for (const auto& a : airports) {
+        if (home && a.icao == home->icao) continue;
+        if (a.longest_runway_ft < min_rwy) continue;
+        if (!area.contains(a)) continue;
+        double dist = 0.0;
+        if (home) {
+            dist = haversine_nm(home->lat, home->lon, a.lat, a.lon);
+            if (dist < min_leg || dist > max_leg) continue;
+        }
+        candidates.push_back({&a, dist});
+    }
+
+    if (candidates.empty()) {
+        // Relax distance filter if nothing found
+        for (const auto& a : airports) {
+            if (a.icao == ac.home) continue;
+            if (a.longest_runway_ft < min_rwy) continue;
+            if (!area.contains(a)) continue;
+            double dist = 0.0;
+            if (home) dist = haversine_nm(home->lat, home->lon, a.lat, a.lon);
+            candidates.push_back({&a, dist});
+        }
+    }
+
+    std::shuffle(candidates.begin(), candidates.end(), gen);
+
+    for (size_t i = 0; i < candidates.size() && (int)out.size() < count; ++i) {
+        Suggestion s;
+        s.from_icao = home ? home->icao : "N/A";
+        s.to_icao = candidates[i].first->icao;
+        s.distance_nm = candidates[i].second;
+        out.push_back(s);
+    }
+    return out;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,31 @@
+// Route suggestions per airframe (range/runway/area fit).
+#pragma once
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/geofilter.hpp"
+
+namespace flightsuite {
+
+struct Suggestion {
+    std::string from_icao;
+    std::string to_icao;
+    double distance_nm = 0.0;
+};
+
+const Airport* pick_random_airport(const std::vector<Airport>& airports, int min_rwy,
+                                   const GeoFilter& area, std::mt19937& gen);
+
+// Destinations that meet runway length and fall between ~30-90% of range from home (or a random
+// runway-qualified start); falls back to any qualified airport when nothing fits.
+std::vector<Suggestion> suggest_routes(const Aircraft& ac,
+                                       const std::unordered_map<std::string, Airport>& by_icao,
+                                       const std::vector<Airport>& airports, int count,
+                                       const GeoFilter& area, bool random_start,
+                                       std::mt19937& gen);
+
+} // namespace flightsuite
@@ -0,0 +1,390 @@
+#include "core/schedule.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include "core/alloc_stats.hpp"
+#include "core/e6b.hpp"
+#include "core/geo.hpp"
+#include "core/spatial.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr int kMaxPasses = 8;
+
+struct Plane {
+    size_t fleet = 0;
+    size_t base = 0;
+    double tas_kt = 0.0;
+    double max_leg_nm = 0.0;
+    int min_runway_ft = 0;
+    int turn_min = 0;
+};
+
+// Everything the restarts share, read-only once built.
+struct Context {
+    const std::vector<Airport>& airports;
+    const ScheduleOptions& opt;
+    std::vector<Plane> planes;
+    std::vector<size_t> eligible; // spatial id -> airport index
+    SpatialIndex index;
+    double window_min = 0.0;
+
+    double leg_nm(size_t a, size_t b) const {
+        return haversine_nm(airports[a].lat, airports[a].lon, airports[b].lat, airports[b].lon);
+    }
+    // Block minutes from a to b; 0 for a == b, kInf when the leg is out of range or too short.
+    double block(const Plane& p, size_t a, size_t b) const {
+        if (a == b) return 0.0;
+        double nm = leg_nm(a, b);
+        if (nm > p.max_leg_nm || nm < opt.min_leg_nm) return kInf;
+        double course = initial_course_deg(airports[a].lat, airports[a].lon, airports[b].lat, airports[b].lon);
+        return block_minutes(nm, course, p.tas_kt, opt);
+    }
+    // Farthest a leg can go in `minutes` of block time, for bounding candidate searches.
+    double reach_nm(const Plane& p, double minutes) const {
+        if (minutes <= opt.taxi_min) return 0.0;
+        return std::min(p.max_leg_nm, (minutes - opt.taxi_min) / 60.0 * (p.tas_kt + opt.wind_kt));
+    }
+};
+
+class Restart {
+public:
+    Restart(const Context& ctx, unsigned n) : ctx_(ctx), stops_(ctx.planes.size()), count_(ctx.airports.size(), 0) {
+        gen_.seed(ctx.opt.seed * 0x9E3779B97F4A7C15ULL + n);
+        noise_ = n == 0 ? 0.0 : 0.6;
+    }
+
+    void run(unsigned n) {
+        // Start 0 fills the shortest-legged aircraft first, since they have the fewest choices;
+        // the others use a shuffled order and noisy greedy picks.
+        std::vector<size_t> order(ctx_.planes.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        if (n == 0) {
+            std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+                return ctx_.planes[a].max_leg_nm < ctx_.planes[b].max_leg_nm;
+            });
+        } else {
+            for (size_t i = order.size(); i > 1; --i) std::swap(order[i - 1], order[gen_() % i]);
+        }
+        for (size_t p : order) greedy(p);
+        for (int pass = 0; pass < kMaxPasses; ++pass) {
+            bool improved = false;
+            for (size_t p : order) improved |= improve(p);
+            if (!improved) break;
+        }
+        for (size_t p : order) {
+            if (stops_[p].empty()) fill_idle(p);
+        }
+    }
+
+    size_t covered() const {
+        return static_cast<size_t>(std::count_if(count_.begin(), count_.end(), [](uint16_t c) { return c > 0; }));
+    }
+    double block_minutes_total() const {
+        double total = 0.0;
+        for (size_t p = 0; p < stops_.size(); ++p) total += duration(p) - turns(p);
+        return total;
+    }
+    const std::vector<size_t>& stops(size_t p) const { return stops_[p]; }
+
+private:
+    double turns(size_t p) const { return static_cast<double>(ctx_.planes[p].turn_min) * stops_[p].size(); }
+
+    double duration(size_t p) const {
+        const Plane& pl = ctx_.planes[p];
+        double total = turns(p);
+        size_t at = pl.base;
+        for (size_t s : stops_[p]) {
+            total += ctx_.block(pl, at, s);
+            at = s;
+        }
+        return total + ctx_.block(pl, at, pl.base);
+    }
+
+    size_t prev_of(size_t p, size_t k) const { return k == 0 ? ctx_.planes[p].base : stops_[p][k - 1]; }
+    size_t next_of(size_t p, size_t k) const {
+        return k == stops_[p].size() ? ctx_.planes[p].base : stops_[p][k];
+    }
+
+    double jitter() {
+        return noise_ == 0.0 ? 1.0 : 1.0 + noise_ * static_cast<double>(gen_() >> 11) * 0x1.0p-53;
+    }
+
+    // Uncovered airports (any, with `covered_too`) within `radius_nm` of `at` that the aircraft
+    // may land at.
+    template <typename Fn>
+    void for_each_candidate(const Plane& pl, size_t at, double radius_nm, Fn&& fn, bool covered_too = false) {
+        if (radius_nm < ctx_.opt.min_leg_nm) return;
+        ctx_.index.within_unordered(ctx_.airports[at].lat, ctx_.airports[at].lon, radius_nm, hits_);
+        for (const auto& h : hits_) {
+            size_t c = ctx_.eligible[h.id];
+            if ((count_[c] && !covered_too) || c == pl.base || ctx_.airports[c].longest_runway_ft < pl.min_runway_ft) {
+                continue;
+            }
+            fn(c);
+        }
+    }
+
+    // An aircraft left without legs flies out and back to the least served airport it can reach,
+    // so the schedule does not park it for the day.
+    void fill_idle(size_t p) {
+        const Plane& pl = ctx_.planes[p];
+        size_t best = 0;
+        double best_score = kInf;
+        for_each_candidate(pl, pl.base, ctx_.reach_nm(pl, ctx_.window_min), [&](size_t c) {
+            double round_trip = ctx_.block(pl, pl.base, c) + pl.turn_min + ctx_.block(pl, c, pl.base);
+            if (round_trip > ctx_.window_min) return;
+            double score = count_[c] * ctx_.window_min + round_trip;
+            if (score < best_score) {
+                best_score = score;
+                best = c;
+            }
+        }, true);
+        if (best_score == kInf) return;
+        stops_[p].push_back(best);
+        ++count_[best];
+    }
+
+    // Builds a rotation stop by stop, taking the cheapest uncovered airport that still leaves time
+    // to get home.
+    void greedy(size_t p) {
+        const Plane& pl = ctx_.planes[p];
+        double used = 0.0;
+        size_t at = pl.base;
+        for (;;) {
+            double left = ctx_.window_min - used, reach = ctx_.reach_nm(pl, left);
+            size_t best = 0;
+            double best_score = kInf, best_cost = 0.0;
+            // Widen the search ring until nothing farther out could beat the best pick: the
+            // cheapest airports are usually close, and a full-range scan costs thousands of hits.
+            // Without a positive minimum leg there is no ring to start from (and doubling would
+            // never grow it), so the first scan covers the whole reach.
+            double first = ctx_.opt.min_leg_nm > 0.0 ? std::min(reach, 4.0 * ctx_.opt.min_leg_nm) : reach;
+            for (double radius = first;; radius = std::min(reach, radius * 2.0)) {
+                for_each_candidate(pl, at, radius, [&](size_t c) {
+                    double out = ctx_.block(pl, at, c), home = ctx_.block(pl, c, pl.base);
+                    if (out + pl.turn_min + home > left) return;
+                    double score = (out + pl.turn_min) * jitter();
+                    if (score < best_score) {
+                        best_score = score;
+                        best = c;
+                        best_cost = out + pl.turn_min;
+                    }
+                });
+                double beyond = ctx_.opt.taxi_min + radius / (pl.tas_kt + ctx_.opt.wind_kt) * 60.0 + pl.turn_min;
+                if (radius >= reach || best_score <= beyond) break;
+            }
+            if (best_score == kInf) break;
+            stops_[p].push_back(best);
+            ++count_[best];
+            used += best_cost;
+            at = best;
+        }
+    }
+
+    // Cheapest insertion of one uncovered airport anywhere in the rotation.
+    bool try_insert(size_t p) {
+        const Plane& pl = ctx_.planes[p];
+        double slack = ctx_.window_min - duration(p);
+        size_t best = 0, best_pos = 0;
+        double best_delta = kInf;
+        for (size_t k = 0; k <= stops_[p].size(); ++k) {
+            size_t a = prev_of(p, k), b = next_of(p, k);
+            double direct = ctx_.block(pl, a, b);
+            for_each_candidate(pl, a, ctx_.reach_nm(pl, slack + direct - pl.turn_min), [&](size_t c) {
+                double delta = ctx_.block(pl, a, c) + pl.turn_min + ctx_.block(pl, c, b) - direct;
+                if (delta <= slack && delta < best_delta) {
+                    best_delta = delta;
+                    best = c;
+                    best_pos = k;
+                }
+            });
+        }
+        if (best_delta == kInf) return false;
+        stops_[p].insert(stops_[p].begin() + static_cast<std::ptrdiff_t>(best_pos), best);
+        ++count_[best];
+        return true;
+    }
+
+    // Swaps a stop that another rotation also serves for an uncovered airport in the same slot.
+    bool try_replace(size_t p, size_t k) {
+        const Plane& pl = ctx_.planes[p];
+        size_t old = stops_[p][k], a = prev_of(p, k), b = next_of(p, k + 1);
+        double base_dur = duration(p) - ctx_.block(pl, a, old) - ctx_.block(pl, old, b);
+        double left = ctx_.window_min - base_dur;
+        size_t best = 0;
+        double best_dur = kInf;
+        for_each_candidate(pl, a, ctx_.reach_nm(pl, left), [&](size_t c) {
+            double dur = base_dur + ctx_.block(pl, a, c) + ctx_.block(pl, c, b);
+            if (dur <= ctx_.window_min && dur < best_dur) {
+                best_dur = dur;
+                best = c;
+            }
+        });
+        if (best_dur == kInf) return false;
+        --count_[old];
+        ++count_[best];
+        stops_[p][k] = best;
+        return true;
+    }
+
+    // Drops a doubly served stop and spends the time it frees on an insertion elsewhere in the
+    // rotation; undone when nothing fits.
+    bool try_trade(size_t p, size_t k) {
+        const Plane& pl = ctx_.planes[p];
+        size_t old = stops_[p][k];
+        if (ctx_.block(pl, prev_of(p, k), next_of(p, k + 1)) == kInf) return false;
+        // Still served by another rotation afterwards, so the insertion cannot pick it back.
+        stops_[p].erase(stops_[p].begin() + static_cast<std::ptrdiff_t>(k));
+        --count_[old];
+        bool ok = try_insert(p);
+        if (!ok) {
+            stops_[p].insert(stops_[p].begin() + static_cast<std::ptrdiff_t>(k), old);
+            ++count_[old];
+        }
+        return ok;
+    }
+
+    bool improve(size_t p) {
+        bool improved = false;
+        while (try_insert(p)) improved = true;
+        for (size_t k = 0; k < stops_[p].size(); ++k) {
+            if (count_[stops_[p][k]] < 2) continue;
+            if (try_replace(p, k) || try_trade(p, k)) improved = true;
+        }
+        return improved;
+    }
+
+    const Context& ctx_;
+    std::vector<std::vector<size_t>> stops_; // outstations per plane, in flying order
+    std::vector<uint16_t> count_;            // rotations serving each airport
+    std::mt19937_64 gen_;
+    double noise_ = 0.0;
+    std::vector<SpatialHit> hits_;
+};
+
+} // namespace
+
+double block_minutes(double distance_nm, double course_deg, double tas_kt, const ScheduleOptions& opt) {
+    double cross = crosswind_component(opt.wind_dir_deg, opt.wind_kt, course_deg);
+    if (cross >= tas_kt) return kInf;
+    double gs = std::sqrt(tas_kt * tas_kt - cross * cross) -
+                headwind_component(opt.wind_dir_deg, opt.wind_kt, course_deg);
+    return gs > 1.0 ? opt.taxi_min + distance_nm / gs * 60.0 : kInf;
+}
+
+FleetSchedule build_schedule(const std::vector<Aircraft>& fleet, const std::vector<Airport>& airports,
+                             const ScheduleOptions& opt) {
+    TraceSpan span("build_schedule", "schedule", [&] { return std::to_string(fleet.size()) + " aircraft"; });
+    FleetSchedule out;
+    Context ctx{airports, opt, {}, {}, {}, static_cast<double>(opt.day_end_min - opt.day_start_min)};
+    std::unordered_map<std::string, size_t> by_icao;
+    for (size_t i = 0; i < airports.size(); ++i) by_icao.emplace(airports[i].icao, i);
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        const Aircraft& ac = fleet[i];
+        auto it = by_icao.find(ac.home);
+        if (it == by_icao.end()) {
+            out.unbased.push_back(i);
+            continue;
+        }
+        Plane p;
+        p.fleet = i;
+        p.base = it->second;
+        p.tas_kt = ac.cruise_tas_kt > 0.0 ? ac.cruise_tas_kt : role_cruise_tas(ac.role);
+        p.max_leg_nm = ac.range_nm * 0.9; // same reserve as suggest_routes
+        p.min_runway_ft = ac.min_runway_ft > 0 ? ac.min_runway_ft : role_min_runway(ac.role);
+        p.turn_min = opt.turnaround_min > 0 ? opt.turnaround_min : role_turnaround_min(ac.role);
+        ctx.planes.push_back(p);
+    }
+    std::vector<GeoPoint> points;
+    std::vector<uint8_t> in_area = opt.area.mask(airports);
+    for (size_t i = 0; i < airports.size(); ++i) {
+        const Airport& a = airports[i];
+        if (!in_area[i]) continue;
+        ctx.eligible.push_back(i);
+        points.push_back({a.lat, a.lon});
+    }
+    ctx.index = SpatialIndex(points);
+    if (ctx.planes.empty() || ctx.window_min <= 0.0) return out;
+
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    unsigned restarts = std::max(1u, opt.restarts);
+    threads = std::min(threads, restarts);
+    std::vector<std::unique_ptr<Restart>> results(restarts);
+    std::atomic<unsigned> next{0};
+    auto worker = [&](unsigned n) {
+        AllocStageScope stage(AllocStage::kAnalyze);
+        if (threads > 1) trace_set_thread_name("schedule worker " + std::to_string(n));
+        for (unsigned r; (r = next.fetch_add(1, std::memory_order_relaxed)) < restarts;) {
+            TraceSpan restart_span("schedule_restart", "schedule", [r] { return std::to_string(r); });
+            auto restart = std::make_unique<Restart>(ctx, r);
+            restart->run(r);
+            results[r] = std::move(restart);
+        }
+    };
+    if (threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+        for (auto& t : pool) t.join();
+    }
+
+    // Most airports served, then most block time; the lowest start wins ties, so the result does
+    // not depend on the thread count.
+    unsigned best = 0;
+    size_t best_covered = results[0]->covered();
+    double best_block = results[0]->block_minutes_total();
+    for (unsigned r = 1; r < restarts; ++r) {
+        size_t covered = results[r]->covered();
+        double block = results[r]->block_minutes_total();
+        if (covered > best_covered || (covered == best_covered && block > best_block)) {
+            best = r;
+            best_covered = covered;
+            best_block = block;
+        }
+    }
+    out.restarts = restarts;
+    out.best_restart = best;
+    out.covered = best_covered;
+    out.block_hours = best_block / 60.0;
+    const Restart& win = *results[best];
+    for (size_t p = 0; p < ctx.planes.size(); ++p) {
+        const Plane& pl = ctx.planes[p];
+        Rotation rot;
+        rot.aircraft = pl.fleet;
+        rot.base = pl.base;
+        double t = opt.day_start_min;
+        size_t at = pl.base;
+        auto fly = [&](size_t to) {
+            double block = ctx.block(pl, at, to);
+            ScheduledLeg leg;
+            leg.from = at;
+            leg.to = to;
+            leg.out_min = static_cast<int>(std::lround(t));
+            leg.in_min = static_cast<int>(std::lround(t + block));
+            leg.distance_nm = ctx.leg_nm(at, to);
+            rot.legs.push_back(leg);
+            t += block + pl.turn_min;
+            at = to;
+        };
+        for (size_t s : win.stops(p)) fly(s);
+        if (at != pl.base) fly(pl.base);
+        out.rotations.push_back(std::move(rot));
+    }
+    return out;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,61 @@
+// Daily fleet schedule for a virtual airline: every aircraft flies a rotation out of its base and
+// back within the duty day, legs fit its range and runway needs, block times come from its cruise
+// TAS in a planning wind, and the fleet together serves as many distinct airports as it can.
+// Greedy construction plus local search (insert new stops, swap or trade doubly served ones),
+// repeated from several randomized starts in parallel; the best schedule wins.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/geofilter.hpp"
+
+namespace flightsuite {
+
+struct ScheduleOptions {
+    int day_start_min = 6 * 60; // first departure, minutes past midnight
+    int day_end_min = 22 * 60;  // every aircraft is back on its base by then
+    double taxi_min = 15.0;     // block time on top of the airborne time, per leg
+    double min_leg_nm = 60.0;
+    int turnaround_min = 0; // at outstations; 0 = by role
+    double wind_dir_deg = 0.0;
+    double wind_kt = 0.0;
+    GeoFilter area;        // outstations must lie inside; bases are exempt
+    unsigned restarts = 8; // randomized starts; the best wins
+    unsigned threads = 0;  // workers running the starts; 0 = hardware concurrency
+    uint64_t seed = 1;
+};
+
+struct ScheduledLeg {
+    size_t from = 0; // airport indexes
+    size_t to = 0;
+    int out_min = 0; // block out / in, minutes past midnight
+    int in_min = 0;
+    double distance_nm = 0.0;
+};
+
+struct Rotation {
+    size_t aircraft = 0; // fleet index
+    size_t base = 0;     // airport index
+    std::vector<ScheduledLeg> legs;
+};
+
+struct FleetSchedule {
+    std::vector<Rotation> rotations; // one per aircraft with a known base, in fleet order
+    std::vector<size_t> unbased;     // fleet indexes whose home is not in the catalog
+    size_t covered = 0;              // distinct airports served, bases excluded
+    double block_hours = 0.0;
+    unsigned restarts = 0;
+    unsigned best_restart = 0;
+};
+
+// Block minutes for one leg: taxi allowance plus distance over the wind-corrected ground speed.
+double block_minutes(double distance_nm, double course_deg, double tas_kt, const ScheduleOptions& opt);
+
+FleetSchedule build_schedule(const std::vector<Aircraft>& fleet, const std::vector<Airport>& airports,
+                             const ScheduleOptions& opt);
+
+} // namespace flightsuite
@@ -0,0 +1,296 @@
+#include "core/spatial.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+void to_unit(double lat, double lon, double* xyz) {
+    double la = deg2rad(lat), lo = deg2rad(lon);
+    xyz[0] = std::cos(la) * std::cos(lo);
+    xyz[1] = std::cos(la) * std::sin(lo);
+    xyz[2] = std::sin(la);
+}
+
+// Great-circle distance <-> squared chord on the unit sphere.
+double nm_to_chord_sq(double nm) {
+    double angle = std::min(nm / kEarthRadiusNm, kPi);
+    double chord = 2.0 * std::sin(angle / 2.0);
+    return chord * chord;
+}
+
+double chord_sq_to_nm(double chord_sq) {
+    double half = std::min(std::sqrt(chord_sq) / 2.0, 1.0);
+    return 2.0 * std::asin(half) * kEarthRadiusNm;
+}
+
+double dist_sq(const double* a, const double* b) {
+    double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Squared distance from `q` to the nearest point of the box [min, max].
+double box_dist_sq(const double* min, const double* max, const double* q) {
+    double sum = 0.0;
+    for (int a = 0; a < 3; ++a) {
+        double d = q[a] < min[a] ? min[a] - q[a] : q[a] > max[a] ? q[a] - max[a] : 0.0;
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Squared distance from `q` to the farthest corner of the box [min, max].
+double box_far_sq(const double* min, const double* max, const double* q) {
+    double sum = 0.0;
+    for (int a = 0; a < 3; ++a) {
+        double d = std::max(q[a] - min[a], max[a] - q[a]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(const std::vector<GeoPoint>& points, bool subtree_bounds) {
+    TraceSpan span("spatial_index_build", "spatial");
+    nodes_.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        to_unit(points[i].lat, points[i].lon, nodes_[i].xyz);
+        nodes_[i].id = static_cast<uint32_t>(i);
+        nodes_[i].axis = 0;
+    }
+    build(0, nodes_.size());
+    if (subtree_bounds && !nodes_.empty()) {
+        boxes_.resize(nodes_.size());
+        bound(0, nodes_.size());
+    }
+}
+
+SpatialIndex SpatialIndex::view(const SpatialNode* nodes, size_t count) {
+    SpatialIndex index;
+    index.view_ = nodes;
+    index.view_size_ = count;
+    return index;
+}
+
+void SpatialIndex::build(size_t lo, size_t hi) {
+    if (hi - lo <= 1) return;
+    // Split on the axis with the widest spread.
+    double mn[3] = {2, 2, 2}, mx[3] = {-2, -2, -2};
+    for (size_t i = lo; i < hi; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            mn[a] = std::min(mn[a], nodes_[i].xyz[a]);
+            mx[a] = std::max(mx[a], nodes_[i].xyz[a]);
+        }
+    }
+    uint8_t axis = 0;
+    for (uint8_t a = 1; a < 3; ++a) {
+        if (mx[a] - mn[a] > mx[axis] - mn[axis]) axis = a;
+    }
+    size_t mid = (lo + hi) / 2;
+    std::nth_element(nodes_.begin() + lo, nodes_.begin() + mid, nodes_.begin() + hi,
+                     [axis](const Node& a, const Node& b) { return a.xyz[axis] < b.xyz[axis]; });
+    nodes_[mid].axis = axis;
+    build(lo, mid);
+    build(mid + 1, hi);
+}
+
+void SpatialIndex::bound(size_t lo, size_t hi) {
+    size_t mid = (lo + hi) / 2;
+    Box box;
+    for (int a = 0; a < 3; ++a) box.min[a] = box.max[a] = nodes_[mid].xyz[a];
+    auto merge = [&](size_t sub_lo, size_t sub_hi) {
+        if (sub_lo == sub_hi) return;
+        bound(sub_lo, sub_hi);
+        const Box& sub = boxes_[(sub_lo + sub_hi) / 2];
+        for (int a = 0; a < 3; ++a) {
+            box.min[a] = std::min(box.min[a], sub.min[a]);
+            box.max[a] = std::max(box.max[a], sub.max[a]);
+        }
+    };
+    merge(lo, mid);
+    merge(mid + 1, hi);
+    boxes_[mid] = box;
+}
+
+// `heap` is a max-heap on squared chord holding the best `k` so far; `bound_sq` is the pruning radius.
+void SpatialIndex::search(size_t lo, size_t hi, const double* q, size_t k, double& bound_sq,
+                          std::vector<std::pair<double, uint32_t>>& heap) const {
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const Node& n = nodes()[mid];
+        double d = dist_sq(q, n.xyz);
+        if (d <= bound_sq) {
+            heap.emplace_back(d, n.id);
+            std::push_heap(heap.begin(), heap.end());
+            if (heap.size() > k) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+            if (heap.size() == k) bound_sq = std::min(bound_sq, heap.front().first);
+        }
+        if (hi - lo == 1) return;
+        double diff = q[n.axis] - n.xyz[n.axis];
+        size_t near_lo = diff < 0 ? lo : mid + 1, near_hi = diff < 0 ? mid : hi;
+        size_t far_lo = diff < 0 ? mid + 1 : lo, far_hi = diff < 0 ? hi : mid;
+        search(near_lo, near_hi, q, k, bound_sq, heap);
+        if (diff * diff > bound_sq) return;
+        lo = far_lo; // tail-iterate into the far side
+        hi = far_hi;
+    }
+}
+
+// Every point within `bound_sq`, in tree order, with the squared chord in distance_nm.
+void SpatialIndex::range(size_t lo, size_t hi, const double* q, double bound_sq, std::vector<SpatialHit>& out) const {
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const Node& n = nodes()[mid];
+        double d = dist_sq(q, n.xyz);
+        if (d <= bound_sq) out.push_back({n.id, d});
+        if (hi - lo == 1) return;
+        double diff = q[n.axis] - n.xyz[n.axis];
+        size_t near_lo = diff < 0 ? lo : mid + 1, near_hi = diff < 0 ? mid : hi;
+        size_t far_lo = diff < 0 ? mid + 1 : lo, far_hi = diff < 0 ? hi : mid;
+        range(near_lo, near_hi, q, bound_sq, out);
+        if (diff * diff > bound_sq) return;
+        lo = far_lo;
+        hi = far_hi;
+    }
+}
+
+// range() over the intersection of two balls. With subtree boxes, every subtree whose box misses
+// either ball is skipped and one inside both is taken whole; without them only the split planes
+// prune, against the first ball. Subtrees the mask has emptied are skipped too.
+void SpatialIndex::range_both(size_t lo, size_t hi, const double* q, double bound_sq, const double* q2,
+                              double bound2_sq, const SpatialMask* mask, std::vector<SpatialHit>& out) const {
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (mask && mask->left(lo, mid, hi) == 0) return;
+        if (!boxes_.empty()) {
+            const Box& box = boxes_[mid];
+            if (box_dist_sq(box.min, box.max, q) > bound_sq || box_dist_sq(box.min, box.max, q2) > bound2_sq) return;
+            if (box_far_sq(box.min, box.max, q) <= bound_sq && box_far_sq(box.min, box.max, q2) <= bound2_sq) {
+                for (size_t i = lo; i < hi; ++i) {
+                    if (!mask || !mask->removed(i)) out.push_back({nodes()[i].id, dist_sq(q, nodes()[i].xyz)});
+                }
+                return;
+            }
+        }
+        const Node& n = nodes()[mid];
+        double d = dist_sq(q, n.xyz);
+        if (d <= bound_sq && dist_sq(q2, n.xyz) <= bound2_sq && (!mask || !mask->removed(mid))) {
+            out.push_back({n.id, d});
+        }
+        if (hi - lo == 1) return;
+        double diff = q[n.axis] - n.xyz[n.axis];
+        bool planes = boxes_.empty() && diff * diff > bound_sq;
+        bool skip_left = planes && diff > 0, skip_right = planes && diff < 0;
+        if (!skip_left && !skip_right) range_both(lo, mid, q, bound_sq, q2, bound2_sq, mask, out);
+        if (skip_right) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+}
+
+void SpatialIndex::collect(std::vector<std::pair<double, uint32_t>>& heap, std::vector<SpatialHit>& out) const {
+    std::sort_heap(heap.begin(), heap.end());
+    out.clear();
+    out.reserve(heap.size());
+    for (const auto& [d, id] : heap) out.push_back({id, chord_sq_to_nm(d)});
+}
+
+void SpatialIndex::nearest(double lat, double lon, size_t k, double max_nm, std::vector<SpatialHit>& out) const {
+    std::vector<std::pair<double, uint32_t>> heap;
+    double q[3];
+    to_unit(lat, lon, q);
+    double bound_sq = nm_to_chord_sq(max_nm);
+    if (k > 0) search(0, size(), q, k, bound_sq, heap);
+    collect(heap, out);
+}
+
+void SpatialIndex::within(double lat, double lon, double radius_nm, std::vector<SpatialHit>& out) const {
+    // A plain range walk and one sort beats feeding every hit through the k-nearest heap.
+    double q[3];
+    to_unit(lat, lon, q);
+    out.clear();
+    range(0, size(), q, nm_to_chord_sq(radius_nm), out);
+    std::sort(out.begin(), out.end(), [](const SpatialHit& a, const SpatialHit& b) {
+        return a.distance_nm < b.distance_nm || (a.distance_nm == b.distance_nm && a.id < b.id);
+    });
+    for (auto& h : out) h.distance_nm = chord_sq_to_nm(h.distance_nm);
+}
+
+void SpatialIndex::within_unordered(double lat, double lon, double radius_nm, std::vector<SpatialHit>& out) const {
+    double q[3];
+    to_unit(lat, lon, q);
+    out.clear();
+    range(0, size(), q, nm_to_chord_sq(radius_nm), out);
+    for (auto& h : out) h.distance_nm = chord_sq_to_nm(h.distance_nm);
+}
+
+void SpatialIndex::within_both_unordered(double lat, double lon, double radius_nm, double lat2, double lon2,
+                                         double radius2_nm, std::vector<SpatialHit>& out,
+                                         const SpatialMask* mask) const {
+    double q[3], q2[3];
+    to_unit(lat, lon, q);
+    to_unit(lat2, lon2, q2);
+    out.clear();
+    range_both(0, size(), q, nm_to_chord_sq(radius_nm), q2, nm_to_chord_sq(radius2_nm), mask, out);
+    for (auto& h : out) h.distance_nm = chord_sq_to_nm(h.distance_nm);
+}
+
+void SpatialIndex::nearest_batch(const std::vector<GeoPoint>& queries, size_t k, double max_nm,
+                                 std::vector<std::vector<SpatialHit>>& out) const {
+    TraceSpan span("spatial_nearest_batch", "spatial");
+    out.resize(queries.size());
+    std::vector<std::pair<double, uint32_t>> heap;
+    double max_sq = nm_to_chord_sq(max_nm);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        heap.clear();
+        double q[3];
+        to_unit(queries[i].lat, queries[i].lon, q);
+        double bound_sq = max_sq;
+        if (k > 0) search(0, size(), q, k, bound_sq, heap);
+        collect(heap, out[i]);
+    }
+}
+
+SpatialMask::SpatialMask(const SpatialIndex& index)
+    : position_(index.size()), counts_(index.size()), removed_(index.size(), 0) {
+    for (size_t i = 0; i < index.size(); ++i) position_[index.nodes()[i].id] = static_cast<uint32_t>(i);
+}
+
+void SpatialMask::reset() {
+    if (++epoch_ == 0) { // stamps wrapped: start over
+        std::fill(counts_.begin(), counts_.end(), Count{});
+        std::fill(removed_.begin(), removed_.end(), 0);
+        epoch_ = 1;
+    }
+}
+
+void SpatialMask::remove(uint32_t id) {
+    size_t pos = position_[id];
+    if (removed_[pos] == epoch_) return;
+    removed_[pos] = epoch_;
+    size_t lo = 0, hi = position_.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        counts_[mid] = {epoch_, left(lo, mid, hi) - 1};
+        if (pos == mid) return;
+        if (pos < mid) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+}
+
+} // namespace flightsuite
@@ -0,0 +1,115 @@
+// Static spatial index over points on the Earth: a k-d tree on unit vectors, so the poles and the
+// antimeridian need no special cases and chord length orders points by great-circle distance.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace flightsuite {
+
+struct GeoPoint {
+    double lat = 0.0;
+    double lon = 0.0;
+};
+
+// One tree node: the point as a unit vector, its id, and the split axis of the subtree it is the
+// median of. Plain data, so a built tree can be written to disk and mapped back (see core/navdata).
+struct SpatialNode {
+    double xyz[3];
+    uint32_t id;
+    uint8_t axis;
+};
+
+struct SpatialHit {
+    uint32_t id = 0; // position of the point in the vector the index was built from
+    double distance_nm = 0.0;
+};
+
+class SpatialMask;
+
+class SpatialIndex {
+public:
+    SpatialIndex() = default;
+    // `subtree_bounds` also keeps every subtree's bounding box (48 bytes a point), which lets
+    // within_both_unordered() prune against both circles rather than filter one ball's points.
+    explicit SpatialIndex(const std::vector<GeoPoint>& points, bool subtree_bounds = false);
+
+    // Non-owning index over a tree laid out by nodes() of another index, e.g. mapped from a file;
+    // the memory must outlive the index.
+    static SpatialIndex view(const SpatialNode* nodes, size_t count);
+
+    size_t size() const { return view_ ? view_size_ : nodes_.size(); }
+    // The tree in its implicit layout, for serialization.
+    const SpatialNode* nodes() const { return view_ ? view_ : nodes_.data(); }
+
+    // Up to `k` points within `max_nm` of (lat, lon), nearest first. `out` is overwritten.
+    void nearest(double lat, double lon, size_t k, double max_nm, std::vector<SpatialHit>& out) const;
+    // Every point within `radius_nm`, nearest first.
+    void within(double lat, double lon, double radius_nm, std::vector<SpatialHit>& out) const;
+    // within() without the sort, for callers that visit every hit anyway.
+    void within_unordered(double lat, double lon, double radius_nm, std::vector<SpatialHit>& out) const;
+    // within_unordered() restricted to points also within `radius2_nm` of (lat2, lon2) and, given a
+    // mask, not removed from it. Distances are to (lat, lon).
+    void within_both_unordered(double lat, double lon, double radius_nm, double lat2, double lon2,
+                               double radius2_nm, std::vector<SpatialHit>& out,
+                               const SpatialMask* mask = nullptr) const;
+    // nearest() for each query; out[i] answers queries[i]. Reuses one scratch heap for the batch.
+    void nearest_batch(const std::vector<GeoPoint>& queries, size_t k, double max_nm,
+                       std::vector<std::vector<SpatialHit>>& out) const;
+
+private:
+    using Node = SpatialNode;
+    struct Box {
+        double min[3];
+        double max[3];
+    };
+
+    void build(size_t lo, size_t hi);
+    void bound(size_t lo, size_t hi);
+    void search(size_t lo, size_t hi, const double* q, size_t k, double& bound_sq,
+                std::vector<std::pair<double, uint32_t>>& heap) const;
+    void range(size_t lo, size_t hi, const double* q, double bound_sq, std::vector<SpatialHit>& out) const;
+    void range_both(size_t lo, size_t hi, const double* q, double bound_sq, const double* q2, double bound2_sq,
+                    const SpatialMask* mask, std::vector<SpatialHit>& out) const;
+    void collect(std::vector<std::pair<double, uint32_t>>& heap, std::vector<SpatialHit>& out) const;
+
+    std::vector<Node> nodes_; // implicit tree: the median of [lo, hi) sits at (lo + hi) / 2
+    std::vector<Box> boxes_;  // bounds of [lo, hi), at (lo + hi) / 2; empty unless requested
+    const Node* view_ = nullptr; // set instead of nodes_ for views
+    size_t view_size_ = 0;
+};
+
+// Points ruled out of an index's within_both_unordered() walks, e.g. the settled nodes of a search.
+// Counts the points left under every subtree so a walk skips subtrees with none; reset() is O(1),
+// so one mask serves query after query.
+class SpatialMask {
+public:
+    SpatialMask() = default;
+    explicit SpatialMask(const SpatialIndex& index);
+
+    void reset();
+    void remove(uint32_t id);
+
+private:
+    friend class SpatialIndex;
+
+    struct Count {
+        uint32_t stamp = 0; // left is valid when stamp == epoch_
+        uint32_t left = 0;
+    };
+
+    // Points left in [lo, hi), whose median is at `mid`.
+    uint32_t left(size_t lo, size_t mid, size_t hi) const {
+        return counts_[mid].stamp == epoch_ ? counts_[mid].left : static_cast<uint32_t>(hi - lo);
+    }
+    bool removed(size_t pos) const { return removed_[pos] == epoch_; }
+
+    std::vector<uint32_t> position_; // tree position of each point id
+    std::vector<Count> counts_;      // by tree position of the subtree's median
+    std::vector<uint32_t> removed_;  // == epoch_ once removed
+    uint32_t epoch_ = 1;
+};
+
+} // namespace flightsuite
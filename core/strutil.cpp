@@ -0,0 +1,106 @@
+#include "core/strutil.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+#include "core/compress.hpp"
+
+namespace flightsuite {
+
+std::string trim(const std::string& s) {
+    size_t start = 0;
+    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
+    size_t end = s.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+    return s.substr(start, end - start);
+}
+
+std::string to_upper(const std::string& s) {
+    std::string out = s;
+    std::transform(out.begin(), out.end(), out.begin(), ::toupper);
+    return out;
+}
+
+bool is_number(const std::string& s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
+}
+
+std::vector<std::string> split_tokens(const std::string& s) {
+    std::istringstream iss(s);
+    std::vector<std::string> tokens;
+    std::string tok;
+    while (iss >> tok) {
+        tokens.push_back(tok);
+    }
+    return tokens;
+}
+
+std::vector<std::string> split_lines(const std::string& text) {
+    std::istringstream iss(text);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(iss, line)) {
+        line = trim(line);
+        if (!line.empty()) lines.push_back(line);
+    }
+    return lines;
+}
+
+std::vector<std::string> split_csv_line(const std::string& line) {
+    std::vector<std::string> cells;
+    std::string cell;
+    std::istringstream ss(line);
+    while (std::getline(ss, cell, ',')) {
+        cells.push_back(trim(cell));
+    }
+    return cells;
+}
+
+std::optional<double> parse_double(const std::string& s) {
+    try {
+        return std::stod(s);
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+std::string format_double(double v, int precision) {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed, std::ios::floatfield);
+    oss.precision(precision);
+    oss << v;
+    return oss.str();
+}
+
+// A missing file is the caller's to report; a compressed one we cannot decode is reported here.
+static bool open_reader(ChunkedFileReader& reader, const std::string& path) {
+    if (reader.open(path)) return true;
+    if (reader.compression() != Compression::kNone) std::cerr << reader.error() << "\n";
+    return false;
+}
+
+std::optional<std::string> read_file(const std::string& path) {
+    ChunkedFileReader reader;
+    if (!open_reader(reader, path)) return std::nullopt;
+    std::string text, chunk;
+    while (reader.next(chunk)) text += chunk;
+    if (reader.failed()) {
+        std::cerr << "Failed to decode " << path << ": " << reader.error() << "\n";
+        return std::nullopt;
+    }
+    return text;
+}
+
+bool read_file_lines(const std::string& path, std::vector<std::string>& lines_out) {
+    ChunkedFileReader reader;
+    if (!open_reader(reader, path)) return false;
+    bool ok = for_each_line(reader, [&lines_out](std::string_view line) {
+        if (!line.empty()) lines_out.emplace_back(line);
+    });
+    if (!ok) std::cerr << "Failed to decode " << path << ": " << reader.error() << "\n";
+    return ok;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,30 @@
+// String and file helpers shared by every tool (trim, token/CSV splitting, whole-file reads).
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flightsuite {
+
+std::string trim(const std::string& s);
+std::string to_upper(const std::string& s);
+bool is_number(const std::string& s);
+
+// Whitespace-separated tokens.
+std::vector<std::string> split_tokens(const std::string& s);
+// Trimmed, non-empty lines.
+std::vector<std::string> split_lines(const std::string& text);
+// Comma-separated cells, each trimmed. No quoting support (the suite's CSVs never quote).
+std::vector<std::string> split_csv_line(const std::string& line);
+
+std::optional<double> parse_double(const std::string& s);
+std::string format_double(double v, int precision = 1);
+
+// Both read plain, gzip, or zstd files alike (see core/compress.hpp).
+std::optional<std::string> read_file(const std::string& path);
+// Appends the non-empty lines of `path`, streaming compressed input; returns false if the file
+// cannot be opened or decoded.
+bool read_file_lines(const std::string& path, std::vector<std::string>& lines_out);
+
+} // namespace flightsuite
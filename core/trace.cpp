@@ -0,0 +1,220 @@
+#include "core/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/json.hpp"
+#include "core/strutil.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr size_t kRingCapacity = 1 << 15;
+constexpr size_t kDetailLen = 48;
+
+struct TraceEvent {
+    int64_t start_ns;
+    int64_t dur_ns;
+    const char* name;
+    const char* cat;
+    char detail[kDetailLen];
+};
+
+struct ThreadBuffer {
+    int tid = 0;
+    std::string name;
+    std::vector<TraceEvent> ring;
+    uint64_t written = 0;
+};
+
+std::atomic<bool> g_enabled{false};
+std::mutex g_mu; // guards g_buffers, g_imported
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+std::vector<std::string> g_imported; // raw event lists from other processes
+std::string g_out_path;
+std::string g_process_name;
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+struct OpenStage {
+    const char* name = nullptr;
+    int64_t start_ns = 0;
+};
+thread_local OpenStage t_stage;
+
+int64_t now_ns() {
+    // steady_clock is CLOCK_MONOTONIC on Linux, so timestamps from child processes line up.
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+ThreadBuffer& buffer() {
+    if (!t_buffer) {
+        auto b = std::make_shared<ThreadBuffer>();
+        b->ring.resize(kRingCapacity);
+        std::lock_guard<std::mutex> lock(g_mu);
+        b->tid = static_cast<int>(g_buffers.size()) + 1;
+        b->name = b->tid == 1 ? "main" : "thread " + std::to_string(b->tid);
+        g_buffers.push_back(b);
+        t_buffer = b.get();
+    }
+    return *t_buffer;
+}
+
+void record(const char* name, const char* cat, int64_t start_ns, int64_t end_ns, const std::string& detail) {
+    ThreadBuffer& b = buffer();
+    TraceEvent& e = b.ring[b.written++ % kRingCapacity];
+    e.start_ns = start_ns;
+    e.dur_ns = end_ns - start_ns;
+    e.name = name;
+    e.cat = cat;
+    size_t n = std::min(detail.size(), kDetailLen - 1);
+    std::memcpy(e.detail, detail.data(), n);
+    e.detail[n] = '\0';
+}
+
+void close_stage() {
+    if (t_stage.name) {
+        record(t_stage.name, "stage", t_stage.start_ns, now_ns(), "");
+        t_stage.name = nullptr;
+    }
+}
+
+void write_at_exit() {
+    close_stage();
+    write_chrome_trace(g_out_path);
+}
+
+std::string metadata_event(const char* kind, int pid, int tid, const std::string& name) {
+    JsonWriter w;
+    w.begin_object();
+    w.field("name", kind);
+    w.field("ph", "M");
+    w.field("pid", pid);
+    w.field("tid", tid);
+    w.key("args").begin_object().field("name", name).end_object();
+    w.end_object();
+    return w.str();
+}
+
+} // namespace
+
+void set_tracing(bool on) { g_enabled.store(on, std::memory_order_relaxed); }
+
+bool tracing_enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+TraceSpan::TraceSpan(const char* name, const char* cat) : name_(name), cat_(cat) {
+    if (g_enabled.load(std::memory_order_relaxed)) start_ns_ = now_ns();
+}
+
+TraceSpan::TraceSpan(const char* name, const char* cat, const std::string& detail) : name_(name), cat_(cat) {
+    if (g_enabled.load(std::memory_order_relaxed)) {
+        detail_ = detail;
+        start_ns_ = now_ns();
+    }
+}
+
+void TraceSpan::end() {
+    if (start_ns_ < 0) return;
+    record(name_, cat_, start_ns_, now_ns(), detail_);
+    start_ns_ = -1;
+}
+
+void enter_stage(AllocStage stage) {
+    set_alloc_stage(stage);
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    close_stage();
+    if (stage == AllocStage::kOther) return;
+    t_stage.name = alloc_stage_name(stage);
+    t_stage.start_ns = now_ns();
+}
+
+void trace_set_thread_name(const std::string& name) {
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    ThreadBuffer& b = buffer();
+    std::lock_guard<std::mutex> lock(g_mu);
+    b.name = name;
+}
+
+bool trace_import_file(const std::string& path) {
+    auto text = read_file(path);
+    if (!text) return false;
+    // Our own files: {"traceEvents":[ ... ],"displayTimeUnit":"ms"}
+    size_t open = text->find('[');
+    size_t close = text->rfind(']');
+    if (open == std::string::npos || close == std::string::npos || close <= open + 1) return false;
+    std::lock_guard<std::mutex> lock(g_mu);
+    g_imported.push_back(text->substr(open + 1, close - open - 1));
+    return true;
+}
+
+bool write_chrome_trace(const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    int pid = static_cast<int>(getpid());
+    std::lock_guard<std::mutex> lock(g_mu);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    auto emit = [&](const std::string& ev) {
+        if (!first) out << ",\n";
+        first = false;
+        out << ev;
+    };
+    if (!g_process_name.empty()) emit(metadata_event("process_name", pid, 0, g_process_name));
+    for (const auto& b : g_buffers) {
+        emit(metadata_event("thread_name", pid, b->tid, b->name));
+        uint64_t count = std::min<uint64_t>(b->written, kRingCapacity);
+        for (uint64_t i = b->written - count; i < b->written; ++i) {
+            const TraceEvent& e = b->ring[i % kRingCapacity];
+            JsonWriter w;
+            w.begin_object();
+            w.field("name", e.name);
+            w.field("cat", e.cat);
+            w.field("ph", "X");
+            w.field("ts", static_cast<double>(e.start_ns) / 1000.0, 3);
+            w.field("dur", static_cast<double>(e.dur_ns) / 1000.0, 3);
+            w.field("pid", pid);
+            w.field("tid", b->tid);
+            if (e.detail[0]) w.key("args").begin_object().field("detail", e.detail).end_object();
+            w.end_object();
+            emit(w.str());
+        }
+    }
+    for (const auto& chunk : g_imported) emit(chunk);
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
+
+std::string init_trace(int& argc, char** argv) {
+    std::string path;
+    int w = 1;
+    for (int r = 1; r < argc; ++r) {
+        if (std::strcmp(argv[r], "--trace") == 0 && r + 1 < argc) {
+            path = argv[++r];
+        } else {
+            argv[w++] = argv[r];
+        }
+    }
+    argc = w;
+    argv[argc] = nullptr;
+    if (path.empty()) return path;
+    g_out_path = path;
+    set_tracing(true);
+    const char* slash = std::strrchr(argv[0], '/');
+    g_process_name = slash ? slash + 1 : argv[0];
+    std::atexit(write_at_exit);
+    return path;
+}
+
+} // namespace flightsuite
@@ -0,0 +1,58 @@
+// Lightweight scoped-span tracing with Chrome/Perfetto trace-event JSON export. Each thread
+// records into its own fixed-size ring buffer (oldest spans are overwritten); when tracing is off
+// a span costs one relaxed atomic load. Tools enable it with `--trace out.json`.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "core/alloc_stats.hpp"
+
+namespace flightsuite {
+
+void set_tracing(bool on);
+bool tracing_enabled();
+
+// Records [construction, end()/destruction) as a complete event. `name` and `cat` must be string
+// literals (or otherwise outlive the process); `detail` is copied (truncated) into the event.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* cat = "core");
+    TraceSpan(const char* name, const char* cat, const std::string& detail);
+    // Lazy detail: `detail()` is called only when tracing is on, so call sites can format freely.
+    template <typename DetailFn, typename = std::enable_if_t<std::is_invocable_r_v<std::string, DetailFn&>>>
+    TraceSpan(const char* name, const char* cat, DetailFn&& detail) : TraceSpan(name, cat) {
+        if (start_ns_ >= 0) detail_ = detail();
+    }
+    ~TraceSpan() { end(); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void end();
+
+private:
+    const char* name_;
+    const char* cat_;
+    int64_t start_ns_ = -1; // -1 when tracing was off at construction
+    std::string detail_;
+};
+
+// Starts a top-level pipeline stage (fetch, parse, analyze, output) on this thread: closes the
+// previous stage's span, opens a new one (none for kOther), and switches the allocation-tracking
+// stage to match.
+void enter_stage(AllocStage stage);
+
+void trace_set_thread_name(const std::string& name);
+
+// Appends the events of another trace file (e.g. a child tool run with --trace) to this trace.
+bool trace_import_file(const std::string& path);
+
+// Writes every thread's buffered spans plus imported events. Call once worker threads are joined.
+bool write_chrome_trace(const std::string& path);
+
+// Removes `--trace PATH` from argv; if present, enables tracing and writes the trace to PATH at
+// exit. Returns the path, or "" when tracing stays off.
+std::string init_trace(int& argc, char** argv);
+
+} // namespace flightsuite
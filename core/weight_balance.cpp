@@ -0,0 +1,509 @@
+#include "core/weight_balance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+namespace flightsuite {
+
+namespace {
+
+constexpr double kTolerance = 1e-6; // on weights and arms, so a load exactly at a limit passes
+constexpr size_t kBlock = 1024;    // most permutations per inner block
+constexpr double kMaxCombinations = 1e9;
+
+double limit_or_inf(double limit) { return limit > 0.0 ? limit : std::numeric_limits<double>::infinity(); }
+
+bool parse_numbers(const std::vector<std::string>& cells, size_t first, std::vector<double>& out) {
+    out.clear();
+    for (size_t i = first; i < cells.size(); ++i) {
+        if (cells[i].empty()) continue;
+        auto v = parse_double(cells[i]);
+        if (!v) return false;
+        out.push_back(*v);
+    }
+    return true;
+}
+
+} // namespace
+
+double WbAirframe::fuel_capacity() const {
+    double total = 0.0;
+    for (const auto& t : tanks) total += t.capacity;
+    return total;
+}
+
+// Whatever fuel remains sits in the first tanks listed, both while loading and while burning.
+// Fuel beyond capacity (reported as a violation) is charged to the last tank.
+double WbAirframe::fuel_moment(double fuel) const {
+    double moment = 0.0;
+    for (const auto& t : tanks) {
+        double amount = std::min(std::max(fuel, 0.0), t.capacity);
+        moment += amount * t.arm;
+        fuel -= amount;
+    }
+    if (!tanks.empty() && fuel > 0.0) moment += fuel * tanks.back().arm;
+    return moment;
+}
+
+std::optional<size_t> WbAirframe::station_index(const std::string& name) const {
+    for (size_t i = 0; i < stations.size(); ++i) {
+        if (stations[i].name == name) return i;
+    }
+    return std::nullopt;
+}
+
+bool load_wb_airframe(const std::string& path, WbAirframe& out, std::string* error) {
+    TraceSpan span("load_wb_airframe", "weight_balance", path);
+    std::vector<std::string> lines;
+    if (!read_file_lines(path, lines)) {
+        if (error) *error = "cannot read " + path;
+        return false;
+    }
+    WbAirframe af;
+    std::vector<double> nums;
+    for (size_t n = 0; n < lines.size(); ++n) {
+        const std::string& line = lines[n];
+        if (line.empty() || line[0] == '#') continue;
+        auto cells = split_csv_line(line);
+        if (cells.empty() || cells[0].empty()) continue;
+        const std::string key = cells[0];
+        auto fail = [&](const std::string& what) {
+            if (error) *error = path + ":" + std::to_string(n + 1) + ": " + what;
+            return false;
+        };
+        if (key == "name") {
+            if (cells.size() > 1) af.name = cells[1];
+            continue;
+        }
+        if (key == "units") {
+            if (cells.size() > 1 && !cells[1].empty()) af.weight_unit = cells[1];
+            if (cells.size() > 2 && !cells[2].empty()) af.arm_unit = cells[2];
+            continue;
+        }
+        bool named = key == "station" || key == "tank";
+        if (!parse_numbers(cells, named ? 2 : 1, nums)) return fail("bad number in '" + key + "' line");
+        if (key == "empty" && nums.size() >= 2) {
+            af.empty_weight = nums[0];
+            af.empty_arm = nums[1];
+        } else if (key == "max_ramp" && !nums.empty()) {
+            af.max_ramp = nums[0];
+        } else if (key == "max_takeoff" && !nums.empty()) {
+            af.max_takeoff = nums[0];
+        } else if (key == "max_landing" && !nums.empty()) {
+            af.max_landing = nums[0];
+        } else if (key == "max_zero_fuel" && !nums.empty()) {
+            af.max_zero_fuel = nums[0];
+        } else if (key == "mac" && nums.size() >= 2 && nums[1] > 0.0) {
+            af.lemac = nums[0];
+            af.mac = nums[1];
+        } else if (key == "station" && cells.size() > 1 && !cells[1].empty() && !nums.empty()) {
+            af.stations.push_back({cells[1], nums[0], nums.size() > 1 ? nums[1] : 0.0});
+        } else if (key == "tank" && cells.size() > 1 && nums.size() >= 2 && nums[1] > 0.0) {
+            af.tanks.push_back({cells[1], nums[0], nums[1]});
+        } else if (key == "envelope" && nums.size() >= 2) {
+            double cg = af.mac > 0.0 ? af.lemac + nums[1] / 100.0 * af.mac : nums[1];
+            af.envelope.push_back({nums[0], cg});
+        } else {
+            return fail("unrecognised or incomplete '" + key + "' line");
+        }
+    }
+    if (af.empty_weight <= 0.0) {
+        if (error) *error = path + ": missing 'empty' line";
+        return false;
+    }
+    if (af.envelope.size() < 3) {
+        if (error) *error = path + ": the envelope needs at least three points";
+        return false;
+    }
+    if (af.name.empty()) af.name = path;
+    out = std::move(af);
+    return true;
+}
+
+WbEnvelope::WbEnvelope(const std::vector<WbPoint>& polygon) {
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        WbPoint a = polygon[i];
+        WbPoint b = polygon[(i + 1) % polygon.size()];
+        if (a.weight == b.weight) continue;
+        if (a.weight > b.weight) std::swap(a, b);
+        edges_.push_back({a.weight, b.weight, a.cg, (b.cg - a.cg) / (b.weight - a.weight)});
+    }
+}
+
+// A flight manual envelope is one CG interval at every weight, so the outermost edge crossings
+// of the weight line bound it; comparing against them also accepts points on the boundary.
+std::optional<std::pair<double, double>> WbEnvelope::cg_range(double weight) const {
+    double fwd = std::numeric_limits<double>::infinity();
+    double aft = -fwd;
+    for (const auto& e : edges_) {
+        if (weight < e.w1 - kTolerance || weight > e.w2 + kTolerance) continue;
+        double cg = e.cg1 + (std::min(std::max(weight, e.w1), e.w2) - e.w1) * e.dcg_dw;
+        fwd = std::min(fwd, cg);
+        aft = std::max(aft, cg);
+    }
+    if (fwd > aft) return std::nullopt;
+    return std::make_pair(fwd, aft);
+}
+
+bool WbEnvelope::contains(double weight, double cg) const {
+    auto range = cg_range(weight);
+    return range && cg >= range->first - kTolerance && cg <= range->second + kTolerance;
+}
+
+// The same test as cg_range() written without branches or selects: an edge that does not span
+// a point's weight is pushed out of reach by a penalty that is zero inside the span, and the
+// result is a distance rather than a flag. GCC will not if-convert floating-point selects under
+// its default trapping math, so this form is what lets each per-edge pass vectorize.
+void WbEnvelope::margin_batch(const double* weight, const double* cg, double* margin, size_t n) const {
+    constexpr size_t kChunk = 1024;
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    constexpr double kPenalty = 1e300;
+    double fwd[kChunk];
+    double aft[kChunk];
+    for (size_t base = 0; base < n; base += kChunk) {
+        size_t m = std::min(kChunk, n - base);
+        const double* w = weight + base;
+        const double* c = cg + base;
+        double* out = margin + base;
+        for (size_t i = 0; i < m; ++i) {
+            fwd[i] = kInf;
+            aft[i] = -kInf;
+        }
+        for (const auto& e : edges_) {
+            const double w1 = e.w1, w2 = e.w2, cg1 = e.cg1, slope = e.dcg_dw;
+            const double lo = w1 - kTolerance, hi = w2 + kTolerance;
+            for (size_t i = 0; i < m; ++i) {
+                double wi = w[i];
+                double x = cg1 + (std::min(std::max(wi, w1), w2) - w1) * slope;
+                double below = lo - wi, above = wi - hi;
+                double outside = std::max(below, above);
+                double penalty = (outside + std::fabs(outside)) * kPenalty;
+                double ahead = x + penalty, behind = x - penalty;
+                fwd[i] = std::min(fwd[i], ahead);
+                aft[i] = std::max(aft[i], behind);
+            }
+        }
+        for (size_t i = 0; i < m; ++i) {
+            double from_fwd = c[i] - fwd[i], from_aft = aft[i] - c[i];
+            double here = std::min(from_fwd, from_aft);
+            out[i] = std::min(out[i], here);
+        }
+    }
+}
+
+WbReport evaluate_loading(const WbAirframe& af, const WbLoad& load, size_t steps) {
+    TraceSpan span("evaluate_loading", "weight_balance");
+    WbReport r;
+    const std::string& unit = af.weight_unit;
+    double zfw = af.empty_weight;
+    double zfm = af.empty_weight * af.empty_arm;
+    for (size_t i = 0; i < af.stations.size(); ++i) {
+        double w = i < load.station_weights.size() ? load.station_weights[i] : 0.0;
+        const WbStation& s = af.stations[i];
+        if (s.max_weight > 0.0 && w > s.max_weight + kTolerance) {
+            r.violations.push_back(s.name + " load " + format_double(w, 1) + " exceeds its " +
+                                   format_double(s.max_weight, 1) + " " + unit + " limit");
+        }
+        zfw += w;
+        zfm += w * s.arm;
+    }
+    r.zero_fuel_weight = zfw;
+    r.ramp_weight = zfw + load.fuel;
+    r.takeoff_weight = r.ramp_weight - load.taxi;
+    r.landing_weight = r.takeoff_weight - load.burn;
+
+    if (load.fuel > af.fuel_capacity() + kTolerance) {
+        r.violations.push_back("fuel " + format_double(load.fuel, 1) + " exceeds the " +
+                               format_double(af.fuel_capacity(), 1) + " " + unit + " capacity");
+    }
+    if (load.taxi + load.burn > load.fuel + kTolerance) {
+        r.violations.push_back("taxi plus trip burn " + format_double(load.taxi + load.burn, 1) +
+                               " exceeds the " + format_double(load.fuel, 1) + " " + unit + " of fuel");
+    }
+    const struct {
+        const char* label;
+        double weight, limit;
+    } limits[] = {{"zero fuel", r.zero_fuel_weight, af.max_zero_fuel},
+                  {"ramp", r.ramp_weight, af.max_ramp},
+                  {"takeoff", r.takeoff_weight, af.max_takeoff},
+                  {"landing", r.landing_weight, af.max_landing}};
+    for (const auto& l : limits) {
+        if (l.limit > 0.0 && l.weight > l.limit + kTolerance) {
+            r.violations.push_back(std::string(l.label) + " weight " + format_double(l.weight, 1) +
+                                   " exceeds the " + format_double(l.limit, 1) + " " + unit + " limit");
+        }
+    }
+
+    WbEnvelope envelope(af.envelope);
+    auto add_state = [&](std::string label, double fuel) {
+        WbState s;
+        s.label = std::move(label);
+        s.fuel = std::max(fuel, 0.0);
+        s.weight = zfw + s.fuel;
+        s.cg = (zfm + af.fuel_moment(s.fuel)) / s.weight;
+        s.in_envelope = envelope.contains(s.weight, s.cg);
+        r.trajectory.push_back(std::move(s));
+    };
+    double takeoff_fuel = load.fuel - load.taxi;
+    add_state("Zero fuel", 0.0);
+    add_state("Takeoff", takeoff_fuel);
+    for (size_t k = 1; k <= steps; ++k) {
+        double burned = load.burn * static_cast<double>(k) / static_cast<double>(steps + 1);
+        add_state("Burn " + format_double(burned, 0), takeoff_fuel - burned);
+    }
+    add_state("Landing", takeoff_fuel - load.burn);
+    for (const auto& s : r.trajectory) {
+        if (s.in_envelope) continue;
+        r.violations.push_back(s.label + " CG " + format_double(s.cg, 2) + " " + af.arm_unit + " at " +
+                               format_double(s.weight, 1) + " " + unit + " is outside the envelope");
+    }
+    return r;
+}
+
+bool load_wb_batch_options(const std::string& path, const WbAirframe& af, WbBatchOptions& out,
+                           std::string* error) {
+    TraceSpan span("load_wb_batch_options", "weight_balance", path);
+    std::vector<std::string> lines;
+    if (!read_file_lines(path, lines)) {
+        if (error) *error = "cannot read " + path;
+        return false;
+    }
+    WbBatchOptions opt = out;
+    opt.station_candidates.assign(af.stations.size(), {});
+    opt.fuel_candidates.clear();
+    opt.burn_candidates.clear();
+    std::vector<double> nums;
+    for (size_t n = 0; n < lines.size(); ++n) {
+        const std::string& line = lines[n];
+        if (line.empty() || line[0] == '#') continue;
+        auto cells = split_csv_line(line);
+        if (cells.empty() || cells[0].empty()) continue;
+        std::string where = path + ":" + std::to_string(n + 1) + ": ";
+        if (!parse_numbers(cells, 1, nums) || nums.empty()) {
+            if (error) *error = where + "expected one or more weights after '" + cells[0] + "'";
+            return false;
+        }
+        if (cells[0] == "fuel") {
+            opt.fuel_candidates = nums;
+        } else if (cells[0] == "burn") {
+            opt.burn_candidates = nums;
+        } else if (auto idx = af.station_index(cells[0])) {
+            double max_weight = af.stations[*idx].max_weight;
+            for (double w : nums) {
+                if (w < 0.0 || (max_weight > 0.0 && w > max_weight + kTolerance)) {
+                    if (error) *error = where + cells[0] + " candidate " + format_double(w, 1) + " is out of range";
+                    return false;
+                }
+            }
+            opt.station_candidates[*idx] = nums;
+        } else {
+            if (error) *error = where + "'" + cells[0] + "' is not a station of " + af.name;
+            return false;
+        }
+    }
+    double combinations = 1.0;
+    for (const auto& c : opt.station_candidates) combinations *= static_cast<double>(std::max<size_t>(c.size(), 1));
+    combinations *= static_cast<double>(std::max<size_t>(opt.fuel_candidates.size(), 1));
+    combinations *= static_cast<double>(std::max<size_t>(opt.burn_candidates.size(), 1));
+    if (combinations > kMaxCombinations) {
+        if (error) *error = path + ": " + format_double(combinations, 0) + " combinations is too many";
+        return false;
+    }
+    out = std::move(opt);
+    return true;
+}
+
+// Permutations are numbered in mixed radix over the rows (stations, fuel, burn), first row
+// fastest. The leading rows whose product fits in a block are expanded once into columns; each
+// combination of the remaining rows then only adds its constant offsets to those columns before
+// the branch-free checks run down them.
+WbBatchResult evaluate_batch(const WbAirframe& af, const WbBatchOptions& opt) {
+    TraceSpan span("evaluate_batch", "weight_balance");
+    enum class Kind { kStation, kFuel, kBurn };
+    struct Row {
+        Kind kind;
+        double arm;
+        std::vector<double> values;
+    };
+    std::vector<Row> rows;
+    for (size_t i = 0; i < af.stations.size(); ++i) {
+        std::vector<double> values = i < opt.station_candidates.size() ? opt.station_candidates[i] : std::vector<double>{};
+        if (values.empty()) values.push_back(0.0);
+        rows.push_back({Kind::kStation, af.stations[i].arm, std::move(values)});
+    }
+    rows.push_back({Kind::kFuel, 0.0, opt.fuel_candidates.empty() ? std::vector<double>{af.fuel_capacity()}
+                                                                   : opt.fuel_candidates});
+    rows.push_back({Kind::kBurn, 0.0, opt.burn_candidates.empty() ? std::vector<double>{0.0} : opt.burn_candidates});
+
+    WbBatchResult result;
+    result.total = 1;
+    for (const auto& row : rows) result.total *= row.values.size();
+
+    // Inner columns: zero fuel weight and moment, fuel, and burn for each inner permutation.
+    size_t inner_rows = 0;
+    size_t block = 1;
+    while (inner_rows < rows.size() && (inner_rows == 0 || block * rows[inner_rows].values.size() <= kBlock)) {
+        block *= rows[inner_rows++].values.size();
+    }
+    std::vector<double> in_w{af.empty_weight}, in_m{af.empty_weight * af.empty_arm}, in_f{0.0}, in_b{0.0};
+    for (size_t r = 0; r < inner_rows; ++r) {
+        const Row& row = rows[r];
+        size_t n = in_w.size();
+        std::vector<double> w(n * row.values.size()), m(w.size()), f(w.size()), b(w.size());
+        for (size_t j = 0; j < row.values.size(); ++j) {
+            double v = row.values[j];
+            double dw = row.kind == Kind::kStation ? v : 0.0;
+            double dm = dw * row.arm;
+            double fv = row.kind == Kind::kFuel ? v : 0.0;
+            double bv = row.kind == Kind::kBurn ? v : 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                w[j * n + i] = in_w[i] + dw;
+                m[j * n + i] = in_m[i] + dm;
+                f[j * n + i] = in_f[i] + fv;
+                b[j * n + i] = in_b[i] + bv;
+            }
+        }
+        in_w.swap(w);
+        in_m.swap(m);
+        in_f.swap(f);
+        in_b.swap(b);
+    }
+
+    const double capacity = af.fuel_capacity();
+    const double max_ramp = limit_or_inf(af.max_ramp), max_takeoff = limit_or_inf(af.max_takeoff);
+    const double max_landing = limit_or_inf(af.max_landing), max_zfw = limit_or_inf(af.max_zero_fuel);
+    const double taxi = opt.taxi;
+    const double empty_weight = af.empty_weight;
+    std::vector<double> fractions{0.0}; // of the trip burn; the zero fuel state is checked separately
+    for (size_t k = 1; k <= opt.burn_samples; ++k) {
+        fractions.push_back(static_cast<double>(k) / static_cast<double>(opt.burn_samples + 1));
+    }
+    fractions.push_back(1.0);
+    WbEnvelope envelope(af.envelope);
+
+    std::vector<double> zfw(block), zfm(block), fuel(block), burn(block), state_w(block), state_cg(block);
+    std::vector<double> state_f(block), remaining(block), fuel_m(block);
+    // Slack to the nearest limit in each class; negative means broken.
+    std::vector<double> fuel_slack(block), weight_slack(block), cg_margin(block);
+
+    struct Candidate {
+        double payload;
+        size_t index;
+    };
+    auto better = [](const Candidate& a, const Candidate& b) {
+        return a.payload > b.payload || (a.payload == b.payload && a.index < b.index);
+    };
+    std::vector<Candidate> heap; // worst of the kept candidates on top
+
+    std::vector<size_t> digits(rows.size() - inner_rows, 0);
+    size_t outer_count = result.total / block;
+    for (size_t outer = 0; outer < outer_count; ++outer) {
+        double ow = 0.0, om = 0.0, of = 0.0, ob = 0.0;
+        for (size_t d = 0; d < digits.size(); ++d) {
+            const Row& row = rows[inner_rows + d];
+            double v = row.values[digits[d]];
+            if (row.kind == Kind::kStation) {
+                ow += v;
+                om += v * row.arm;
+            } else if (row.kind == Kind::kFuel) {
+                of = v;
+            } else {
+                ob = v;
+            }
+        }
+        for (size_t i = 0; i < block; ++i) {
+            zfw[i] = in_w[i] + ow;
+            zfm[i] = in_m[i] + om;
+            fuel[i] = in_f[i] + of;
+            burn[i] = in_b[i] + ob;
+        }
+        for (size_t i = 0; i < block; ++i) {
+            double ramp = zfw[i] + fuel[i];
+            double takeoff = ramp - taxi;
+            double landing = takeoff - burn[i];
+            double landing_fuel = fuel[i] - taxi - burn[i], spare_capacity = capacity - fuel[i];
+            fuel_slack[i] = std::min(landing_fuel, spare_capacity);
+            double zfw_slack = max_zfw - zfw[i], ramp_slack = max_ramp - ramp;
+            double takeoff_slack = max_takeoff - takeoff, landing_slack = max_landing - landing;
+            weight_slack[i] = std::min(std::min(zfw_slack, ramp_slack), std::min(takeoff_slack, landing_slack));
+            cg_margin[i] = std::numeric_limits<double>::infinity();
+            state_cg[i] = zfm[i] / zfw[i];
+        }
+        envelope.margin_batch(zfw.data(), state_cg.data(), cg_margin.data(), block);
+        for (double frac : fractions) {
+            for (size_t i = 0; i < block; ++i) {
+                state_f[i] = std::max(fuel[i] - taxi - burn[i] * frac, 0.0);
+                remaining[i] = state_f[i];
+                fuel_m[i] = 0.0;
+            }
+            for (const auto& t : af.tanks) {
+                const double cap = t.capacity, arm = t.arm;
+                for (size_t i = 0; i < block; ++i) {
+                    double amount = std::min(remaining[i], cap);
+                    fuel_m[i] += amount * arm;
+                    remaining[i] -= amount;
+                }
+            }
+            if (!af.tanks.empty()) {
+                const double arm = af.tanks.back().arm;
+                for (size_t i = 0; i < block; ++i) fuel_m[i] += remaining[i] * arm;
+            }
+            for (size_t i = 0; i < block; ++i) {
+                state_w[i] = zfw[i] + state_f[i];
+                state_cg[i] = (zfm[i] + fuel_m[i]) / state_w[i];
+            }
+            envelope.margin_batch(state_w.data(), state_cg.data(), cg_margin.data(), block);
+        }
+        for (size_t i = 0; i < block; ++i) {
+            if (fuel_slack[i] < -kTolerance) {
+                ++result.short_of_fuel;
+            } else if (weight_slack[i] < -kTolerance) {
+                ++result.over_weight;
+            } else if (cg_margin[i] < -kTolerance) {
+                ++result.out_of_envelope;
+            } else {
+                ++result.feasible;
+                if (opt.top == 0) continue;
+                Candidate c{zfw[i] - empty_weight, outer * block + i};
+                if (heap.size() < opt.top) {
+                    heap.push_back(c);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                } else if (better(c, heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = c;
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+            }
+        }
+        for (size_t d = 0; d < digits.size(); ++d) {
+            if (++digits[d] < rows[inner_rows + d].values.size()) break;
+            digits[d] = 0;
+        }
+    }
+
+    std::sort(heap.begin(), heap.end(), better);
+    for (const auto& c : heap) {
+        WbLoad load;
+        load.taxi = taxi;
+        size_t index = c.index;
+        for (const auto& row : rows) {
+            double v = row.values[index % row.values.size()];
+            index /= row.values.size();
+            if (row.kind == Kind::kStation) {
+                load.station_weights.push_back(v);
+            } else if (row.kind == Kind::kFuel) {
+                load.fuel = v;
+            } else {
+                load.burn = v;
+            }
+        }
+        result.best.push_back(std::move(load));
+    }
+    return result;
+}
+
+} // namespace flightsuite
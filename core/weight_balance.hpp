@@ -0,0 +1,133 @@
+// Weight and balance: per-airframe stations, fuel tanks, weight limits, and a CG envelope read
+// from a small definition file; CG for one loading along its whole fuel burn; and a batch mode
+// that evaluates every combination of candidate station loads, fuel, and trip burn in blocks of
+// structure-of-arrays columns with branch-free checks, so the loops vectorize.
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flightsuite {
+
+struct WbStation {
+    std::string name;
+    double arm = 0.0;
+    double max_weight = 0.0; // 0 = no limit
+};
+
+struct WbTank {
+    std::string name;
+    double arm = 0.0;
+    double capacity = 0.0; // weight units
+};
+
+struct WbPoint {
+    double weight = 0.0;
+    double cg = 0.0; // arm units
+};
+
+struct WbAirframe {
+    std::string name;
+    std::string weight_unit = "lb";
+    std::string arm_unit = "in";
+    double empty_weight = 0.0;
+    double empty_arm = 0.0;
+    double max_ramp = 0.0; // limits: 0 = none
+    double max_takeoff = 0.0;
+    double max_landing = 0.0;
+    double max_zero_fuel = 0.0;
+    double lemac = 0.0; // with `mac` > 0, CGs are also shown in %MAC
+    double mac = 0.0;
+    std::vector<WbStation> stations;
+    std::vector<WbTank> tanks; // filled in the order listed, burned in reverse
+    std::vector<WbPoint> envelope;
+
+    double fuel_capacity() const;
+    double fuel_moment(double fuel) const;
+    double percent_mac(double cg) const { return mac > 0.0 ? (cg - lemac) / mac * 100.0 : 0.0; }
+    std::optional<size_t> station_index(const std::string& name) const;
+};
+
+// Lines of `keyword,values...`: name, units, empty (weight, arm), max_ramp, max_takeoff,
+// max_landing, max_zero_fuel, mac (LEMAC arm, length), station (name, arm[, max]), tank (name,
+// arm, capacity), envelope (weight, cg; cg in %MAC once a mac line has been given).
+bool load_wb_airframe(const std::string& path, WbAirframe& out, std::string* error = nullptr);
+
+// The envelope polygon prepared for point tests: horizontal edges dropped, the rest stored with
+// their inverse slopes so a test is one multiply-add and compare per edge.
+class WbEnvelope {
+public:
+    explicit WbEnvelope(const std::vector<WbPoint>& polygon);
+
+    bool contains(double weight, double cg) const;
+    // Forward and aft limits at `weight`; nullopt outside the envelope's weight range.
+    std::optional<std::pair<double, double>> cg_range(double weight) const;
+    // margin[i] = min(margin[i], distance of cg[i] inside the limits at weight[i]), negative when
+    // outside, -inf outside the weight range.
+    void margin_batch(const double* weight, const double* cg, double* margin, size_t n) const;
+
+private:
+    struct Edge {
+        double w1, w2;   // weight span, w1 < w2
+        double cg1;      // cg at w1
+        double dcg_dw;   // cg change per unit weight
+    };
+    std::vector<Edge> edges_;
+};
+
+struct WbLoad {
+    std::vector<double> station_weights; // one per airframe station
+    double fuel = 0.0;                   // at the ramp
+    double taxi = 0.0;
+    double burn = 0.0; // trip
+};
+
+struct WbState {
+    std::string label;
+    double fuel = 0.0;
+    double weight = 0.0;
+    double cg = 0.0;
+    bool in_envelope = false;
+};
+
+struct WbReport {
+    double zero_fuel_weight = 0.0;
+    double ramp_weight = 0.0;
+    double takeoff_weight = 0.0;
+    double landing_weight = 0.0;
+    // Zero fuel, takeoff, `steps` points of the burn, landing. There is no ramp state: certified
+    // envelopes stop at max takeoff, so ramp weight is only checked against max_ramp.
+    std::vector<WbState> trajectory;
+    std::vector<std::string> violations;
+};
+
+WbReport evaluate_loading(const WbAirframe& airframe, const WbLoad& load, size_t steps = 8);
+
+struct WbBatchOptions {
+    std::vector<std::vector<double>> station_candidates; // per station; empty = {0}
+    std::vector<double> fuel_candidates;                 // empty = full tanks
+    std::vector<double> burn_candidates;                 // empty = {0}
+    double taxi = 0.0;
+    size_t burn_samples = 3; // envelope checks between takeoff and landing
+    size_t top = 10;
+};
+
+struct WbBatchResult {
+    size_t total = 0;
+    size_t feasible = 0;
+    size_t over_weight = 0;   // a weight limit broken
+    size_t short_of_fuel = 0; // burn plus taxi exceeds the fuel
+    size_t out_of_envelope = 0;
+    std::vector<WbLoad> best; // most payload first
+};
+
+// Rows of `name,candidate,...`: station names, plus `fuel` and `burn`.
+bool load_wb_batch_options(const std::string& path, const WbAirframe& airframe, WbBatchOptions& out,
+                           std::string* error = nullptr);
+
+WbBatchResult evaluate_batch(const WbAirframe& airframe, const WbBatchOptions& opt);
+
+} // namespace flightsuite
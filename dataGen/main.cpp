@@ -0,0 +1,166 @@
+// Synthetic data generator: writes large, deterministic inputs for the suite tools (airports,
+// METAR cycles, NOTAM dumps, OFPs, fleets, flight logs, navdata sources) for load tests and
+// benchmarks.
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/alloc_stats.hpp"
+#include "core/datagen.hpp"
+#include "core/geo.hpp"
+#include "core/trace.hpp"
+
+using namespace flightsuite;
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <airports|metar|notam|ofp|fleet|log|navfix|navaid|airway> [options]\n"
+              << "  --seed N          RNG seed (default 1); same seed + --stations gives the same catalog\n"
+              << "  --stations N      station catalog size (default 5000)\n"
+              << "  --count N         rows/records for airports, notam, fleet, log; enroute fixes for\n"
+              << "                    navfix/navaid/airway (default 4 per station)\n"
+              << "  --out PATH        write to PATH instead of stdout\n"
+              << "  --alloc-stats     print heap allocation counts per stage at exit\n"
+              << "  --trace out.json  write a Chrome/Perfetto trace of the run\n"
+              << "  metar: --hour HH (cycle hour, default 12)\n"
+              << "  notam: --format icao|faa (default icao)\n"
+              << "  ofp:   --fixes N (default 2000) [--from ICAO --to ICAO]\n";
+}
+
+static const StationSpec* find_station(const std::vector<StationSpec>& stations, const std::string& icao) {
+    for (const auto& s : stations) {
+        if (s.icao == icao) return &s;
+    }
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string kind = argv[1];
+    if (kind == "--help" || kind == "-h") {
+        usage(argv[0]);
+        return 0;
+    }
+    uint64_t seed = 1;
+    size_t stations_n = 5000;
+    size_t count = 0;
+    size_t fixes = 2000;
+    int hour = 12;
+    std::string out_path, format = "icao", from_icao, to_icao;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--stations" && i + 1 < argc) {
+            stations_n = std::stoull(argv[++i]);
+        } else if (arg == "--count" && i + 1 < argc) {
+            count = std::stoull(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (arg == "--hour" && i + 1 < argc) {
+            hour = std::stoi(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--fixes" && i + 1 < argc) {
+            fixes = std::stoull(argv[++i]);
+        } else if (arg == "--from" && i + 1 < argc) {
+            from_icao = argv[++i];
+        } else if (arg == "--to" && i + 1 < argc) {
+            to_icao = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (format != "icao" && format != "faa") {
+        std::cerr << "Unknown NOTAM format: " << format << "\n";
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+    std::unique_ptr<std::ofstream> file;
+    std::vector<char> buffer(1 << 20);
+    if (!out_path.empty()) {
+        file = std::make_unique<std::ofstream>();
+        file->rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file->open(out_path, std::ios::binary);
+        if (!*file) {
+            std::cerr << "Failed to open output: " << out_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = file ? static_cast<std::ostream&>(*file) : std::cout;
+
+    // `airports --count N` is the catalog itself, so it matches `metar --stations N` for the same seed.
+    if (kind == "airports" && count > 0) stations_n = count;
+    enter_stage(AllocStage::kAnalyze);
+    auto stations = generate_stations(stations_n, seed);
+    if (stations.empty()) {
+        std::cerr << "Empty station catalog.\n";
+        return 1;
+    }
+
+    enter_stage(AllocStage::kOutput);
+    if (kind == "airports") {
+        write_airports_csv(out, stations);
+    } else if (kind == "metar") {
+        MetarCycleOptions opt;
+        opt.hour = hour;
+        opt.seed = seed;
+        write_metar_cycle(out, stations, opt);
+    } else if (kind == "notam") {
+        write_notam_dump(out, stations, count ? count : 10000,
+                         format == "faa" ? NotamFormat::kFaa : NotamFormat::kIcao, seed);
+    } else if (kind == "ofp") {
+        const StationSpec* from = from_icao.empty() ? &stations.front() : find_station(stations, from_icao);
+        const StationSpec* to = to_icao.empty() ? nullptr : find_station(stations, to_icao);
+        if (!from || (!to_icao.empty() && !to)) {
+            std::cerr << "Unknown station in generated catalog (try `" << argv[0]
+                      << " airports` with the same --seed/--stations).\n";
+            return 1;
+        }
+        if (!to) {
+            // Default to the farthest station so the navlog spans a long-haul leg.
+            double best = -1.0;
+            for (const auto& s : stations) {
+                double d = haversine_nm(from->lat, from->lon, s.lat, s.lon);
+                if (d > best) {
+                    best = d;
+                    to = &s;
+                }
+            }
+        }
+        write_ofp_xml(out, *from, *to, fixes < 2 ? 2 : fixes, seed);
+    } else if (kind == "fleet") {
+        write_fleet_csv(out, stations, count ? count : 100, seed);
+    } else if (kind == "log") {
+        write_flight_log_csv(out, stations, count ? count : 1000000, seed);
+    } else if (kind == "navfix" || kind == "navaid" || kind == "airway") {
+        // All three come from the same generated set, so separately written files line up.
+        auto nav = generate_navdata(stations, count ? count : stations.size() * 4, seed);
+        if (kind == "navfix") {
+            write_earth_fix(out, nav);
+        } else if (kind == "navaid") {
+            write_earth_nav(out, nav);
+        } else {
+            write_earth_awy(out, nav);
+        }
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
+
+    out.flush();
+    if (!out) {
+        std::cerr << "Write failed.\n";
+        return 1;
+    }
+    return 0;
+}
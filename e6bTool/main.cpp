@@ -1,77 +1,30 @@
-// E6B flight computer CLI: provides common flight calculations.
-#include <cmath>
+// E6B flight computer CLI: provides common flight calculations, a worksheet session with chained,
+// cached variables, and Monte Carlo spreads of trip time and fuel over a navlog.
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
-#include <map>
 #include <string>
+#include <unistd.h>
 
-constexpr double kPi = 3.14159265358979323846;
-constexpr double kRho0 = 1.225; // kg/m^3 sea-level
+#include "core/alloc_stats.hpp"
+#include "core/trace.hpp"
+#include "core/e6b.hpp"
+#include "core/e6b_session.hpp"
+#include "core/montecarlo.hpp"
+#include "core/ofp.hpp"
+#include "core/strutil.hpp"
 
-static double deg2rad(double d) { return d * kPi / 180.0; }
-static double rad2deg(double r) { return r * 180.0 / kPi; }
+using namespace flightsuite;
 
 static void print_result(const std::string& label, double value, const std::string& unit = "") {
+    AllocStageScope stage(AllocStage::kOutput);
+    TraceSpan span("output", "stage");
     std::cout << std::fixed << std::setprecision(2);
     std::cout << label << ": " << value;
     if (!unit.empty()) std::cout << " " << unit;
     std::cout << "\n";
 }
 
-// Basic wind triangle: returns ground speed and track using heading, true airspeed, wind direction/speed.
-static void wind_triangle(double hdg_deg, double tas_kt, double wind_dir_deg, double wind_spd_kt,
-                          double& out_gs, double& out_track_deg, double& out_wca_deg) {
-    double hdg = deg2rad(hdg_deg);
-    double wind_dir = deg2rad(wind_dir_deg);
-    double wx = wind_spd_kt * std::sin(wind_dir);
-    double wy = wind_spd_kt * std::cos(wind_dir);
-    double tx = tas_kt * std::sin(hdg) + wx;
-    double ty = tas_kt * std::cos(hdg) + wy;
-    out_track_deg = rad2deg(std::atan2(tx, ty));
-    if (out_track_deg < 0) out_track_deg += 360.0;
-    out_gs = std::sqrt(tx * tx + ty * ty);
-    double desired_track_rad = deg2rad(out_track_deg);
-    double wca = std::asin((wind_spd_kt * std::sin(wind_dir - desired_track_rad)) / tas_kt);
-    out_wca_deg = rad2deg(wca);
-}
-
-static double crosswind_component(double wind_dir_deg, double wind_spd_kt, double runway_deg) {
-    double angle = std::fabs(wind_dir_deg - runway_deg);
-    if (angle > 180.0) angle = 360.0 - angle;
-    return wind_spd_kt * std::sin(deg2rad(angle));
-}
-
-static double headwind_component(double wind_dir_deg, double wind_spd_kt, double runway_deg) {
-    double angle = std::fabs(wind_dir_deg - runway_deg);
-    if (angle > 180.0) angle = 360.0 - angle;
-    return wind_spd_kt * std::cos(deg2rad(angle));
-}
-
-static double pressure_altitude_ft(double field_elev_ft, double altimeter_inhg) {
-    return field_elev_ft + (29.92 - altimeter_inhg) * 1000.0;
-}
-
-static double density_altitude_ft(double pressure_alt_ft, double oat_c) {
-    // Simple approximation: DA = PA + 120 * (OAT - ISA)
-    double isa_temp_c = 15.0 - (pressure_alt_ft / 1000.0) * 2.0;
-    return pressure_alt_ft + 120.0 * (oat_c - isa_temp_c);
-}
-
-static double mach_from_tas(double tas_kt, double oat_c) {
-    // a = sqrt(gamma*R*T), gamma=1.4, R=287 J/kg/K; TAS in kt -> m/s
-    double tas_ms = tas_kt * 0.514444;
-    double temp_k = oat_c + 273.15;
-    double a_ms = std::sqrt(1.4 * 287.0 * temp_k);
-    return tas_ms / a_ms;
-}
-
-static double tas_from_mach(double mach, double oat_c) {
-    double temp_k = oat_c + 273.15;
-    double a_ms = std::sqrt(1.4 * 287.0 * temp_k);
-    double tas_ms = mach * a_ms;
-    return tas_ms / 0.514444;
-}
-
 static void usage(const char* prog) {
     std::cout << "E6B flight computer\n";
     std::cout << "Usage: " << prog << " <mode> [args]\n";
@@ -87,24 +40,168 @@ static void usage(const char* prog) {
     std::cout << "  fuel         <flow_gph> <time_hr>\n";
     std::cout << "  drift        <wind_dir_deg> <wind_spd_kt> <tas_kt> <track_deg>\n";
     std::cout << "  groundspeed  <tas_kt> <wind_component_kt>\n";
+    std::cout << "  session      [worksheet.e6b]   (variables and chained formulas; REPL on stdin without a file)\n";
+    std::cout << "  montecarlo   (--ofp ofp.xml | --legs legs.csv) [--tas KT] [--flow PER_HR] [--trials 200000]\n"
+                 "               [--threads N] [--seed N] [--wind-sd KT] [--oat-sd C] [--flow-sd PCT] [--correlation 0.5]\n";
+    std::cout << " montecarlo takes OFP navlog winds/OATs; TAS and flow default to the OFP's trip time and burn.\n";
+    std::cout << " Add --alloc-stats to print heap allocation counts per stage at exit,\n";
+    std::cout << " or --trace out.json to write a Chrome/Perfetto trace.\n";
+}
+
+static void print_spread(const char* label, const Spread& s, int precision) {
+    std::cout << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(precision);
+    for (double v : {s.planned, s.mean, s.stddev, s.p05, s.p50, s.p90, s.p95, s.p99, s.max}) {
+        std::cout << std::setw(10) << v;
+    }
+    std::cout << "\n";
+}
+
+// A worksheet file runs in one go; otherwise lines come from stdin and every value is echoed.
+static int run_session(int argc, char** argv) {
+    E6bSession session;
+    std::string error;
+    if (argc == 3) {
+        enter_stage(AllocStage::kParse);
+        auto text = read_file(argv[2]);
+        if (!text) {
+            std::cerr << "Failed to read worksheet: " << argv[2] << "\n";
+            return 1;
+        }
+        enter_stage(AllocStage::kAnalyze);
+        if (!session.run_script(*text, std::cout, &error)) {
+            std::cerr << argv[2] << ", " << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    enter_stage(AllocStage::kAnalyze);
+    bool interactive = isatty(STDIN_FILENO);
+    if (interactive) std::cout << "E6B session: name = expr, bare expressions, 'help', 'quit'.\n";
+    std::string line, out;
+    while ((interactive && std::cout << "e6b> " << std::flush), std::getline(std::cin, line)) {
+        if (line == "quit" || line == "exit") break;
+        if (session.run_line(line, out, true, &error)) {
+            std::cout << out;
+        } else {
+            std::cout << "error: " << error << "\n";
+        }
+    }
+    return 0;
+}
+
+static int run_montecarlo(int argc, char** argv) {
+    std::string ofp_path, legs_path;
+    double tas = 0.0, flow = 0.0;
+    MonteCarloOptions opt;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string val = argv[++i];
+        if (arg == "--ofp") {
+            ofp_path = val;
+        } else if (arg == "--legs") {
+            legs_path = val;
+        } else if (arg == "--tas") {
+            tas = std::stod(val);
+        } else if (arg == "--flow") {
+            flow = std::stod(val);
+        } else if (arg == "--trials") {
+            opt.trials = std::stoul(val);
+        } else if (arg == "--threads") {
+            opt.threads = static_cast<unsigned>(std::stoul(val));
+        } else if (arg == "--seed") {
+            opt.seed = std::stoull(val);
+        } else if (arg == "--wind-sd") {
+            opt.sd.wind_sd_kt = std::stod(val);
+        } else if (arg == "--oat-sd") {
+            opt.sd.oat_sd_c = std::stod(val);
+        } else if (arg == "--flow-sd") {
+            opt.sd.fuel_flow_sd = std::stod(val) / 100.0;
+        } else if (arg == "--correlation") {
+            opt.sd.correlation = std::stod(val);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (ofp_path.empty() == legs_path.empty() || opt.trials == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    enter_stage(AllocStage::kParse);
+    std::vector<TripLeg> legs;
+    if (!legs_path.empty()) {
+        legs = load_trip_legs(legs_path);
+    } else {
+        auto content = read_file(ofp_path);
+        if (!content) {
+            std::cerr << "Failed to read OFP: " << ofp_path << "\n";
+            return 1;
+        }
+        // Without --flow/--tas, the OFP's own plan sets them: trip burn over time en route, and the
+        // cruise TAS that flies its navlog winds in that time.
+        double ete_hr = parse_double(tag_value(*content, {"est_time_enroute"}).value_or("")).value_or(0.0) / 3600.0;
+        double burn = parse_double(parse_fuel(*content).trip.value_or("")).value_or(0.0);
+        if (flow <= 0.0 && ete_hr > 0.0) flow = burn / ete_hr;
+        legs = trip_legs_from_ofp(*content, tas, flow);
+        if (tas <= 0.0 && !legs.empty() && !calibrate_trip_tas(legs, ete_hr * 60.0)) {
+            std::cerr << "No --tas given and the OFP's time en route does not fix one.\n";
+            return 1;
+        }
+    }
+    if (legs.empty()) {
+        std::cerr << "No legs loaded.\n";
+        return 1;
+    }
+
+    enter_stage(AllocStage::kAnalyze);
+    double distance = 0.0;
+    for (const auto& leg : legs) distance += leg.distance_nm;
+    auto result = run_trip_montecarlo(legs, opt);
+
+    enter_stage(AllocStage::kOutput);
+    std::cout << "Monte Carlo: " << result.trials << " trials, " << legs.size() << " legs, "
+              << format_double(distance, 0) << " nm, seed " << opt.seed << "\n";
+    std::cout << "Sigma: wind " << format_double(opt.sd.wind_sd_kt, 1) << " kt, OAT " << format_double(opt.sd.oat_sd_c, 1)
+              << " C, fuel flow " << format_double(opt.sd.fuel_flow_sd * 100.0, 1) << "%, correlation "
+              << format_double(opt.sd.correlation, 2) << "\n";
+    std::cout << std::left << std::setw(12) << "" << std::right;
+    for (const char* h : {"planned", "mean", "sd", "p5", "p50", "p90", "p95", "p99", "max"}) std::cout << std::setw(10) << h;
+    std::cout << "\n";
+    print_spread("Time (min)", result.minutes, 1);
+    print_spread("Fuel", result.fuel, 1);
+    if (result.unflyable) std::cout << "Unflyable trials: " << result.unflyable << "\n";
+    return 0;
 }
 
 int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
     if (argc < 2) {
         usage(argv[0]);
         return 1;
     }
     std::string mode = argv[1];
+    if (mode == "montecarlo") return run_montecarlo(argc, argv);
+    if (mode == "session") return run_session(argc, argv);
+    enter_stage(AllocStage::kAnalyze);
     if (mode == "winds" && argc == 6) {
         double hdg = std::stod(argv[2]);
         double tas = std::stod(argv[3]);
         double wdir = std::stod(argv[4]);
         double wspd = std::stod(argv[5]);
-        double gs, track, wca;
-        wind_triangle(hdg, tas, wdir, wspd, gs, track, wca);
-        print_result("Groundspeed", gs, "kt");
-        print_result("Resulting track", track, "deg");
-        print_result("Wind correction angle", wca, "deg");
+        WindTriangle wt = wind_triangle(hdg, tas, wdir, wspd);
+        print_result("Groundspeed", wt.groundspeed_kt, "kt");
+        print_result("Resulting track", wt.track_deg, "deg");
+        print_result("Wind correction angle", wt.wca_deg, "deg");
     } else if (mode == "xwind" && argc == 5) {
         double wdir = std::stod(argv[2]);
         double wspd = std::stod(argv[3]);
@@ -147,8 +244,7 @@ int main(int argc, char** argv) {
         double wspd = std::stod(argv[3]);
         double tas = std::stod(argv[4]);
         double track = std::stod(argv[5]);
-        double wca = rad2deg(std::asin((wspd / tas) * std::sin(deg2rad(wdir - track))));
-        print_result("Drift angle", wca, "deg");
+        print_result("Drift angle", drift_angle_deg(wdir, wspd, tas, track), "deg");
     } else if (mode == "groundspeed" && argc == 4) {
         double tas = std::stod(argv[2]);
         double wind_comp = std::stod(argv[3]);
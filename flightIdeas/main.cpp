@@ -1,237 +1,232 @@
 // Route suggester: reads aircraft.csv and airports.csv, and proposes routes suited to each airframe.
+// With a compiled navdata database it also routes each suggestion along airways.
 #include <algorithm>
-#include <cctype>
 #include <cmath>
-#include <fstream>
+#include <cstdio>
+#include <iomanip>
 #include <iostream>
-#include <map>
+#include <optional>
 #include <random>
-#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
-struct Airport {
-    std::string icao;
-    std::string name;
-    std::string country;
-    std::string region;
-    double lat = 0.0;
-    double lon = 0.0;
-    int longest_runway_ft = 0;
-    std::string kind;
-};
+#include "core/airports.hpp"
+#include "core/airway_router.hpp"
+#include "core/alloc_stats.hpp"
+#include "core/fuel_stops.hpp"
+#include "core/geo.hpp"
+#include "core/geofilter.hpp"
+#include "core/navdata.hpp"
+#include "core/routes.hpp"
+#include "core/schedule.hpp"
+#include "core/trace.hpp"
 
-struct Aircraft {
-    std::string name;
-    std::string role;
-    std::string home;
-    double range_nm = 500.0;
-    int min_runway_ft = 0;
-};
+using namespace flightsuite;
 
-static std::string trim(const std::string& s) {
-    size_t start = 0;
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
-    size_t end = s.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
-    return s.substr(start, end - start);
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog
+              << " [--aircraft aircraft.csv] [--airports airports.csv] [--count 3] "
+                 "[--region USA|US-WA|...] [--bbox LAT,LON,LAT,LON] [--near LAT,LON,NM]\n"
+                 "           [--polygon area.geojson] [--random-start] [--navdata nav.bin] [--alloc-stats] [--trace out.json]\n";
+    std::cerr << "       " << prog
+              << " --route FROM TO --navdata nav.bin [--airports airports.csv] [--min-fl 180] [--max-fl 450]\n"
+                 "           [--avoid J70,V23,SEA,OLM-BTG] [--tas 250 [--wind 270@60]]\n";
+    std::cerr << "       " << prog
+              << " --stops FROM TO --with NAME [--aircraft aircraft.csv] [--airports airports.csv] [--shortest]\n";
+    std::cerr << "       " << prog
+              << " --schedule [--aircraft aircraft.csv] [--airports airports.csv] [--base ICAO] [area filters]\n"
+                 "           [--start 06:00] [--end 22:00] [--turn MIN] [--wind 270@40] [--threads N] [--restarts N]\n"
+                 "           [--seed N] [--summary]\n";
+    std::cerr << " aircraft.csv columns: name,role,home,range_nm[,min_runway_ft[,cruise_tas_kt]]\n";
+    std::cerr << " airports.csv columns: icao,name,country,region,lat,lon,longest_runway_ft[,kind]\n";
+    std::cerr << " Area filters (--region, --bbox, --near, --polygon) combine; an airport must pass all of them.\n"
+                 " --bbox takes the west corner first (LON1 > LON2 spans the antimeridian); --polygon reads\n"
+                 " Polygon/MultiPolygon geometry from GeoJSON, features and collections included.\n";
+    std::cerr << " --navdata routes suggestions along airways (compile one with the navdata tool); --avoid\n"
+                 " takes airways, fixes, and FIX-FIX segments; --wind is a uniform DIR@KT field and needs --tas.\n";
+    std::cerr << " --stops plans fuel stops for the named aircraft (legs up to 90% of range, stops on runways it\n"
+                 " can use): fewest stops by default, --shortest for the least total distance.\n";
+    std::cerr << " --schedule builds one day of rotations for the whole fleet, each back on base by --end,\n"
+                 " serving as many distinct airports as it can; aircraft without a home fly from --base.\n";
 }
 
-static std::vector<std::string> split_csv_line(const std::string& line) {
-    std::vector<std::string> cells;
-    std::string cell;
-    std::istringstream ss(line);
-    while (std::getline(ss, cell, ',')) {
-        cells.push_back(trim(cell));
-    }
-    return cells;
+static bool parse_clock(const std::string& s, int& minutes) {
+    int h = 0, m = 0;
+    char extra = 0;
+    if (std::sscanf(s.c_str(), "%d:%d%c", &h, &m, &extra) != 2 || h < 0 || h > 24 || m < 0 || m > 59) return false;
+    minutes = h * 60 + m;
+    return minutes <= 24 * 60;
 }
 
-static bool read_file_lines(const std::string& path, std::vector<std::string>& lines_out) {
-    std::ifstream file(path);
-    if (!file.is_open()) return false;
-    std::string line;
-    while (std::getline(file, line)) {
-        if (!line.empty()) lines_out.push_back(line);
-    }
-    return true;
+static std::string clock_str(int minutes) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%02d:%02d", minutes / 60, minutes % 60);
+    return buf;
 }
 
-static std::vector<Airport> load_airports(const std::string& path) {
-    std::vector<Airport> airports;
-    std::vector<std::string> lines;
-    if (!read_file_lines(path, lines)) {
-        std::cerr << "Failed to open airports file: " << path << "\n";
-        return airports;
+static int run_schedule(std::vector<Aircraft> aircraft, const std::vector<Airport>& airports,
+                        const std::string& default_base, const ScheduleOptions& opt, bool summary) {
+    for (auto& ac : aircraft) {
+        if (ac.home.empty()) ac.home = default_base;
     }
-    for (const auto& line : lines) {
-        if (line.empty() || line[0] == '#') continue;
-        auto cells = split_csv_line(line);
-        if (cells.size() < 7) continue;
-        Airport a;
-        a.icao = cells[0];
-        a.name = cells[1];
-        a.country = cells[2];
-        a.region = cells[3];
-        a.lat = std::stod(cells[4]);
-        a.lon = std::stod(cells[5]);
-        a.longest_runway_ft = std::stoi(cells[6]);
-        a.kind = cells.size() > 7 ? cells[7] : "";
-        airports.push_back(a);
+    enter_stage(AllocStage::kAnalyze);
+    auto sched = build_schedule(aircraft, airports, opt);
+    enter_stage(AllocStage::kOutput);
+    size_t legs = 0, idle = 0;
+    for (const auto& rot : sched.rotations) {
+        legs += rot.legs.size();
+        if (rot.legs.empty()) ++idle;
     }
-    return airports;
-}
-
-static std::vector<Aircraft> load_aircraft(const std::string& path) {
-    std::vector<Aircraft> planes;
-    std::vector<std::string> lines;
-    if (!read_file_lines(path, lines)) {
-        std::cerr << "Failed to open aircraft file: " << path << "\n";
-        return planes;
+    for (size_t i : sched.unbased) {
+        std::cerr << "Skipping " << aircraft[i].name << ": "
+                  << (aircraft[i].home.empty() ? "no home (use --base)" : "home " + aircraft[i].home + " not in catalog")
+                  << "\n";
     }
-    for (const auto& line : lines) {
-        if (line.empty() || line[0] == '#') continue;
-        auto cells = split_csv_line(line);
-        if (cells.size() < 3) continue;
-        Aircraft ac;
-        ac.name = cells[0];
-        ac.role = cells[1];
-        ac.home = cells[2];
-        if (cells.size() > 3 && !cells[3].empty()) {
-            ac.range_nm = std::stod(cells[3]);
-        }
-        if (cells.size() > 4 && !cells[4].empty()) {
-            ac.min_runway_ft = std::stoi(cells[4]);
+    if (sched.rotations.empty()) {
+        std::cerr << "No aircraft to schedule.\n";
+        return 1;
+    }
+    if (!summary) {
+        for (const auto& rot : sched.rotations) {
+            const Aircraft& ac = aircraft[rot.aircraft];
+            std::cout << "=== " << ac.name << " (" << ac.role << "), base " << airports[rot.base].icao << " ===\n";
+            if (rot.legs.empty()) std::cout << "  no legs fit the day\n";
+            for (const auto& leg : rot.legs) {
+                std::cout << "  " << clock_str(leg.out_min) << "-" << clock_str(leg.in_min) << "  "
+                          << airports[leg.from].icao << " -> " << airports[leg.to].icao << "  "
+                          << static_cast<int>(std::round(leg.distance_nm)) << " nm\n";
+            }
         }
-        planes.push_back(ac);
+        std::cout << "\n";
     }
-    return planes;
-}
-
-static int role_min_runway(const std::string& role_raw) {
-    std::string r = role_raw;
-    std::transform(r.begin(), r.end(), r.begin(), [](unsigned char c) { return std::tolower(c); });
-    if (r.find("wide") != std::string::npos || r.find("long") != std::string::npos) return 8000;
-    if (r.find("jet") != std::string::npos || r.find("737") != std::string::npos ||
-        r.find("320") != std::string::npos)
-        return 6500;
-    if (r.find("regional") != std::string::npos || r.find("crj") != std::string::npos ||
-        r.find("e175") != std::string::npos)
-        return 5500;
-    if (r.find("turboprop") != std::string::npos || r.find("king") != std::string::npos ||
-        r.find("pc-12") != std::string::npos)
-        return 4000;
-    if (r.find("ga") != std::string::npos || r.find("piston") != std::string::npos ||
-        r.find("172") != std::string::npos || r.find("pa-") != std::string::npos)
-        return 2500;
-    return 3500;
-}
-
-static double deg2rad(double d) { return d * M_PI / 180.0; }
-
-static double haversine_nm(double lat1, double lon1, double lat2, double lon2) {
-    const double R_nm = 3440.065; // nautical miles
-    double dlat = deg2rad(lat2 - lat1);
-    double dlon = deg2rad(lon2 - lon1);
-    double a = std::sin(dlat / 2) * std::sin(dlat / 2) +
-               std::cos(deg2rad(lat1)) * std::cos(deg2rad(lat2)) * std::sin(dlon / 2) *
-                   std::sin(dlon / 2);
-    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
-    return R_nm * c;
+    std::cout << sched.rotations.size() << " aircraft, " << legs << " legs, " << sched.covered
+              << " airports served, " << std::fixed << std::setprecision(1) << sched.block_hours
+              << " block hours (best of " << sched.restarts << " starts: #" << sched.best_restart << ")";
+    if (idle) std::cout << "; " << idle << " aircraft idle";
+    std::cout << "\n";
+    return 0;
 }
 
-struct Suggestion {
-    std::string from_icao;
-    std::string to_icao;
-    double distance_nm = 0.0;
-};
-
-static const Airport* pick_random_airport(const std::vector<Airport>& airports, int min_rwy,
-                                          const std::string& region_filter, std::mt19937& gen) {
-    std::vector<const Airport*> candidates;
-    for (const auto& a : airports) {
-        if (a.longest_runway_ft < min_rwy) continue;
-        if (!region_filter.empty() && a.country != region_filter && a.region != region_filter)
-            continue;
-        candidates.push_back(&a);
+static int run_stops(const std::vector<Airport>& airports, const std::unordered_map<std::string, Airport>& by_icao,
+                     const Aircraft& ac, const std::string& from, const std::string& to, FuelStopGoal goal) {
+    auto a = by_icao.find(from), b = by_icao.find(to);
+    if (a == by_icao.end() || b == by_icao.end()) {
+        std::cerr << "Unknown airport " << (a == by_icao.end() ? from : to) << "\n";
+        return 1;
     }
-    if (candidates.empty()) return nullptr;
-    std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
-    return candidates[dist(gen)];
-}
-
-static std::vector<Suggestion> suggest_routes(const Aircraft& ac,
-                                              const std::unordered_map<std::string, Airport>& by_icao,
-                                              const std::vector<Airport>& airports, int count,
-                                              const std::string& region_filter, bool random_start) {
-    std::vector<Suggestion> out;
+    enter_stage(AllocStage::kAnalyze);
     int min_rwy = ac.min_runway_ft > 0 ? ac.min_runway_ft : role_min_runway(ac.role);
-    double min_leg = ac.range_nm * 0.3;
+    // Same reserve as suggest_routes: a leg may use up to 90% of the published range.
     double max_leg = ac.range_nm * 0.9;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    auto home_it = by_icao.find(ac.home);
-    const Airport* home = (random_start || home_it == by_icao.end()) ? nullptr : &home_it->second;
-    if (!home) {
-        home = pick_random_airport(airports, min_rwy, region_filter, gen);
+    FuelStopPlanner planner(airports, min_rwy);
+    auto plan = planner.plan(a->second, b->second, max_leg, goal);
+    enter_stage(AllocStage::kOutput);
+    std::cout << ac.name << ": legs up to " << static_cast<int>(std::round(max_leg)) << " nm, stops on "
+              << planner.qualified() << " airports with " << min_rwy << " ft runways\n";
+    if (!plan.found) {
+        std::cout << "No chain of fuel stops from " << from << " to " << to << ".\n";
+        return 1;
     }
-
-    std::vector<std::pair<const Airport*, double>> candidates;
-    for (const auto& a : airports) {
-        if (home && a.icao == home->icao) continue;
-        if (a.longest_runway_ft < min_rwy) continue;
-        if (!region_filter.empty() && a.country != region_filter && a.region != region_filter)
-            continue;
-        double dist = 0.0;
-        if (home) {
-            dist = haversine_nm(home->lat, home->lon, a.lat, a.lon);
-            if (dist < min_leg || dist > max_leg) continue;
+    for (size_t i = 0; i < plan.stops.size(); ++i) {
+        const Airport* s = plan.stops[i];
+        std::cout << "  " << s->icao;
+        if (i > 0) {
+            const Airport* p = plan.stops[i - 1];
+            std::cout << "  " << static_cast<int>(std::round(haversine_nm(p->lat, p->lon, s->lat, s->lon))) << " nm";
         }
-        candidates.push_back({&a, dist});
+        if (!s->name.empty()) std::cout << "  " << s->name;
+        std::cout << "\n";
     }
+    size_t stops = plan.stops.size() - 2;
+    std::cout << stops << " fuel stop" << (stops == 1 ? "" : "s") << ", "
+              << static_cast<int>(std::round(plan.distance_nm)) << " nm total, longest leg "
+              << static_cast<int>(std::round(plan.longest_leg_nm)) << " nm (" << plan.expanded
+              << " airports expanded)\n";
+    return 0;
+}
 
-    if (candidates.empty()) {
-        // Relax distance filter if nothing found
-        for (const auto& a : airports) {
-            if (a.icao == ac.home) continue;
-            if (a.longest_runway_ft < min_rwy) continue;
-            if (!region_filter.empty() && a.country != region_filter && a.region != region_filter)
-                continue;
-            double dist = 0.0;
-            if (home) dist = haversine_nm(home->lat, home->lon, a.lat, a.lon);
-            candidates.push_back({&a, dist});
-        }
+// Airway levels by airframe class, reusing the role buckets behind the runway defaults: jets file
+// the high structure, pistons the low one, turboprops either.
+static void role_band(const Aircraft& ac, AirwayRouteOptions& opt) {
+    int rwy = role_min_runway(ac.role);
+    if (rwy >= 5500) {
+        opt.min_fl = 180;
+        opt.max_fl = 450;
+    } else if (rwy <= 2500) {
+        opt.min_fl = 0;
+        opt.max_fl = 179;
+    } else {
+        opt.min_fl = 0;
+        opt.max_fl = 350;
     }
+}
 
-    std::shuffle(candidates.begin(), candidates.end(), gen);
-
-    for (size_t i = 0; i < candidates.size() && (int)out.size() < count; ++i) {
-        Suggestion s;
-        s.from_icao = home ? home->icao : "N/A";
-        s.to_icao = candidates[i].first->icao;
-        s.distance_nm = candidates[i].second;
-        out.push_back(s);
+static void add_avoid(const NavDatabase& db, const std::string& list, AirwayRouteOptions& opt) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? list.size() + 1 : comma + 1;
+        if (item.empty()) continue;
+        size_t dash = item.find('-');
+        if (dash != std::string::npos) {
+            opt.avoid_segments.emplace_back(item.substr(0, dash), item.substr(dash + 1));
+        } else if (db.find_airway(item)) {
+            opt.avoid_airways.push_back(item);
+        } else {
+            opt.avoid_fixes.push_back(item);
+        }
     }
-    return out;
 }
 
-static void usage(const char* prog) {
-    std::cerr << "Usage: " << prog
-              << " [--aircraft aircraft.csv] [--airports airports.csv] [--count 3] "
-                 "[--region USA|US-WA|...] [--random-start]\n";
-    std::cerr << " aircraft.csv columns: name,role,home,range_nm[,min_runway_ft]\n";
-    std::cerr << " airports.csv columns: icao,name,country,region,lat,lon,longest_runway_ft[,kind]\n";
+static int run_route(const NavDatabase& db, const std::unordered_map<std::string, Airport>& by_icao,
+                     const std::string& from, const std::string& to, AirwayRouteOptions opt) {
+    auto a = by_icao.find(from), b = by_icao.find(to);
+    if (a == by_icao.end() || b == by_icao.end()) {
+        std::cerr << "Unknown airport " << (a == by_icao.end() ? from : to) << "\n";
+        return 1;
+    }
+    enter_stage(AllocStage::kAnalyze);
+    AirwayRouter router(db, opt);
+    auto route = router.find(a->second.lat, a->second.lon, b->second.lat, b->second.lon);
+    enter_stage(AllocStage::kOutput);
+    if (!route.found) {
+        std::cout << "No airway route from " << from << " to " << to << " between FL" << opt.min_fl << " and FL"
+                  << opt.max_fl << ".\n";
+        return 1;
+    }
+    std::cout << route.route_string(db, from, to) << "\n";
+    std::cout << std::fixed << std::setprecision(0) << route.distance_nm << " nm along airways, " << route.direct_nm
+              << " nm direct (+" << std::setprecision(1)
+              << (route.direct_nm > 0.0 ? (route.distance_nm / route.direct_nm - 1.0) * 100.0 : 0.0) << "%)";
+    if (opt.tas_kt > 0.0) {
+        int minutes = static_cast<int>(std::round(route.minutes));
+        std::cout << ", " << minutes / 60 << "h" << std::setfill('0') << std::setw(2) << minutes % 60
+                  << std::setfill(' ') << " at " << std::setprecision(0) << opt.tas_kt << " kt TAS";
+    }
+    std::cout << "; " << route.points.size() << " points, " << route.expanded << " nodes expanded\n";
+    return 0;
 }
 
 int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
     std::string aircraft_path = "aircraft.csv";
     std::string airports_path = "airports.csv";
-    std::string region_filter;
+    GeoFilter area;
+    std::string polygon_path;
     int count = 3;
     bool random_start = false;
+    std::string navdata_path, route_from, route_to, avoid;
+    std::string stops_from, stops_to, stops_with;
+    FuelStopGoal stops_goal = FuelStopGoal::kFewestStops;
+    bool schedule = false, schedule_summary = false;
+    std::string schedule_base;
+    ScheduleOptions sched_opt;
+    std::optional<int> min_fl, max_fl;
+    AirwayRouteOptions route_opt;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -242,9 +237,75 @@ int main(int argc, char** argv) {
         } else if (arg == "--count" && i + 1 < argc) {
             count = std::stoi(argv[++i]);
         } else if (arg == "--region" && i + 1 < argc) {
-            region_filter = argv[++i];
+            area.set_region(argv[++i]);
+        } else if (arg == "--bbox" && i + 1 < argc) {
+            BoundingBox box;
+            if (!parse_bbox(argv[++i], box)) {
+                usage(argv[0]);
+                return 1;
+            }
+            area.set_bbox(box);
+        } else if (arg == "--near" && i + 1 < argc) {
+            GeoPoint center;
+            double nm = 0.0;
+            if (!parse_radius(argv[++i], center, nm)) {
+                usage(argv[0]);
+                return 1;
+            }
+            area.set_radius(center, nm);
+        } else if (arg == "--polygon" && i + 1 < argc) {
+            polygon_path = argv[++i];
         } else if (arg == "--random-start") {
             random_start = true;
+        } else if (arg == "--navdata" && i + 1 < argc) {
+            navdata_path = argv[++i];
+        } else if (arg == "--route" && i + 2 < argc) {
+            route_from = argv[++i];
+            route_to = argv[++i];
+        } else if (arg == "--stops" && i + 2 < argc) {
+            stops_from = argv[++i];
+            stops_to = argv[++i];
+        } else if (arg == "--with" && i + 1 < argc) {
+            stops_with = argv[++i];
+        } else if (arg == "--shortest") {
+            stops_goal = FuelStopGoal::kShortestDistance;
+        } else if (arg == "--min-fl" && i + 1 < argc) {
+            min_fl = std::stoi(argv[++i]);
+        } else if (arg == "--max-fl" && i + 1 < argc) {
+            max_fl = std::stoi(argv[++i]);
+        } else if (arg == "--avoid" && i + 1 < argc) {
+            avoid = argv[++i];
+        } else if (arg == "--tas" && i + 1 < argc) {
+            route_opt.tas_kt = std::stod(argv[++i]);
+        } else if (arg == "--wind" && i + 1 < argc) {
+            double dir = 0.0, kt = 0.0;
+            if (std::sscanf(argv[++i], "%lf@%lf", &dir, &kt) != 2 || kt < 0.0) {
+                usage(argv[0]);
+                return 1;
+            }
+            route_opt.wind = [dir, kt](double, double) { return WindSample{dir, kt}; };
+            route_opt.max_wind_kt = kt;
+            sched_opt.wind_dir_deg = dir;
+            sched_opt.wind_kt = kt;
+        } else if (arg == "--schedule") {
+            schedule = true;
+        } else if (arg == "--summary") {
+            schedule_summary = true;
+        } else if (arg == "--base" && i + 1 < argc) {
+            schedule_base = argv[++i];
+        } else if ((arg == "--start" || arg == "--end") && i + 1 < argc) {
+            if (!parse_clock(argv[++i], arg == "--start" ? sched_opt.day_start_min : sched_opt.day_end_min)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--turn" && i + 1 < argc) {
+            sched_opt.turnaround_min = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            sched_opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--restarts" && i + 1 < argc) {
+            sched_opt.restarts = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            sched_opt.seed = std::stoull(argv[++i]);
         } else if (arg == "--help" || arg == "-h") {
             usage(argv[0]);
             return 0;
@@ -254,14 +315,40 @@ int main(int argc, char** argv) {
         }
     }
 
+    enter_stage(AllocStage::kParse);
     auto airports = load_airports(airports_path);
     if (airports.empty()) {
         std::cerr << "No airports loaded.\n";
         return 1;
     }
-    std::unordered_map<std::string, Airport> by_icao;
-    for (const auto& a : airports) {
-        by_icao[a.icao] = a;
+    auto by_icao = index_by_icao(airports);
+    if (!polygon_path.empty()) {
+        PreparedPolygon polygon;
+        std::string error;
+        if (!load_geojson_polygon(polygon_path, polygon, &error)) {
+            std::cerr << "Failed to load polygon: " << error << "\n";
+            return 1;
+        }
+        area.set_polygon(std::move(polygon));
+    }
+
+    NavDatabase db;
+    if (!navdata_path.empty()) {
+        std::string error;
+        if (!db.open(navdata_path, &error)) {
+            std::cerr << "Failed to open navdata: " << error << "\n";
+            return 1;
+        }
+        add_avoid(db, avoid, route_opt);
+    }
+    if (!route_from.empty()) {
+        if (!db.is_open()) {
+            std::cerr << "--route needs --navdata.\n";
+            return 1;
+        }
+        if (min_fl) route_opt.min_fl = *min_fl;
+        if (max_fl) route_opt.max_fl = *max_fl;
+        return run_route(db, by_icao, route_from, route_to, route_opt);
     }
 
     auto aircraft = load_aircraft(aircraft_path);
@@ -269,14 +356,40 @@ int main(int argc, char** argv) {
         std::cerr << "No aircraft loaded.\n";
         return 1;
     }
+    if (!stops_from.empty()) {
+        auto ac = std::find_if(aircraft.begin(), aircraft.end(), [&](const Aircraft& a) { return a.name == stops_with; });
+        if (ac == aircraft.end()) {
+            std::cerr << (stops_with.empty() ? "--stops needs --with NAME" : "No aircraft named " + stops_with)
+                      << "\n";
+            return 1;
+        }
+        return run_stops(airports, by_icao, *ac, stops_from, stops_to, stops_goal);
+    }
+    if (schedule) {
+        sched_opt.area = std::move(area);
+        return run_schedule(aircraft, airports, schedule_base, sched_opt, schedule_summary);
+    }
 
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    if (!area.empty()) std::cout << "Area: " << area.describe() << "\n";
     for (const auto& ac : aircraft) {
+        enter_stage(AllocStage::kOutput);
         std::cout << "=== " << ac.name << " (" << ac.role << "), home " << ac.home
                   << ", range " << ac.range_nm << "nm"
                   << ", min rwy "
                   << (ac.min_runway_ft > 0 ? ac.min_runway_ft : role_min_runway(ac.role))
                   << " ft ===\n";
-        auto routes = suggest_routes(ac, by_icao, airports, count, region_filter, random_start);
+        enter_stage(AllocStage::kAnalyze);
+        // One router per airframe: the band depends on the role, explicit levels override it.
+        AirwayRouteOptions opt = route_opt;
+        role_band(ac, opt);
+        if (min_fl) opt.min_fl = *min_fl;
+        if (max_fl) opt.max_fl = *max_fl;
+        std::optional<AirwayRouter> router;
+        if (db.is_open()) router.emplace(db, opt);
+        auto routes = suggest_routes(ac, by_icao, airports, count, area, random_start, gen);
+        enter_stage(AllocStage::kOutput);
         if (routes.empty()) {
             std::cout << "No suggestions found.\n";
             continue;
@@ -288,6 +401,19 @@ int main(int argc, char** argv) {
                 std::cout << " (" << static_cast<int>(std::round(r.distance_nm)) << " nm)";
             }
             std::cout << "\n";
+            if (!db.is_open()) continue;
+            auto a = by_icao.find(r.from_icao), b = by_icao.find(r.to_icao);
+            if (a == by_icao.end() || b == by_icao.end()) continue;
+            enter_stage(AllocStage::kAnalyze);
+            auto routed = router->find(a->second.lat, a->second.lon, b->second.lat, b->second.lon);
+            enter_stage(AllocStage::kOutput);
+            if (!routed.found) {
+                std::cout << "     no airway route between FL" << opt.min_fl << " and FL" << opt.max_fl << "\n";
+                continue;
+            }
+            std::cout << "     " << static_cast<int>(std::round(routed.distance_nm)) << " nm via airways"
+                      << (routed.distance_nm > ac.range_nm ? " (beyond range)" : "") << ": "
+                      << routed.route_string(db, r.from_icao, r.to_icao) << "\n";
         }
         std::cout << "\n";
     }
@@ -1,10 +1,17 @@
-// Simple flight log updater: prompts for flight details and appends to a CSV log file.
+// Simple flight log updater: prompts for flight details and appends to a CSV log file, or
+// searches the log's routes and remarks through its full-text index.
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "core/alloc_stats.hpp"
+#include "core/log_index.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
 struct FlightEntry {
     std::string date;       // YYYY-MM-DD
     std::string tail;       // aircraft tail/registration
@@ -83,14 +90,76 @@ static void append_entry(const FlightEntry& e, const std::string& path) {
     std::cout << "Saved to " << path << "\n";
 }
 
+// Prints the newest `limit` matches, one line each.
+static int search_log(const std::string& log_path, const std::string& index_path, const std::string& query,
+                      size_t limit, bool reindex) {
+    flightsuite::enter_stage(flightsuite::AllocStage::kParse);
+    flightsuite::LogIndex index;
+    std::string error;
+    if (!index.open(log_path, index_path, reindex, &error)) {
+        std::cerr << "Index: " << error << "\n";
+        return 1;
+    }
+    if (index.rebuilt() || index.added() > 0) {
+        std::cerr << (index.rebuilt() ? "Indexed " : "Added ") << index.added() << " entries to " << index_path
+                  << " (" << index.segment_count() << " segments, " << index.file_size() << " bytes)\n";
+    }
+    if (query.empty()) return 0;
+    flightsuite::enter_stage(flightsuite::AllocStage::kAnalyze);
+    auto hits = index.search(query, &error);
+    if (!hits) {
+        std::cerr << "Search: " << error << "\n";
+        return 1;
+    }
+    flightsuite::enter_stage(flightsuite::AllocStage::kOutput);
+    std::ifstream log(log_path, std::ios::binary);
+    std::string line;
+    size_t shown = 0;
+    for (auto it = hits->rbegin(); it != hits->rend() && shown < limit; ++it, ++shown) {
+        log.clear();
+        log.seekg(static_cast<std::streamoff>(index.entry_offset(*it)));
+        if (!std::getline(log, line)) break;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        auto cells = flightsuite::split_csv_line(line);
+        cells.resize(std::max<size_t>(cells.size(), 12));
+        std::string remarks = cells[11];
+        for (size_t c = 12; c < cells.size(); ++c) remarks += "," + cells[c];
+        std::cout << cells[0] << "  " << cells[1] << "  " << cells[2] << "-" << cells[3] << "  " << cells[4];
+        if (!remarks.empty()) std::cout << "  | " << remarks;
+        std::cout << "\n";
+    }
+    std::cout << hits->size() << " matching entries of " << index.entry_count();
+    if (shown < hits->size()) std::cout << " (newest " << shown << " shown)";
+    std::cout << "\n";
+    return 0;
+}
+
 int main(int argc, char** argv) {
+    flightsuite::init_alloc_stats(argc, argv);
+    flightsuite::init_trace(argc, argv);
     std::string log_path = "flight_log.csv";
+    std::string index_path, query;
+    size_t limit = 20;
+    bool search = false, reindex = false;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if ((arg == "--log" || arg == "-l") && i + 1 < argc) {
             log_path = argv[++i];
+        } else if (arg == "--search" && i + 1 < argc) {
+            query = argv[++i];
+            search = true;
+        } else if (arg == "--limit" && i + 1 < argc) {
+            limit = std::stoul(argv[++i]);
+        } else if (arg == "--index" && i + 1 < argc) {
+            index_path = argv[++i];
+        } else if (arg == "--reindex") {
+            reindex = true;
         } else if (arg == "--help" || arg == "-h") {
-            std::cout << "Usage: " << argv[0] << " [--log path/to/log.csv]\n";
+            std::cout << "Usage: " << argv[0] << " [--log path/to/log.csv] [--alloc-stats] [--trace out.json]\n"
+                      << "   or: " << argv[0] << " --log log.csv --search 'query' [--limit 20] [--index log.csv.idx]\n"
+                      << "   or: " << argv[0] << " --log log.csv --reindex\n"
+                      << " A query is words and \"quoted phrases\", each optionally prefixed with route: or remarks:;\n"
+                      << " entries must match all of them, e.g. --search 'remarks:\"ILS 16R\" route:J70'.\n";
             return 0;
         } else {
             std::cout << "Unknown option: " << arg << "\n";
@@ -98,6 +167,9 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (index_path.empty()) index_path = flightsuite::log_index_path(log_path);
+    if (search || reindex) return search_log(log_path, index_path, query, limit, reindex);
+
     // If file is empty/new, write header.
     std::ifstream check(log_path);
     bool need_header = !check.good() || check.peek() == std::ifstream::traits_type::eof();
@@ -107,7 +179,16 @@ int main(int argc, char** argv) {
         init << "date,tail,from,to,route,pic_hours,sic_hours,night_hours,ifr_hours,landings_day,landings_night,remarks\n";
     }
 
+    flightsuite::enter_stage(flightsuite::AllocStage::kParse);
     FlightEntry e = collect_entry();
+    flightsuite::enter_stage(flightsuite::AllocStage::kOutput);
     append_entry(e, log_path);
+
+    // Keep an existing index current; one is created by the first --search.
+    if (std::ifstream(index_path).good()) {
+        flightsuite::LogIndex index;
+        std::string error;
+        if (!index.open(log_path, index_path, false, &error)) std::cerr << "Index: " << error << "\n";
+    }
     return 0;
 }
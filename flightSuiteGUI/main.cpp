@@ -6,15 +6,33 @@
 #include <sstream>
 #include <string>
 
+#include "core/alloc_stats.hpp"
+#include "core/e6b_session.hpp"
+#include "core/trace.hpp"
+
+static std::string g_trace_path; // --trace: children write next to it and get merged in
+
 static std::string run_cmd(const std::string& cmd) {
+    flightsuite::AllocStageScope stage(flightsuite::AllocStage::kFetch);
+    flightsuite::TraceSpan span("child", "gui", cmd);
+    std::string full_cmd = cmd;
+    std::string child_trace;
+    if (!g_trace_path.empty()) {
+        static int runs = 0;
+        child_trace = g_trace_path + ".child" + std::to_string(++runs) + ".json";
+        full_cmd += " --trace \"" + child_trace + "\"";
+    }
     std::string output;
-    FILE* pipe = popen(cmd.c_str(), "r");
+    FILE* pipe = popen(full_cmd.c_str(), "r");
     if (!pipe) return "Failed to run command.\n";
     char buffer[256];
     while (fgets(buffer, sizeof(buffer), pipe)) {
         output += buffer;
     }
     pclose(pipe);
+    if (!child_trace.empty() && flightsuite::trace_import_file(child_trace)) {
+        std::remove(child_trace.c_str());
+    }
     return output;
 }
 
@@ -78,18 +96,22 @@ static void notam_menu() {
     std::cout << out << "\n";
 }
 
+// Runs in-process on one session for the launcher's lifetime, so variables carry over between
+// visits and only formulas whose inputs changed are recomputed.
 static void e6b_menu() {
-    std::cout << "Modes: winds, xwind, headwind, pressure_alt, density_alt, mach, tas, tsd, fuel, drift, groundspeed\n";
-    std::cout << "Enter mode: ";
-    std::string mode;
-    std::getline(std::cin, mode);
-    std::cout << "Enter args separated by space (per README): ";
-    std::string args;
-    std::getline(std::cin, args);
-    std::stringstream cmd;
-    cmd << "../e6bTool/e6b " << mode << " " << args;
-    auto out = run_cmd(cmd.str());
-    std::cout << out << "\n";
+    static flightsuite::E6bSession session;
+    flightsuite::AllocStageScope stage(flightsuite::AllocStage::kAnalyze);
+    std::cout << "E6B session: name = expr, bare expressions, 'vars', 'help'; blank line returns.\n";
+    std::string line, out, error;
+    while (true) {
+        std::cout << "e6b> ";
+        if (!std::getline(std::cin, line) || line.empty()) break;
+        if (session.run_line(line, out, true, &error)) {
+            std::cout << out;
+        } else {
+            std::cout << "error: " << error << "\n";
+        }
+    }
 }
 
 static void vertical_profile_menu() {
@@ -153,8 +175,7 @@ static void menu() {
             if (file_exists("../notamTool/notam_risk")) notam_menu();
             else std::cout << "Build ../notamTool/notam_risk first.\n";
         } else if (choice == "4") {
-            if (file_exists("../e6bTool/e6b")) e6b_menu();
-            else std::cout << "Build ../e6bTool/e6b first.\n";
+            e6b_menu();
         } else if (choice == "5") {
             if (file_exists("../verticalProfile/vert_profile")) vertical_profile_menu();
             else std::cout << "Build ../verticalProfile/vert_profile first.\n";
@@ -169,7 +190,9 @@ static void menu() {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    flightsuite::init_alloc_stats(argc, argv);
+    g_trace_path = flightsuite::init_trace(argc, argv);
     menu();
     return 0;
 }
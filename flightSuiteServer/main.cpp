@@ -0,0 +1,1075 @@
+// Flight Suite Server: local HTTP/JSON API over the suite's tools (METAR decode, NOTAM scoring,
+// route suggestions, E6B, vertical profile, OFP summary). Event-driven epoll loop + worker pool.
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/airports.hpp"
+#include "core/alloc_stats.hpp"
+#include "core/e6b.hpp"
+#include "core/geofilter.hpp"
+#include "core/json.hpp"
+#include "core/metar.hpp"
+#include "core/notam.hpp"
+#include "core/ofp.hpp"
+#include "core/profile.hpp"
+#include "core/routes.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+
+using namespace flightsuite;
+
+// ---------------------------------------------------------------------------
+// HTTP plumbing.
+// ---------------------------------------------------------------------------
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> query;
+    std::string body;
+    bool keep_alive = true;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string body;
+};
+
+static std::string url_decode(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '+') {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size() && std::isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+                   std::isxdigit(static_cast<unsigned char>(s[i + 2]))) {
+            out += static_cast<char>(std::stoi(s.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+static void parse_query(const std::string& qs, std::map<std::string, std::string>& out) {
+    size_t pos = 0;
+    while (pos <= qs.size()) {
+        size_t amp = qs.find('&', pos);
+        if (amp == std::string::npos) amp = qs.size();
+        std::string pair = qs.substr(pos, amp - pos);
+        if (!pair.empty()) {
+            size_t eq = pair.find('=');
+            if (eq == std::string::npos) {
+                out[url_decode(pair)] = "";
+            } else {
+                out[url_decode(pair.substr(0, eq))] = url_decode(pair.substr(eq + 1));
+            }
+        }
+        pos = amp + 1;
+    }
+}
+
+constexpr size_t kMaxHeaderBytes = 64 * 1024;
+constexpr size_t kMaxBodyBytes = 8 * 1024 * 1024;
+// Input a connection may buffer, e.g. pipelined requests behind a busy one.
+constexpr size_t kMaxBufferedBytes = kMaxHeaderBytes + kMaxBodyBytes;
+
+enum class ParseResult { kIncomplete, kComplete, kBad, kTooLarge };
+
+// Parses one request from the front of `buf`; on success erases the consumed bytes.
+static ParseResult parse_http_request(std::string& buf, HttpRequest& req) {
+    size_t header_end = buf.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        return buf.size() > kMaxHeaderBytes ? ParseResult::kTooLarge : ParseResult::kIncomplete;
+    }
+    size_t line_end = buf.find("\r\n");
+    std::istringstream request_line(buf.substr(0, line_end));
+    std::string target, version;
+    if (!(request_line >> req.method >> target >> version)) return ParseResult::kBad;
+    req.keep_alive = version != "HTTP/1.0";
+
+    size_t content_length = 0;
+    size_t pos = line_end + 2;
+    while (pos < header_end) {
+        size_t eol = buf.find("\r\n", pos);
+        std::string line = buf.substr(pos, eol - pos);
+        pos = eol + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::string value = trim(line.substr(colon + 1));
+        if (name == "content-length") {
+            if (!is_number(value)) return ParseResult::kBad;
+            // Digits only, so the one failure left is a value too large for size_t.
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), content_length);
+            if (ec != std::errc() || end != value.data() + value.size() || content_length > kMaxBodyBytes) {
+                return ParseResult::kTooLarge;
+            }
+        } else if (name == "connection") {
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            if (value == "close") req.keep_alive = false;
+            if (value == "keep-alive") req.keep_alive = true;
+        }
+    }
+    size_t total = header_end + 4 + content_length;
+    if (buf.size() < total) return ParseResult::kIncomplete;
+
+    size_t qmark = target.find('?');
+    req.path = target.substr(0, qmark);
+    if (qmark != std::string::npos) parse_query(target.substr(qmark + 1), req.query);
+    req.body = buf.substr(header_end + 4, content_length);
+    buf.erase(0, total);
+    return ParseResult::kComplete;
+}
+
+static const char* status_text(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+static std::string serialize_response(const HttpResponse& r, bool keep_alive) {
+    std::string out;
+    out.reserve(r.body.size() + 128);
+    out += "HTTP/1.1 " + std::to_string(r.status) + " " + status_text(r.status) + "\r\n";
+    out += "Content-Type: application/json\r\n";
+    out += "Content-Length: " + std::to_string(r.body.size()) + "\r\n";
+    out += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    out += r.body;
+    return out;
+}
+
+static HttpResponse error_response(int status, const std::string& message) {
+    JsonWriter w;
+    w.begin_object().field("error", message).end_object();
+    return {status, w.str()};
+}
+
+// ---------------------------------------------------------------------------
+// Latency metrics.
+// ---------------------------------------------------------------------------
+
+// Fixed log-spaced buckets (microseconds); lock-free recording from any worker.
+class LatencyHistogram {
+public:
+    static constexpr int kBuckets = 24;
+
+    void record(double micros, bool error) {
+        count_.fetch_add(1, std::memory_order_relaxed);
+        if (error) errors_.fetch_add(1, std::memory_order_relaxed);
+        total_us_.fetch_add(static_cast<unsigned long long>(micros), std::memory_order_relaxed);
+        buckets_[bucket_for(micros)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void write_json(JsonWriter& w) const {
+        unsigned long long n = count_.load(std::memory_order_relaxed);
+        w.begin_object();
+        w.field("count", n);
+        w.field("errors", errors_.load(std::memory_order_relaxed));
+        w.field("mean_us", n ? static_cast<double>(total_us_.load(std::memory_order_relaxed)) / n : 0.0, 1);
+        w.field("p50_us", percentile(0.50), 1);
+        w.field("p95_us", percentile(0.95), 1);
+        w.field("p99_us", percentile(0.99), 1);
+        w.end_object();
+    }
+
+private:
+    // Bucket i covers (upper(i-1), upper(i)] with upper(i) = 2^(i/2) us (sqrt(2) steps).
+    static double upper_bound(int i) { return std::pow(2.0, i / 2.0); }
+
+    static int bucket_for(double micros) {
+        for (int i = 0; i < kBuckets - 1; ++i) {
+            if (micros <= upper_bound(i)) return i;
+        }
+        return kBuckets - 1;
+    }
+
+    double percentile(double q) const {
+        unsigned long long n = 0;
+        for (const auto& b : buckets_) n += b.load(std::memory_order_relaxed);
+        if (n == 0) return 0.0;
+        auto rank = static_cast<unsigned long long>(std::ceil(q * n));
+        unsigned long long seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return upper_bound(i);
+        }
+        return upper_bound(kBuckets - 1);
+    }
+
+    std::atomic<unsigned long long> count_{0};
+    std::atomic<unsigned long long> errors_{0};
+    std::atomic<unsigned long long> total_us_{0};
+    std::atomic<unsigned long long> buckets_[kBuckets] = {};
+};
+
+// ---------------------------------------------------------------------------
+// Warm caches shared by all workers.
+// ---------------------------------------------------------------------------
+
+// Sharded LRU for decoded METARs; the same reports are requested over and over by dashboards.
+class MetarCache {
+public:
+    explicit MetarCache(size_t capacity_per_shard) : capacity_(capacity_per_shard) {}
+
+    MetarDecoded get_or_decode(const std::string& raw) {
+        Shard& s = shards_[std::hash<std::string>{}(raw) % kShards];
+        {
+            std::lock_guard<std::mutex> lock(s.mu);
+            auto it = s.index.find(raw);
+            if (it != s.index.end()) {
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return it->second->second;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        MetarDecoded decoded = decode_metar(raw);
+        std::lock_guard<std::mutex> lock(s.mu);
+        if (s.index.find(raw) == s.index.end()) {
+            s.lru.emplace_front(raw, decoded);
+            s.index[raw] = s.lru.begin();
+            if (s.lru.size() > capacity_) {
+                s.index.erase(s.lru.back().first);
+                s.lru.pop_back();
+            }
+        }
+        return decoded;
+    }
+
+    unsigned long long hits() const { return hits_.load(std::memory_order_relaxed); }
+    unsigned long long misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kShards = 16;
+    using Entry = std::pair<std::string, MetarDecoded>;
+    struct Shard {
+        std::mutex mu;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+    size_t capacity_;
+    Shard shards_[kShards];
+    std::atomic<unsigned long long> hits_{0};
+    std::atomic<unsigned long long> misses_{0};
+};
+
+struct Catalog {
+    std::vector<Airport> airports;
+    std::unordered_map<std::string, Airport> by_icao;
+    std::vector<Aircraft> aircraft;
+};
+
+struct ServerState {
+    Catalog catalog;
+    MetarCache metar_cache{2048};
+    std::map<std::string, LatencyHistogram> metrics; // keys fixed at startup; values are atomic
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+};
+
+// ---------------------------------------------------------------------------
+// Endpoint handlers.
+// ---------------------------------------------------------------------------
+
+static std::optional<double> query_double(const HttpRequest& req, const std::string& name) {
+    auto it = req.query.find(name);
+    if (it == req.query.end()) return std::nullopt;
+    return parse_double(it->second);
+}
+
+// A whole-number parameter: `def` when absent or unparsable, otherwise clamped to [lo, hi] and
+// truncated. NaN and infinity have no value to clamp to and yield nullopt.
+static std::optional<int> query_int(const HttpRequest& req, const std::string& name, int def, int lo, int hi) {
+    auto d = query_double(req, name);
+    if (!d) return def;
+    if (!std::isfinite(*d)) return std::nullopt;
+    return static_cast<int>(std::clamp(*d, static_cast<double>(lo), static_cast<double>(hi)));
+}
+
+static std::string query_string(const HttpRequest& req, const std::string& name,
+                                const std::string& def = "") {
+    auto it = req.query.find(name);
+    return it == req.query.end() ? def : it->second;
+}
+
+static void write_metar_json(JsonWriter& w, const std::string& raw, const MetarDecoded& m,
+                             int runway_heading) {
+    w.begin_object();
+    w.field("raw", raw);
+    w.field("station", m.station);
+    w.field("time", m.timestamp_z);
+    w.key("wind").begin_object();
+    w.field("direction_deg", m.wind.direction_deg);
+    w.field("speed_kt", m.wind.speed_kt);
+    w.field("gust_kt", m.wind.gust_kt);
+    if (m.wind.direction_deg && runway_heading != 0) {
+        w.field("headwind_kt", headwind_component(*m.wind.direction_deg, m.wind.speed_kt, runway_heading));
+        w.field("crosswind_kt", crosswind_component(*m.wind.direction_deg, m.wind.speed_kt, runway_heading));
+    }
+    w.end_object();
+    w.field("visibility_sm", m.visibility_sm);
+    w.field("visibility_m", m.visibility_m);
+    w.field("cavok", m.cavok);
+    w.field("ceiling_ft", m.ceiling_ft);
+    w.field("ceiling_layer", m.ceiling_layer);
+    w.field("no_significant_cloud", m.no_significant_cloud);
+    w.field("temperature_c", m.temperature_c);
+    w.field("dewpoint_c", m.dewpoint_c);
+    w.field("altimeter_inhg", m.altimeter_inhg);
+    w.field("altimeter_hpa", m.altimeter_hpa);
+    w.key("rvr").begin_array();
+    for (const auto& r : m.rvr) {
+        w.begin_object();
+        w.field("runway", r.runway);
+        w.field("range_ft", r.range_ft);
+        w.field("max_range_ft", r.max_range_ft);
+        if (r.qualifier) w.field("qualifier", std::string(1, r.qualifier));
+        if (r.trend) w.field("trend", std::string(1, r.trend));
+        w.end_object();
+    }
+    w.end_array();
+    w.key("weather").begin_array();
+    for (const auto& wx : m.weather) w.value(wx);
+    w.end_array();
+    w.end_object();
+}
+
+// GET /metar/decode?raw=...&runway=220, or POST one METAR per line.
+static HttpResponse handle_metar(ServerState& st, const HttpRequest& req) {
+    auto runway = query_int(req, "runway", 0, 0, 360); // magnetic heading; 0 = none
+    if (!runway) return error_response(400, "runway must be a finite heading");
+    std::vector<std::string> raws;
+    if (req.method == "POST") {
+        raws = split_lines(req.body);
+    } else if (auto it = req.query.find("raw"); it != req.query.end()) {
+        raws.push_back(trim(it->second));
+    }
+    if (raws.empty()) return error_response(400, "provide ?raw=<METAR> or POST one METAR per line");
+    JsonWriter w;
+    if (req.method == "POST") w.begin_array();
+    for (const auto& raw : raws) {
+        write_metar_json(w, raw, st.metar_cache.get_or_decode(raw), *runway);
+    }
+    if (req.method == "POST") w.end_array();
+    return {200, w.str()};
+}
+
+// POST /notam/score?icao=KJFK with the NOTAM text as body.
+static HttpResponse handle_notam(ServerState&, const HttpRequest& req) {
+    std::string icao = query_string(req, "icao");
+    std::transform(icao.begin(), icao.end(), icao.begin(), ::toupper);
+    if (icao.empty()) return error_response(400, "missing ?icao=");
+    if (req.body.empty()) return error_response(400, "POST the NOTAM text as the request body");
+    auto parsed = parse_notams_text(req.body, icao);
+    auto risk = score_notams(parsed, icao);
+    JsonWriter w;
+    w.begin_object();
+    w.field("icao", icao);
+    w.field("score", risk.score);
+    w.key("reasons").begin_array();
+    for (const auto& r : risk.reasons) w.value(r);
+    w.end_array();
+    w.key("notams").begin_array();
+    for (const auto& n : parsed) {
+        w.begin_object();
+        w.field("raw", n.raw);
+        w.field("icao", n.icao);
+        w.field("runway_closure", n.runway_closure);
+        w.field("approach_out", n.approach_change);
+        w.field("gps_outage", n.gps_outage);
+        w.field("lighting_issue", n.lighting_issue);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    return {200, w.str()};
+}
+
+// GET /routes/suggest?aircraft=KingAir&count=3&region=US-WA&random_start=1
+//     [&bbox=LAT,LON,LAT,LON][&near=LAT,LON,NM]
+static HttpResponse handle_routes(ServerState& st, const HttpRequest& req) {
+    thread_local std::mt19937 gen(std::random_device{}());
+    const Catalog& cat = st.catalog;
+    if (cat.airports.empty()) return error_response(503, "no airport catalog loaded");
+    std::string name = query_string(req, "aircraft");
+    auto count = query_int(req, "count", 3, 1, 100);
+    if (!count) return error_response(400, "count must be a finite number");
+    GeoFilter area;
+    area.set_region(query_string(req, "region"));
+    if (std::string bbox = query_string(req, "bbox"); !bbox.empty()) {
+        BoundingBox box;
+        if (!parse_bbox(bbox, box)) return error_response(400, "bbox wants LAT,LON,LAT,LON");
+        area.set_bbox(box);
+    }
+    if (std::string near = query_string(req, "near"); !near.empty()) {
+        GeoPoint center;
+        double nm = 0.0;
+        if (!parse_radius(near, center, nm)) return error_response(400, "near wants LAT,LON,NM");
+        area.set_radius(center, nm);
+    }
+    bool random_start = query_string(req, "random_start") == "1" || query_string(req, "random_start") == "true";
+
+    std::vector<const Aircraft*> fleet;
+    for (const auto& ac : cat.aircraft) {
+        if (name.empty() || ac.name == name) fleet.push_back(&ac);
+    }
+    if (fleet.empty()) return error_response(404, "unknown aircraft: " + name);
+
+    JsonWriter w;
+    w.begin_array();
+    for (const Aircraft* ac : fleet) {
+        auto routes = suggest_routes(*ac, cat.by_icao, cat.airports, *count, area, random_start, gen);
+        w.begin_object();
+        w.field("aircraft", ac->name);
+        w.field("role", ac->role);
+        w.field("range_nm", ac->range_nm, 0);
+        w.field("min_runway_ft", ac->min_runway_ft > 0 ? ac->min_runway_ft : role_min_runway(ac->role));
+        w.key("routes").begin_array();
+        for (const auto& r : routes) {
+            w.begin_object();
+            w.field("from", r.from_icao);
+            w.field("to", r.to_icao);
+            w.field("distance_nm", r.distance_nm, 0);
+            w.end_object();
+        }
+        w.end_array();
+        w.end_object();
+    }
+    w.end_array();
+    return {200, w.str()};
+}
+
+// GET /e6b/<mode>?... with the same argument names as the e6bTool README.
+static HttpResponse handle_e6b(ServerState&, const HttpRequest& req) {
+    std::string mode = req.path.substr(std::string("/e6b/").size());
+    std::vector<double> v;
+    auto need = [&](std::initializer_list<const char*> names) {
+        for (const char* n : names) {
+            auto d = query_double(req, n);
+            if (!d) return std::string(n);
+            v.push_back(*d);
+        }
+        return std::string();
+    };
+    JsonWriter w;
+    w.begin_object();
+    w.field("mode", mode);
+    std::string missing;
+    if (mode == "winds") {
+        if ((missing = need({"hdg", "tas", "wind_dir", "wind_spd"})).empty()) {
+            WindTriangle wt = wind_triangle(v[0], v[1], v[2], v[3]);
+            w.field("groundspeed_kt", wt.groundspeed_kt).field("track_deg", wt.track_deg).field("wca_deg", wt.wca_deg);
+        }
+    } else if (mode == "xwind") {
+        if ((missing = need({"wind_dir", "wind_spd", "runway"})).empty())
+            w.field("crosswind_kt", crosswind_component(v[0], v[1], v[2]));
+    } else if (mode == "headwind") {
+        if ((missing = need({"wind_dir", "wind_spd", "runway"})).empty())
+            w.field("headwind_kt", headwind_component(v[0], v[1], v[2]));
+    } else if (mode == "pressure_alt") {
+        if ((missing = need({"elev", "altimeter"})).empty())
+            w.field("pressure_alt_ft", pressure_altitude_ft(v[0], v[1]));
+    } else if (mode == "density_alt") {
+        if ((missing = need({"elev", "altimeter", "oat"})).empty()) {
+            double pa = pressure_altitude_ft(v[0], v[1]);
+            w.field("pressure_alt_ft", pa).field("density_alt_ft", density_altitude_ft(pa, v[2]));
+        }
+    } else if (mode == "mach") {
+        if ((missing = need({"tas", "oat"})).empty()) w.field("mach", mach_from_tas(v[0], v[1]), 3);
+    } else if (mode == "tas") {
+        if ((missing = need({"mach", "oat"})).empty()) w.field("tas_kt", tas_from_mach(v[0], v[1]));
+    } else if (mode == "tsd") {
+        if ((missing = need({"distance", "gs"})).empty()) w.field("time_min", (v[0] / v[1]) * 60.0);
+    } else if (mode == "fuel") {
+        if ((missing = need({"flow", "time"})).empty()) w.field("fuel_used", v[0] * v[1]);
+    } else if (mode == "drift") {
+        if ((missing = need({"wind_dir", "wind_spd", "tas", "track"})).empty())
+            w.field("drift_deg", drift_angle_deg(v[0], v[1], v[2], v[3]));
+    } else if (mode == "groundspeed") {
+        if ((missing = need({"tas", "wind_component"})).empty()) w.field("groundspeed_kt", v[0] + v[1]);
+    } else {
+        return error_response(404, "unknown e6b mode: " + mode);
+    }
+    if (!missing.empty()) return error_response(400, "missing or invalid parameter: " + missing);
+    w.end_object();
+    return {200, w.str()};
+}
+
+// POST /profile?climb=300&descent=250&samples=200 with route CSV (name,distance_nm,altitude_ft).
+static HttpResponse handle_profile(ServerState&, const HttpRequest& req) {
+    auto route = parse_route_csv(req.body);
+    if (route.size() < 2) return error_response(400, "route needs at least 2 waypoints");
+    double climb = query_double(req, "climb").value_or(300.0);
+    double descent = query_double(req, "descent").value_or(250.0);
+    auto samples = query_int(req, "samples", 200, 2, 10000);
+    if (!samples) return error_response(400, "samples must be a finite number");
+
+    double total_dist = route.back().distance_nm;
+    double cruise_alt = route.front().altitude_ft;
+    for (const auto& wp : route) cruise_alt = std::max(cruise_alt, wp.altitude_ft);
+    double toc = find_distance_to_alt(route.front().altitude_ft, cruise_alt, climb);
+    double tod_from_dest = find_distance_to_alt(route.back().altitude_ft, cruise_alt, descent);
+    auto profile = interpolate_profile(route, *samples);
+
+    JsonWriter w;
+    w.begin_object();
+    w.field("total_distance_nm", total_dist);
+    w.field("cruise_altitude_ft", cruise_alt, 0);
+    w.field("toc_nm", toc);
+    w.field("tod_from_dest_nm", tod_from_dest);
+    w.field("tod_at_nm", std::max(0.0, total_dist - tod_from_dest));
+    w.key("profile").begin_array();
+    for (size_t i = 0; i < profile.distances_nm.size(); ++i) {
+        w.begin_array().value(profile.distances_nm[i]).value(profile.altitudes_ft[i], 0).end_array();
+    }
+    w.end_array();
+    w.end_object();
+    return {200, w.str()};
+}
+
+// POST /ofp/summary with the SimBrief OFP XML as body.
+static HttpResponse handle_ofp(ServerState&, const HttpRequest& req) {
+    if (req.body.empty()) return error_response(400, "POST the OFP XML as the request body");
+    const std::string& content = req.body;
+    auto val = [&](std::vector<std::string> tags) { return tag_value(content, tags); };
+    auto fixes = parse_navlog_fixes(content);
+    JsonWriter w;
+    w.begin_object();
+    w.field("airline", val({"icao_airline"}));
+    w.field("flight_number", val({"flight_number", "plan_number", "callsign"}));
+    w.field("origin", val({"origin", "orig_icao", "icao_code"}));
+    w.field("destination", val({"destination", "dest", "dest_icao"}));
+    w.field("alternate", val({"alternate", "altn", "altn_icao", "altn_code"}));
+    w.field("route", val({"plan_rte", "atc_route", "route", "route_ifps"}));
+    w.field("cruise", val({"initial_altitude", "cruise_altitude", "cruise_fl"}));
+    w.field("airframe", val({"aircraft_icao", "aircraft_type"}));
+    w.field("distance_nm", val({"route_distance", "gc_distance", "distance"}));
+    w.field("ete", val({"ete", "enroute_time", "block_time"}));
+    w.field("takeoff_weight", val({"plan_takeoff", "takeoff_weight"}));
+    w.field("landing_weight", val({"plan_landing", "landing_weight"}));
+    w.field("zfw", val({"plan_zfw", "zfw", "estimated_zfw"}));
+    w.field("navlog_distance_nm", cumulative_distance(fixes), 0);
+    w.key("fixes").begin_array();
+    for (const auto& f : fixes) {
+        w.begin_object();
+        w.field("name", f.name);
+        w.field("lat", f.lat, 4);
+        w.field("lon", f.lon, 4);
+        w.field("altitude_ft", f.altitude_ft, 0);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    return {200, w.str()};
+}
+
+static HttpResponse handle_metrics(ServerState& st, const HttpRequest&) {
+    JsonWriter w;
+    w.begin_object();
+    w.field("uptime_s", std::chrono::duration<double>(std::chrono::steady_clock::now() - st.started).count(), 1);
+    w.key("metar_cache").begin_object();
+    w.field("hits", st.metar_cache.hits());
+    w.field("misses", st.metar_cache.misses());
+    w.end_object();
+    w.key("endpoints").begin_object();
+    for (const auto& [name, hist] : st.metrics) {
+        w.key(name);
+        hist.write_json(w);
+    }
+    w.end_object();
+    if (alloc_tracking_enabled()) {
+        w.key("alloc").begin_object();
+        for (int s = 0; s <= static_cast<int>(AllocStage::kCount); ++s) {
+            bool total = s == static_cast<int>(AllocStage::kCount);
+            AllocCounters c = total ? alloc_counters_total() : alloc_counters(static_cast<AllocStage>(s));
+            w.key(total ? "total" : alloc_stage_name(static_cast<AllocStage>(s))).begin_object();
+            w.field("allocs", static_cast<unsigned long long>(c.allocs));
+            w.field("bytes", static_cast<unsigned long long>(c.bytes));
+            w.field("frees", static_cast<unsigned long long>(c.frees));
+            w.field("peak_live_bytes", static_cast<long long>(c.peak_live_bytes));
+            w.end_object();
+        }
+        w.end_object();
+    }
+    w.end_object();
+    return {200, w.str()};
+}
+
+static HttpResponse handle_health(ServerState& st, const HttpRequest&) {
+    JsonWriter w;
+    w.begin_object();
+    w.field("status", "ok");
+    w.field("airports", static_cast<int>(st.catalog.airports.size()));
+    w.field("aircraft", static_cast<int>(st.catalog.aircraft.size()));
+    w.end_object();
+    return {200, w.str()};
+}
+
+struct Route {
+    std::string prefix; // exact path, or prefix when it ends with '/'
+    std::string metric;
+    std::vector<std::string> methods;
+    HttpResponse (*handler)(ServerState&, const HttpRequest&);
+};
+
+static const std::vector<Route>& routes() {
+    static const std::vector<Route> table = {
+        {"/health", "health", {"GET"}, handle_health},
+        {"/metrics", "metrics", {"GET"}, handle_metrics},
+        {"/metar/decode", "metar", {"GET", "POST"}, handle_metar},
+        {"/notam/score", "notam", {"POST"}, handle_notam},
+        {"/routes/suggest", "routes", {"GET"}, handle_routes},
+        {"/e6b/", "e6b", {"GET"}, handle_e6b},
+        {"/profile", "profile", {"POST"}, handle_profile},
+        {"/ofp/summary", "ofp", {"POST"}, handle_ofp},
+    };
+    return table;
+}
+
+static HttpResponse dispatch(ServerState& st, const HttpRequest& req) {
+    auto start = std::chrono::steady_clock::now();
+    const Route* match = nullptr;
+    for (const auto& r : routes()) {
+        bool is_prefix = r.prefix.back() == '/';
+        if ((is_prefix && req.path.rfind(r.prefix, 0) == 0) || req.path == r.prefix) {
+            match = &r;
+            break;
+        }
+    }
+    if (!match) return error_response(404, "no such endpoint: " + req.path);
+    HttpResponse resp;
+    if (std::find(match->methods.begin(), match->methods.end(), req.method) == match->methods.end()) {
+        resp = error_response(405, "method not allowed");
+    } else {
+        try {
+            resp = match->handler(st, req);
+        } catch (const std::exception& e) {
+            resp = error_response(400, e.what());
+        }
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    st.metrics.at(match->metric).record(micros, resp.status >= 400);
+    return resp;
+}
+
+// ---------------------------------------------------------------------------
+// Worker pool + epoll event loop.
+// ---------------------------------------------------------------------------
+
+struct Job {
+    int fd = -1;
+    unsigned long long conn_id = 0;
+    HttpRequest request;
+};
+
+struct Completion {
+    int fd = -1;
+    unsigned long long conn_id = 0;
+    std::string wire;
+    bool keep_alive = true;
+};
+
+class WorkerPool {
+public:
+    WorkerPool(ServerState& st, int threads, int notify_fd) : st_(st), notify_fd_(notify_fd) {
+        for (int i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            jobs_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+    }
+
+    std::vector<Completion> drain() {
+        std::lock_guard<std::mutex> lock(done_mu_);
+        std::vector<Completion> out;
+        out.swap(done_);
+        return out;
+    }
+
+private:
+    void run(int index) {
+        trace_set_thread_name("worker " + std::to_string(index));
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                if (stop_ && jobs_.empty()) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            HttpResponse resp;
+            {
+                AllocStageScope stage(AllocStage::kAnalyze);
+                TraceSpan span("dispatch", "server", job.request.path);
+                resp = dispatch(st_, job.request);
+            }
+            AllocStageScope stage(AllocStage::kOutput);
+            TraceSpan span("serialize", "server");
+            Completion c{job.fd, job.conn_id, serialize_response(resp, job.request.keep_alive),
+                         job.request.keep_alive};
+            span.end();
+            {
+                std::lock_guard<std::mutex> lock(done_mu_);
+                done_.push_back(std::move(c));
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(notify_fd_, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    ServerState& st_;
+    int notify_fd_;
+    std::vector<std::thread> workers_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    bool stop_ = false;
+    std::mutex done_mu_;
+    std::vector<Completion> done_;
+};
+
+struct Connection {
+    unsigned long long id = 0;
+    std::string in;
+    std::string out;
+    size_t out_pos = 0;
+    bool busy = false;      // a request is with the workers; responses stay in order
+    bool keep_alive = true;
+    bool want_write = false;
+    bool read_closed = false; // peer sent EOF; no longer polled for input
+};
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void on_signal(int) { g_stop = 1; }
+
+class EventLoop {
+public:
+    EventLoop(ServerState& st, int listen_fd, int threads)
+        : listen_fd_(listen_fd), notify_fd_(eventfd(0, EFD_NONBLOCK)), epoll_fd_(epoll_create1(0)),
+          pool_(st, threads, notify_fd_) {
+        add(listen_fd_, EPOLLIN);
+        add(notify_fd_, EPOLLIN);
+    }
+
+    ~EventLoop() {
+        for (auto& [fd, conn] : conns_) close(fd);
+        close(epoll_fd_);
+        close(notify_fd_);
+    }
+
+    void run() {
+        std::vector<epoll_event> events(256);
+        while (!g_stop) {
+            int n = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), 500);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::perror("epoll_wait");
+                return;
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                uint32_t ev = events[i].events;
+                if (fd == listen_fd_) {
+                    accept_all();
+                } else if (fd == notify_fd_) {
+                    uint64_t count;
+                    while (read(notify_fd_, &count, sizeof(count)) > 0) {
+                    }
+                    for (auto& c : pool_.drain()) complete(std::move(c));
+                } else {
+                    if (ev & (EPOLLERR | EPOLLHUP)) {
+                        drop(fd);
+                        continue;
+                    }
+                    if (ev & EPOLLIN) on_readable(fd);
+                    if ((ev & EPOLLOUT) && conns_.count(fd)) flush(fd);
+                }
+            }
+        }
+    }
+
+private:
+    void add(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void modify(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+
+    // Level-triggered EPOLLIN stays ready after EOF, so a closed read side is not polled.
+    void watch(int fd, const Connection& c) {
+        modify(fd, (c.read_closed ? 0u : static_cast<uint32_t>(EPOLLIN)) | (c.want_write ? EPOLLOUT : 0u));
+    }
+
+    void accept_all() {
+        while (true) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            Connection c;
+            c.id = ++next_id_;
+            conns_[fd] = std::move(c);
+            add(fd, EPOLLIN);
+        }
+    }
+
+    void drop(int fd) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns_.erase(fd);
+    }
+
+    void on_readable(int fd) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end()) return;
+        char buf[16384];
+        while (true) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n > 0) {
+                if (it->second.in.size() + static_cast<size_t>(n) > kMaxBufferedBytes) {
+                    drop(fd);
+                    return;
+                }
+                it->second.in.append(buf, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0) {
+                // Peer closed; still answer an in-flight request if one is pending.
+                if (!it->second.busy) {
+                    drop(fd);
+                } else {
+                    it->second.keep_alive = false;
+                    it->second.read_closed = true;
+                    watch(fd, it->second);
+                }
+                return;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            drop(fd);
+            return;
+        }
+        try_dispatch(fd);
+    }
+
+    void try_dispatch(int fd) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end() || it->second.busy) return;
+        Connection& c = it->second;
+        HttpRequest req;
+        ParseResult pr;
+        {
+            AllocStageScope stage(AllocStage::kParse);
+            TraceSpan span("parse_request", "server");
+            pr = parse_http_request(c.in, req);
+        }
+        if (pr == ParseResult::kIncomplete) return;
+        if (pr != ParseResult::kComplete) {
+            HttpResponse r = error_response(pr == ParseResult::kTooLarge ? 413 : 400, "malformed request");
+            c.keep_alive = false;
+            c.out = serialize_response(r, false);
+            c.out_pos = 0;
+            c.busy = true;
+            flush(fd);
+            return;
+        }
+        c.busy = true;
+        c.keep_alive = c.keep_alive && req.keep_alive;
+        pool_.submit(Job{fd, c.id, std::move(req)});
+    }
+
+    void complete(Completion c) {
+        auto it = conns_.find(c.fd);
+        if (it == conns_.end() || it->second.id != c.conn_id) return; // connection went away
+        Connection& conn = it->second;
+        conn.out = std::move(c.wire);
+        conn.out_pos = 0;
+        conn.keep_alive = conn.keep_alive && c.keep_alive;
+        flush(c.fd);
+    }
+
+    void flush(int fd) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end()) return;
+        Connection& c = it->second;
+        while (c.out_pos < c.out.size()) {
+            ssize_t n = send(fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.out_pos += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!c.want_write) {
+                    c.want_write = true;
+                    watch(fd, c);
+                }
+                return;
+            }
+            drop(fd);
+            return;
+        }
+        if (c.want_write) {
+            c.want_write = false;
+            watch(fd, c);
+        }
+        c.out.clear();
+        c.out_pos = 0;
+        c.busy = false;
+        if (!c.keep_alive) {
+            drop(fd);
+            return;
+        }
+        try_dispatch(fd); // pipelined request already buffered
+    }
+
+    int listen_fd_;
+    int notify_fd_;
+    int epoll_fd_;
+    WorkerPool pool_;
+    std::unordered_map<int, Connection> conns_;
+    unsigned long long next_id_ = 0;
+};
+
+static int open_listener(const std::string& host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 1024) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog
+              << " [--host 127.0.0.1] [--port 8787] [--threads N] "
+                 "[--airports ../flightIdeas/airports.csv] [--aircraft ../flightIdeas/aircraft.csv] [--alloc-stats] [--trace out.json]\n";
+}
+
+int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
+    std::string host = "127.0.0.1";
+    int port = 8787;
+    int threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    std::string airports_path = "../flightIdeas/airports.csv";
+    std::string aircraft_path = "../flightIdeas/aircraft.csv";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            host = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--airports" && i + 1 < argc) {
+            airports_path = argv[++i];
+        } else if (arg == "--aircraft" && i + 1 < argc) {
+            aircraft_path = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    enter_stage(AllocStage::kParse);
+    ServerState st;
+    st.catalog.airports = load_airports(airports_path);
+    st.catalog.by_icao = index_by_icao(st.catalog.airports);
+    st.catalog.aircraft = load_aircraft(aircraft_path);
+    for (const auto& r : routes()) st.metrics[r.metric];
+    enter_stage(AllocStage::kOther);
+
+    int listen_fd = open_listener(host, port);
+    if (listen_fd < 0) {
+        std::cerr << "Failed to listen on " << host << ":" << port << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "flightsuite-server listening on http://" << host << ":" << port << " (" << threads
+              << " workers, " << st.catalog.airports.size() << " airports, " << st.catalog.aircraft.size()
+              << " aircraft)\n";
+    {
+        EventLoop loop(st, listen_fd, threads);
+        loop.run();
+    }
+    close(listen_fd);
+    std::cout << "Shutting down.\n";
+    return 0;
+}
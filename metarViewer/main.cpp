@@ -1,23 +1,28 @@
+// Aviation weather decoder: decodes raw or fetched METARs, checks them against personal minima,
+// and summarizes trends across reports.
 #include <algorithm>
 #include <cmath>
-#include <cctype>
 #include <cstdio>
 #include <ctime>
 #include <iostream>
-#include <map>
 #include <optional>
-#include <regex>
-#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-constexpr double kPi = 3.14159265358979323846;
+#include "core/alloc_stats.hpp"
+#include "core/cassette.hpp"
+#include "core/compress.hpp"
+#include "core/density.hpp"
+#include "core/fetch.hpp"
+#include "core/grid.hpp"
+#include "core/metar.hpp"
+#include "core/ofp.hpp"
+#include "core/spatial.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
 
-struct WindInfo {
-    std::optional<int> direction_deg; // std::nullopt for VRB
-    int speed_kt = 0;
-    std::optional<int> gust_kt;
-};
+using namespace flightsuite;
 
 struct Minima {
     double min_ceiling_ft = 1000.0;
@@ -25,271 +30,6 @@ struct Minima {
     double max_crosswind_kt = 15.0;
 };
 
-struct MetarDecoded {
-    std::string station;
-    std::string timestamp_z;
-    WindInfo wind;
-    std::optional<double> visibility_sm;
-    std::optional<int> ceiling_ft;
-    std::string ceiling_layer;
-    std::vector<std::string> weather;
-};
-
-struct WindComponents {
-    double headwind = 0.0;
-    double crosswind = 0.0;
-};
-
-static std::string trim(const std::string& s) {
-    size_t start = 0;
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
-    size_t end = s.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
-    return s.substr(start, end - start);
-}
-
-static std::vector<std::string> split_tokens(const std::string& s) {
-    std::istringstream iss(s);
-    std::vector<std::string> tokens;
-    std::string tok;
-    while (iss >> tok) {
-        tokens.push_back(tok);
-    }
-    return tokens;
-}
-
-static bool is_number(const std::string& s) {
-    return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
-}
-
-static std::string to_upper(const std::string& s) {
-    std::string out = s;
-    std::transform(out.begin(), out.end(), out.begin(), ::toupper);
-    return out;
-}
-
-static std::optional<std::string> fetch_url(const std::string& url) {
-    std::string cmd = "curl -s --max-time 5 \"" + url + "\"";
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) return std::nullopt;
-    std::string output;
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        output += buffer;
-    }
-    pclose(pipe);
-    if (output.empty()) return std::nullopt;
-    return output;
-}
-
-static std::optional<std::string> fetch_metar_by_icao(const std::string& icao_raw) {
-    if (icao_raw.size() < 3) return std::nullopt;
-    std::string icao = to_upper(icao_raw);
-    auto output = fetch_url("https://tgftp.nws.noaa.gov/data/observations/metar/stations/" + icao +
-                            ".TXT");
-    if (!output) return std::nullopt;
-
-    std::istringstream iss(*output);
-    std::string line;
-    std::string last_non_empty;
-    while (std::getline(iss, line)) {
-        line = trim(line);
-        if (!line.empty()) last_non_empty = line;
-    }
-    if (!last_non_empty.empty()) {
-        return last_non_empty;
-    }
-    return std::nullopt;
-}
-
-static std::vector<std::string> fetch_cycle_metars_for_hour(const std::string& icao,
-                                                            int hour_utc) {
-    std::vector<std::string> results;
-    char hour_buf[8];
-    std::snprintf(hour_buf, sizeof(hour_buf), "%02d", hour_utc);
-    std::string url =
-        "https://tgftp.nws.noaa.gov/data/observations/metar/cycles/" + std::string(hour_buf) +
-        "Z.TXT";
-    auto content = fetch_url(url);
-    if (!content) return results;
-    std::istringstream iss(*content);
-    std::string line;
-    std::string target = to_upper(icao);
-    while (std::getline(iss, line)) {
-        line = trim(line);
-        if (line.rfind(target + " ", 0) == 0) {
-            results.push_back(line);
-        }
-    }
-    return results;
-}
-
-static std::vector<std::string> fetch_metars_history(const std::string& icao, int desired_count) {
-    std::vector<std::string> collected;
-    std::time_t now = std::time(nullptr);
-    const int max_hours = 48; // limit fetch window
-    for (int back = 0; back < max_hours && (int)collected.size() < desired_count; ++back) {
-        std::time_t t = now - back * 3600;
-        std::tm* gmt = std::gmtime(&t);
-        if (!gmt) break;
-        int hour = gmt->tm_hour;
-        auto hour_metars = fetch_cycle_metars_for_hour(icao, hour);
-        for (const auto& m : hour_metars) {
-            if ((int)collected.size() >= desired_count) break;
-            // Avoid duplicates
-            if (std::find(collected.begin(), collected.end(), m) == collected.end()) {
-                collected.push_back(m);
-            }
-        }
-    }
-    // Data collected newest-first due to hour loop; reverse to oldest-first for trend logic
-    std::reverse(collected.begin(), collected.end());
-    return collected;
-}
-
-static std::optional<double> parse_fraction(const std::string& token) {
-    auto slash_pos = token.find('/');
-    if (slash_pos == std::string::npos) {
-        return std::nullopt;
-    }
-    std::string num_str = token.substr(0, slash_pos);
-    std::string den_str = token.substr(slash_pos + 1);
-    if (!is_number(num_str) || !is_number(den_str)) {
-        return std::nullopt;
-    }
-    double num = std::stod(num_str);
-    double den = std::stod(den_str);
-    if (den == 0) {
-        return std::nullopt;
-    }
-    return num / den;
-}
-
-// Handles "10SM", "1/2SM", "1 1/2SM"
-static std::optional<double> parse_visibility_sm(const std::vector<std::string>& tokens) {
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        const std::string& tok = tokens[i];
-        auto sm_pos = tok.find("SM");
-        if (sm_pos == std::string::npos) {
-            continue;
-        }
-        std::string value_part = tok.substr(0, sm_pos);
-        double total = 0.0;
-        if (!value_part.empty()) {
-            if (auto frac = parse_fraction(value_part)) {
-                total += *frac;
-            } else if (is_number(value_part)) {
-                total += std::stod(value_part);
-            }
-        }
-        // Support a leading whole number token (e.g., "1 1/2SM")
-        if (i > 0 && is_number(tokens[i - 1])) {
-            total += std::stod(tokens[i - 1]);
-        }
-        if (total > 0.0) {
-            return total;
-        }
-    }
-    return std::nullopt;
-}
-
-static WindInfo parse_wind(const std::vector<std::string>& tokens) {
-    std::regex wind_re(R"((\d{3}|VRB)(\d{2,3})(G(\d{2,3}))?KT)");
-    for (const auto& tok : tokens) {
-        std::smatch m;
-        if (std::regex_match(tok, m, wind_re)) {
-            WindInfo w;
-            if (m[1] != "VRB") {
-                w.direction_deg = std::stoi(m[1]);
-            }
-            w.speed_kt = std::stoi(m[2]);
-            if (m[4].matched) {
-                w.gust_kt = std::stoi(m[4]);
-            }
-            return w;
-        }
-    }
-    return {};
-}
-
-static std::optional<int> parse_ceiling_ft(const std::vector<std::string>& tokens, std::string& layer_out) {
-    std::optional<int> ceiling_ft;
-    for (const auto& tok : tokens) {
-        if (tok.rfind("OVC", 0) == 0 || tok.rfind("BKN", 0) == 0 || tok.rfind("VV", 0) == 0) {
-            int start = tok.rfind("VV", 0) == 0 ? 2 : 3;
-            std::string height_str = tok.substr(start, 3);
-            if (is_number(height_str)) {
-                int height = std::stoi(height_str) * 100;
-                if (!ceiling_ft || height < *ceiling_ft) {
-                    ceiling_ft = height;
-                    layer_out = tok.substr(0, 3);
-                }
-            }
-        }
-    }
-    return ceiling_ft;
-}
-
-static std::vector<std::string> parse_weather(const std::vector<std::string>& tokens) {
-    // Simple decoder; looks for common codes inside tokens.
-    static const std::map<std::string, std::string> wx_map = {
-        {"TS", "thunderstorm"}, {"RA", "rain"},  {"DZ", "drizzle"},
-        {"SN", "snow"},         {"SG", "snow grains"}, {"PL", "ice pellets"},
-        {"FG", "fog"},          {"BR", "mist"}, {"HZ", "haze"},
-        {"FU", "smoke"},        {"SH", "showers"}
-    };
-    std::vector<std::string> found;
-    for (const auto& tok : tokens) {
-        for (const auto& [code, desc] : wx_map) {
-            if (tok.find(code) != std::string::npos) {
-                if (std::find(found.begin(), found.end(), desc) == found.end()) {
-                    found.push_back(desc);
-                }
-            }
-        }
-    }
-    return found;
-}
-
-static std::optional<WindComponents> compute_wind_components(const WindInfo& wind, int runway_heading_deg) {
-    if (!wind.direction_deg || runway_heading_deg == 0) return std::nullopt;
-    double angle_diff_rad = std::fabs(*wind.direction_deg - runway_heading_deg) * kPi / 180.0;
-    if (angle_diff_rad > kPi) angle_diff_rad = 2 * kPi - angle_diff_rad;
-    double headwind = std::cos(angle_diff_rad) * wind.speed_kt;
-    double crosswind = std::sin(angle_diff_rad) * wind.speed_kt;
-    return WindComponents{headwind, crosswind};
-}
-
-static MetarDecoded decode_metar(const std::string& raw) {
-    MetarDecoded m;
-    auto tokens_raw = split_tokens(raw);
-    std::vector<std::string> tokens;
-    tokens.reserve(tokens_raw.size());
-    for (auto t : tokens_raw) {
-        std::transform(t.begin(), t.end(), t.begin(), ::toupper);
-        tokens.push_back(std::move(t));
-    }
-    if (!tokens.empty()) {
-        m.station = tokens[0];
-    }
-    if (tokens.size() > 1 && tokens[1].size() >= 5 && tokens[1].back() == 'Z') {
-        m.timestamp_z = tokens[1];
-    }
-    m.wind = parse_wind(tokens);
-    m.visibility_sm = parse_visibility_sm(tokens);
-    m.ceiling_ft = parse_ceiling_ft(tokens, m.ceiling_layer);
-    m.weather = parse_weather(tokens);
-    return m;
-}
-
-static std::string format_double(double v, int precision = 1) {
-    std::ostringstream oss;
-    oss.setf(std::ios::fixed, std::ios::floatfield);
-    oss.precision(precision);
-    oss << v;
-    return oss.str();
-}
-
 static void analyze_wind(const WindInfo& wind, int runway_heading_deg, const Minima& minima) {
     std::cout << "- Wind: ";
     if (!wind.direction_deg) {
@@ -317,11 +57,16 @@ static void analyze_wind(const WindInfo& wind, int runway_heading_deg, const Min
     }
 }
 
-static void analyze_metar(const std::string& raw_metar, const MetarDecoded& m, const Minima& minima,
-                          int runway_heading_deg) {
+static void analyze_metar(const MetarDecoded& m, const Minima& minima, int runway_heading_deg) {
     std::cout << "Station: " << (m.station.empty() ? "N/A" : m.station);
     if (!m.timestamp_z.empty()) {
         std::cout << " @ " << m.timestamp_z;
+        if (m.obs_time) {
+            std::time_t t = static_cast<std::time_t>(*m.obs_time);
+            char buf[32];
+            std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%MZ", std::gmtime(&t));
+            std::cout << " (" << buf << ")";
+        }
     }
     std::cout << "\n";
 
@@ -330,6 +75,11 @@ static void analyze_metar(const std::string& raw_metar, const MetarDecoded& m, c
     std::cout << "- Visibility: ";
     if (m.visibility_sm) {
         std::cout << format_double(*m.visibility_sm) << " SM";
+        if (m.cavok) {
+            std::cout << " [CAVOK]";
+        } else if (m.visibility_m) {
+            std::cout << " [" << *m.visibility_m << " m]";
+        }
         if (*m.visibility_sm < minima.min_visibility_sm) {
             std::cout << " (BELOW " << minima.min_visibility_sm << " SM)";
         } else {
@@ -350,7 +100,31 @@ static void analyze_metar(const std::string& raw_metar, const MetarDecoded& m, c
         }
         std::cout << "\n";
     } else {
-        std::cout << "No ceiling reported\n";
+        std::cout << (m.no_significant_cloud ? "None (no significant cloud)\n" : "No ceiling reported\n");
+    }
+
+    for (const auto& r : m.rvr) {
+        std::cout << "- RVR " << r.runway << ": " << (r.qualifier == 'P' ? ">" : r.qualifier == 'M' ? "<" : "")
+                  << r.range_ft;
+        if (r.max_range_ft) std::cout << "-" << *r.max_range_ft;
+        std::cout << " ft";
+        if (r.trend == 'U') std::cout << " (rising)";
+        if (r.trend == 'D') std::cout << " (falling)";
+        std::cout << "\n";
+    }
+
+    if (m.temperature_c) {
+        std::cout << "- Temp/Dew: " << *m.temperature_c << "C";
+        if (m.dewpoint_c) {
+            int spread = *m.temperature_c - *m.dewpoint_c;
+            std::cout << " / " << *m.dewpoint_c << "C (spread " << spread << "C"
+                      << (spread <= 2 ? ", fog/low cloud risk" : "") << ")";
+        }
+        std::cout << "\n";
+    }
+    if (m.altimeter_inhg && m.altimeter_hpa) {
+        std::cout << "- Altimeter: " << format_double(*m.altimeter_inhg, 2) << " inHg / "
+                  << format_double(*m.altimeter_hpa, 0) << " hPa\n";
     }
 
     std::cout << "- Weather: ";
@@ -397,13 +171,291 @@ static void print_trend_text(const std::vector<MetarDecoded>& mets) {
     }
 }
 
+// Batch modes that work on a whole cycle file: --da-batch, --corridor and --grid.
+struct CycleBatchOptions {
+    std::string cycle_file;
+    int cycle_hour = -1;
+    std::string airports_path = "../flightIdeas/airports.csv";
+    double threshold_ft = 5000.0;
+    size_t top = 20;
+    std::vector<std::string> corridor_ofps;
+    double corridor_nm = 50.0;
+    std::string grid_field; // "ceiling" or "visibility"
+    GridSpec grid;
+    IdwOptions idw;
+    std::string grid_out;
+    size_t map_width = 100;
+    bool ascii = false;
+};
+
+// Streams (plain or compressed) or fetches the cycle file, decoding every report in it against the
+// current time.
+static bool load_cycle_reports(const CycleBatchOptions& opt, std::vector<MetarDecoded>& decoded) {
+    std::time_t now = cassette_now();
+    if (!opt.cycle_file.empty()) {
+        // Decoded as each chunk of the file decodes; no report text is kept.
+        enter_stage(AllocStage::kParse);
+        if (!for_each_cycle_report(opt.cycle_file, [&](std::string_view raw) {
+                decoded.push_back(decode_metar(std::string(raw), now));
+            })) {
+            std::cerr << "Failed to read cycle file: " << opt.cycle_file << "\n";
+            return false;
+        }
+        return true;
+    }
+    enter_stage(AllocStage::kFetch);
+    auto text = fetch_cycle_file(opt.cycle_hour);
+    if (!text) {
+        std::cerr << "Failed to fetch the " << opt.cycle_hour << "Z cycle file\n";
+        return false;
+    }
+    enter_stage(AllocStage::kParse);
+    auto raws = cycle_file_reports(*text);
+    TraceSpan span("decode_metars", "metar", [&] { return std::to_string(raws.size()) + " reports"; });
+    decoded.reserve(raws.size());
+    for (const auto& raw : raws) decoded.push_back(decode_metar(raw, now));
+    return true;
+}
+
+// Density altitude for every station in one cycle file, flagging those at or above the threshold.
+static int run_da_batch(const CycleBatchOptions& opt) {
+    std::vector<MetarDecoded> decoded;
+    if (!load_cycle_reports(opt, decoded)) return 1;
+    auto airports = load_airports(opt.airports_path);
+    if (airports.empty()) return 1;
+    auto by_icao = index_by_icao(airports);
+
+    enter_stage(AllocStage::kAnalyze);
+    ObsJoinStats stats;
+    StationObsColumns obs = join_station_obs(decoded, by_icao, &stats);
+    DensityColumns dens;
+    compute_density_altitudes(obs, dens);
+    constexpr int kClasses = static_cast<int>(AirframeClass::kCount);
+    std::vector<double> factors[kClasses];
+    for (int c = 0; c < kClasses; ++c) {
+        takeoff_distance_factors(static_cast<AirframeClass>(c), dens.density_alt_ft, factors[c]);
+    }
+    std::vector<size_t> flagged;
+    for (size_t i = 0; i < obs.size(); ++i) {
+        if (dens.density_alt_ft[i] >= opt.threshold_ft) flagged.push_back(i);
+    }
+    std::sort(flagged.begin(), flagged.end(),
+              [&](size_t a, size_t b) { return dens.density_alt_ft[a] > dens.density_alt_ft[b]; });
+
+    enter_stage(AllocStage::kOutput);
+    std::cout << "=== Density altitude batch ===\n"
+              << stats.reports << " reports, " << stats.stations << " stations computed ("
+              << stats.missing_obs << " reports lacked temp/altimeter, " << stats.missing_elevation
+              << " had no catalog elevation)\n"
+              << flagged.size() << " stations at or above DA " << format_double(opt.threshold_ft, 0) << " ft";
+    if (opt.top && flagged.size() > opt.top) std::cout << " (top " << opt.top << " shown)";
+    std::cout << "\n\n";
+    if (flagged.empty()) return 0;
+    std::printf("%-6s %-8s %7s %5s %7s %8s %8s", "ICAO", "Time", "Elev", "OAT", "Altim", "PA", "DA");
+    for (int c = 0; c < kClasses; ++c) std::printf(" %13s", airframe_class_name(static_cast<AirframeClass>(c)));
+    std::printf("\n");
+    size_t shown = opt.top ? std::min(opt.top, flagged.size()) : flagged.size();
+    for (size_t k = 0; k < shown; ++k) {
+        size_t i = flagged[k];
+        std::printf("%-6s %-8s %7.0f %5.0f %7.2f %8.0f %8.0f", obs.station[i].c_str(), obs.time_z[i].c_str(),
+                    obs.elevation_ft[i], obs.temperature_c[i], obs.altimeter_inhg[i], dens.pressure_alt_ft[i],
+                    dens.density_alt_ft[i]);
+        for (int c = 0; c < kClasses; ++c) std::printf(" %12.2fx", factors[c][i]);
+        std::printf("\n");
+    }
+    return 0;
+}
+
+// One line of conditions for the corridor table.
+static std::string conditions_summary(const MetarDecoded& m) {
+    std::string out;
+    if (m.wind.direction_deg) {
+        char dir[8];
+        std::snprintf(dir, sizeof(dir), "%03d", *m.wind.direction_deg);
+        out += std::string(dir) + "@" + std::to_string(m.wind.speed_kt);
+    } else {
+        out += "VRB" + std::to_string(m.wind.speed_kt);
+    }
+    if (m.wind.gust_kt) out += "G" + std::to_string(*m.wind.gust_kt);
+    out += "kt";
+    if (m.visibility_sm) out += " vis " + format_double(*m.visibility_sm) + "SM";
+    if (m.ceiling_ft) {
+        out += " " + m.ceiling_layer + " " + std::to_string(*m.ceiling_ft) + "ft";
+    } else if (m.cavok) {
+        out += " CAVOK";
+    }
+    if (m.temperature_c) out += " " + std::to_string(*m.temperature_c) + "C";
+    for (const auto& wx : m.weather) out += " " + wx;
+    return out;
+}
+
+// Latest report per station that the catalog can place, as index points; `report_of[id]` is the
+// report's position in `decoded`.
+static void latest_station_points(const std::vector<MetarDecoded>& decoded,
+                                  const std::unordered_map<std::string, Airport>& by_icao,
+                                  std::vector<GeoPoint>& points, std::vector<size_t>& report_of) {
+    std::unordered_map<std::string, size_t> latest;
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        const auto& m = decoded[i];
+        if (by_icao.find(m.station) == by_icao.end()) continue;
+        auto [it, inserted] = latest.emplace(m.station, i);
+        if (!inserted && m.obs_time.value_or(0) > decoded[it->second].obs_time.value_or(0)) it->second = i;
+    }
+    points.clear();
+    report_of.clear();
+    points.reserve(latest.size());
+    report_of.reserve(latest.size());
+    for (const auto& [icao, idx] : latest) {
+        const Airport& a = by_icao.at(icao);
+        points.push_back({a.lat, a.lon});
+        report_of.push_back(idx);
+    }
+}
+
+// Nearest reporting station to every navlog fix of each OFP, grouped into legs that share a station.
+static int run_corridor(const CycleBatchOptions& opt) {
+    std::vector<MetarDecoded> decoded;
+    if (!load_cycle_reports(opt, decoded)) return 1;
+    auto airports = load_airports(opt.airports_path);
+    if (airports.empty()) return 1;
+    auto by_icao = index_by_icao(airports);
+
+    enter_stage(AllocStage::kAnalyze);
+    std::vector<GeoPoint> points;
+    std::vector<size_t> report_of; // point id -> index into decoded
+    latest_station_points(decoded, by_icao, points, report_of);
+    SpatialIndex index(points);
+
+    std::vector<GeoPoint> queries;
+    std::vector<std::vector<SpatialHit>> hits;
+    for (const auto& path : opt.corridor_ofps) {
+        enter_stage(AllocStage::kParse);
+        auto content = read_file(path);
+        if (!content) {
+            std::cerr << "Failed to read OFP: " << path << "\n";
+            continue;
+        }
+        auto fixes = parse_navlog_fixes(*content);
+
+        enter_stage(AllocStage::kAnalyze);
+        queries.clear();
+        for (const auto& f : fixes) queries.push_back({f.lat, f.lon});
+        index.nearest_batch(queries, 1, opt.corridor_nm, hits);
+
+        enter_stage(AllocStage::kOutput);
+        std::cout << "=== Corridor weather: " << path << " (" << fixes.size() << " fixes, "
+                  << format_double(opt.corridor_nm, 0) << " nm corridor) ===\n";
+        // Consecutive fixes served by the same station (or by none) form one leg.
+        for (size_t i = 0; i < fixes.size();) {
+            long station = hits[i].empty() ? -1 : static_cast<long>(hits[i][0].id);
+            size_t j = i + 1;
+            double max_nm = hits[i].empty() ? 0.0 : hits[i][0].distance_nm;
+            while (j < fixes.size() && (hits[j].empty() ? -1 : static_cast<long>(hits[j][0].id)) == station) {
+                if (!hits[j].empty()) max_nm = std::max(max_nm, hits[j][0].distance_nm);
+                ++j;
+            }
+            std::cout << "- " << fixes[i].name;
+            if (j - i > 1) std::cout << ".." << fixes[j - 1].name;
+            if (station < 0) {
+                std::cout << ": no report within " << format_double(opt.corridor_nm, 0) << " nm\n";
+            } else {
+                const MetarDecoded& m = decoded[report_of[static_cast<size_t>(station)]];
+                std::cout << ": " << m.station << " " << m.timestamp_z << " (<= " << format_double(max_nm, 0)
+                          << " nm) " << conditions_summary(m) << "\n";
+            }
+            i = j;
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+// Values at or above these caps render blank; no BKN/OVC/VV layer counts as the ceiling cap.
+constexpr double kGridCeilingCapFt = 12000.0;
+constexpr double kGridVisibilityCapSm = 10.0;
+
+// Interpolates ceiling or visibility from every placed station onto a lat/lon grid and renders it
+// as a heat map (worst conditions darkest), optionally exporting the raw grid.
+static int run_grid(const CycleBatchOptions& opt) {
+    bool ceiling = opt.grid_field == "ceiling";
+    std::vector<MetarDecoded> decoded;
+    if (!load_cycle_reports(opt, decoded)) return 1;
+    auto airports = load_airports(opt.airports_path);
+    if (airports.empty()) return 1;
+    auto by_icao = index_by_icao(airports);
+
+    enter_stage(AllocStage::kAnalyze);
+    std::vector<GeoPoint> all_points;
+    std::vector<size_t> report_of;
+    latest_station_points(decoded, by_icao, all_points, report_of);
+    std::vector<GeoPoint> points;
+    std::vector<double> values;
+    points.reserve(all_points.size());
+    values.reserve(all_points.size());
+    for (size_t id = 0; id < all_points.size(); ++id) {
+        const MetarDecoded& m = decoded[report_of[id]];
+        if (ceiling) {
+            values.push_back(m.ceiling_ft ? std::min<double>(*m.ceiling_ft, kGridCeilingCapFt) : kGridCeilingCapFt);
+        } else if (m.visibility_sm) {
+            values.push_back(std::min(*m.visibility_sm, kGridVisibilityCapSm));
+        } else {
+            continue;
+        }
+        points.push_back(all_points[id]);
+    }
+    SpatialIndex index(points);
+    GridField field = idw_grid(index, values, opt.grid, opt.idw);
+
+    enter_stage(AllocStage::kOutput);
+    const GridSpec& g = opt.grid;
+    std::cout << "=== " << (ceiling ? "Ceiling" : "Visibility") << " analysis: " << points.size()
+              << " stations, " << g.rows() << "x" << g.cols() << " grid at " << format_double(g.step_deg, 2)
+              << " deg (" << format_double(g.lat_min, 1) << ".." << format_double(g.lat_max, 1) << "N, "
+              << format_double(g.lon_min, 1) << ".." << format_double(g.lon_max, 1) << "E), k=" << opt.idw.k
+              << " within " << format_double(opt.idw.max_nm, 0) << " nm ===\n";
+    if (ceiling) {
+        std::cout << "Shading: darkest below 500 ft, blank at " << format_double(kGridCeilingCapFt, 0)
+                  << " ft or no ceiling; '?' no station in reach\n\n";
+        render_grid_map(std::cout, field, 500.0, kGridCeilingCapFt, opt.map_width, !opt.ascii);
+    } else {
+        std::cout << "Shading: darkest below 1 SM, blank at " << format_double(kGridVisibilityCapSm, 0)
+                  << " SM or better; '?' no station in reach\n\n";
+        render_grid_map(std::cout, field, 1.0, kGridVisibilityCapSm, opt.map_width, !opt.ascii);
+    }
+    if (!opt.grid_out.empty()) {
+        if (!write_grid_binary(opt.grid_out, field)) {
+            std::cerr << "Failed to write grid: " << opt.grid_out << "\n";
+            return 1;
+        }
+        std::cout << "\nGrid written to " << opt.grid_out << "\n";
+    }
+    return 0;
+}
+
 static void usage(const char* prog) {
     std::cerr << "Usage: " << prog
               << " (--metar \"RAW METAR\" ... | --icao KJFK [...]) [--icao-history N] [--taf \"RAW TAF\"] "
-                 "[--runway 220] [--min-ceiling 1000] [--min-vis 3] [--max-xwind 15]\n";
+                 "[--runway 220] [--min-ceiling 1000] [--min-vis 3] [--max-xwind 15] [--alloc-stats] [--trace out.json]\n"
+                 "       [--record DIR | --replay DIR [--replay-latency recorded|MS]]\n"
+                 "       [--deadline MS] [--source-timeout MS] [--mirror metar=URL_WITH_{ICAO}] [--no-hedge]\n"
+              << "   or: " << prog
+              << " --da-batch (--cycle-file 12Z.TXT | --cycle HH) [--airports airports.csv] [--da-threshold 5000] "
+                 "[--top 20]\n"
+              << "   or: " << prog
+              << " --corridor ofp.xml [--corridor ofp2.xml ...] (--cycle-file 12Z.TXT | --cycle HH) "
+                 "[--airports airports.csv] [--corridor-nm 50]\n"
+              << "   or: " << prog
+              << " --grid ceiling|visibility (--cycle-file 12Z.TXT | --cycle HH) [--airports airports.csv]\n"
+                 "       [--bbox LATMIN,LATMAX,LONMIN,LONMAX] [--grid-step 0.1] [--idw-k 6] [--idw-max-nm 150]\n"
+                 "       [--threads N] [--map-width 100] [--ascii] [--grid-out grid.bin]\n"
+              << "Cycle files, airport catalogs, and OFPs may be gzip or zstd compressed; --threads N also sets the\n"
+                 "workers for multi-frame zstd archives.\n";
 }
 
 int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
+    if (!init_cassette(argc, argv) || !init_fetch_policy(argc, argv)) return 1;
     std::cout << " " << "\n";
     std::vector<std::string> metar_raws;
     std::vector<std::string> icaos;
@@ -411,6 +463,8 @@ int main(int argc, char** argv) {
     Minima minima;
     int runway_heading = 0;
     int history_count = 0;
+    bool da_batch = false;
+    CycleBatchOptions batch_opt;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -430,6 +484,45 @@ int main(int argc, char** argv) {
             minima.max_crosswind_kt = std::stod(argv[++i]);
         } else if (arg == "--icao-history" && i + 1 < argc) {
             history_count = std::stoi(argv[++i]);
+        } else if (arg == "--da-batch") {
+            da_batch = true;
+        } else if (arg == "--corridor" && i + 1 < argc) {
+            batch_opt.corridor_ofps.push_back(argv[++i]);
+        } else if (arg == "--corridor-nm" && i + 1 < argc) {
+            batch_opt.corridor_nm = std::stod(argv[++i]);
+        } else if (arg == "--cycle-file" && i + 1 < argc) {
+            batch_opt.cycle_file = argv[++i];
+        } else if (arg == "--cycle" && i + 1 < argc) {
+            batch_opt.cycle_hour = std::stoi(argv[++i]);
+        } else if (arg == "--airports" && i + 1 < argc) {
+            batch_opt.airports_path = argv[++i];
+        } else if (arg == "--da-threshold" && i + 1 < argc) {
+            batch_opt.threshold_ft = std::stod(argv[++i]);
+        } else if (arg == "--top" && i + 1 < argc) {
+            batch_opt.top = std::stoul(argv[++i]);
+        } else if (arg == "--grid" && i + 1 < argc) {
+            batch_opt.grid_field = argv[++i];
+        } else if (arg == "--bbox" && i + 1 < argc) {
+            GridSpec& g = batch_opt.grid;
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf", &g.lat_min, &g.lat_max, &g.lon_min, &g.lon_max) != 4) {
+                std::cerr << "Bad --bbox (expected LATMIN,LATMAX,LONMIN,LONMAX): " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--grid-step" && i + 1 < argc) {
+            batch_opt.grid.step_deg = std::stod(argv[++i]);
+        } else if (arg == "--idw-k" && i + 1 < argc) {
+            batch_opt.idw.k = std::stoul(argv[++i]);
+        } else if (arg == "--idw-max-nm" && i + 1 < argc) {
+            batch_opt.idw.max_nm = std::stod(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            batch_opt.idw.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            set_decompress_threads(batch_opt.idw.threads);
+        } else if (arg == "--map-width" && i + 1 < argc) {
+            batch_opt.map_width = std::stoul(argv[++i]);
+        } else if (arg == "--ascii") {
+            batch_opt.ascii = true;
+        } else if (arg == "--grid-out" && i + 1 < argc) {
+            batch_opt.grid_out = argv[++i];
         } else if (arg == "--help" || arg == "-h") {
             usage(argv[0]);
             return 0;
@@ -439,11 +532,28 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (da_batch || !batch_opt.corridor_ofps.empty() || !batch_opt.grid_field.empty()) {
+        if (batch_opt.cycle_file.empty() && (batch_opt.cycle_hour < 0 || batch_opt.cycle_hour > 23)) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (da_batch) return run_da_batch(batch_opt);
+        if (!batch_opt.corridor_ofps.empty()) return run_corridor(batch_opt);
+        const GridSpec& g = batch_opt.grid;
+        if ((batch_opt.grid_field != "ceiling" && batch_opt.grid_field != "visibility") || g.step_deg <= 0 ||
+            g.rows() == 0 || g.cols() == 0 || batch_opt.idw.k == 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        return run_grid(batch_opt);
+    }
+
     if (metar_raws.empty() && icaos.empty()) {
         usage(argv[0]);
         return 1;
     }
 
+    enter_stage(AllocStage::kFetch);
     for (const auto& icao : icaos) {
         if (history_count > 0) {
             auto fetched = fetch_metars_history(icao, history_count);
@@ -467,18 +577,23 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    enter_stage(AllocStage::kParse);
     std::vector<MetarDecoded> decoded;
     decoded.reserve(metar_raws.size());
-    for (const auto& raw : metar_raws) {
-        decoded.push_back(decode_metar(raw));
+    std::time_t now = cassette_now();
+    {
+        TraceSpan span("decode_metars", "metar", [&] { return std::to_string(metar_raws.size()) + " reports"; });
+        for (const auto& raw : metar_raws) decoded.push_back(decode_metar(raw, now));
     }
 
+    // Minima checks are interleaved with printing, so they count as output.
+    enter_stage(AllocStage::kOutput);
     for (size_t i = 0; i < metar_raws.size(); ++i) {
         std::cout << "=== METAR " << (i + 1) << " ===\n" << metar_raws[i] << "\n";
         if (runway_heading == 0) {
             std::cout << "(Tip: add --runway <mag heading> to compute crosswind)\n";
         }
-        analyze_metar(metar_raws[i], decoded[i], minima, runway_heading == 0 ? 0 : runway_heading);
+        analyze_metar(decoded[i], minima, runway_heading == 0 ? 0 : runway_heading);
         if (i + 1 != metar_raws.size()) std::cout << "\n";
     }
     if (!taf_raw.empty()) {
@@ -0,0 +1,225 @@
+// Navdata compiler and inspector: turns earth_fix.dat / earth_nav.dat / earth_awy.dat style
+// sources into the binary navigation database the other tools map, and queries it by ident,
+// position, or airway.
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/alloc_stats.hpp"
+#include "core/navdata.hpp"
+#include "core/trace.hpp"
+
+using namespace flightsuite;
+
+static void usage(const char* prog) {
+    std::cerr << "Usage:\n"
+              << "  " << prog << " compile --fix earth_fix.dat --nav earth_nav.dat --awy earth_awy.dat\n"
+              << "        [--airports airports.csv] --out navdata.bin\n"
+              << "  " << prog << " info navdata.bin\n"
+              << "  " << prog << " find navdata.bin IDENT [--near LAT,LON]\n"
+              << "  " << prog << " near navdata.bin LAT LON [--radius 50] [--limit 10]\n"
+              << "  " << prog << " airway navdata.bin NAME\n"
+              << "  --alloc-stats     print heap allocation counts per stage at exit\n"
+              << "  --trace out.json  write a Chrome/Perfetto trace of the run\n"
+              << "Sources may be gzip/zstd compressed.\n";
+}
+
+static void print_point(const NavDatabase& db, uint32_t id, double distance_nm = -1.0) {
+    NavPoint p = db.point(id);
+    std::cout << std::left << std::setw(7) << p.ident << std::setw(8) << nav_kind_name(p.kind) << std::setw(4)
+              << (p.region.empty() ? "-" : std::string(p.region)) << std::right << std::fixed << std::setprecision(5)
+              << std::setw(10) << p.lat << std::setw(11) << p.lon;
+    if (p.kind == NavKind::kNdb) {
+        std::cout << std::setprecision(0) << std::setw(8) << p.freq << "kHz";
+    } else if (p.kind == NavKind::kVor || p.kind == NavKind::kDme) {
+        std::cout << std::setprecision(2) << std::setw(8) << p.freq << "MHz";
+    } else {
+        std::cout << std::setw(11) << "";
+    }
+    if (distance_nm >= 0.0) std::cout << std::setprecision(1) << std::setw(8) << distance_nm << " nm";
+    size_t edges = static_cast<size_t>(db.edges_end(id) - db.edges_begin(id));
+    if (edges) std::cout << "  " << edges << " airway segment" << (edges == 1 ? "" : "s");
+    if (!p.name.empty()) std::cout << "  " << p.name;
+    std::cout << "\n";
+}
+
+static bool parse_lat_lon(const std::string& s, double& lat, double& lon) {
+    size_t comma = s.find(',');
+    if (comma == std::string::npos) return false;
+    char* end = nullptr;
+    lat = std::strtod(s.c_str(), &end);
+    if (end != s.c_str() + comma) return false;
+    lon = std::strtod(s.c_str() + comma + 1, &end);
+    return *end == '\0';
+}
+
+static int run_compile(int argc, char** argv) {
+    NavSources src;
+    std::string out_path;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fix" && i + 1 < argc) {
+            src.fix_path = argv[++i];
+        } else if (arg == "--nav" && i + 1 < argc) {
+            src.nav_path = argv[++i];
+        } else if (arg == "--awy" && i + 1 < argc) {
+            src.awy_path = argv[++i];
+        } else if (arg == "--airports" && i + 1 < argc) {
+            src.airports_path = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (out_path.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    enter_stage(AllocStage::kParse);
+    NavCompileStats stats;
+    std::string error;
+    if (!compile_navdata(src, out_path, &stats, &error)) {
+        std::cerr << "Compile failed: " << error << "\n";
+        return 1;
+    }
+    enter_stage(AllocStage::kOutput);
+    std::cout << "Wrote " << out_path << ": " << stats.fixes << " fixes, " << stats.navaids << " navaids, "
+              << stats.airports << " airports, " << stats.airways << " airways, " << stats.edges
+              << " directed segments\n";
+    if (stats.skipped_lines) std::cerr << "Skipped " << stats.skipped_lines << " unparseable source lines\n";
+    if (stats.unresolved_segments) {
+        std::cerr << "Dropped " << stats.unresolved_segments << " airway segments with unknown endpoints\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string cmd = argv[1];
+    if (cmd == "--help" || cmd == "-h") {
+        usage(argv[0]);
+        return 0;
+    }
+    if (cmd == "compile") return run_compile(argc, argv);
+    if (argc < 3 || (cmd != "info" && cmd != "find" && cmd != "near" && cmd != "airway")) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    enter_stage(AllocStage::kParse);
+    auto t0 = std::chrono::steady_clock::now();
+    NavDatabase db;
+    std::string error;
+    if (!db.open(argv[2], &error)) {
+        std::cerr << "Failed to open navdata: " << error << "\n";
+        return 1;
+    }
+    double open_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    enter_stage(AllocStage::kAnalyze);
+    if (cmd == "info") {
+        std::cout << argv[2] << ": " << db.point_count() << " points, " << db.airway_count() << " airways, "
+                  << db.edge_count() << " directed segments (opened in " << std::fixed << std::setprecision(2)
+                  << open_ms << " ms)\n";
+        return 0;
+    }
+    if (cmd == "find") {
+        if (argc < 4) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string ident = argv[3];
+        double lat = 0.0, lon = 0.0;
+        bool near = false;
+        for (int i = 4; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--near" && i + 1 < argc && parse_lat_lon(argv[i + 1], lat, lon)) {
+                near = true;
+                ++i;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        enter_stage(AllocStage::kOutput);
+        if (near) {
+            auto id = db.resolve(ident, lat, lon);
+            if (!id) {
+                std::cerr << "No point named " << ident << "\n";
+                return 1;
+            }
+            print_point(db, *id);
+            return 0;
+        }
+        auto [first, last] = db.find(ident);
+        if (first == last) {
+            std::cerr << "No point named " << ident << "\n";
+            return 1;
+        }
+        for (uint32_t id = first; id < last; ++id) print_point(db, id);
+        return 0;
+    }
+    if (cmd == "near") {
+        double lat = 0.0, lon = 0.0, radius = 50.0;
+        size_t limit = 10;
+        if (argc < 5 || !parse_lat_lon(std::string(argv[3]) + "," + argv[4], lat, lon)) {
+            usage(argv[0]);
+            return 1;
+        }
+        for (int i = 5; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--radius" && i + 1 < argc) {
+                radius = std::stod(argv[++i]);
+            } else if (arg == "--limit" && i + 1 < argc) {
+                limit = std::stoul(argv[++i]);
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        std::vector<SpatialHit> hits;
+        db.spatial().nearest(lat, lon, limit, radius, hits);
+        enter_stage(AllocStage::kOutput);
+        if (hits.empty()) std::cout << "Nothing within " << radius << " nm.\n";
+        for (const auto& h : hits) print_point(db, h.id, h.distance_nm);
+        return 0;
+    }
+    // airway
+    if (argc < 4) {
+        usage(argv[0]);
+        return 1;
+    }
+    auto awy = db.find_airway(argv[3]);
+    if (!awy) {
+        std::cerr << "No airway named " << argv[3] << "\n";
+        return 1;
+    }
+    enter_stage(AllocStage::kOutput);
+    const uint32_t* begin = db.airway_points_begin(*awy);
+    const uint32_t* end = db.airway_points_end(*awy);
+    std::cout << db.airway_name(*awy) << ": " << (end - begin) << " points\n";
+    for (const uint32_t* it = begin; it != end; ++it) {
+        std::cout << "  ";
+        NavPoint p = db.point(*it);
+        std::cout << std::left << std::setw(7) << p.ident;
+        // Segments leaving this point along the airway, with their levels.
+        for (const NavEdge* e = db.edges_begin(*it); e != db.edges_end(*it); ++e) {
+            if (e->airway != *awy) continue;
+            std::cout << " -> " << db.point(e->to).ident << " " << std::fixed << std::setprecision(1)
+                      << e->distance_nm << " nm FL" << std::setfill('0') << std::setw(3) << std::right << e->base_fl
+                      << "-" << std::setw(3) << e->top_fl << std::setfill(' ') << std::left;
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -1,124 +1,17 @@
 // NOTAM parser/scorer: fetches (via curl) or loads NOTAMs from a file, flags key hazards, and scores risk.
 #include <algorithm>
-#include <cctype>
-#include <cstdio>
-#include <fstream>
 #include <iostream>
-#include <map>
-#include <optional>
-#include <regex>
-#include <sstream>
 #include <string>
 #include <vector>
 
-struct Notam {
-    std::string raw;
-    std::string icao;
-    bool runway_closure = false;
-    bool approach_change = false;
-    bool gps_outage = false;
-    bool lighting_issue = false;
-};
-
-struct RiskScore {
-    int score = 0;
-    std::vector<std::string> reasons;
-};
-
-static std::string trim(const std::string& s) {
-    size_t start = 0;
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
-    size_t end = s.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
-    return s.substr(start, end - start);
-}
-
-static std::vector<std::string> split_lines(const std::string& text) {
-    std::istringstream iss(text);
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(iss, line)) {
-        line = trim(line);
-        if (!line.empty()) lines.push_back(line);
-    }
-    return lines;
-}
-
-static std::optional<std::string> fetch_notams_http(const std::string& icao) {
-    // Source: FAA/D-NOTAM (example static feed). For offline use, prefer --file.
-    std::string url = "https://www.notams.faa.gov/dinsQueryWeb/queryRetrievalMapAction.do?retrieveLocId="
-                      + icao + "&actionType=notamRetrievalByICAOs";
-    std::string cmd = "curl -s --max-time 6 \"" + url + "\"";
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) return std::nullopt;
-    std::string output;
-    char buffer[512];
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        output += buffer;
-    }
-    pclose(pipe);
-    if (output.empty()) return std::nullopt;
-    return output;
-}
-
-static std::vector<Notam> parse_notams_text(const std::string& text, const std::string& icao_hint) {
-    auto lines = split_lines(text);
-    std::vector<Notam> out;
-    std::regex icao_re(R"(([A-Z]{4}))");
-    for (const auto& line : lines) {
-        Notam n;
-        n.raw = line;
-        n.icao = icao_hint;
-        std::smatch m;
-        if (std::regex_search(line, m, icao_re)) {
-            n.icao = m[1];
-        }
-        std::string up = line;
-        std::transform(up.begin(), up.end(), up.begin(), ::toupper);
-        if (up.find("RWY") != std::string::npos && (up.find("CLSD") != std::string::npos || up.find("CLOSED") != std::string::npos)) {
-            n.runway_closure = true;
-        }
-        if (up.find("ILS") != std::string::npos || up.find("RNAV") != std::string::npos ||
-            up.find("APCH") != std::string::npos || up.find("APPROACH") != std::string::npos) {
-            if (up.find("U/S") != std::string::npos || up.find("UNUSABLE") != std::string::npos ||
-                up.find("OUT OF SERVICE") != std::string::npos || up.find("NOT AVBL") != std::string::npos) {
-                n.approach_change = true;
-            }
-        }
-        if (up.find("GPS") != std::string::npos && (up.find("UNREL") != std::string::npos || up.find("OUTAGE") != std::string::npos || up.find("JAMMING") != std::string::npos)) {
-            n.gps_outage = true;
-        }
-        if (up.find("RCLL") != std::string::npos || up.find("RWY LGTS") != std::string::npos ||
-            up.find("PAPI") != std::string::npos || up.find("VASI") != std::string::npos ||
-            up.find("MALSR") != std::string::npos || up.find("MIRL") != std::string::npos ||
-            up.find("HIRL") != std::string::npos) {
-            if (up.find("U/S") != std::string::npos || up.find("UNSERVICEABLE") != std::string::npos ||
-                up.find("OUT OF SERVICE") != std::string::npos || up.find("OUTAGE") != std::string::npos ||
-                up.find("NOT AVBL") != std::string::npos) {
-                n.lighting_issue = true;
-            }
-        }
-        out.push_back(n);
-    }
-    return out;
-}
+#include "core/alloc_stats.hpp"
+#include "core/cassette.hpp"
+#include "core/fetch.hpp"
+#include "core/notam.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
 
-static RiskScore score_notams(const std::vector<Notam>& ns, const std::string& icao) {
-    RiskScore r;
-    r.score = 0;
-    auto add = [&](int pts, const std::string& why) {
-        r.score += pts;
-        r.reasons.push_back(why);
-    };
-    for (const auto& n : ns) {
-        if (!icao.empty() && !n.icao.empty() && n.icao != icao) continue;
-        if (n.runway_closure) add(4, "Runway closure");
-        if (n.approach_change) add(3, "Approach/NAVAID out");
-        if (n.gps_outage) add(2, "GPS unreliability");
-        if (n.lighting_issue) add(1, "Runway/approach lighting issue");
-    }
-    return r;
-}
+using namespace flightsuite;
 
 static void print_notams(const std::vector<Notam>& ns) {
     for (size_t i = 0; i < ns.size(); ++i) {
@@ -140,9 +33,19 @@ static void usage(const char* prog) {
     std::cerr << "  --icao     ICAO code to analyze\n";
     std::cerr << "  --file     Path to local NOTAM text (if omitted, will try live fetch via curl)\n";
     std::cerr << "  --risk-only  Only print risk score\n";
+    std::cerr << "  --alloc-stats  Print heap allocation counts per stage at exit\n";
+    std::cerr << "  --trace out.json  Write a Chrome/Perfetto trace of the run\n";
+    std::cerr << "  --record DIR   Save every fetched response (with timing) to a cassette directory\n";
+    std::cerr << "  --replay DIR   Serve fetches from a recorded cassette instead of the network\n";
+    std::cerr << "  --replay-latency recorded|MS  Sleep for the recorded (or a fixed) latency on replay\n";
+    std::cerr << "  --deadline MS  Overall fetch budget; --source-timeout MS per request\n";
+    std::cerr << "  --mirror notam=URL  Second source ({ICAO} is substituted), hedged after the p95 delay; --no-hedge to only fail over\n";
 }
 
 int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
+    if (!init_cassette(argc, argv) || !init_fetch_policy(argc, argv)) return 1;
     std::string icao;
     std::string file_path;
     bool risk_only = false;
@@ -169,28 +72,39 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    std::string raw_text;
+    std::vector<Notam> parsed;
+    RiskScore risk;
+    bool scored = false;
     if (!file_path.empty()) {
-        std::ifstream f(file_path);
-        if (!f.is_open()) {
-            std::cerr << "Could not open NOTAM file: " << file_path << "\n";
+        // Saved dumps (plain or compressed) are parsed as they stream in; with --risk-only each
+        // entry is scored and dropped, so nothing of the dump is kept.
+        enter_stage(AllocStage::kParse);
+        bool ok = for_each_notam_in_file(file_path, icao, [&](Notam&& n) {
+            if (risk_only) {
+                add_notam_risk(n, icao, risk);
+            } else {
+                parsed.push_back(std::move(n));
+            }
+        });
+        if (!ok) {
+            std::cerr << "Could not read NOTAM file: " << file_path << "\n";
             return 1;
         }
-        std::stringstream buffer;
-        buffer << f.rdbuf();
-        raw_text = buffer.str();
+        scored = risk_only;
     } else {
+        enter_stage(AllocStage::kFetch);
         auto fetched = fetch_notams_http(icao);
         if (!fetched) {
             std::cerr << "Failed to fetch NOTAMs (offline?). Provide --file <path> to a saved NOTAM list.\n";
             return 1;
         }
-        raw_text = *fetched;
+        enter_stage(AllocStage::kParse);
+        parsed = parse_notams_text(*fetched, icao);
     }
+    enter_stage(AllocStage::kAnalyze);
+    if (!scored) risk = score_notams(parsed, icao);
 
-    auto parsed = parse_notams_text(raw_text, icao);
-    auto risk = score_notams(parsed, icao);
-
+    enter_stage(AllocStage::kOutput);
     if (!risk_only) {
         std::cout << "NOTAMs for " << icao << " (" << parsed.size() << "):\n";
         print_notams(parsed);
@@ -1,238 +1,154 @@
 // SimBrief summarizer: reads a SimBrief OFP XML, prints a concise summary, and can optionally
-// write a verticalProfile-compatible route CSV.
+// write a verticalProfile-compatible route CSV. With a navdata database it also expands the route
+// string into its full fix sequence, for one OFP or a whole archive.
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <optional>
-#include <regex>
-#include <sstream>
 #include <string>
 #include <vector>
 
-struct Fix {
-    std::string name;
-    double lat = 0.0;
-    double lon = 0.0;
-    double altitude_ft = 0.0;
-};
+#include "core/alloc_stats.hpp"
+#include "core/geo.hpp"
+#include "core/navdata.hpp"
+#include "core/ofp.hpp"
+#include "core/route_string.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
 
-static std::string trim(const std::string& s) {
-    size_t start = 0;
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
-    size_t end = s.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
-    return s.substr(start, end - start);
-}
-
-static double deg2rad(double d) { return d * M_PI / 180.0; }
-
-static double haversine_nm(double lat1, double lon1, double lat2, double lon2) {
-    const double R_nm = 3440.065;
-    double dlat = deg2rad(lat2 - lat1);
-    double dlon = deg2rad(lon2 - lon1);
-    double a = std::sin(dlat / 2) * std::sin(dlat / 2) +
-               std::cos(deg2rad(lat1)) * std::cos(deg2rad(lat2)) * std::sin(dlon / 2) *
-                   std::sin(dlon / 2);
-    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
-    return R_nm * c;
-}
+using namespace flightsuite;
 
-static double parse_latlon(const std::string& s) {
-    if (s.empty()) return 0.0;
-    char hemi = 0;
-    std::string num = s;
-    if (std::isalpha(static_cast<unsigned char>(s.front()))) {
-        hemi = s.front();
-        num = s.substr(1);
-    } else if (std::isalpha(static_cast<unsigned char>(s.back()))) {
-        hemi = s.back();
-        num = s.substr(0, s.size() - 1);
+static bool write_route_csv(const std::vector<Fix>& fixes, const std::string& out_path) {
+    std::ofstream out(out_path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open output file: " << out_path << "\n";
+        return false;
     }
-    double v = std::stod(num);
-    if (hemi == 'S' || hemi == 'W' || hemi == 's' || hemi == 'w') v = -v;
-    return v;
-}
-
-static std::optional<double> parse_double(const std::string& s) {
-    try {
-        return std::stod(s);
-    } catch (...) {
-        return std::nullopt;
+    out << "# name,distance_nm,altitude_ft\n";
+    double cumulative = 0.0;
+    if (fixes.empty()) return true;
+    out << fixes[0].name << "," << cumulative << "," << fixes[0].altitude_ft << "\n";
+    for (size_t i = 1; i < fixes.size(); ++i) {
+        double leg = haversine_nm(fixes[i - 1].lat, fixes[i - 1].lon, fixes[i].lat, fixes[i].lon);
+        cumulative += leg;
+        out << fixes[i].name << "," << cumulative << "," << fixes[i].altitude_ft << "\n";
     }
+    return true;
 }
 
-static std::optional<std::string> tag_in_block(const std::string& block, const std::string& tag) {
-    std::regex re("<" + tag + R"(>([^<]+)</)" + tag + ">");
-    std::smatch m;
-    if (std::regex_search(block, m, re)) return trim(m[1]);
-    return std::nullopt;
+static RouteRequest route_request(const std::string& content) {
+    RouteRequest r;
+    r.route = tag_value(content, {"plan_rte", "atc_route", "route", "route_ifps"}).value_or("");
+    r.origin = tag_in_section(content, "origin", "icao_code").value_or(tag_value(content, {"orig_icao"}).value_or(""));
+    r.destination =
+        tag_in_section(content, "destination", "icao_code").value_or(tag_value(content, {"dest_icao"}).value_or(""));
+    return r;
 }
 
-static std::optional<std::string> tag_in_section(const std::string& content,
-                                                 const std::string& section_tag,
-                                                 const std::string& tag) {
-    size_t start = content.find("<" + section_tag + ">");
-    size_t end = content.find("</" + section_tag + ">", start);
-    if (start == std::string::npos || end == std::string::npos || end <= start) {
-        return std::nullopt;
+// An expanded route has positions but no profile: field elevations at the airports, cruise between.
+static void assign_altitudes(const std::string& content, std::vector<Fix>& fixes) {
+    if (fixes.empty()) return;
+    auto number = [&content](const std::string& section, const std::string& tag) {
+        auto v = section.empty() ? tag_value(content, {tag}) : tag_in_section(content, section, tag);
+        auto d = v ? parse_double(*v) : std::nullopt;
+        return d.value_or(0.0);
+    };
+    double cruise = number("", "initial_altitude");
+    if (cruise > 0.0 && cruise <= 600.0) cruise *= 100.0; // flight level
+    for (auto& f : fixes) f.altitude_ft = cruise;
+    RouteRequest ends = route_request(content);
+    if (fixes.front().name == ends.origin) fixes.front().altitude_ft = number("origin", "elevation");
+    if (fixes.size() > 1 && fixes.back().name == ends.destination) {
+        fixes.back().altitude_ft = number("destination", "elevation");
     }
-    std::string block = content.substr(start, end - start);
-    return tag_in_block(block, tag);
 }
 
-struct AircraftInfo {
-    std::string name;
-    std::string engines;
-    std::string reg;
-};
-
-static AircraftInfo parse_aircraft(const std::string& content) {
-    AircraftInfo info;
-    size_t start = content.find("<aircraft>");
-    size_t end = content.find("</aircraft>", start);
-    if (start != std::string::npos && end != std::string::npos && end > start) {
-        std::string block = content.substr(start, end - start);
-        if (auto v = tag_in_block(block, "name")) info.name = *v;
-        if (auto v = tag_in_block(block, "engines")) info.engines = *v;
-        if (auto v = tag_in_block(block, "reg")) info.reg = *v;
+static void print_expanded(const ExpandedRoute& r) {
+    std::cout << "Expanded route: " << r.fixes.size() << " fixes, " << static_cast<int>(std::round(cumulative_distance(r.fixes)))
+              << " nm\n ";
+    std::string via;
+    for (size_t i = 0; i < r.fixes.size(); ++i) {
+        if (i > 0 && r.via[i] != via) std::cout << " " << r.via[i];
+        via = r.via[i];
+        std::cout << " " << r.fixes[i].name;
     }
-    return info;
+    std::cout << "\n";
+    auto list = [](const char* label, const std::vector<std::string>& items) {
+        if (items.empty()) return;
+        std::cout << label;
+        for (size_t i = 0; i < items.size(); ++i) std::cout << (i ? ", " : "") << items[i];
+        std::cout << "\n";
+    };
+    list("  not expanded: ", r.skipped);
+    list("  unresolved:   ", r.unresolved);
 }
 
-struct FuelInfo {
-    std::optional<std::string> ramp;
-    std::optional<std::string> trip;
-    std::optional<std::string> reserve;
-    std::optional<std::string> taxi;
-    std::optional<std::string> extra;
-};
-
-static FuelInfo parse_fuel(const std::string& content) {
-    FuelInfo f;
-    size_t start = content.find("<fuel>");
-    size_t end = content.find("</fuel>", start);
-    if (start != std::string::npos && end != std::string::npos && end > start) {
-        std::string block = content.substr(start, end - start);
-        if (auto v = tag_in_block(block, "plan_ramp")) f.ramp = v;
-        if (auto v = tag_in_block(block, "plan_trip")) f.trip = v;
-        if (auto v = tag_in_block(block, "enroute_burn")) f.trip = v;
-        if (auto v = tag_in_block(block, "reserve")) f.reserve = v;
-        if (auto v = tag_in_block(block, "taxi")) f.taxi = v;
-        if (auto v = tag_in_block(block, "extra")) f.extra = v;
+// --ofp-list: expand every OFP's route against the navdata and optionally write one CSV each
+// (navlog when the OFP has one, expanded route otherwise).
+static int run_archive(const std::string& list_path, const NavDatabase& db, const std::string& csv_dir,
+                       unsigned threads) {
+    enter_stage(AllocStage::kFetch);
+    std::vector<std::string> paths;
+    if (!read_file_lines(list_path, paths)) {
+        std::cerr << "Failed to read OFP list: " << list_path << "\n";
+        return 1;
     }
-    return f;
-}
-
-static std::optional<std::string> read_file(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) return std::nullopt;
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
-}
-
-static std::optional<std::string> tag_value(const std::string& content,
-                                            const std::vector<std::string>& tags) {
-    for (const auto& t : tags) {
-        std::regex re("<" + t + R"(>([^<]+)</)" + t + ">");
-        std::smatch m;
-        if (std::regex_search(content, m, re)) {
-            return trim(m[1]);
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [](const std::string& p) { return trim(p).empty(); }),
+                paths.end());
+    std::vector<std::string> contents;
+    contents.reserve(paths.size());
+    for (auto& p : paths) {
+        p = trim(p);
+        auto content = read_file(p);
+        if (!content) {
+            std::cerr << "Failed to read OFP file: " << p << "\n";
+            return 1;
         }
+        contents.push_back(std::move(*content));
     }
-    return std::nullopt;
-}
+    enter_stage(AllocStage::kParse);
+    std::vector<RouteRequest> requests;
+    requests.reserve(contents.size());
+    for (const auto& c : contents) requests.push_back(route_request(c));
 
-static std::vector<Fix> parse_navlog_fixes(const std::string& content) {
-    std::vector<Fix> fixes;
-    // Extract a <navlog> ... </navlog> block that contains <fix> entries.
-    std::string navlog_block;
-    size_t search_pos = 0;
-    while (true) {
-        size_t start = content.find("<navlog>", search_pos);
-        if (start == std::string::npos) break;
-        size_t end_tag = content.find("</navlog>", start);
-        if (end_tag == std::string::npos) break;
-        std::string candidate = content.substr(start, end_tag - start);
-        if (candidate.find("<fix>") != std::string::npos) {
-            navlog_block = candidate;
-            break;
-        }
-        search_pos = end_tag + 9;
-    }
-    if (navlog_block.empty()) navlog_block = content;
+    enter_stage(AllocStage::kAnalyze);
+    auto t0 = std::chrono::steady_clock::now();
+    auto expanded = expand_routes(db, requests, threads);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
 
-    std::regex block_re("<fix>([\\s\\S]*?)</fix>");
-    auto begin = std::sregex_iterator(navlog_block.begin(), navlog_block.end(), block_re);
-    auto end = std::sregex_iterator();
-    for (auto it = begin; it != end; ++it) {
-        std::string block = (*it)[1];
-        std::smatch m;
-        Fix f;
-        std::regex ident_re("<ident>([^<]+)</ident>");
-        if (std::regex_search(block, m, ident_re)) f.name = m[1];
-        std::regex lat_re("<pos_lat>([^<]+)</pos_lat>");
-        if (std::regex_search(block, m, lat_re)) f.lat = parse_latlon(m[1]);
-        std::regex lon_re("<pos_long>([^<]+)</pos_long>");
-        if (std::regex_search(block, m, lon_re)) f.lon = parse_latlon(m[1]);
-        std::regex alt_re("<altitude_feet>([^<]+)</altitude_feet>");
-        if (std::regex_search(block, m, alt_re)) {
-            if (auto v = parse_double(m[1])) f.altitude_ft = *v;
-        } else {
-            std::regex targ_re("<target_altitude>([^<]+)</target_altitude>");
-            if (std::regex_search(block, m, targ_re)) {
-                if (auto v = parse_double(m[1])) f.altitude_ft = *v;
-            }
-        }
-        if (!f.name.empty()) fixes.push_back(f);
+    enter_stage(AllocStage::kOutput);
+    size_t fixes = 0, unresolved = 0, incomplete = 0;
+    for (const auto& r : expanded) {
+        fixes += r.fixes.size();
+        unresolved += r.unresolved.size();
+        incomplete += !r.unresolved.empty();
     }
-    // Fallback: older navlog_fix attributes.
-    if (fixes.empty()) {
-        std::regex fix_re(
-            R"(<navlog_fix[^>]*fix=\"([^\"]+)\"[^>]*lat=\"([^\"]+)\"[^>]*lon=\"([^\"]+)\"[^>]*alt=\"([^\"]+)\")");
-        auto b2 = std::sregex_iterator(content.begin(), content.end(), fix_re);
-        for (auto it2 = b2; it2 != end; ++it2) {
-            std::smatch m2 = *it2;
-            Fix f2;
-            f2.name = m2[1];
-            f2.lat = parse_latlon(m2[2]);
-            f2.lon = parse_latlon(m2[3]);
-            f2.altitude_ft = std::stod(m2[4]);
-            if (f2.altitude_ft > 0.0 && f2.altitude_ft <= 200.0) f2.altitude_ft *= 100.0;
-            fixes.push_back(f2);
+    std::cout << "Expanded " << expanded.size() << " routes into " << fixes << " fixes in " << std::fixed
+              << std::setprecision(1) << ms << " ms";
+    if (incomplete) std::cout << "; " << incomplete << " with " << unresolved << " unresolved tokens";
+    std::cout << "\n";
+    if (csv_dir.empty()) return 0;
+    std::error_code ec;
+    std::filesystem::create_directories(csv_dir, ec);
+    size_t written = 0;
+    for (size_t i = 0; i < contents.size(); ++i) {
+        auto fixes_out = parse_navlog_fixes(contents[i]);
+        if (fixes_out.empty()) {
+            fixes_out = expanded[i].fixes;
+            assign_altitudes(contents[i], fixes_out);
         }
+        std::string stem = std::filesystem::path(paths[i]).stem().string();
+        written += write_route_csv(fixes_out, (std::filesystem::path(csv_dir) / (stem + ".csv")).string());
     }
-    return fixes;
-}
-
-static double cumulative_distance(const std::vector<Fix>& fixes) {
-    if (fixes.size() < 2) return 0.0;
-    double total = 0.0;
-    for (size_t i = 1; i < fixes.size(); ++i) {
-        total += haversine_nm(fixes[i - 1].lat, fixes[i - 1].lon, fixes[i].lat, fixes[i].lon);
-    }
-    return total;
-}
-
-static void write_route_csv(const std::vector<Fix>& fixes, const std::string& out_path) {
-    std::ofstream out(out_path);
-    if (!out.is_open()) {
-        std::cerr << "Failed to open output file: " << out_path << "\n";
-        return;
-    }
-    out << "# name,distance_nm,altitude_ft\n";
-    double cumulative = 0.0;
-    if (fixes.empty()) return;
-    out << fixes[0].name << "," << cumulative << "," << fixes[0].altitude_ft << "\n";
-    for (size_t i = 1; i < fixes.size(); ++i) {
-        double leg = haversine_nm(fixes[i - 1].lat, fixes[i - 1].lon, fixes[i].lat, fixes[i].lon);
-        cumulative += leg;
-        out << fixes[i].name << "," << cumulative << "," << fixes[i].altitude_ft << "\n";
-    }
-    std::cout << "Route CSV written to " << out_path << " (" << fixes.size() << " fixes)\n";
+    std::cout << "Route CSVs written to " << csv_dir << " (" << written << " files)\n";
+    return written == contents.size() ? 0 : 1;
 }
 
 static void print_summary(const std::string& content, const std::vector<Fix>& fixes) {
+    enter_stage(AllocStage::kParse);
     auto val = [&](std::vector<std::string> tags, const std::string& fallback = "N/A") {
         auto v = tag_value(content, tags);
         return v ? *v : fallback;
@@ -263,8 +179,10 @@ static void print_summary(const std::string& content, const std::vector<Fix>& fi
     std::string ldw = val({"plan_landing", "landing_weight"});
     std::string zfw = val({"plan_zfw", "zfw", "estimated_zfw"});
 
+    enter_stage(AllocStage::kAnalyze);
     double navlog_dist = cumulative_distance(fixes);
 
+    enter_stage(AllocStage::kOutput);
     std::cout << "=== SimBrief Summary ===\n";
     std::cout << "Flight: " << flight << "\n";
     std::cout << "From:   " << dep << (dep_rwy != "N/A" ? " RWY " + dep_rwy : "") << "\n";
@@ -295,20 +213,35 @@ static void print_summary(const std::string& content, const std::vector<Fix>& fi
 }
 
 static void usage(const char* prog) {
-    std::cout << "Usage: " << prog << " --ofp simbrief_ofp.xml [--csv route.csv]\n";
+    std::cout << "Usage: " << prog << " --ofp simbrief_ofp.xml [--csv route.csv] [--navdata navdata.bin]"
+              << " [--alloc-stats] [--trace out.json]\n";
+    std::cout << "       " << prog << " --ofp-list ofps.txt --navdata navdata.bin [--csv-dir DIR] [--threads N]\n";
     std::cout << "Prints a summary of the OFP and optionally writes a route CSV for verticalProfile.\n";
+    std::cout << "--navdata expands the route string along airways (see navData/); the CSV then falls back\n"
+              << "to the expanded route when the OFP has no navlog. --ofp-list expands one OFP per line.\n";
 }
 
 int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
     try {
-        std::string ofp_path;
+        std::string ofp_path, ofp_list, navdata_path, csv_dir;
         std::string csv_out;
+        unsigned threads = 0;
         for (int i = 1; i < argc; ++i) {
             std::string arg = argv[i];
             if (arg == "--ofp" && i + 1 < argc) {
                 ofp_path = argv[++i];
             } else if (arg == "--csv" && i + 1 < argc) {
                 csv_out = argv[++i];
+            } else if (arg == "--navdata" && i + 1 < argc) {
+                navdata_path = argv[++i];
+            } else if (arg == "--ofp-list" && i + 1 < argc) {
+                ofp_list = argv[++i];
+            } else if (arg == "--csv-dir" && i + 1 < argc) {
+                csv_dir = argv[++i];
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = static_cast<unsigned>(std::stoul(argv[++i]));
             } else if (arg == "--help" || arg == "-h") {
                 usage(argv[0]);
                 return 0;
@@ -317,19 +250,44 @@ int main(int argc, char** argv) {
                 return 1;
             }
         }
-        if (ofp_path.empty()) {
+        if (ofp_path.empty() == ofp_list.empty() || (!ofp_list.empty() && navdata_path.empty())) {
             usage(argv[0]);
             return 1;
         }
+        NavDatabase db;
+        if (!navdata_path.empty()) {
+            std::string error;
+            if (!db.open(navdata_path, &error)) {
+                std::cerr << "Failed to open navdata: " << error << "\n";
+                return 1;
+            }
+        }
+        if (!ofp_list.empty()) return run_archive(ofp_list, db, csv_dir, threads);
+        enter_stage(AllocStage::kFetch);
         auto content = read_file(ofp_path);
         if (!content) {
             std::cerr << "Failed to read OFP file: " << ofp_path << "\n";
             return 1;
         }
+        enter_stage(AllocStage::kParse);
         auto fixes = parse_navlog_fixes(*content);
         print_summary(*content, fixes);
+        if (db.is_open()) {
+            enter_stage(AllocStage::kAnalyze);
+            RouteExpander expander(db);
+            ExpandedRoute expanded = expander.expand(route_request(*content));
+            enter_stage(AllocStage::kOutput);
+            print_expanded(expanded);
+            if (fixes.empty()) {
+                fixes = expanded.fixes;
+                assign_altitudes(*content, fixes);
+            }
+        }
         if (!csv_out.empty()) {
-            write_route_csv(fixes, csv_out);
+            enter_stage(AllocStage::kOutput);
+            if (write_route_csv(fixes, csv_out)) {
+                std::cout << "Route CSV written to " << csv_out << " (" << fixes.size() << " fixes)\n";
+            }
         }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
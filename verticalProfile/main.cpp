@@ -2,85 +2,16 @@
 // computes TOC/TOD based on climb/descent gradients, and renders an ASCII profile.
 #include <algorithm>
 #include <cmath>
-#include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 
-struct Waypoint {
-    std::string name;
-    double distance_nm = 0.0; // cumulative distance from origin
-    double altitude_ft = 0.0;
-};
+#include "core/alloc_stats.hpp"
+#include "core/profile.hpp"
+#include "core/trace.hpp"
 
-struct ProfilePoints {
-    std::vector<double> distances_nm;
-    std::vector<double> altitudes_ft;
-};
-
-static std::string trim(const std::string& s) {
-    size_t start = 0;
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
-    size_t end = s.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
-    return s.substr(start, end - start);
-}
-
-static std::vector<std::string> split_csv_line(const std::string& line) {
-    std::vector<std::string> cells;
-    std::string cell;
-    std::istringstream ss(line);
-    while (std::getline(ss, cell, ',')) {
-        cells.push_back(trim(cell));
-    }
-    return cells;
-}
-
-static std::vector<Waypoint> load_route(const std::string& path) {
-    std::vector<Waypoint> wpts;
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open route file: " << path << "\n";
-        return wpts;
-    }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
-        auto cells = split_csv_line(line);
-        if (cells.size() < 3) continue;
-        Waypoint w;
-        w.name = cells[0];
-        w.distance_nm = std::stod(cells[1]);
-        w.altitude_ft = std::stod(cells[2]);
-        wpts.push_back(w);
-    }
-    return wpts;
-}
-
-static ProfilePoints interpolate_profile(const std::vector<Waypoint>& wpts, int samples = 200) {
-    ProfilePoints p;
-    if (wpts.size() < 2) return p;
-    double total_dist = wpts.back().distance_nm;
-    for (int i = 0; i <= samples; ++i) {
-        double d = total_dist * i / samples;
-        p.distances_nm.push_back(d);
-        // find segment
-        size_t seg = 1;
-        while (seg < wpts.size() && wpts[seg].distance_nm < d) ++seg;
-        if (seg >= wpts.size()) {
-            p.altitudes_ft.push_back(wpts.back().altitude_ft);
-        } else {
-            const auto& a = wpts[seg - 1];
-            const auto& b = wpts[seg];
-            double t = (d - a.distance_nm) / (b.distance_nm - a.distance_nm);
-            double alt = a.altitude_ft + t * (b.altitude_ft - a.altitude_ft);
-            p.altitudes_ft.push_back(alt);
-        }
-    }
-    return p;
-}
+using namespace flightsuite;
 
 static void render_ascii(const ProfilePoints& p) {
     if (p.distances_nm.empty()) {
@@ -111,20 +42,15 @@ static void render_ascii(const ProfilePoints& p) {
     std::cout << " nm\n";
 }
 
-static double find_distance_to_alt(const std::vector<Waypoint>& wpts, double start_alt,
-                                   double target_alt, double gradient_ft_per_nm) {
-    if (gradient_ft_per_nm <= 0) return 0.0;
-    double delta_ft = target_alt - start_alt;
-    return delta_ft / gradient_ft_per_nm;
-}
-
 static void usage(const char* prog) {
     std::cerr << "Usage: " << prog
-              << " --route route.csv [--climb 300] [--descent 250] [--samples 200]\n";
+              << " --route route.csv [--climb 300] [--descent 250] [--samples 200] [--alloc-stats] [--trace out.json]\n";
     std::cerr << " route.csv columns: name,distance_nm,altitude_ft (cumulative distance)\n";
 }
 
 int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
     std::string route_path;
     double climb_grad = 300.0;   // ft per nm
     double descent_grad = 250.0; // ft per nm
@@ -151,29 +77,31 @@ int main(int argc, char** argv) {
         usage(argv[0]);
         return 1;
     }
+    enter_stage(AllocStage::kParse);
     auto route = load_route(route_path);
     if (route.size() < 2) {
         std::cerr << "Route needs at least 2 waypoints.\n";
         return 1;
     }
+    enter_stage(AllocStage::kAnalyze);
     double total_dist = route.back().distance_nm;
     double dep_alt = route.front().altitude_ft;
     double dest_alt = route.back().altitude_ft;
     double cruise_alt = dep_alt;
     for (const auto& w : route) cruise_alt = std::max(cruise_alt, w.altitude_ft);
 
-    double dist_to_toc = find_distance_to_alt(route, dep_alt, cruise_alt, climb_grad);
-    double dist_from_dest_tod = find_distance_to_alt(route, dest_alt, cruise_alt, descent_grad);
+    double dist_to_toc = find_distance_to_alt(dep_alt, cruise_alt, climb_grad);
+    double dist_from_dest_tod = find_distance_to_alt(dest_alt, cruise_alt, descent_grad);
     double tod_at = total_dist - dist_from_dest_tod;
     if (tod_at < 0) tod_at = 0;
+    auto profile = interpolate_profile(route, samples);
 
+    enter_stage(AllocStage::kOutput);
     std::cout << "Total distance: " << total_dist << " nm\n";
     std::cout << "Cruise altitude: " << cruise_alt << " ft\n";
     std::cout << "TOC ~ " << dist_to_toc << " nm from departure\n";
     std::cout << "TOD ~ " << dist_from_dest_tod << " nm from destination (at " << tod_at
               << " nm along route)\n\n";
-
-    auto profile = interpolate_profile(route, samples);
     render_ascii(profile);
     return 0;
 }
@@ -0,0 +1,229 @@
+// Weight and Balance: loads an airframe definition (stations, tanks, limits, CG envelope),
+// checks one loading from zero fuel through takeoff and the trip burn to landing, or searches
+// every combination of candidate loads for the feasible ones.
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/alloc_stats.hpp"
+#include "core/ofp.hpp"
+#include "core/strutil.hpp"
+#include "core/trace.hpp"
+#include "core/weight_balance.hpp"
+
+using namespace flightsuite;
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " --airframe file.wb [--load station=w,...] [--fuel w] [--taxi w] [--burn w]\n"
+              << "       [--ofp ofp.xml] [--steps 8] [--alloc-stats] [--trace out.json]\n"
+              << "   or: " << prog << " --airframe file.wb --batch options.csv [--taxi w] [--samples 3] [--top 10]\n"
+              << " --ofp takes ramp fuel, taxi, and trip burn from a SimBrief OFP and compares its planned weights.\n"
+              << " options.csv rows: station,candidate,... plus fuel,... and burn,... (every combination is tried)\n";
+}
+
+static std::string cg_text(const WbAirframe& af, double cg) {
+    std::string s = format_double(cg, 2);
+    if (af.mac > 0.0) s += " (" + format_double(af.percent_mac(cg), 1) + "%)";
+    return s;
+}
+
+static bool parse_loads(const WbAirframe& af, const std::string& spec, std::vector<double>& weights) {
+    weights.assign(af.stations.size(), 0.0);
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        auto idx = eq == std::string::npos ? std::nullopt : af.station_index(trim(item.substr(0, eq)));
+        auto w = eq == std::string::npos ? std::nullopt : parse_double(item.substr(eq + 1));
+        if (!idx || !w) {
+            std::cerr << "Bad load '" << item << "'; stations of " << af.name << ":";
+            for (const auto& s : af.stations) std::cerr << " " << s.name;
+            std::cerr << "\n";
+            return false;
+        }
+        weights[*idx] = *w;
+    }
+    return true;
+}
+
+// OFP weights come in the OFP's own unit; convert them to the airframe's.
+static double ofp_weight(const std::string& content, const WbAirframe& af, const std::optional<std::string>& v) {
+    double w = v ? parse_double(*v).value_or(0.0) : 0.0;
+    auto units = tag_value(content, {"units"});
+    bool ofp_kg = units && to_upper(*units).rfind("KG", 0) == 0;
+    bool af_kg = to_upper(af.weight_unit).rfind("KG", 0) == 0;
+    if (ofp_kg && !af_kg) return w / 0.45359237;
+    if (!ofp_kg && af_kg) return w * 0.45359237;
+    return w;
+}
+
+static void print_report(const WbAirframe& af, const WbLoad& load, const WbReport& r) {
+    const std::string& wu = af.weight_unit;
+    std::cout << af.name << " (" << wu << ", " << af.arm_unit << ")\n";
+    std::cout << std::left << std::setw(16) << "Item" << std::right << std::setw(10) << "Weight" << std::setw(10)
+              << "Arm" << std::setw(14) << "Moment" << "\n";
+    auto row = [](const std::string& name, double w, double arm) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(10) << format_double(w, 1)
+                  << std::setw(10) << format_double(arm, 2) << std::setw(14) << format_double(w * arm, 0) << "\n";
+    };
+    row("Empty", af.empty_weight, af.empty_arm);
+    for (size_t i = 0; i < af.stations.size(); ++i) {
+        double w = i < load.station_weights.size() ? load.station_weights[i] : 0.0;
+        if (w != 0.0) row(af.stations[i].name, w, af.stations[i].arm);
+    }
+    std::cout << "\nZero fuel " << format_double(r.zero_fuel_weight, 1) << "  ramp " << format_double(r.ramp_weight, 1)
+              << "  takeoff " << format_double(r.takeoff_weight, 1) << "  landing "
+              << format_double(r.landing_weight, 1) << " " << wu << "\n\n";
+
+    WbEnvelope envelope(af.envelope);
+    std::cout << std::left << std::setw(12) << "State" << std::right << std::setw(10) << "Fuel" << std::setw(10)
+              << "Weight" << std::setw(16) << "CG" << std::setw(24) << "Limits" << "  \n";
+    for (const auto& s : r.trajectory) {
+        std::string limits = "-";
+        if (auto range = envelope.cg_range(s.weight)) {
+            limits = format_double(range->first, 2) + " .. " + format_double(range->second, 2);
+        }
+        std::cout << std::left << std::setw(12) << s.label << std::right << std::setw(10) << format_double(s.fuel, 1)
+                  << std::setw(10) << format_double(s.weight, 1) << std::setw(16) << cg_text(af, s.cg)
+                  << std::setw(24) << limits << "  " << (s.in_envelope ? "ok" : "OUT") << "\n";
+    }
+    std::cout << "\n";
+    if (r.violations.empty()) {
+        std::cout << "Within limits for the whole flight.\n";
+    } else {
+        for (const auto& v : r.violations) std::cout << "LIMIT: " << v << "\n";
+    }
+}
+
+static void print_batch(const WbAirframe& af, const WbBatchResult& r) {
+    std::cout << af.name << ": " << r.total << " loadings, " << r.feasible << " feasible\n";
+    std::cout << "  rejected: " << r.over_weight << " over a weight limit, " << r.out_of_envelope
+              << " outside the CG envelope, " << r.short_of_fuel << " short of fuel or over capacity\n";
+    if (r.best.empty()) return;
+    std::cout << "\nMost payload first:\n";
+    std::vector<size_t> widths;
+    std::cout << std::right << std::setw(9) << "Payload";
+    for (const auto& s : af.stations) {
+        widths.push_back(std::max<size_t>(s.name.size(), 7) + 2);
+        std::cout << std::setw(static_cast<int>(widths.back())) << s.name;
+    }
+    std::cout << std::setw(9) << "Fuel" << std::setw(9) << "Burn" << std::setw(10) << "TOW" << std::setw(16)
+              << "TO CG" << std::setw(16) << "LDG CG" << "\n";
+    for (const auto& load : r.best) {
+        WbReport rep = evaluate_loading(af, load, 0);
+        double payload = rep.zero_fuel_weight - af.empty_weight;
+        std::cout << std::setw(9) << format_double(payload, 0);
+        for (size_t i = 0; i < af.stations.size(); ++i) {
+            std::cout << std::setw(static_cast<int>(widths[i])) << format_double(load.station_weights[i], 0);
+        }
+        std::cout << std::setw(9) << format_double(load.fuel, 0) << std::setw(9) << format_double(load.burn, 0)
+                  << std::setw(10) << format_double(rep.takeoff_weight, 0) << std::setw(16)
+                  << cg_text(af, rep.trajectory[1].cg) << std::setw(16) << cg_text(af, rep.trajectory.back().cg)
+                  << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    init_alloc_stats(argc, argv);
+    init_trace(argc, argv);
+    std::string airframe_path, load_spec, ofp_path, batch_path;
+    std::optional<double> fuel, taxi, burn;
+    size_t steps = 8, samples = 3, top = 10;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--airframe" && i + 1 < argc) {
+            airframe_path = argv[++i];
+        } else if (arg == "--load" && i + 1 < argc) {
+            load_spec = argv[++i];
+        } else if (arg == "--fuel" && i + 1 < argc) {
+            fuel = std::stod(argv[++i]);
+        } else if (arg == "--taxi" && i + 1 < argc) {
+            taxi = std::stod(argv[++i]);
+        } else if (arg == "--burn" && i + 1 < argc) {
+            burn = std::stod(argv[++i]);
+        } else if (arg == "--ofp" && i + 1 < argc) {
+            ofp_path = argv[++i];
+        } else if (arg == "--steps" && i + 1 < argc) {
+            steps = std::stoul(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch_path = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            samples = std::stoul(argv[++i]);
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = std::stoul(argv[++i]);
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (airframe_path.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    enter_stage(AllocStage::kParse);
+    WbAirframe af;
+    std::string error;
+    if (!load_wb_airframe(airframe_path, af, &error)) {
+        std::cerr << "Airframe: " << error << "\n";
+        return 1;
+    }
+
+    if (!batch_path.empty()) {
+        WbBatchOptions opt;
+        opt.taxi = taxi.value_or(0.0);
+        opt.burn_samples = samples;
+        opt.top = top;
+        if (!load_wb_batch_options(batch_path, af, opt, &error)) {
+            std::cerr << "Batch options: " << error << "\n";
+            return 1;
+        }
+        enter_stage(AllocStage::kAnalyze);
+        WbBatchResult result = evaluate_batch(af, opt);
+        enter_stage(AllocStage::kOutput);
+        print_batch(af, result);
+        return 0;
+    }
+
+    WbLoad load;
+    if (!parse_loads(af, load_spec, load.station_weights)) return 1;
+    std::string ofp;
+    if (!ofp_path.empty()) {
+        auto content = read_file(ofp_path);
+        if (!content) {
+            std::cerr << "Failed to read OFP: " << ofp_path << "\n";
+            return 1;
+        }
+        ofp = std::move(*content);
+        FuelInfo f = parse_fuel(ofp);
+        load.fuel = ofp_weight(ofp, af, f.ramp);
+        load.taxi = ofp_weight(ofp, af, f.taxi);
+        load.burn = ofp_weight(ofp, af, f.trip);
+    } else {
+        load.fuel = af.fuel_capacity();
+    }
+    if (fuel) load.fuel = *fuel;
+    if (taxi) load.taxi = *taxi;
+    if (burn) load.burn = *burn;
+
+    enter_stage(AllocStage::kAnalyze);
+    WbReport report = evaluate_loading(af, load, steps);
+    enter_stage(AllocStage::kOutput);
+    print_report(af, load, report);
+    if (!ofp.empty()) {
+        auto planned = [&](std::initializer_list<std::string> tags) { return ofp_weight(ofp, af, tag_value(ofp, tags)); };
+        std::cout << "\nOFP plan (" << af.weight_unit << "): zero fuel " << format_double(planned({"plan_zfw", "est_zfw"}), 0)
+                  << ", takeoff " << format_double(planned({"plan_takeoff"}), 0) << ", landing "
+                  << format_double(planned({"plan_landing"}), 0) << "\n";
+    }
+    return report.violations.empty() ? 0 : 2;
+}